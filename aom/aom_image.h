@@ -30,7 +30,7 @@ extern "C" {
  * types, removing or reassigning enums, adding/removing/rearranging
  * fields to structures
  */
-#define AOM_IMAGE_ABI_VERSION (5) /**<\hideinitializer*/
+#define AOM_IMAGE_ABI_VERSION (6) /**<\hideinitializer*/
 
 #define AOM_IMG_FMT_PLANAR 0x100  /**< Image is a planar format. */
 #define AOM_IMG_FMT_UV_FLIP 0x200 /**< V plane precedes U in memory. */
@@ -137,6 +137,15 @@ typedef enum aom_chroma_sample_position {
   AOM_CSP_RESERVED = 3          /**< Reserved value */
 } aom_chroma_sample_position_t; /**< alias for enum aom_transfer_function */
 
+/*!\brief Image release callback prototype
+ *
+ * Called by an encoder once it no longer references the data of an image
+ * passed to aom_codec_encode(). See aom_image_t::release_cb.
+ *
+ * \param[in] priv     Callback's private data (aom_image_t::release_cb_priv)
+ */
+typedef void (*aom_release_image_cb_fn_t)(void *priv);
+
 /**\brief Image Descriptor */
 typedef struct aom_image {
   aom_img_fmt_t fmt;                 /**< Image Format */
@@ -189,7 +198,31 @@ typedef struct aom_image {
   int self_allocd;         /**< private */
 
   void *fb_priv; /**< Frame buffer data associated with the image. */
-} aom_image_t;   /**< alias for struct aom_image */
+
+  /*!\brief Padding, in pixels, around each side of the planes.
+   *
+   * Set by aom_img_alloc_with_border(). Applications that allocate their own
+   * padded planes may set it to the padding they provide.
+   */
+  unsigned int border;
+
+  /*!\brief Release callback for zero-copy encoding.
+   *
+   * If set on an image passed to aom_codec_encode(), the encoder may keep a
+   * reference to the image data in its lookahead queue instead of copying it,
+   * and calls release_cb(release_cb_priv) exactly once when it is done with
+   * the data. Until then the application must not modify or free the planes,
+   * and the encoder may write into the border to extend the edge pixels.
+   *
+   * The data is referenced only if its layout matches the encoder's internal
+   * frame buffers, e.g. for widths that are a multiple of 128, an image from
+   * aom_img_alloc_with_border() with align = 32, size_align = 8 and
+   * border = 64. Otherwise the data is copied and release_cb is called before
+   * aom_codec_encode() returns.
+   */
+  aom_release_image_cb_fn_t release_cb;
+  void *release_cb_priv; /**< Private data passed to release_cb */
+} aom_image_t;           /**< alias for struct aom_image */
 
 /**\brief Representation of a rectangle on a surface */
 typedef struct aom_image_rect {
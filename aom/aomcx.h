@@ -1108,7 +1108,22 @@ enum aome_enc_control_id {
    * ratio of each frame to be higher than the given value divided by 100.
    * E.g. 850 means minimum compression ratio of 8.5.
    */
-  AV1E_SET_MIN_CR
+  AV1E_SET_MIN_CR,
+
+  /*!\brief Codec control function to get the memory used by the encoder.
+   *
+   * Takes a pointer to two size_t values, which receive the number of bytes
+   * currently allocated by the encoder instance and the peak so far. Returns
+   * AOM_CODEC_INCAPABLE unless libaom is built with CONFIG_MEM_POOL.
+   */
+  AV1E_GET_MEM_USAGE,
+
+  /*!\brief Codec control function to get the time spent in each stage of the
+   * encoder by the last call to aom_codec_encode().
+   *
+   * Takes a pointer to an aom_enc_frame_stats_t.
+   */
+  AV1E_GET_FRAME_STATS
 };
 
 /*!\brief aom 1-D scaling mode
@@ -1172,6 +1187,39 @@ typedef struct aom_scaling_mode {
   AOM_SCALING_MODE v_scaling_mode; /**< vertical scaling mode   */
 } aom_scaling_mode_t;
 
+/*!\brief Encoder stages timed by AV1E_GET_FRAME_STATS */
+typedef enum {
+  AOM_ENC_STAGE_FIRST_PASS,      /**< First pass statistics */
+  AOM_ENC_STAGE_TEMPORAL_FILTER, /**< Temporal filtering of the ARFs */
+  AOM_ENC_STAGE_TPL,             /**< TPL model */
+  /*! Frame level motion search: global motion and motion field projection */
+  AOM_ENC_STAGE_MOTION_SEARCH,
+  /*! Partition and mode RD search and encoding of the tiles, including the
+   * block level motion search */
+  AOM_ENC_STAGE_RD_SEARCH,
+  AOM_ENC_STAGE_LOOP_FILTER_SEARCH, /**< Loop filter level search */
+  AOM_ENC_STAGE_CDEF_SEARCH,        /**< CDEF strength search */
+  AOM_ENC_STAGE_LR_SEARCH,          /**< Loop restoration search */
+  AOM_ENC_STAGE_PACK_BITSTREAM,     /**< Bitstream packing */
+  AOM_ENC_STAGES                    /**< Number of stages */
+} aom_enc_stage_t;
+
+/*!\brief Encoder stage timing
+ *
+ * The wall clock time, in microseconds, that the frames encoded by a call to
+ * aom_codec_encode() spent in each stage of the encoder. Stages that run on
+ * worker threads are timed on the calling thread, so the times of the
+ * stages add up to at most the total time.
+ */
+typedef struct aom_enc_frame_stats {
+  /*! Number of frames encoded, including frames that are not shown. */
+  unsigned int frames;
+  /*! Time spent in each of the stages. */
+  uint64_t stage_time[AOM_ENC_STAGES];
+  /*! Total time spent encoding the frames. */
+  uint64_t total_time;
+} aom_enc_frame_stats_t;
+
 /*!brief AV1 encoder content type */
 typedef enum {
   AOM_CONTENT_DEFAULT,
@@ -1533,6 +1581,12 @@ AOM_CTRL_USE_TYPE(AV1E_SET_TIER_MASK, unsigned int)
 AOM_CTRL_USE_TYPE(AV1E_SET_MIN_CR, unsigned int)
 #define AOM_CTRL_AV1E_SET_MIN_CR
 
+AOM_CTRL_USE_TYPE(AV1E_GET_MEM_USAGE, size_t *)
+#define AOM_CTRL_AV1E_GET_MEM_USAGE
+
+AOM_CTRL_USE_TYPE(AV1E_GET_FRAME_STATS, aom_enc_frame_stats_t *)
+#define AOM_CTRL_AV1E_GET_FRAME_STATS
+
 /*!\endcond */
 /*! @} - end defgroup aom_encoder */
 #ifdef __cplusplus
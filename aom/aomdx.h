@@ -100,6 +100,121 @@ typedef struct av1_ext_ref_frame {
   int num;
 } av1_ext_ref_frame_t;
 
+/*!\brief Stages of the decoder timed by AV1D_GET_FRAME_STATS. */
+typedef enum {
+  /*! Sequence and frame header parsing, and the frame setup that follows. */
+  AOM_DEC_STAGE_HEADER,
+  /*! Tiles parsed and reconstructed in one pass, block by block, which is
+   * how they are decoded unless row based multithreading is used. */
+  AOM_DEC_STAGE_TILE_DECODE,
+  /*! Parsing of the tile data with row based multithreading. */
+  AOM_DEC_STAGE_ENTROPY_DECODE,
+  /*! Reconstruction of the parsed superblock rows with row based
+   * multithreading, including waiting for the row above. */
+  AOM_DEC_STAGE_RECON,
+  /*! Deblocking filter. */
+  AOM_DEC_STAGE_LOOP_FILTER,
+  /*! CDEF. */
+  AOM_DEC_STAGE_CDEF,
+  /*! Super-resolution upscaling. */
+  AOM_DEC_STAGE_SUPERRES,
+  /*! Loop restoration. */
+  AOM_DEC_STAGE_LOOP_RESTORATION,
+  /*! Film grain synthesis, timed when the frame is returned by
+   * aom_codec_get_frame(). */
+  AOM_DEC_STAGE_FILM_GRAIN,
+  /*! Time a thread spent waiting for work while the tile workers were
+   * running. */
+  AOM_DEC_STAGE_IDLE,
+  /*! Number of stages. */
+  AOM_DEC_STAGES
+} aom_dec_stage_t;
+
+/*!\brief Number of threads reported by AV1D_GET_FRAME_STATS. */
+#define AOM_DEC_STATS_MAX_THREADS 64
+
+/*!\brief Time spent in each stage of the decoder.
+ *
+ * Filled in by AV1D_GET_FRAME_STATS. The times are in microseconds of wall
+ * time. Entry 0 of thread_time is the thread that calls aom_codec_decode(),
+ * and the other entries are the tile worker threads. Threads past
+ * AOM_DEC_STATS_MAX_THREADS are not reported.
+ */
+typedef struct aom_dec_frame_stats {
+  /*! Number of frames decoded, including shown existing frames. */
+  unsigned int frames;
+  /*! Number of entries of thread_time in use. */
+  int num_threads;
+  /*! Time each thread spent in each stage. */
+  uint64_t thread_time[AOM_DEC_STATS_MAX_THREADS][AOM_DEC_STAGES];
+  /*! Time spent in each stage, summed over the threads. */
+  uint64_t stage_time[AOM_DEC_STAGES];
+  /*! Time spent in aom_codec_decode() and in the film grain synthesis. */
+  uint64_t total_time;
+} aom_dec_frame_stats_t;
+
+/*!rief Film grain parameters of a frame.
+ *
+ * Filled in by AV1D_GET_FILM_GRAIN_PARAMS with the film_grain_params() of the
+ * frame, as named and constrained by the AV1 specification, with the values
+ * the decoding process derives from the signaled ones.
+ */
+typedef struct aom_film_grain_params {
+  /*! Whether film grain is added to the frame. The other members are only
+   * set when it is. */
+  int apply_grain;
+  /*! Seed of the pseudo-random numbers of the grain of the frame. */
+  uint16_t random_seed;
+  /*! Number of points of the piecewise linear luma scaling function. */
+  int num_y_points;
+  /*! Value and scaling of each point of the luma scaling function. */
+  int scaling_points_y[14][2];
+  /*! Number of points of the cb scaling function. */
+  int num_cb_points;
+  /*! Value and scaling of each point of the cb scaling function. */
+  int scaling_points_cb[10][2];
+  /*! Number of points of the cr scaling function. */
+  int num_cr_points;
+  /*! Value and scaling of each point of the cr scaling function. */
+  int scaling_points_cr[10][2];
+  /*! Whether the chroma scaling is derived from the luma scaling function. */
+  int chroma_scaling_from_luma;
+  /*! Shift of the scaling function output, from 8 to 11. */
+  int scaling_shift;
+  /*! Lag of the auto-regressive filter of the grain, from 0 to 3. */
+  int ar_coeff_lag;
+  /*! Luma auto-regressive coefficients, from -128 to 127. */
+  int ar_coeffs_y[24];
+  /*! Cb auto-regressive coefficients, from -128 to 127. The last one applies
+   * to the luma grain. */
+  int ar_coeffs_cb[25];
+  /*! Cr auto-regressive coefficients, from -128 to 127. The last one applies
+   * to the luma grain. */
+  int ar_coeffs_cr[25];
+  /*! Shift of the auto-regressive coefficients, from 6 to 9. */
+  int ar_coeff_shift;
+  /*! Downscaling shift of the Gaussian grain, from 0 to 3. */
+  int grain_scale_shift;
+  /*! Multiplier of the cb component in the cb scaling function input. */
+  int cb_mult;
+  /*! Multiplier of the luma component in the cb scaling function input. */
+  int cb_luma_mult;
+  /*! Offset of the cb scaling function input. */
+  int cb_offset;
+  /*! Multiplier of the cr component in the cr scaling function input. */
+  int cr_mult;
+  /*! Multiplier of the luma component in the cr scaling function input. */
+  int cr_luma_mult;
+  /*! Offset of the cr scaling function input. */
+  int cr_offset;
+  /*! Whether the grain blocks overlap. */
+  int overlap_flag;
+  /*! Whether the output is clipped to the restricted range. */
+  int clip_to_restricted_range;
+  /*! Bit depth of the frame. */
+  unsigned int bit_depth;
+} aom_film_grain_params_t;
+
 /*!\enum aom_dec_control_id
  * \brief AOM decoder control functions
  *
@@ -252,6 +367,73 @@ enum aom_dec_control_id {
    */
   AV1D_SET_SKIP_FILM_GRAIN,
 
+  /** control function to set the number of frames the decoder may decode
+   * concurrently. Valid values are unsigned integers up to 4. The default
+   * value 0, like 1, decodes frames serially. With larger values,
+   * consecutive frames are decoded by that many frame worker threads, which
+   * share the threads set in aom_codec_dec_cfg_t. Decoded frames are then
+   * returned up to that many frames later, so the application has to flush
+   * the decoder (call aom_codec_decode() with NULL data) at the end of the
+   * stream, and decode errors may be reported by a later aom_codec_decode()
+   * call. A frame starts once the tiles of the frame before it are decoded,
+   * or right after its header when that frame disables the frame end update
+   * of the CDFs. It then waits for each row of a reference frame to be
+   * filtered before predicting from it. A reference frame without any loop
+   * filter, CDEF or loop restoration instead signals each tile row once it
+   * is decoded, provided its tiles are decoded on a single thread. Otherwise,
+   * and with superres, a reference frame only becomes available once it is
+   * fully decoded. Must be set before the first frame is decoded. Has no
+   * effect in large scale tile mode, with AV1D_SET_OUTPUT_ALL_LAYERS or with
+   * an inspection callback.
+   */
+  AV1D_SET_FRAME_PARALLEL_DEPTH,
+
+  /** control function to get the memory used by the decoder. Takes a pointer
+   * to two size_t values, which receive the number of bytes currently
+   * allocated by the decoder instance and the peak so far. Returns
+   * AOM_CODEC_INCAPABLE unless libaom is built with CONFIG_MEM_POOL.
+   */
+  AV1D_GET_MEM_USAGE,
+
+  /** control function to enable adding the film grain with multiple threads.
+   * A value that is equal to 1 indicates that the grain is added to
+   * horizontal stripes of the frame in parallel, using the tile worker
+   * threads of the decoder. The default value is 1. Has no effect when frames
+   * are decoded in parallel. The output does not depend on this setting.
+   */
+  AV1D_SET_FILM_GRAIN_MT,
+
+  /** control function to get the time spent in each stage of the decoder,
+   * per thread, by the last call to aom_codec_decode() and by the film grain
+   * synthesis of the frames it returned. Takes a pointer to an
+   * aom_dec_frame_stats_t. Returns AOM_CODEC_INCAPABLE when frames are
+   * decoded in parallel. The loop filter, CDEF and loop restoration of frames
+   * using superres or intra block copy, and the film grain synthesis, are
+   * timed as a whole on the decoding thread.
+   */
+  AV1D_GET_FRAME_STATS,
+
+  /** control function to let the decoder add the film grain in place, to
+   * the frame buffer it decoded the frame into, instead of to a new image.
+   * This is only done when the frame buffer is not kept as a reference
+   * frame, so that no copy of the frame is made; the grain is added to a new
+   * image as before otherwise. A frame returned with its grain added in
+   * place is also returned with the grain by AV1_GET_NEW_FRAME_IMAGE and
+   * AV1_COPY_NEW_FRAME_IMAGE. Valid values are unsigned integers. The
+   * default value 0 always adds the grain to a new image.
+   */
+  AV1D_SET_FILM_GRAIN_IN_PLACE,
+
+  /** control function to get the film grain parameters of the last frame
+   * returned by aom_codec_get_frame(). Takes a pointer to an
+   * aom_film_grain_params_t. apply_grain is 0 when the frame has no film
+   * grain. The parameters do not
+   * depend on AV1D_SET_SKIP_FILM_GRAIN, so an application may skip the film
+   * grain in the decoder and add it to the frames itself. Returns
+   * AOM_CODEC_ERROR before the first frame is returned.
+   */
+  AV1D_GET_FILM_GRAIN_PARAMS,
+
   AOM_DECODER_CTRL_ID_MAX,
 };
 
@@ -305,6 +487,18 @@ AOM_CTRL_USE_TYPE(AV1D_SET_ROW_MT, unsigned int)
 #define AOM_CTRL_AV1D_SET_ROW_MT
 AOM_CTRL_USE_TYPE(AV1D_SET_SKIP_FILM_GRAIN, int)
 #define AOM_CTRL_AV1D_SET_SKIP_FILM_GRAIN
+AOM_CTRL_USE_TYPE(AV1D_SET_FRAME_PARALLEL_DEPTH, unsigned int)
+#define AOM_CTRL_AV1D_SET_FRAME_PARALLEL_DEPTH
+AOM_CTRL_USE_TYPE(AV1D_GET_MEM_USAGE, size_t *)
+#define AOM_CTRL_AV1D_GET_MEM_USAGE
+AOM_CTRL_USE_TYPE(AV1D_SET_FILM_GRAIN_MT, unsigned int)
+#define AOM_CTRL_AV1D_SET_FILM_GRAIN_MT
+AOM_CTRL_USE_TYPE(AV1D_GET_FRAME_STATS, aom_dec_frame_stats_t *)
+#define AOM_CTRL_AV1D_GET_FRAME_STATS
+AOM_CTRL_USE_TYPE(AV1D_SET_FILM_GRAIN_IN_PLACE, unsigned int)
+#define AOM_CTRL_AV1D_SET_FILM_GRAIN_IN_PLACE
+AOM_CTRL_USE_TYPE(AV1D_GET_FILM_GRAIN_PARAMS, aom_film_grain_params_t *)
+#define AOM_CTRL_AV1D_GET_FILM_GRAIN_PARAMS
 AOM_CTRL_USE_TYPE(AV1D_SET_IS_ANNEXB, unsigned int)
 #define AOM_CTRL_AV1D_SET_IS_ANNEXB
 AOM_CTRL_USE_TYPE(AV1D_SET_OPERATING_POINT, int)
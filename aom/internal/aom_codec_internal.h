@@ -334,6 +334,8 @@ typedef struct aom_codec_priv_cb_pair {
 struct aom_codec_priv {
   const char *err_detail;
   aom_codec_flags_t init_flags;
+  // Charged for the memory allocated by calls into this instance.
+  struct aom_mem_usage *mem_usage;
   struct {
     aom_codec_priv_cb_pair_t put_frame_cb;
     aom_codec_priv_cb_pair_t put_slice_cb;
@@ -21,6 +21,7 @@
 
 #include "aom/aom_integer.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
 
@@ -74,7 +75,11 @@ aom_codec_err_t aom_codec_destroy(aom_codec_ctx_t *ctx) {
   else if (!ctx->iface || !ctx->priv)
     res = AOM_CODEC_ERROR;
   else {
+    aom_mem_usage_t *const mem_usage = ctx->priv->mem_usage;
+    aom_mem_usage_t *const prev_usage = aom_mem_usage_select(mem_usage);
     ctx->iface->destroy((aom_codec_alg_priv_t *)ctx->priv);
+    aom_mem_usage_select(prev_usage);
+    aom_mem_usage_destroy(mem_usage);
 
     ctx->iface = NULL;
     ctx->name = NULL;
@@ -106,7 +111,10 @@ aom_codec_err_t aom_codec_control_(aom_codec_ctx_t *ctx, int ctrl_id, ...) {
         va_list ap;
 
         va_start(ap, ctrl_id);
+        aom_mem_usage_t *const prev_usage =
+            aom_mem_usage_select(ctx->priv->mem_usage);
         res = entry->fn((aom_codec_alg_priv_t *)ctx->priv, ap);
+        aom_mem_usage_select(prev_usage);
         va_end(ap);
         break;
       }
@@ -15,6 +15,7 @@
  */
 #include <string.h>
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
 
@@ -47,7 +48,14 @@ aom_codec_err_t aom_codec_dec_init_ver(aom_codec_ctx_t *ctx,
     ctx->init_flags = flags;
     ctx->config.dec = cfg;
 
+    aom_mem_usage_t *const mem_usage = aom_mem_usage_create();
+    aom_mem_usage_t *const prev_usage = aom_mem_usage_select(mem_usage);
     res = ctx->iface->init(ctx, NULL);
+    aom_mem_usage_select(prev_usage);
+    if (ctx->priv)
+      ctx->priv->mem_usage = mem_usage;
+    else
+      aom_mem_usage_destroy(mem_usage);
     if (res) {
       ctx->err_detail = ctx->priv ? ctx->priv->err_detail : NULL;
       aom_codec_destroy(ctx);
@@ -103,7 +111,10 @@ aom_codec_err_t aom_codec_decode(aom_codec_ctx_t *ctx, const uint8_t *data,
   else if (!ctx->iface || !ctx->priv)
     res = AOM_CODEC_ERROR;
   else {
+    aom_mem_usage_t *const prev_usage =
+        aom_mem_usage_select(ctx->priv->mem_usage);
     res = ctx->iface->dec.decode(get_alg_priv(ctx), data, data_sz, user_priv);
+    aom_mem_usage_select(prev_usage);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -112,10 +123,14 @@ aom_codec_err_t aom_codec_decode(aom_codec_ctx_t *ctx, const uint8_t *data,
 aom_image_t *aom_codec_get_frame(aom_codec_ctx_t *ctx, aom_codec_iter_t *iter) {
   aom_image_t *img;
 
-  if (!ctx || !iter || !ctx->iface || !ctx->priv)
+  if (!ctx || !iter || !ctx->iface || !ctx->priv) {
     img = NULL;
-  else
+  } else {
+    aom_mem_usage_t *const prev_usage =
+        aom_mem_usage_select(ctx->priv->mem_usage);
     img = ctx->iface->dec.get_frame(get_alg_priv(ctx), iter);
+    aom_mem_usage_select(prev_usage);
+  }
 
   return img;
 }
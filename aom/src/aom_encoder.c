@@ -25,6 +25,7 @@
 #include <limits.h>
 #include <string.h>
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_mem/aom_mem.h"
 
 #define SAVE_STATUS(ctx, var) (ctx ? (ctx->err = var) : var)
 
@@ -54,7 +55,14 @@ aom_codec_err_t aom_codec_enc_init_ver(aom_codec_ctx_t *ctx,
     ctx->priv = NULL;
     ctx->init_flags = flags;
     ctx->config.enc = cfg;
+    aom_mem_usage_t *const mem_usage = aom_mem_usage_create();
+    aom_mem_usage_t *const prev_usage = aom_mem_usage_select(mem_usage);
     res = ctx->iface->init(ctx, NULL);
+    aom_mem_usage_select(prev_usage);
+    if (ctx->priv)
+      ctx->priv->mem_usage = mem_usage;
+    else
+      aom_mem_usage_destroy(mem_usage);
 
     if (res) {
       ctx->err_detail = ctx->priv ? ctx->priv->err_detail : NULL;
@@ -223,6 +231,8 @@ aom_codec_err_t aom_codec_encode(aom_codec_ctx_t *ctx, const aom_image_t *img,
     res = AOM_CODEC_INCAPABLE;
   else {
     unsigned int num_enc = ctx->priv->enc.total_encoders;
+    aom_mem_usage_t *const prev_usage =
+        aom_mem_usage_select(ctx->priv->mem_usage);
 
     /* Execute in a normalized floating point environment, if the platform
      * requires it.
@@ -255,6 +265,7 @@ aom_codec_err_t aom_codec_encode(aom_codec_ctx_t *ctx, const aom_image_t *img,
     }
 
     FLOATING_POINT_RESTORE
+    aom_mem_usage_select(prev_usage);
   }
 
   return SAVE_STATUS(ctx, res);
@@ -368,8 +379,12 @@ aom_codec_err_t aom_codec_enc_config_set(aom_codec_ctx_t *ctx,
     res = AOM_CODEC_INVALID_PARAM;
   else if (!(ctx->iface->caps & AOM_CODEC_CAP_ENCODER))
     res = AOM_CODEC_INCAPABLE;
-  else
+  else {
+    aom_mem_usage_t *const prev_usage =
+        aom_mem_usage_select(ctx->priv->mem_usage);
     res = ctx->iface->enc.cfg_set(get_alg_priv(ctx), cfg);
+    aom_mem_usage_select(prev_usage);
+  }
 
   return SAVE_STATUS(ctx, res);
 }
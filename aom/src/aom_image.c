@@ -145,6 +145,7 @@ static aom_image_t *img_alloc_helper(
   img->x_chroma_shift = xcs;
   img->y_chroma_shift = ycs;
   img->bps = bps;
+  img->border = border;
 
   /* Calculate strides */
   img->stride[AOM_PLANE_Y] = stride_in_bytes;
@@ -54,13 +54,13 @@ push @block_sizes, [32, 8];
 push @block_sizes, [16, 64];
 push @block_sizes, [64, 16];
 
-@tx_dims = (2, 4, 8, 16, 32, 64);
+@tx_dims = (4, 8, 16, 32, 64);
 @tx_sizes = ();
 foreach $w (@tx_dims) {
   push @tx_sizes, [$w, $w];
   foreach $h (@tx_dims) {
-    push @tx_sizes, [$w, $h] if ($w >=4 && $h >=4 && ($w == 2*$h || $h == 2*$w));
-    push @tx_sizes, [$w, $h] if ($w >=4 && $h >=4 && ($w == 4*$h || $h == 4*$w));
+    push @tx_sizes, [$w, $h] if ($w == 2*$h || $h == 2*$w);
+    push @tx_sizes, [$w, $h] if ($w == 4*$h || $h == 4*$w);
   }
 }
 
@@ -466,6 +466,26 @@ specialize qw/aom_highbd_lpf_horizontal_4 sse2/;
 add_proto qw/void aom_highbd_lpf_horizontal_4_dual/, "uint16_t *s, int pitch, const uint8_t *blimit0, const uint8_t *limit0, const uint8_t *thresh0, const uint8_t *blimit1, const uint8_t *limit1, const uint8_t *thresh1, int bd";
 specialize qw/aom_highbd_lpf_horizontal_4_dual sse2 avx2/;
 
+#
+# Film grain synthesis
+#
+if (aom_config("CONFIG_AV1_DECODER") eq "yes") {
+  add_proto qw/void aom_film_grain_add_luma_noise/, "uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const int *scaling_lut, int scaling_shift, int min_luma, int max_luma";
+  specialize qw/aom_film_grain_add_luma_noise avx2/;
+
+  add_proto qw/void aom_film_grain_add_chroma_noise/, "uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut, int scaling_shift, int luma_mult, int chroma_mult, int offset, int min_chroma, int max_chroma";
+  specialize qw/aom_film_grain_add_chroma_noise avx2/;
+
+  add_proto qw/void aom_highbd_film_grain_add_luma_noise/, "uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, const int *scaling_lut, int scaling_shift, int min_luma, int max_luma, int bd";
+  specialize qw/aom_highbd_film_grain_add_luma_noise avx2/;
+
+  add_proto qw/void aom_highbd_film_grain_add_chroma_noise/, "uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride, const int *grain, int grain_stride, int width, int height, int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut, int scaling_shift, int luma_mult, int chroma_mult, int offset, int min_chroma, int max_chroma, int bd";
+  specialize qw/aom_highbd_film_grain_add_chroma_noise avx2/;
+
+  add_proto qw/void aom_film_grain_hor_overlap/, "const int *top, int top_stride, const int *bottom, int bottom_stride, int *dst, int dst_stride, int width, int height, int min_value, int max_value";
+  specialize qw/aom_film_grain_hor_overlap avx2/;
+}  # CONFIG_AV1_DECODER
+
 #
 # Encoder functions.
 #
@@ -509,6 +529,13 @@ if (aom_config("CONFIG_AV1_ENCODER") eq "yes"){
 
     add_proto qw/void aom_ifft32x32_float/, "const float *input, float *temp, float *output";
     specialize qw/aom_ifft32x32_float avx2          sse2/;
+
+    # Pointwise operations on the blocks and spectra of the Wiener denoiser
+    add_proto qw/void aom_noise_tx_wiener_filter/, "float *tx_block, const float *psd, int n";
+    specialize qw/aom_noise_tx_wiener_filter avx2/;
+
+    add_proto qw/void aom_noise_pointwise_multiply/, "const float *a, float *b, int n";
+    specialize qw/aom_noise_pointwise_multiply avx2/;
 }  # CONFIG_AV1_ENCODER
 
 #
@@ -57,6 +57,14 @@ static INLINE int aom_stop_encode(aom_writer *bc) {
   return aom_daala_stop_encode(bc);
 }
 
+static INLINE int aom_finish_encode(aom_writer *bc) {
+  return aom_daala_finish_encode(bc);
+}
+
+static INLINE void aom_release_encode(aom_writer *bc) {
+  aom_daala_release_encode(bc);
+}
+
 static INLINE void aom_write(aom_writer *br, int bit, int probability) {
   aom_daala_write(br, bit, probability);
 }
@@ -29,3 +29,15 @@ int aom_daala_stop_encode(daala_writer *br) {
   od_ec_enc_clear(&br->ec);
   return nb_bits;
 }
+
+int aom_daala_finish_encode(daala_writer *br) {
+  uint32_t daala_bytes;
+  br->buffer = od_ec_enc_done(&br->ec, &daala_bytes);
+  br->pos = daala_bytes;
+  return od_ec_enc_tell(&br->ec);
+}
+
+void aom_daala_release_encode(daala_writer *br) {
+  od_ec_enc_clear(&br->ec);
+  br->buffer = NULL;
+}
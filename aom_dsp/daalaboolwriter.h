@@ -35,6 +35,12 @@ typedef struct daala_writer daala_writer;
 
 void aom_daala_start_encode(daala_writer *w, uint8_t *buffer);
 int aom_daala_stop_encode(daala_writer *w);
+// Ends coding like aom_daala_stop_encode(), but leaves the w->pos coded bytes
+// in the writer's own storage, pointed to by w->buffer, so that the caller can
+// copy them once it knows where they go. aom_daala_release_encode() then frees
+// the storage.
+int aom_daala_finish_encode(daala_writer *w);
+void aom_daala_release_encode(daala_writer *w);
 
 static INLINE void aom_daala_write(daala_writer *w, int bit, int prob) {
   int p = (0x7FFFFF - (prob << 15) + prob) >> 8;
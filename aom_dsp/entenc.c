@@ -144,6 +144,8 @@ void od_ec_enc_reset(od_ec_enc *enc) {
 void od_ec_enc_clear(od_ec_enc *enc) {
   free(enc->precarry_buf);
   free(enc->buf);
+  enc->precarry_buf = NULL;
+  enc->buf = NULL;
 }
 
 /*Encodes a symbol given its frequency in Q15.
@@ -18,6 +18,9 @@
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
+
+#include "config/aom_dsp_rtcd.h"
+
 #include "aom_dsp/grain_synthesis.h"
 #include "aom_mem/aom_mem.h"
 
@@ -228,27 +231,11 @@ static const int max_luma_legal_range = 235;
 static const int min_chroma_legal_range = 16;
 static const int max_chroma_legal_range = 240;
 
-static int scaling_lut_y[256];
-static int scaling_lut_cb[256];
-static int scaling_lut_cr[256];
-
 static int grain_min;
 static int grain_max;
 
-static uint16_t random_register = 0;  // random number generator register
-
-static void init_arrays(const aom_film_grain_t *params, int luma_stride,
-                        int chroma_stride, int ***pred_pos_luma_p,
-                        int ***pred_pos_chroma_p, int **luma_grain_block,
-                        int **cb_grain_block, int **cr_grain_block,
-                        int **y_line_buf, int **cb_line_buf, int **cr_line_buf,
-                        int **y_col_buf, int **cb_col_buf, int **cr_col_buf,
-                        int luma_grain_samples, int chroma_grain_samples,
-                        int chroma_subsamp_y, int chroma_subsamp_x) {
-  memset(scaling_lut_y, 0, sizeof(*scaling_lut_y) * 256);
-  memset(scaling_lut_cb, 0, sizeof(*scaling_lut_cb) * 256);
-  memset(scaling_lut_cr, 0, sizeof(*scaling_lut_cr) * 256);
-
+static void init_arrays(const aom_film_grain_t *params,
+                        int ***pred_pos_luma_p, int ***pred_pos_chroma_p) {
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int num_pos_chroma = num_pos_luma;
   if (params->num_y_points > 0) ++num_pos_chroma;
@@ -305,38 +292,10 @@ static void init_arrays(const aom_film_grain_t *params, int luma_stride,
 
   *pred_pos_luma_p = pred_pos_luma;
   *pred_pos_chroma_p = pred_pos_chroma;
-
-  *y_line_buf = (int *)aom_malloc(sizeof(**y_line_buf) * luma_stride * 2);
-  *cb_line_buf = (int *)aom_malloc(sizeof(**cb_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-  *cr_line_buf = (int *)aom_malloc(sizeof(**cr_line_buf) * chroma_stride *
-                                   (2 >> chroma_subsamp_y));
-
-  *y_col_buf =
-      (int *)aom_malloc(sizeof(**y_col_buf) * (luma_subblock_size_y + 2) * 2);
-  *cb_col_buf =
-      (int *)aom_malloc(sizeof(**cb_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-  *cr_col_buf =
-      (int *)aom_malloc(sizeof(**cr_col_buf) *
-                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
-                        (2 >> chroma_subsamp_x));
-
-  *luma_grain_block =
-      (int *)aom_malloc(sizeof(**luma_grain_block) * luma_grain_samples);
-  *cb_grain_block =
-      (int *)aom_malloc(sizeof(**cb_grain_block) * chroma_grain_samples);
-  *cr_grain_block =
-      (int *)aom_malloc(sizeof(**cr_grain_block) * chroma_grain_samples);
 }
 
 static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
-                           int ***pred_pos_chroma, int **luma_grain_block,
-                           int **cb_grain_block, int **cr_grain_block,
-                           int **y_line_buf, int **cb_line_buf,
-                           int **cr_line_buf, int **y_col_buf, int **cb_col_buf,
-                           int **cr_col_buf) {
+                           int ***pred_pos_chroma) {
   int num_pos_luma = 2 * params->ar_coeff_lag * (params->ar_coeff_lag + 1);
   int num_pos_chroma = num_pos_luma;
   if (params->num_y_points > 0) ++num_pos_chroma;
@@ -350,56 +309,42 @@ static void dealloc_arrays(const aom_film_grain_t *params, int ***pred_pos_luma,
     aom_free((*pred_pos_chroma)[row]);
   }
   aom_free((*pred_pos_chroma));
-
-  aom_free(*y_line_buf);
-
-  aom_free(*cb_line_buf);
-
-  aom_free(*cr_line_buf);
-
-  aom_free(*y_col_buf);
-
-  aom_free(*cb_col_buf);
-
-  aom_free(*cr_col_buf);
-
-  aom_free(*luma_grain_block);
-
-  aom_free(*cb_grain_block);
-
-  aom_free(*cr_grain_block);
 }
 
 // get a number between 0 and 2^bits - 1
-static INLINE int get_random_number(int bits) {
+// The generator state is passed in, rather than kept in a static, so that
+// stripes of the frame can be processed on different threads.
+static INLINE int get_random_number(int bits, uint16_t *random_register) {
   uint16_t bit;
-  bit = ((random_register >> 0) ^ (random_register >> 1) ^
-         (random_register >> 3) ^ (random_register >> 12)) &
+  bit = ((*random_register >> 0) ^ (*random_register >> 1) ^
+         (*random_register >> 3) ^ (*random_register >> 12)) &
         1;
-  random_register = (random_register >> 1) | (bit << 15);
-  return (random_register >> (16 - bits)) & ((1 << bits) - 1);
+  *random_register = (*random_register >> 1) | (bit << 15);
+  return (*random_register >> (16 - bits)) & ((1 << bits) - 1);
 }
 
-static void init_random_generator(int luma_line, uint16_t seed) {
+static void init_random_generator(int luma_line, uint16_t seed,
+                                  uint16_t *random_register) {
   // same for the picture
 
   uint16_t msb = (seed >> 8) & 255;
   uint16_t lsb = seed & 255;
 
-  random_register = (msb << 8) + lsb;
+  *random_register = (msb << 8) + lsb;
 
   //  changes for each row
   int luma_num = luma_line >> 5;
 
-  random_register ^= ((luma_num * 37 + 178) & 255) << 8;
-  random_register ^= ((luma_num * 173 + 105) & 255);
+  *random_register ^= ((luma_num * 37 + 178) & 255) << 8;
+  *random_register ^= ((luma_num * 173 + 105) & 255);
 }
 
 // Return 0 for success, -1 for failure
 static int generate_luma_grain_block(
     const aom_film_grain_t *params, int **pred_pos_luma, int *luma_grain_block,
     int luma_block_size_y, int luma_block_size_x, int luma_grain_stride,
-    int left_pad, int top_pad, int right_pad, int bottom_pad) {
+    int left_pad, int top_pad, int right_pad, int bottom_pad,
+    uint16_t *random_register) {
   if (params->num_y_points == 0) {
     memset(luma_grain_block, 0,
            sizeof(*luma_grain_block) * luma_block_size_y * luma_grain_stride);
@@ -415,7 +360,7 @@ static int generate_luma_grain_block(
   for (int i = 0; i < luma_block_size_y; i++)
     for (int j = 0; j < luma_block_size_x; j++)
       luma_grain_block[i * luma_grain_stride + j] =
-          (gaussian_sequence[get_random_number(gauss_bits)] +
+          (gaussian_sequence[get_random_number(gauss_bits, random_register)] +
            ((1 << gauss_sec_shift) >> 1)) >>
           gauss_sec_shift;
 
@@ -443,7 +388,8 @@ static int generate_chroma_grain_blocks(
     int **pred_pos_chroma, int *luma_grain_block, int *cb_grain_block,
     int *cr_grain_block, int luma_grain_stride, int chroma_block_size_y,
     int chroma_block_size_x, int chroma_grain_stride, int left_pad, int top_pad,
-    int right_pad, int bottom_pad, int chroma_subsamp_y, int chroma_subsamp_x) {
+    int right_pad, int bottom_pad, int chroma_subsamp_y, int chroma_subsamp_x,
+    uint16_t *random_register) {
   int bit_depth = params->bit_depth;
   int gauss_sec_shift = 12 - bit_depth + params->grain_scale_shift;
 
@@ -453,12 +399,13 @@ static int generate_chroma_grain_blocks(
   int chroma_grain_block_size = chroma_block_size_y * chroma_grain_stride;
 
   if (params->num_cb_points || params->chroma_scaling_from_luma) {
-    init_random_generator(7 << 5, params->random_seed);
+    init_random_generator(7 << 5, params->random_seed, random_register);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cb_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(gauss_bits,
+                                                 random_register)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -467,12 +414,13 @@ static int generate_chroma_grain_blocks(
   }
 
   if (params->num_cr_points || params->chroma_scaling_from_luma) {
-    init_random_generator(11 << 5, params->random_seed);
+    init_random_generator(11 << 5, params->random_seed, random_register);
 
     for (int i = 0; i < chroma_block_size_y; i++)
       for (int j = 0; j < chroma_block_size_x; j++)
         cr_grain_block[i * chroma_grain_stride + j] =
-            (gaussian_sequence[get_random_number(gauss_bits)] +
+            (gaussian_sequence[get_random_number(gauss_bits,
+                                                 random_register)] +
              ((1 << gauss_sec_shift) >> 1)) >>
             gauss_sec_shift;
   } else {
@@ -558,7 +506,7 @@ static void init_scaling_function(const int scaling_points[][2], int num_points,
 
 // function that extracts samples from a LUT (and interpolates intemediate
 // frames for 10- and 12-bit video)
-static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
+static int scale_LUT(const int *scaling_lut, int index, int bit_depth) {
   int x = index >> (bit_depth - 8);
 
   if (!(bit_depth - 8) || x == 255)
@@ -570,14 +518,135 @@ static int scale_LUT(int *scaling_lut, int index, int bit_depth) {
                              (bit_depth - 8));
 }
 
+void aom_film_grain_add_luma_noise_c(uint8_t *luma, int luma_stride,
+                                     const int *grain, int grain_stride,
+                                     int width, int height,
+                                     const int *scaling_lut, int scaling_shift,
+                                     int min_luma, int max_luma) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      luma[i * luma_stride + j] =
+          clamp(luma[i * luma_stride + j] +
+                    ((scale_LUT(scaling_lut, luma[i * luma_stride + j], 8) *
+                          grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     scaling_shift),
+                min_luma, max_luma);
+    }
+  }
+}
+
+void aom_film_grain_add_chroma_noise_c(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      int average_luma = 0;
+      if (chroma_subsamp_x) {
+        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
+                             (j << chroma_subsamp_x)] +
+                        luma[(i << chroma_subsamp_y) * luma_stride +
+                             (j << chroma_subsamp_x) + 1] +
+                        1) >>
+                       1;
+      } else {
+        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
+      }
+
+      const int merged = clamp(((average_luma * luma_mult +
+                                 chroma_mult * chroma[i * chroma_stride + j]) >>
+                                6) +
+                                   offset,
+                               0, 255);
+
+      chroma[i * chroma_stride + j] =
+          clamp(chroma[i * chroma_stride + j] +
+                    ((scale_LUT(scaling_lut, merged, 8) *
+                          grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     scaling_shift),
+                min_chroma, max_chroma);
+    }
+  }
+}
+
+void aom_highbd_film_grain_add_luma_noise_c(uint16_t *luma, int luma_stride,
+                                            const int *grain, int grain_stride,
+                                            int width, int height,
+                                            const int *scaling_lut,
+                                            int scaling_shift, int min_luma,
+                                            int max_luma, int bd) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      luma[i * luma_stride + j] =
+          clamp(luma[i * luma_stride + j] +
+                    ((scale_LUT(scaling_lut, luma[i * luma_stride + j], bd) *
+                          grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     scaling_shift),
+                min_luma, max_luma);
+    }
+  }
+}
+
+void aom_highbd_film_grain_add_chroma_noise_c(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma, int bd) {
+  const int rounding_offset = (1 << (scaling_shift - 1));
+
+  for (int i = 0; i < height; i++) {
+    for (int j = 0; j < width; j++) {
+      int average_luma = 0;
+      if (chroma_subsamp_x) {
+        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
+                             (j << chroma_subsamp_x)] +
+                        luma[(i << chroma_subsamp_y) * luma_stride +
+                             (j << chroma_subsamp_x) + 1] +
+                        1) >>
+                       1;
+      } else {
+        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
+      }
+
+      const int merged = clamp(((average_luma * luma_mult +
+                                 chroma_mult * chroma[i * chroma_stride + j]) >>
+                                6) +
+                                   offset,
+                               0, (256 << (bd - 8)) - 1);
+
+      chroma[i * chroma_stride + j] =
+          clamp(chroma[i * chroma_stride + j] +
+                    ((scale_LUT(scaling_lut, merged, bd) *
+                          grain[i * grain_stride + j] +
+                      rounding_offset) >>
+                     scaling_shift),
+                min_chroma, max_chroma);
+    }
+  }
+}
+
 static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
                                uint8_t *cb, uint8_t *cr, int luma_stride,
                                int chroma_stride, int *luma_grain,
                                int *cb_grain, int *cr_grain,
                                int luma_grain_stride, int chroma_grain_stride,
                                int half_luma_height, int half_luma_width,
-                               int bit_depth, int chroma_subsamp_y,
-                               int chroma_subsamp_x, int mc_identity) {
+                               int chroma_subsamp_y, int chroma_subsamp_x,
+                               int mc_identity, const int *scaling_lut_y,
+                               const int *scaling_lut_cb,
+                               const int *scaling_lut_cr) {
   int cb_mult = params->cb_mult - 128;            // fixed scale
   int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
   int cb_offset = params->cb_offset - 256;
@@ -586,8 +655,6 @@ static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
   int cr_luma_mult = params->cr_luma_mult - 128;  // fixed scale
   int cr_offset = params->cr_offset - 256;
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
   int apply_y = params->num_y_points > 0 ? 1 : 0;
   int apply_cb =
       (params->num_cb_points > 0 || params->chroma_scaling_from_luma) ? 1 : 0;
@@ -622,66 +689,32 @@ static void add_noise_to_block(const aom_film_grain_t *params, uint8_t *luma,
     max_luma = max_chroma = 255;
   }
 
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-      int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
-      } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
-
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
+  const int chroma_height = half_luma_height << (1 - chroma_subsamp_y);
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
+
+  // The chroma noise depends on the luma samples without noise, so it is
+  // added first.
+  if (apply_cb) {
+    aom_film_grain_add_chroma_noise(
+        cb, chroma_stride, luma, luma_stride, cb_grain, chroma_grain_stride,
+        chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+        scaling_lut_cb, params->scaling_shift, cb_luma_mult, cb_mult,
+        cb_offset, min_chroma, max_chroma);
+  }
 
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            8) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-    }
+  if (apply_cr) {
+    aom_film_grain_add_chroma_noise(
+        cr, chroma_stride, luma, luma_stride, cr_grain, chroma_grain_stride,
+        chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+        scaling_lut_cr, params->scaling_shift, cr_luma_mult, cr_mult,
+        cr_offset, min_chroma, max_chroma);
   }
 
   if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j], 8) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
-    }
+    aom_film_grain_add_luma_noise(luma, luma_stride, luma_grain,
+                                  luma_grain_stride, half_luma_width << 1,
+                                  half_luma_height << 1, scaling_lut_y,
+                                  params->scaling_shift, min_luma, max_luma);
   }
 }
 
@@ -690,7 +723,9 @@ static void add_noise_to_block_hbd(
     int luma_stride, int chroma_stride, int *luma_grain, int *cb_grain,
     int *cr_grain, int luma_grain_stride, int chroma_grain_stride,
     int half_luma_height, int half_luma_width, int bit_depth,
-    int chroma_subsamp_y, int chroma_subsamp_x, int mc_identity) {
+    int chroma_subsamp_y, int chroma_subsamp_x, int mc_identity,
+    const int *scaling_lut_y, const int *scaling_lut_cb,
+    const int *scaling_lut_cr) {
   int cb_mult = params->cb_mult - 128;            // fixed scale
   int cb_luma_mult = params->cb_luma_mult - 128;  // fixed scale
   // offset value depends on the bit depth
@@ -701,8 +736,6 @@ static void add_noise_to_block_hbd(
   // offset value depends on the bit depth
   int cr_offset = (params->cr_offset << (bit_depth - 8)) - (1 << bit_depth);
 
-  int rounding_offset = (1 << (params->scaling_shift - 1));
-
   int apply_y = params->num_y_points > 0 ? 1 : 0;
   int apply_cb =
       (params->num_cb_points > 0 || params->chroma_scaling_from_luma) > 0 ? 1
@@ -739,66 +772,30 @@ static void add_noise_to_block_hbd(
     max_luma = max_chroma = (256 << (bit_depth - 8)) - 1;
   }
 
-  for (int i = 0; i < (half_luma_height << (1 - chroma_subsamp_y)); i++) {
-    for (int j = 0; j < (half_luma_width << (1 - chroma_subsamp_x)); j++) {
-      int average_luma = 0;
-      if (chroma_subsamp_x) {
-        average_luma = (luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x)] +
-                        luma[(i << chroma_subsamp_y) * luma_stride +
-                             (j << chroma_subsamp_x) + 1] +
-                        1) >>
-                       1;
-      } else {
-        average_luma = luma[(i << chroma_subsamp_y) * luma_stride + j];
-      }
+  const int chroma_height = half_luma_height << (1 - chroma_subsamp_y);
+  const int chroma_width = half_luma_width << (1 - chroma_subsamp_x);
 
-      if (apply_cb) {
-        cb[i * chroma_stride + j] = clamp(
-            cb[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cb,
-                            clamp(((average_luma * cb_luma_mult +
-                                    cb_mult * cb[i * chroma_stride + j]) >>
-                                   6) +
-                                      cb_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cb_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-      if (apply_cr) {
-        cr[i * chroma_stride + j] = clamp(
-            cr[i * chroma_stride + j] +
-                ((scale_LUT(scaling_lut_cr,
-                            clamp(((average_luma * cr_luma_mult +
-                                    cr_mult * cr[i * chroma_stride + j]) >>
-                                   6) +
-                                      cr_offset,
-                                  0, (256 << (bit_depth - 8)) - 1),
-                            bit_depth) *
-                      cr_grain[i * chroma_grain_stride + j] +
-                  rounding_offset) >>
-                 params->scaling_shift),
-            min_chroma, max_chroma);
-      }
-    }
+  if (apply_cb) {
+    aom_highbd_film_grain_add_chroma_noise(
+        cb, chroma_stride, luma, luma_stride, cb_grain, chroma_grain_stride,
+        chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+        scaling_lut_cb, params->scaling_shift, cb_luma_mult, cb_mult,
+        cb_offset, min_chroma, max_chroma, bit_depth);
+  }
+
+  if (apply_cr) {
+    aom_highbd_film_grain_add_chroma_noise(
+        cr, chroma_stride, luma, luma_stride, cr_grain, chroma_grain_stride,
+        chroma_width, chroma_height, chroma_subsamp_x, chroma_subsamp_y,
+        scaling_lut_cr, params->scaling_shift, cr_luma_mult, cr_mult,
+        cr_offset, min_chroma, max_chroma, bit_depth);
   }
 
   if (apply_y) {
-    for (int i = 0; i < (half_luma_height << 1); i++) {
-      for (int j = 0; j < (half_luma_width << 1); j++) {
-        luma[i * luma_stride + j] =
-            clamp(luma[i * luma_stride + j] +
-                      ((scale_LUT(scaling_lut_y, luma[i * luma_stride + j],
-                                  bit_depth) *
-                            luma_grain[i * luma_grain_stride + j] +
-                        rounding_offset) >>
-                       params->scaling_shift),
-                  min_luma, max_luma);
-      }
-    }
+    aom_highbd_film_grain_add_luma_noise(
+        luma, luma_stride, luma_grain, luma_grain_stride, half_luma_width << 1,
+        half_luma_height << 1, scaling_lut_y, params->scaling_shift, min_luma,
+        max_luma, bit_depth);
   }
 }
 
@@ -883,39 +880,447 @@ static void ver_boundary_overlap(int *left_block, int left_stride,
   }
 }
 
-static void hor_boundary_overlap(int *top_block, int top_stride,
-                                 int *bottom_block, int bottom_stride,
-                                 int *dst_block, int dst_stride, int width,
-                                 int height) {
+void aom_film_grain_hor_overlap_c(const int *top, int top_stride,
+                                  const int *bottom, int bottom_stride,
+                                  int *dst, int dst_stride, int width,
+                                  int height, int min_value, int max_value) {
   if (height == 1) {
     while (width) {
-      *dst_block = clamp((*top_block * 23 + *bottom_block * 22 + 16) >> 5,
-                         grain_min, grain_max);
-      ++top_block;
-      ++bottom_block;
-      ++dst_block;
+      *dst = clamp((*top * 23 + *bottom * 22 + 16) >> 5, min_value, max_value);
+      ++top;
+      ++bottom;
+      ++dst;
       --width;
     }
     return;
   } else if (height == 2) {
     while (width) {
-      dst_block[0] = clamp((27 * top_block[0] + 17 * bottom_block[0] + 16) >> 5,
-                           grain_min, grain_max);
-      dst_block[dst_stride] = clamp((17 * top_block[top_stride] +
-                                     27 * bottom_block[bottom_stride] + 16) >>
-                                        5,
-                                    grain_min, grain_max);
-      ++top_block;
-      ++bottom_block;
-      ++dst_block;
+      dst[0] = clamp((27 * top[0] + 17 * bottom[0] + 16) >> 5, min_value,
+                     max_value);
+      dst[dst_stride] =
+          clamp((17 * top[top_stride] + 27 * bottom[bottom_stride] + 16) >> 5,
+                min_value, max_value);
+      ++top;
+      ++bottom;
+      ++dst;
       --width;
     }
     return;
   }
 }
 
+// Frame level state of the grain synthesis, shared by all the stripes.
+typedef struct {
+  const aom_film_grain_t *params;
+  uint8_t *luma;
+  uint8_t *cb;
+  uint8_t *cr;
+  int height;
+  int width;
+  int luma_stride;
+  int chroma_stride;
+  int use_high_bit_depth;
+  int chroma_subsamp_y;
+  int chroma_subsamp_x;
+  int mc_identity;
+  const int *scaling_lut_y;
+  const int *scaling_lut_cb;
+  const int *scaling_lut_cr;
+  int *luma_grain_block;
+  int *cb_grain_block;
+  int *cr_grain_block;
+  int luma_grain_stride;
+  int chroma_grain_stride;
+  int left_pad;
+  int top_pad;
+  int ar_padding;
+} grain_frame_info_t;
+
+// Grain kept for the overlap with the neighboring blocks: the line buffers
+// hold the bottom rows of the previous block row, and the column buffers the
+// right columns of the previous block.
+typedef struct {
+  int *y_line_buf;
+  int *cb_line_buf;
+  int *cr_line_buf;
+  int *y_col_buf;
+  int *cb_col_buf;
+  int *cr_col_buf;
+} grain_overlap_bufs_t;
+
+// A horizontal stripe of the frame, covering the block rows from start_y to
+// end_y (in units of two luma rows).
+typedef struct {
+  const grain_frame_info_t *info;
+  grain_overlap_bufs_t bufs;
+  int start_y;
+  int end_y;
+} grain_stripe_t;
+
+// Return 0 for success, -1 for failure
+static int alloc_overlap_bufs(grain_overlap_bufs_t *bufs, int luma_stride,
+                              int chroma_stride, int chroma_subsamp_y,
+                              int chroma_subsamp_x) {
+  bufs->y_line_buf = (int *)aom_malloc(sizeof(*bufs->y_line_buf) *
+                                       luma_stride * 2);
+  bufs->cb_line_buf = (int *)aom_malloc(
+      sizeof(*bufs->cb_line_buf) * chroma_stride * (2 >> chroma_subsamp_y));
+  bufs->cr_line_buf = (int *)aom_malloc(
+      sizeof(*bufs->cr_line_buf) * chroma_stride * (2 >> chroma_subsamp_y));
+
+  bufs->y_col_buf = (int *)aom_malloc(sizeof(*bufs->y_col_buf) *
+                                      (luma_subblock_size_y + 2) * 2);
+  bufs->cb_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cb_col_buf) *
+                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+                        (2 >> chroma_subsamp_x));
+  bufs->cr_col_buf =
+      (int *)aom_malloc(sizeof(*bufs->cr_col_buf) *
+                        (chroma_subblock_size_y + (2 >> chroma_subsamp_y)) *
+                        (2 >> chroma_subsamp_x));
+
+  if (!bufs->y_line_buf || !bufs->cb_line_buf || !bufs->cr_line_buf ||
+      !bufs->y_col_buf || !bufs->cb_col_buf || !bufs->cr_col_buf)
+    return -1;
+  return 0;
+}
+
+static void free_overlap_bufs(grain_overlap_bufs_t *bufs) {
+  aom_free(bufs->y_line_buf);
+  aom_free(bufs->cb_line_buf);
+  aom_free(bufs->cr_line_buf);
+  aom_free(bufs->y_col_buf);
+  aom_free(bufs->cb_col_buf);
+  aom_free(bufs->cr_col_buf);
+}
+
+// Picks the next random offset into the grain templates and returns the
+// grain of the block at that offset.
+static void get_block_grain(const grain_frame_info_t *info,
+                            uint16_t *random_register, int **luma_grain,
+                            int **cb_grain, int **cr_grain) {
+  const int chroma_subsamp_y = info->chroma_subsamp_y;
+  const int chroma_subsamp_x = info->chroma_subsamp_x;
+  const int ar_padding = info->ar_padding;
+
+  int offset_y = get_random_number(8, random_register);
+  int offset_x = (offset_y >> 4) & 15;
+  offset_y &= 15;
+
+  int luma_offset_y = info->left_pad + 2 * ar_padding + (offset_y << 1);
+  int luma_offset_x = info->top_pad + 2 * ar_padding + (offset_x << 1);
+
+  int chroma_offset_y = info->top_pad + (2 >> chroma_subsamp_y) * ar_padding +
+                        offset_y * (2 >> chroma_subsamp_y);
+  int chroma_offset_x = info->left_pad + (2 >> chroma_subsamp_x) * ar_padding +
+                        offset_x * (2 >> chroma_subsamp_x);
+
+  *luma_grain = info->luma_grain_block +
+                luma_offset_y * info->luma_grain_stride + luma_offset_x;
+  *cb_grain = info->cb_grain_block +
+              chroma_offset_y * info->chroma_grain_stride + chroma_offset_x;
+  *cr_grain = info->cr_grain_block +
+              chroma_offset_y * info->chroma_grain_stride + chroma_offset_x;
+}
+
+// Adds noise to the area starting at (y, x), in units of two luma samples.
+static void add_noise_to_area(const grain_frame_info_t *info, int y, int x,
+                              int *luma_grain, int *cb_grain, int *cr_grain,
+                              int luma_grain_stride, int chroma_grain_stride,
+                              int half_luma_height, int half_luma_width) {
+  const int chroma_subsamp_y = info->chroma_subsamp_y;
+  const int chroma_subsamp_x = info->chroma_subsamp_x;
+  const int luma_offset = (y << 1) * info->luma_stride + (x << 1);
+  const int chroma_offset =
+      (y << (1 - chroma_subsamp_y)) * info->chroma_stride +
+      (x << (1 - chroma_subsamp_x));
+
+  if (info->use_high_bit_depth) {
+    add_noise_to_block_hbd(
+        info->params, (uint16_t *)info->luma + luma_offset,
+        (uint16_t *)info->cb + chroma_offset,
+        (uint16_t *)info->cr + chroma_offset, info->luma_stride,
+        info->chroma_stride, luma_grain, cb_grain, cr_grain, luma_grain_stride,
+        chroma_grain_stride, half_luma_height, half_luma_width,
+        info->params->bit_depth, chroma_subsamp_y, chroma_subsamp_x,
+        info->mc_identity, info->scaling_lut_y, info->scaling_lut_cb,
+        info->scaling_lut_cr);
+  } else {
+    add_noise_to_block(info->params, info->luma + luma_offset,
+                       info->cb + chroma_offset, info->cr + chroma_offset,
+                       info->luma_stride, info->chroma_stride, luma_grain,
+                       cb_grain, cr_grain, luma_grain_stride,
+                       chroma_grain_stride, half_luma_height, half_luma_width,
+                       chroma_subsamp_y, chroma_subsamp_x, info->mc_identity,
+                       info->scaling_lut_y, info->scaling_lut_cb,
+                       info->scaling_lut_cr);
+  }
+}
+
+// Blends the grain of the block to the left, kept in the column buffers, with
+// the left columns of the grain of the block at row y.
+static void blend_col_bufs(const grain_frame_info_t *info,
+                           const grain_overlap_bufs_t *bufs, int y,
+                           int *luma_grain, int *cb_grain, int *cr_grain) {
+  const int chroma_subsamp_y = info->chroma_subsamp_y;
+  const int chroma_subsamp_x = info->chroma_subsamp_x;
+  const int height = info->height;
+
+  ver_boundary_overlap(bufs->y_col_buf, 2, luma_grain, info->luma_grain_stride,
+                       bufs->y_col_buf, 2, 2,
+                       AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+  ver_boundary_overlap(
+      bufs->cb_col_buf, 2 >> chroma_subsamp_x, cb_grain,
+      info->chroma_grain_stride, bufs->cb_col_buf, 2 >> chroma_subsamp_x,
+      2 >> chroma_subsamp_x,
+      AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+             (height - (y << 1)) >> chroma_subsamp_y));
+
+  ver_boundary_overlap(
+      bufs->cr_col_buf, 2 >> chroma_subsamp_x, cr_grain,
+      info->chroma_grain_stride, bufs->cr_col_buf, 2 >> chroma_subsamp_x,
+      2 >> chroma_subsamp_x,
+      AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+             (height - (y << 1)) >> chroma_subsamp_y));
+}
+
+// Saves the grain of the block at (y, x) needed for the overlap with the
+// blocks below and to the right of it.
+static void save_overlap_bufs(const grain_frame_info_t *info,
+                              grain_overlap_bufs_t *bufs, int y, int x,
+                              int *luma_grain, int *cb_grain, int *cr_grain) {
+  const int chroma_subsamp_y = info->chroma_subsamp_y;
+  const int chroma_subsamp_x = info->chroma_subsamp_x;
+  const int height = info->height;
+  const int width = info->width;
+  const int luma_stride = info->luma_stride;
+  const int chroma_stride = info->chroma_stride;
+  const int luma_grain_stride = info->luma_grain_stride;
+  const int chroma_grain_stride = info->chroma_grain_stride;
+
+  if (x) {
+    // Copy overlapped column bufer to line buffer
+    copy_area(bufs->y_col_buf + (luma_subblock_size_y << 1), 2,
+              bufs->y_line_buf + (x << 1), luma_stride, 2, 2);
+
+    copy_area(
+        bufs->cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+        2 >> chroma_subsamp_x,
+        bufs->cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
+        2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+
+    copy_area(
+        bufs->cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
+        2 >> chroma_subsamp_x,
+        bufs->cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
+        2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
+  }
+
+  // Copy grain to the line buffer for overlap with a bottom block
+  copy_area(luma_grain + luma_subblock_size_y * luma_grain_stride +
+                (x ? 2 : 0),
+            luma_grain_stride, bufs->y_line_buf + ((x ? x + 1 : 0) << 1),
+            luma_stride,
+            AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
+
+  copy_area(cb_grain + chroma_subblock_size_y * chroma_grain_stride +
+                (x ? 2 >> chroma_subsamp_x : 0),
+            chroma_grain_stride,
+            bufs->cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+            chroma_stride,
+            AOMMIN(chroma_subblock_size_x,
+                   ((width - (x << 1)) >> chroma_subsamp_x)) -
+                (x ? 2 >> chroma_subsamp_x : 0),
+            2 >> chroma_subsamp_y);
+
+  copy_area(cr_grain + chroma_subblock_size_y * chroma_grain_stride +
+                (x ? 2 >> chroma_subsamp_x : 0),
+            chroma_grain_stride,
+            bufs->cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+            chroma_stride,
+            AOMMIN(chroma_subblock_size_x,
+                   ((width - (x << 1)) >> chroma_subsamp_x)) -
+                (x ? 2 >> chroma_subsamp_x : 0),
+            2 >> chroma_subsamp_y);
+
+  // Copy grain to the column buffer for overlap with the next block to the
+  // right
+
+  copy_area(luma_grain + luma_subblock_size_x, luma_grain_stride,
+            bufs->y_col_buf, 2, 2,
+            AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
+
+  copy_area(cb_grain + chroma_subblock_size_x, chroma_grain_stride,
+            bufs->cb_col_buf, 2 >> chroma_subsamp_x, 2 >> chroma_subsamp_x,
+            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                   (height - (y << 1)) >> chroma_subsamp_y));
+
+  copy_area(cr_grain + chroma_subblock_size_x, chroma_grain_stride,
+            bufs->cr_col_buf, 2 >> chroma_subsamp_x, 2 >> chroma_subsamp_x,
+            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
+                   (height - (y << 1)) >> chroma_subsamp_y));
+}
+
+// Adds grain to the block row y, in units of two luma rows.
+static void add_grain_to_row(const grain_frame_info_t *info,
+                             grain_overlap_bufs_t *bufs, int y) {
+  const aom_film_grain_t *params = info->params;
+  const int chroma_subsamp_y = info->chroma_subsamp_y;
+  const int chroma_subsamp_x = info->chroma_subsamp_x;
+  const int height = info->height;
+  const int width = info->width;
+  const int luma_stride = info->luma_stride;
+  const int chroma_stride = info->chroma_stride;
+  const int luma_grain_stride = info->luma_grain_stride;
+  const int chroma_grain_stride = info->chroma_grain_stride;
+  const int overlap = params->overlap_flag;
+  uint16_t random_register;
+
+  init_random_generator(y * 2, params->random_seed, &random_register);
+
+  for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
+    int *luma_grain, *cb_grain, *cr_grain;
+    get_block_grain(info, &random_register, &luma_grain, &cb_grain, &cr_grain);
+
+    if (overlap && x) {
+      blend_col_bufs(info, bufs, y, luma_grain, cb_grain, cr_grain);
+
+      int i = y ? 1 : 0;
+      int chroma_col_offset =
+          i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x);
+
+      add_noise_to_area(info, y + i, x, bufs->y_col_buf + i * 4,
+                        bufs->cb_col_buf + chroma_col_offset,
+                        bufs->cr_col_buf + chroma_col_offset, 2,
+                        (2 - chroma_subsamp_x),
+                        AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+                        1);
+    }
+
+    if (overlap && y) {
+      if (x) {
+        aom_film_grain_hor_overlap(bufs->y_line_buf + (x << 1), luma_stride,
+                                   bufs->y_col_buf, 2,
+                                   bufs->y_line_buf + (x << 1), luma_stride, 2,
+                                   2, grain_min, grain_max);
+
+        aom_film_grain_hor_overlap(
+            bufs->cb_line_buf + x * (2 >> chroma_subsamp_x), chroma_stride,
+            bufs->cb_col_buf, 2 >> chroma_subsamp_x,
+            bufs->cb_line_buf + x * (2 >> chroma_subsamp_x), chroma_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y, grain_min,
+            grain_max);
+
+        aom_film_grain_hor_overlap(
+            bufs->cr_line_buf + x * (2 >> chroma_subsamp_x), chroma_stride,
+            bufs->cr_col_buf, 2 >> chroma_subsamp_x,
+            bufs->cr_line_buf + x * (2 >> chroma_subsamp_x), chroma_stride,
+            2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y, grain_min,
+            grain_max);
+      }
+
+      aom_film_grain_hor_overlap(
+          bufs->y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          luma_grain + (x ? 2 : 0), luma_grain_stride,
+          bufs->y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
+          AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
+                 width - ((x ? x + 1 : 0) << 1)),
+          2, grain_min, grain_max);
+
+      aom_film_grain_hor_overlap(
+          bufs->cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cb_grain + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          bufs->cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      aom_film_grain_hor_overlap(
+          bufs->cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          cr_grain + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_grain_stride,
+          bufs->cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
+          chroma_stride,
+          AOMMIN(chroma_subblock_size_x -
+                     ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
+                 (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
+          2 >> chroma_subsamp_y, grain_min, grain_max);
+
+      add_noise_to_area(info, y, x, bufs->y_line_buf + (x << 1),
+                        bufs->cb_line_buf + (x << (1 - chroma_subsamp_x)),
+                        bufs->cr_line_buf + (x << (1 - chroma_subsamp_x)),
+                        luma_stride, chroma_stride, 1,
+                        AOMMIN(luma_subblock_size_x >> 1, width / 2 - x));
+    }
+
+    int i = overlap && y ? 1 : 0;
+    int j = overlap && x ? 1 : 0;
+
+    add_noise_to_area(
+        info, y + i, x + j,
+        luma_grain + (i << 1) * luma_grain_stride + (j << 1),
+        cb_grain + (i << (1 - chroma_subsamp_y)) * chroma_grain_stride +
+            (j << (1 - chroma_subsamp_x)),
+        cr_grain + (i << (1 - chroma_subsamp_y)) * chroma_grain_stride +
+            (j << (1 - chroma_subsamp_x)),
+        luma_grain_stride, chroma_grain_stride,
+        AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
+        AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j);
+
+    if (overlap)
+      save_overlap_bufs(info, bufs, y, x, luma_grain, cb_grain, cr_grain);
+  }
+}
+
+// Fills the overlap buffers as add_grain_to_row() leaves them after the block
+// row y, without adding any noise. The line buffers only depend on the grain
+// of that row, so this lets a stripe start at any block row.
+static void restore_overlap_bufs(const grain_frame_info_t *info,
+                                 grain_overlap_bufs_t *bufs, int y) {
+  uint16_t random_register;
+
+  init_random_generator(y * 2, info->params->random_seed, &random_register);
+
+  for (int x = 0; x < info->width / 2; x += (luma_subblock_size_x >> 1)) {
+    int *luma_grain, *cb_grain, *cr_grain;
+    get_block_grain(info, &random_register, &luma_grain, &cb_grain, &cr_grain);
+    if (x) blend_col_bufs(info, bufs, y, luma_grain, cb_grain, cr_grain);
+    save_overlap_bufs(info, bufs, y, x, luma_grain, cb_grain, cr_grain);
+  }
+}
+
+static void add_grain_to_stripe(grain_stripe_t *stripe) {
+  const grain_frame_info_t *info = stripe->info;
+  const int block_rows = luma_subblock_size_y >> 1;
+
+  if (info->params->overlap_flag && stripe->start_y)
+    restore_overlap_bufs(info, &stripe->bufs, stripe->start_y - block_rows);
+
+  for (int y = stripe->start_y; y < stripe->end_y; y += block_rows)
+    add_grain_to_row(info, &stripe->bufs, y);
+}
+
+static int grain_stripe_worker_hook(void *arg1, void *unused) {
+  (void)unused;
+  add_grain_to_stripe((grain_stripe_t *)arg1);
+  return 1;
+}
+
 int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
                        aom_image_t *dst) {
+  return av1_add_film_grain_mt(params, src, dst, NULL, NULL, 0);
+}
+
+int av1_add_film_grain_mt(const aom_film_grain_t *params,
+                          const aom_image_t *src, aom_image_t *dst,
+                          aom_film_grain_cache_t *cache, AVxWorker *workers,
+                          int num_workers) {
   uint8_t *luma, *cb, *cr;
   int height, width, luma_stride, chroma_stride;
   int use_high_bit_depth = 0;
@@ -923,6 +1328,10 @@ int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
   int chroma_subsamp_y = 0;
   int mc_identity = src->mc == AOM_CICP_MC_IDENTITY ? 1 : 0;
 
+  // The grain can be added without a codec instance, which would otherwise
+  // be what sets up the function pointers of the kernels below.
+  aom_dsp_rtcd();
+
   switch (src->fmt) {
     case AOM_IMG_FMT_AOMI420:
     case AOM_IMG_FMT_I420:
@@ -988,14 +1397,19 @@ int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
   width = src->d_w % 2 ? src->d_w + 1 : src->d_w;
   height = src->d_h % 2 ? src->d_h + 1 : src->d_h;
 
-  copy_rect(src->planes[AOM_PLANE_Y], src->stride[AOM_PLANE_Y],
-            dst->planes[AOM_PLANE_Y], dst->stride[AOM_PLANE_Y], src->d_w,
-            src->d_h, use_high_bit_depth);
+  // The grain may be added in place, when src and dst share their planes.
+  const int in_place = src->planes[AOM_PLANE_Y] == dst->planes[AOM_PLANE_Y];
+
+  if (!in_place) {
+    copy_rect(src->planes[AOM_PLANE_Y], src->stride[AOM_PLANE_Y],
+              dst->planes[AOM_PLANE_Y], dst->stride[AOM_PLANE_Y], src->d_w,
+              src->d_h, use_high_bit_depth);
+  }
   // Note that dst is already assumed to be aligned to even.
   extend_even(dst->planes[AOM_PLANE_Y], dst->stride[AOM_PLANE_Y], src->d_w,
               src->d_h, use_high_bit_depth);
 
-  if (!src->monochrome) {
+  if (!src->monochrome && !in_place) {
     copy_rect(src->planes[AOM_PLANE_U], src->stride[AOM_PLANE_U],
               dst->planes[AOM_PLANE_U], dst->stride[AOM_PLANE_U],
               width >> chroma_subsamp_x, height >> chroma_subsamp_y,
@@ -1015,31 +1429,87 @@ int av1_add_film_grain(const aom_film_grain_t *params, const aom_image_t *src,
   luma_stride = dst->stride[AOM_PLANE_Y] >> use_high_bit_depth;
   chroma_stride = dst->stride[AOM_PLANE_U] >> use_high_bit_depth;
 
-  return av1_add_film_grain_run(
-      params, luma, cb, cr, height, width, luma_stride, chroma_stride,
-      use_high_bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
+  return av1_add_film_grain_run(params, luma, cb, cr, height, width,
+                                luma_stride, chroma_stride, use_high_bit_depth,
+                                chroma_subsamp_y, chroma_subsamp_x, mc_identity,
+                                cache, workers, num_workers);
+}
+
+// Returns 1 if the grain templates in the cache were generated with the
+// parameters that the templates of the frame depend on.
+static int grain_templates_match(const aom_film_grain_cache_t *cache,
+                                 const aom_film_grain_t *params,
+                                 int chroma_subsamp_y, int chroma_subsamp_x) {
+  const aom_film_grain_t *const pa = &cache->params;
+  if (!cache->templates_valid) return 0;
+  if (cache->chroma_subsamp_y != chroma_subsamp_y ||
+      cache->chroma_subsamp_x != chroma_subsamp_x)
+    return 0;
+  if (pa->random_seed != params->random_seed) return 0;
+  if (pa->bit_depth != params->bit_depth) return 0;
+  if (pa->grain_scale_shift != params->grain_scale_shift) return 0;
+  if (pa->num_y_points != params->num_y_points) return 0;
+  if (pa->num_cb_points != params->num_cb_points) return 0;
+  if (pa->num_cr_points != params->num_cr_points) return 0;
+  if (pa->chroma_scaling_from_luma != params->chroma_scaling_from_luma)
+    return 0;
+  if (pa->ar_coeff_lag != params->ar_coeff_lag) return 0;
+  if (pa->ar_coeff_shift != params->ar_coeff_shift) return 0;
+  if (memcmp(pa->ar_coeffs_y, params->ar_coeffs_y,
+             sizeof(params->ar_coeffs_y)) != 0)
+    return 0;
+  if (memcmp(pa->ar_coeffs_cb, params->ar_coeffs_cb,
+             sizeof(params->ar_coeffs_cb)) != 0)
+    return 0;
+  if (memcmp(pa->ar_coeffs_cr, params->ar_coeffs_cr,
+             sizeof(params->ar_coeffs_cr)) != 0)
+    return 0;
+  return 1;
+}
+
+// Returns 1 if the scaling functions in the cache were generated with the
+// scaling points of the frame. They do not depend on the random seed.
+static int scaling_luts_match(const aom_film_grain_cache_t *cache,
+                              const aom_film_grain_t *params) {
+  const aom_film_grain_t *const pa = &cache->params;
+  if (!cache->luts_valid) return 0;
+  if (pa->chroma_scaling_from_luma != params->chroma_scaling_from_luma)
+    return 0;
+
+  if (pa->num_y_points != params->num_y_points) return 0;
+  if (memcmp(pa->scaling_points_y, params->scaling_points_y,
+             params->num_y_points * sizeof(*params->scaling_points_y)) != 0)
+    return 0;
+
+  if (pa->num_cb_points != params->num_cb_points) return 0;
+  if (memcmp(pa->scaling_points_cb, params->scaling_points_cb,
+             params->num_cb_points * sizeof(*params->scaling_points_cb)) != 0)
+    return 0;
+
+  if (pa->num_cr_points != params->num_cr_points) return 0;
+  if (memcmp(pa->scaling_points_cr, params->scaling_points_cr,
+             params->num_cr_points * sizeof(*params->scaling_points_cr)) != 0)
+    return 0;
+  return 1;
+}
+
+void av1_free_film_grain_cache(aom_film_grain_cache_t *cache) {
+  aom_free(cache->luma_grain_block);
+  aom_free(cache->cb_grain_block);
+  aom_free(cache->cr_grain_block);
+  memset(cache, 0, sizeof(*cache));
 }
 
 int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
                            uint8_t *cb, uint8_t *cr, int height, int width,
                            int luma_stride, int chroma_stride,
                            int use_high_bit_depth, int chroma_subsamp_y,
-                           int chroma_subsamp_x, int mc_identity) {
-  int **pred_pos_luma;
-  int **pred_pos_chroma;
-  int *luma_grain_block;
-  int *cb_grain_block;
-  int *cr_grain_block;
+                           int chroma_subsamp_x, int mc_identity,
+                           aom_film_grain_cache_t *cache, AVxWorker *workers,
+                           int num_workers) {
+  aom_film_grain_cache_t frame_cache;
 
-  int *y_line_buf;
-  int *cb_line_buf;
-  int *cr_line_buf;
-
-  int *y_col_buf;
-  int *cb_col_buf;
-  int *cr_col_buf;
-
-  random_register = params->random_seed;
+  uint16_t random_register = params->random_seed;
 
   int left_pad = 3;
   int right_pad = 3;  // padding to offset for AR coefficients
@@ -1073,336 +1543,164 @@ int av1_add_film_grain_run(const aom_film_grain_t *params, uint8_t *luma,
   int luma_grain_stride = luma_block_size_x;
   int chroma_grain_stride = chroma_block_size_x;
 
-  int overlap = params->overlap_flag;
   int bit_depth = params->bit_depth;
 
   const int grain_center = 128 << (bit_depth - 8);
   grain_min = 0 - grain_center;
   grain_max = grain_center - 1;
 
-  init_arrays(params, luma_stride, chroma_stride, &pred_pos_luma,
-              &pred_pos_chroma, &luma_grain_block, &cb_grain_block,
-              &cr_grain_block, &y_line_buf, &cb_line_buf, &cr_line_buf,
-              &y_col_buf, &cb_col_buf, &cr_col_buf,
-              luma_block_size_y * luma_block_size_x,
-              chroma_block_size_y * chroma_block_size_x, chroma_subsamp_y,
-              chroma_subsamp_x);
-
-  if (generate_luma_grain_block(params, pred_pos_luma, luma_grain_block,
-                                luma_block_size_y, luma_block_size_x,
-                                luma_grain_stride, left_pad, top_pad, right_pad,
-                                bottom_pad))
-    return -1;
-
-  if (generate_chroma_grain_blocks(
-          params,
-          //                               pred_pos_luma,
-          pred_pos_chroma, luma_grain_block, cb_grain_block, cr_grain_block,
-          luma_grain_stride, chroma_block_size_y, chroma_block_size_x,
-          chroma_grain_stride, left_pad, top_pad, right_pad, bottom_pad,
-          chroma_subsamp_y, chroma_subsamp_x))
-    return -1;
-
-  init_scaling_function(params->scaling_points_y, params->num_y_points,
-                        scaling_lut_y);
-
-  if (params->chroma_scaling_from_luma) {
-    memcpy(scaling_lut_cb, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-    memcpy(scaling_lut_cr, scaling_lut_y, sizeof(*scaling_lut_y) * 256);
-  } else {
-    init_scaling_function(params->scaling_points_cb, params->num_cb_points,
-                          scaling_lut_cb);
-    init_scaling_function(params->scaling_points_cr, params->num_cr_points,
-                          scaling_lut_cr);
+  if (!cache) {
+    memset(&frame_cache, 0, sizeof(frame_cache));
+    cache = &frame_cache;
   }
-  for (int y = 0; y < height / 2; y += (luma_subblock_size_y >> 1)) {
-    init_random_generator(y * 2, params->random_seed);
-
-    for (int x = 0; x < width / 2; x += (luma_subblock_size_x >> 1)) {
-      int offset_y = get_random_number(8);
-      int offset_x = (offset_y >> 4) & 15;
-      offset_y &= 15;
-
-      int luma_offset_y = left_pad + 2 * ar_padding + (offset_y << 1);
-      int luma_offset_x = top_pad + 2 * ar_padding + (offset_x << 1);
-
-      int chroma_offset_y = top_pad + (2 >> chroma_subsamp_y) * ar_padding +
-                            offset_y * (2 >> chroma_subsamp_y);
-      int chroma_offset_x = left_pad + (2 >> chroma_subsamp_x) * ar_padding +
-                            offset_x * (2 >> chroma_subsamp_x);
-
-      if (overlap && x) {
-        ver_boundary_overlap(
-            y_col_buf, 2,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x,
-            luma_grain_stride, y_col_buf, 2, 2,
-            AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        ver_boundary_overlap(
-            cb_col_buf, 2 >> chroma_subsamp_x,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        ver_boundary_overlap(
-            cr_col_buf, 2 >> chroma_subsamp_x,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x,
-            chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-            2 >> chroma_subsamp_x,
-            AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                   (height - (y << 1)) >> chroma_subsamp_y));
-
-        int i = y ? 1 : 0;
-
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params,
-              (uint16_t *)luma + ((y + i) << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              (uint16_t *)cr +
-                  ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + ((y + i) << 1) * luma_stride + (x << 1),
-              cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << (1 - chroma_subsamp_x)),
-              luma_stride, chroma_stride, y_col_buf + i * 4,
-              cb_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              cr_col_buf + i * (2 - chroma_subsamp_y) * (2 - chroma_subsamp_x),
-              2, (2 - chroma_subsamp_x),
-              AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i, 1,
-              bit_depth, chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
-
-      if (overlap && y) {
-        if (x) {
-          hor_boundary_overlap(y_line_buf + (x << 1), luma_stride, y_col_buf, 2,
-                               y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          hor_boundary_overlap(cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                               cb_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-
-          hor_boundary_overlap(cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                               cr_line_buf + x * (2 >> chroma_subsamp_x),
-                               chroma_stride, 2 >> chroma_subsamp_x,
-                               2 >> chroma_subsamp_y);
-        }
 
-        hor_boundary_overlap(
-            y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            luma_grain_block + luma_offset_y * luma_grain_stride +
-                luma_offset_x + (x ? 2 : 0),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x - ((x ? 1 : 0) << 1),
-                   width - ((x ? x + 1 : 0) << 1)),
-            2);
-
-        hor_boundary_overlap(
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
-
-        hor_boundary_overlap(
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                chroma_offset_x + ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_grain_stride,
-            cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-            chroma_stride,
-            AOMMIN(chroma_subblock_size_x -
-                       ((x ? 1 : 0) << (1 - chroma_subsamp_x)),
-                   (width - ((x ? x + 1 : 0) << 1)) >> chroma_subsamp_x),
-            2 >> chroma_subsamp_y);
+  // The chroma templates are never larger than the luma one, so the
+  // buffers are allocated once for any subsampling.
+  if (!cache->luma_grain_block) {
+    const size_t grain_samples = luma_block_size_y * luma_block_size_x;
+    cache->luma_grain_block =
+        (int *)aom_malloc(sizeof(*cache->luma_grain_block) * grain_samples);
+    cache->cb_grain_block =
+        (int *)aom_malloc(sizeof(*cache->cb_grain_block) * grain_samples);
+    cache->cr_grain_block =
+        (int *)aom_malloc(sizeof(*cache->cr_grain_block) * grain_samples);
+    if (!cache->luma_grain_block || !cache->cb_grain_block ||
+        !cache->cr_grain_block) {
+      av1_free_film_grain_cache(cache);
+      return -1;
+    }
+  }
 
-        if (use_high_bit_depth) {
-          add_noise_to_block_hbd(
-              params, (uint16_t *)luma + (y << 1) * luma_stride + (x << 1),
-              (uint16_t *)cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              (uint16_t *)cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        } else {
-          add_noise_to_block(
-              params, luma + (y << 1) * luma_stride + (x << 1),
-              cb + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              cr + (y << (1 - chroma_subsamp_y)) * chroma_stride +
-                  (x << ((1 - chroma_subsamp_x))),
-              luma_stride, chroma_stride, y_line_buf + (x << 1),
-              cb_line_buf + (x << (1 - chroma_subsamp_x)),
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), luma_stride,
-              chroma_stride, 1,
-              AOMMIN(luma_subblock_size_x >> 1, width / 2 - x), bit_depth,
-              chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-        }
-      }
+  if (!grain_templates_match(cache, params, chroma_subsamp_y,
+                             chroma_subsamp_x)) {
+    int **pred_pos_luma;
+    int **pred_pos_chroma;
+    int res = 0;
+
+    cache->templates_valid = 0;
+    init_arrays(params, &pred_pos_luma, &pred_pos_chroma);
+
+    if (generate_luma_grain_block(params, pred_pos_luma,
+                                  cache->luma_grain_block, luma_block_size_y,
+                                  luma_block_size_x, luma_grain_stride,
+                                  left_pad, top_pad, right_pad, bottom_pad,
+                                  &random_register) ||
+        generate_chroma_grain_blocks(
+            params,
+            //                               pred_pos_luma,
+            pred_pos_chroma, cache->luma_grain_block, cache->cb_grain_block,
+            cache->cr_grain_block, luma_grain_stride, chroma_block_size_y,
+            chroma_block_size_x, chroma_grain_stride, left_pad, top_pad,
+            right_pad, bottom_pad, chroma_subsamp_y, chroma_subsamp_x,
+            &random_register))
+      res = -1;
+
+    dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma);
+    if (res) {
+      if (cache == &frame_cache) av1_free_film_grain_cache(cache);
+      return -1;
+    }
+    cache->templates_valid = 1;
+  }
 
-      int i = overlap && y ? 1 : 0;
-      int j = overlap && x ? 1 : 0;
+  if (!scaling_luts_match(cache, params)) {
+    memset(cache->scaling_lut_y, 0, sizeof(cache->scaling_lut_y));
+    memset(cache->scaling_lut_cb, 0, sizeof(cache->scaling_lut_cb));
+    memset(cache->scaling_lut_cr, 0, sizeof(cache->scaling_lut_cr));
 
-      if (use_high_bit_depth) {
-        add_noise_to_block_hbd(
-            params,
-            (uint16_t *)luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            (uint16_t *)cb +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            (uint16_t *)cr +
-                ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      } else {
-        add_noise_to_block(
-            params, luma + ((y + i) << 1) * luma_stride + ((x + j) << 1),
-            cb + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            cr + ((y + i) << (1 - chroma_subsamp_y)) * chroma_stride +
-                ((x + j) << (1 - chroma_subsamp_x)),
-            luma_stride, chroma_stride,
-            luma_grain_block + (luma_offset_y + (i << 1)) * luma_grain_stride +
-                luma_offset_x + (j << 1),
-            cb_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            cr_grain_block +
-                (chroma_offset_y + (i << (1 - chroma_subsamp_y))) *
-                    chroma_grain_stride +
-                chroma_offset_x + (j << (1 - chroma_subsamp_x)),
-            luma_grain_stride, chroma_grain_stride,
-            AOMMIN(luma_subblock_size_y >> 1, height / 2 - y) - i,
-            AOMMIN(luma_subblock_size_x >> 1, width / 2 - x) - j, bit_depth,
-            chroma_subsamp_y, chroma_subsamp_x, mc_identity);
-      }
+    init_scaling_function(params->scaling_points_y, params->num_y_points,
+                          cache->scaling_lut_y);
 
-      if (overlap) {
-        if (x) {
-          // Copy overlapped column bufer to line buffer
-          copy_area(y_col_buf + (luma_subblock_size_y << 1), 2,
-                    y_line_buf + (x << 1), luma_stride, 2, 2);
-
-          copy_area(
-              cb_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cb_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-
-          copy_area(
-              cr_col_buf + (chroma_subblock_size_y << (1 - chroma_subsamp_x)),
-              2 >> chroma_subsamp_x,
-              cr_line_buf + (x << (1 - chroma_subsamp_x)), chroma_stride,
-              2 >> chroma_subsamp_x, 2 >> chroma_subsamp_y);
-        }
+    if (params->chroma_scaling_from_luma) {
+      memcpy(cache->scaling_lut_cb, cache->scaling_lut_y,
+             sizeof(cache->scaling_lut_y));
+      memcpy(cache->scaling_lut_cr, cache->scaling_lut_y,
+             sizeof(cache->scaling_lut_y));
+    } else {
+      init_scaling_function(params->scaling_points_cb, params->num_cb_points,
+                            cache->scaling_lut_cb);
+      init_scaling_function(params->scaling_points_cr, params->num_cr_points,
+                            cache->scaling_lut_cr);
+    }
+    cache->luts_valid = 1;
+  }
 
-        // Copy grain to the line buffer for overlap with a bottom block
-        copy_area(
-            luma_grain_block +
-                (luma_offset_y + luma_subblock_size_y) * luma_grain_stride +
-                luma_offset_x + ((x ? 2 : 0)),
-            luma_grain_stride, y_line_buf + ((x ? x + 1 : 0) << 1), luma_stride,
-            AOMMIN(luma_subblock_size_x, width - (x << 1)) - (x ? 2 : 0), 2);
+  // Both the templates and the scaling functions now match the parameters
+  // of this frame.
+  cache->params = *params;
+  cache->chroma_subsamp_y = chroma_subsamp_y;
+  cache->chroma_subsamp_x = chroma_subsamp_x;
+
+  grain_frame_info_t info;
+  info.params = params;
+  info.luma = luma;
+  info.cb = cb;
+  info.cr = cr;
+  info.height = height;
+  info.width = width;
+  info.luma_stride = luma_stride;
+  info.chroma_stride = chroma_stride;
+  info.use_high_bit_depth = use_high_bit_depth;
+  info.chroma_subsamp_y = chroma_subsamp_y;
+  info.chroma_subsamp_x = chroma_subsamp_x;
+  info.mc_identity = mc_identity;
+  info.scaling_lut_y = cache->scaling_lut_y;
+  info.scaling_lut_cb = cache->scaling_lut_cb;
+  info.scaling_lut_cr = cache->scaling_lut_cr;
+  info.luma_grain_block = cache->luma_grain_block;
+  info.cb_grain_block = cache->cb_grain_block;
+  info.cr_grain_block = cache->cr_grain_block;
+  info.luma_grain_stride = luma_grain_stride;
+  info.chroma_grain_stride = chroma_grain_stride;
+  info.left_pad = left_pad;
+  info.top_pad = top_pad;
+  info.ar_padding = ar_padding;
+
+  // Split the block rows into one horizontal stripe per worker. Each stripe
+  // has its own overlap buffers and random number generator state.
+  const int block_rows = luma_subblock_size_y >> 1;
+  const int num_rows = (height / 2 + block_rows - 1) / block_rows;
+  const int num_stripes =
+      workers ? AOMMAX(AOMMIN(num_workers, num_rows), 1) : 1;
+  int res = 0;
+
+  grain_stripe_t *stripes =
+      (grain_stripe_t *)aom_calloc(num_stripes, sizeof(*stripes));
+  if (!stripes) res = -1;
+
+  for (int s = 0; !res && s < num_stripes; ++s) {
+    grain_stripe_t *const stripe = &stripes[s];
+    stripe->info = &info;
+    stripe->start_y = s * num_rows / num_stripes * block_rows;
+    stripe->end_y = (s + 1) * num_rows / num_stripes * block_rows;
+    res = alloc_overlap_bufs(&stripe->bufs, luma_stride, chroma_stride,
+                             chroma_subsamp_y, chroma_subsamp_x);
+  }
 
-        copy_area(cb_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cb_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        copy_area(cr_grain_block +
-                      (chroma_offset_y + chroma_subblock_size_y) *
-                          chroma_grain_stride +
-                      chroma_offset_x + (x ? 2 >> chroma_subsamp_x : 0),
-                  chroma_grain_stride,
-                  cr_line_buf + ((x ? x + 1 : 0) << (1 - chroma_subsamp_x)),
-                  chroma_stride,
-                  AOMMIN(chroma_subblock_size_x,
-                         ((width - (x << 1)) >> chroma_subsamp_x)) -
-                      (x ? 2 >> chroma_subsamp_x : 0),
-                  2 >> chroma_subsamp_y);
-
-        // Copy grain to the column buffer for overlap with the next block to
-        // the right
-
-        copy_area(luma_grain_block + luma_offset_y * luma_grain_stride +
-                      luma_offset_x + luma_subblock_size_x,
-                  luma_grain_stride, y_col_buf, 2, 2,
-                  AOMMIN(luma_subblock_size_y + 2, height - (y << 1)));
-
-        copy_area(cb_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cb_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
-
-        copy_area(cr_grain_block + chroma_offset_y * chroma_grain_stride +
-                      chroma_offset_x + chroma_subblock_size_x,
-                  chroma_grain_stride, cr_col_buf, 2 >> chroma_subsamp_x,
-                  2 >> chroma_subsamp_x,
-                  AOMMIN(chroma_subblock_size_y + (2 >> chroma_subsamp_y),
-                         (height - (y << 1)) >> chroma_subsamp_y));
+  if (!res) {
+    if (num_stripes == 1) {
+      add_grain_to_stripe(&stripes[0]);
+    } else {
+      const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+      for (int s = 0; s < num_stripes; ++s) {
+        AVxWorker *const worker = &workers[s];
+        worker->hook = grain_stripe_worker_hook;
+        worker->data1 = &stripes[s];
+        worker->data2 = NULL;
+        if (s == num_stripes - 1)
+          winterface->execute(worker);
+        else
+          winterface->launch(worker);
       }
+      for (int s = 0; s < num_stripes; ++s) winterface->sync(&workers[s]);
     }
   }
 
-  dealloc_arrays(params, &pred_pos_luma, &pred_pos_chroma, &luma_grain_block,
-                 &cb_grain_block, &cr_grain_block, &y_line_buf, &cb_line_buf,
-                 &cr_line_buf, &y_col_buf, &cb_col_buf, &cr_col_buf);
-  return 0;
+  if (stripes) {
+    for (int s = 0; s < num_stripes; ++s) free_overlap_bufs(&stripes[s].bufs);
+    aom_free(stripes);
+  }
+
+  if (cache == &frame_cache) av1_free_film_grain_cache(cache);
+  return res;
 }
@@ -24,6 +24,7 @@ extern "C" {
 
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom/aom_image.h"
+#include "aom_util/aom_thread.h"
 
 /*!\brief Structure containing film grain synthesis parameters for a frame
  *
@@ -151,6 +152,35 @@ static INLINE int av1_check_grain_params_equiv(
   return 1;
 }
 
+/*!\brief Film grain synthesis state derived from the grain parameters
+ *
+ * Keeps the grain templates and the scaling functions of the last frame, so
+ * that they are only regenerated when the parameters they depend on change.
+ * Must be zero-initialized before its first use, and released with
+ * av1_free_film_grain_cache().
+ */
+typedef struct {
+  aom_film_grain_t params;  // parameters the state was generated with
+  int chroma_subsamp_y;
+  int chroma_subsamp_x;
+  int templates_valid;
+  int luts_valid;
+
+  int *luma_grain_block;
+  int *cb_grain_block;
+  int *cr_grain_block;
+
+  int scaling_lut_y[256];
+  int scaling_lut_cb[256];
+  int scaling_lut_cr[256];
+} aom_film_grain_cache_t;
+
+/*!\brief Free the grain templates of a film grain cache
+ *
+ * \param[in]    cache            Cache to free, left zero-initialized
+ */
+void av1_free_film_grain_cache(aom_film_grain_cache_t *cache);
+
 /*!\brief Add film grain
  *
  * Add film grain to an image
@@ -165,12 +195,17 @@ static INLINE int av1_check_grain_params_equiv(
  * \param[in]    width            luma plane width
  * \param[in]    luma_stride      luma plane stride
  * \param[in]    chroma_stride    chroma plane stride
+ * \param[in]    cache            Cache of the grain templates, or NULL
+ * \param[in]    workers          Workers to add the grain with, or NULL
+ * \param[in]    num_workers      Number of workers
  */
 int av1_add_film_grain_run(const aom_film_grain_t *grain_params, uint8_t *luma,
                            uint8_t *cb, uint8_t *cr, int height, int width,
                            int luma_stride, int chroma_stride,
                            int use_high_bit_depth, int chroma_subsamp_y,
-                           int chroma_subsamp_x, int mc_identity);
+                           int chroma_subsamp_x, int mc_identity,
+                           aom_film_grain_cache_t *cache, AVxWorker *workers,
+                           int num_workers);
 
 /*!\brief Add film grain
  *
@@ -185,6 +220,31 @@ int av1_add_film_grain_run(const aom_film_grain_t *grain_params, uint8_t *luma,
 int av1_add_film_grain(const aom_film_grain_t *grain_params,
                        const aom_image_t *src, aom_image_t *dst);
 
+/*!\brief Add film grain using several workers
+ *
+ * Same as av1_add_film_grain(), except that the image is split into
+ * horizontal stripes, and the grain of each stripe is added by one of the
+ * workers. The output does not depend on the number of workers. The workers
+ * must be idle; their hook and data are overwritten. When a cache is given,
+ * the grain templates and scaling functions kept in it are reused if they
+ * match grain_params, and replaced otherwise. dst may be src, in which case
+ * the grain is added in place and src must have room for the width and
+ * height rounded up to even.
+ *
+ * Returns 0 for success, -1 for failure
+ *
+ * \param[in]    grain_params     Grain parameters
+ * \param[in]    src              Source image
+ * \param[out]   dst              Resulting image with grain
+ * \param[in]    cache            Cache of the grain templates, or NULL
+ * \param[in]    workers          Workers to add the grain with, or NULL
+ * \param[in]    num_workers      Number of workers
+ */
+int av1_add_film_grain_mt(const aom_film_grain_t *grain_params,
+                          const aom_image_t *src, aom_image_t *dst,
+                          aom_film_grain_cache_t *cache, AVxWorker *workers,
+                          int num_workers);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
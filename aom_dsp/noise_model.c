@@ -18,8 +18,10 @@
 #include "aom_dsp/noise_model.h"
 #include "aom_dsp/noise_util.h"
 #include "aom_mem/aom_mem.h"
+#include "aom_util/aom_thread.h"
 #include "av1/common/common.h"
 #include "av1/encoder/mathutils.h"
+#include "config/aom_dsp_rtcd.h"
 
 #define kLowPolyNumParams 3
 
@@ -550,113 +552,224 @@ static int compare_scores(const void *a, const void *b) {
   return 0;
 }
 
-int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
-                              const uint8_t *const data, int w, int h,
-                              int stride, uint8_t *flat_blocks) {
+// Returns the number of jobs to split num_rows rows into, one per worker.
+static int get_num_jobs(AVxWorker *workers, int num_workers, int num_rows) {
+  return workers ? AOMMAX(AOMMIN(num_workers, num_rows), 1) : 1;
+}
+
+// Runs hook on each of the num_jobs jobs, which are job_size bytes apart. The
+// jobs run on the workers if given, or else one after the other on the
+// calling thread. The first worker runs on the calling thread, so it need not
+// have a thread of its own. Returns 1 if all the jobs succeeded.
+static int run_jobs(AVxWorker *workers, AVxWorkerHook hook, void *jobs,
+                    size_t job_size, int num_jobs) {
+  int success = 1;
+  if (!workers || num_jobs == 1) {
+    for (int i = 0; i < num_jobs; ++i) {
+      success &= hook((uint8_t *)jobs + i * job_size, NULL);
+    }
+    return success;
+  }
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  for (int i = num_jobs - 1; i >= 0; --i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = hook;
+    worker->data1 = (uint8_t *)jobs + i * job_size;
+    worker->data2 = NULL;
+    worker->had_error = 0;
+    if (i == 0)
+      winterface->execute(worker);
+    else
+      winterface->launch(worker);
+  }
+  for (int i = 0; i < num_jobs; ++i) {
+    success &= winterface->sync(&workers[i]);
+  }
+  return success;
+}
+
+// The block rows from start_row, every row_step rows, that a job of
+// aom_flat_block_finder_run_mt() scores.
+typedef struct {
+  const aom_flat_block_finder_t *block_finder;
+  const uint8_t *data;
+  int w;
+  int h;
+  int stride;
+  int num_blocks_w;
+  int num_blocks_h;
+  uint8_t *flat_blocks;
+  index_and_score_t *scores;
+  int start_row;
+  int row_step;
+} flat_block_job_t;
+
+static void find_flat_blocks_in_row(const flat_block_job_t *job, int by,
+                                    double *plane, double *block) {
   // The gradient-based features used in this code are based on:
   //  A. Kokaram, D. Kelly, H. Denman and A. Crawford, "Measuring noise
   //  correlation for improved video denoising," 2012 19th, ICIP.
   // The thresholds are more lenient to allow for correct grain modeling
   // if extreme cases.
-  const int block_size = block_finder->block_size;
+  const int block_size = job->block_finder->block_size;
   const int n = block_size * block_size;
   const double kTraceThreshold = 0.15 / (32 * 32);
   const double kRatioThreshold = 1.25;
   const double kNormThreshold = 0.08 / (32 * 32);
   const double kVarThreshold = 0.005 / (double)n;
+  const int num_blocks_w = job->num_blocks_w;
+  for (int bx = 0; bx < num_blocks_w; ++bx) {
+    // Compute gradient covariance matrix.
+    double Gxx = 0, Gxy = 0, Gyy = 0;
+    double var = 0;
+    double mean = 0;
+    int xi, yi;
+    aom_flat_block_finder_extract_block(job->block_finder, job->data, job->w,
+                                        job->h, job->stride, bx * block_size,
+                                        by * block_size, plane, block);
+
+    for (yi = 1; yi < block_size - 1; ++yi) {
+      for (xi = 1; xi < block_size - 1; ++xi) {
+        const double gx = (block[yi * block_size + xi + 1] -
+                           block[yi * block_size + xi - 1]) /
+                          2;
+        const double gy = (block[yi * block_size + xi + block_size] -
+                           block[yi * block_size + xi - block_size]) /
+                          2;
+        Gxx += gx * gx;
+        Gxy += gx * gy;
+        Gyy += gy * gy;
+
+        mean += block[yi * block_size + xi];
+        var += block[yi * block_size + xi] * block[yi * block_size + xi];
+      }
+    }
+    mean /= (block_size - 2) * (block_size - 2);
+
+    // Normalize gradients by block_size.
+    Gxx /= ((block_size - 2) * (block_size - 2));
+    Gxy /= ((block_size - 2) * (block_size - 2));
+    Gyy /= ((block_size - 2) * (block_size - 2));
+    var = var / ((block_size - 2) * (block_size - 2)) - mean * mean;
+
+    {
+      const double trace = Gxx + Gyy;
+      const double det = Gxx * Gyy - Gxy * Gxy;
+      const double e1 = (trace + sqrt(trace * trace - 4 * det)) / 2.;
+      const double e2 = (trace - sqrt(trace * trace - 4 * det)) / 2.;
+      const double norm = e1;  // Spectral norm
+      const double ratio = (e1 / AOMMAX(e2, 1e-6));
+      const int is_flat = (trace < kTraceThreshold) &&
+                          (ratio < kRatioThreshold) &&
+                          (norm < kNormThreshold) && (var > kVarThreshold);
+      // The following weights are used to combine the above features to give
+      // a sigmoid score for flatness. If the input was normalized to [0,100]
+      // the magnitude of these values would be close to 1 (e.g., weights
+      // corresponding to variance would be a factor of 10000x smaller).
+      // The weights are given in the following order:
+      //    [{var}, {ratio}, {trace}, {norm}, offset]
+      // with one of the most discriminative being simply the variance.
+      const double weights[5] = { -6682, -0.2056, 13087, -12434, 2.5694 };
+      const float score =
+          (float)(1.0 / (1 + exp(-(weights[0] * var + weights[1] * ratio +
+                                   weights[2] * trace + weights[3] * norm +
+                                   weights[4]))));
+      job->flat_blocks[by * num_blocks_w + bx] = is_flat ? 255 : 0;
+      job->scores[by * num_blocks_w + bx].score =
+          var > kVarThreshold ? score : 0;
+      job->scores[by * num_blocks_w + bx].index = by * num_blocks_w + bx;
+#ifdef NOISE_MODEL_LOG_SCORE
+      fprintf(stderr, "%g %g %g %g %g %d ", score, var, ratio, trace, norm,
+              is_flat);
+#endif
+    }
+  }
+#ifdef NOISE_MODEL_LOG_SCORE
+  fprintf(stderr, "\n");
+#endif
+}
+
+static int flat_block_finder_hook(void *arg1, void *unused) {
+  const flat_block_job_t *const job = (const flat_block_job_t *)arg1;
+  const int n = job->block_finder->block_size * job->block_finder->block_size;
+  (void)unused;
+  double *plane = (double *)aom_malloc(n * sizeof(*plane));
+  double *block = (double *)aom_malloc(n * sizeof(*block));
+  if (plane == NULL || block == NULL) {
+    aom_free(plane);
+    aom_free(block);
+    return 0;
+  }
+  for (int by = job->start_row; by < job->num_blocks_h; by += job->row_step) {
+    find_flat_blocks_in_row(job, by, plane, block);
+  }
+  aom_free(block);
+  aom_free(plane);
+  return 1;
+}
+
+int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
+                              const uint8_t *const data, int w, int h,
+                              int stride, uint8_t *flat_blocks) {
+  return aom_flat_block_finder_run_mt(block_finder, data, w, h, stride,
+                                      flat_blocks, NULL, 0);
+}
+
+int aom_flat_block_finder_run_mt(const aom_flat_block_finder_t *block_finder,
+                                 const uint8_t *const data, int w, int h,
+                                 int stride, uint8_t *flat_blocks,
+                                 AVxWorker *workers, int num_workers) {
+  const int block_size = block_finder->block_size;
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
+  const int num_jobs = get_num_jobs(workers, num_workers, num_blocks_h);
   int num_flat = 0;
-  int bx = 0, by = 0;
-  double *plane = (double *)aom_malloc(n * sizeof(*plane));
-  double *block = (double *)aom_malloc(n * sizeof(*block));
   index_and_score_t *scores = (index_and_score_t *)aom_malloc(
       num_blocks_w * num_blocks_h * sizeof(*scores));
-  if (plane == NULL || block == NULL || scores == NULL) {
-    fprintf(stderr, "Failed to allocate memory for block of size %d\n", n);
-    aom_free(plane);
-    aom_free(block);
+  flat_block_job_t *jobs =
+      (flat_block_job_t *)aom_malloc(num_jobs * sizeof(*jobs));
+  if (scores == NULL || jobs == NULL) {
+    fprintf(stderr, "Failed to allocate memory for %d blocks\n",
+            num_blocks_w * num_blocks_h);
     aom_free(scores);
+    aom_free(jobs);
     return -1;
   }
 
+  for (int i = 0; i < num_jobs; ++i) {
+    flat_block_job_t *const job = &jobs[i];
+    job->block_finder = block_finder;
+    job->data = data;
+    job->w = w;
+    job->h = h;
+    job->stride = stride;
+    job->num_blocks_w = num_blocks_w;
+    job->num_blocks_h = num_blocks_h;
+    job->flat_blocks = flat_blocks;
+    job->scores = scores;
+    job->start_row = i;
+    job->row_step = num_jobs;
+  }
+
 #ifdef NOISE_MODEL_LOG_SCORE
   fprintf(stderr, "score = [");
 #endif
-  for (by = 0; by < num_blocks_h; ++by) {
-    for (bx = 0; bx < num_blocks_w; ++bx) {
-      // Compute gradient covariance matrix.
-      double Gxx = 0, Gxy = 0, Gyy = 0;
-      double var = 0;
-      double mean = 0;
-      int xi, yi;
-      aom_flat_block_finder_extract_block(block_finder, data, w, h, stride,
-                                          bx * block_size, by * block_size,
-                                          plane, block);
-
-      for (yi = 1; yi < block_size - 1; ++yi) {
-        for (xi = 1; xi < block_size - 1; ++xi) {
-          const double gx = (block[yi * block_size + xi + 1] -
-                             block[yi * block_size + xi - 1]) /
-                            2;
-          const double gy = (block[yi * block_size + xi + block_size] -
-                             block[yi * block_size + xi - block_size]) /
-                            2;
-          Gxx += gx * gx;
-          Gxy += gx * gy;
-          Gyy += gy * gy;
-
-          mean += block[yi * block_size + xi];
-          var += block[yi * block_size + xi] * block[yi * block_size + xi];
-        }
-      }
-      mean /= (block_size - 2) * (block_size - 2);
-
-      // Normalize gradients by block_size.
-      Gxx /= ((block_size - 2) * (block_size - 2));
-      Gxy /= ((block_size - 2) * (block_size - 2));
-      Gyy /= ((block_size - 2) * (block_size - 2));
-      var = var / ((block_size - 2) * (block_size - 2)) - mean * mean;
-
-      {
-        const double trace = Gxx + Gyy;
-        const double det = Gxx * Gyy - Gxy * Gxy;
-        const double e1 = (trace + sqrt(trace * trace - 4 * det)) / 2.;
-        const double e2 = (trace - sqrt(trace * trace - 4 * det)) / 2.;
-        const double norm = e1;  // Spectral norm
-        const double ratio = (e1 / AOMMAX(e2, 1e-6));
-        const int is_flat = (trace < kTraceThreshold) &&
-                            (ratio < kRatioThreshold) &&
-                            (norm < kNormThreshold) && (var > kVarThreshold);
-        // The following weights are used to combine the above features to give
-        // a sigmoid score for flatness. If the input was normalized to [0,100]
-        // the magnitude of these values would be close to 1 (e.g., weights
-        // corresponding to variance would be a factor of 10000x smaller).
-        // The weights are given in the following order:
-        //    [{var}, {ratio}, {trace}, {norm}, offset]
-        // with one of the most discriminative being simply the variance.
-        const double weights[5] = { -6682, -0.2056, 13087, -12434, 2.5694 };
-        const float score =
-            (float)(1.0 / (1 + exp(-(weights[0] * var + weights[1] * ratio +
-                                     weights[2] * trace + weights[3] * norm +
-                                     weights[4]))));
-        flat_blocks[by * num_blocks_w + bx] = is_flat ? 255 : 0;
-        scores[by * num_blocks_w + bx].score = var > kVarThreshold ? score : 0;
-        scores[by * num_blocks_w + bx].index = by * num_blocks_w + bx;
-#ifdef NOISE_MODEL_LOG_SCORE
-        fprintf(stderr, "%g %g %g %g %g %d ", score, var, ratio, trace, norm,
-                is_flat);
-#endif
-        num_flat += is_flat;
-      }
-    }
-#ifdef NOISE_MODEL_LOG_SCORE
-    fprintf(stderr, "\n");
-#endif
-  }
+  const int success =
+      run_jobs(workers, flat_block_finder_hook, jobs, sizeof(*jobs), num_jobs);
 #ifdef NOISE_MODEL_LOG_SCORE
   fprintf(stderr, "];\n");
 #endif
+  aom_free(jobs);
+  if (!success) {
+    fprintf(stderr, "Failed to allocate memory for block of size %d\n",
+            block_size * block_size);
+    aom_free(scores);
+    return -1;
+  }
+
+  for (int i = 0; i < num_blocks_w * num_blocks_h; ++i) {
+    num_flat += flat_blocks[i] != 0;
+  }
   // Find the top-scored blocks (most likely to be flat) and set the flat blocks
   // be the union of the thresholded results and the top 10th percentile of the
   // scored results.
@@ -669,8 +782,6 @@ int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
       flat_blocks[scores[i].index] |= 1;
     }
   }
-  aom_free(block);
-  aom_free(plane);
   aom_free(scores);
   return num_flat;
 }
@@ -788,134 +899,236 @@ void aom_noise_model_free(aom_noise_model_t *model) {
 EXTRACT_AR_ROW(uint8_t, lowbd);
 EXTRACT_AR_ROW(uint16_t, highbd);
 
-static int add_block_observations(
-    aom_noise_model_t *noise_model, int c, const uint8_t *const data,
-    const uint8_t *const denoised, int w, int h, int stride, int sub_log2[2],
-    const uint8_t *const alt_data, const uint8_t *const alt_denoised,
-    int alt_stride, const uint8_t *const flat_blocks, int block_size,
-    int num_blocks_w, int num_blocks_h) {
+// The state shared by the jobs that gather the observations of one channel
+// for aom_noise_model_update_mt().
+typedef struct {
+  const aom_noise_model_t *noise_model;
+  int c;
+  const uint8_t *data;
+  const uint8_t *denoised;
+  int w;
+  int h;
+  int stride;
+  int *sub_log2;
+  const uint8_t *alt_data;
+  const uint8_t *alt_denoised;
+  int alt_stride;
+  const uint8_t *flat_blocks;
+  int block_size;
+  int num_blocks_w;
+  int num_blocks_h;
+  // Per block row equation systems of the AR coefficients.
+  double *row_A;
+  double *row_b;
+  int *row_num_observations;
+  // Per block noise strength measurements, valid where measured is set.
+  double *block_means;
+  double *block_strengths;
+  uint8_t *measured;
+} noise_observations_t;
+
+typedef struct {
+  const noise_observations_t *obs;
+  int start_row;
+  int row_step;
+} noise_observations_job_t;
+
+// Adds the observations of the flat blocks of block row by to the equation
+// system of that row.
+static void add_block_observations_in_row(const noise_observations_t *obs,
+                                          int by, double *buffer) {
+  const aom_noise_model_t *const noise_model = obs->noise_model;
   const int lag = noise_model->params.lag;
   const int num_coords = noise_model->n;
   const double normalization = (1 << noise_model->params.bit_depth) - 1;
-  double *A = noise_model->latest_state[c].eqns.A;
-  double *b = noise_model->latest_state[c].eqns.b;
-  double *buffer = (double *)aom_malloc(sizeof(*buffer) * (num_coords + 1));
-  const int n = noise_model->latest_state[c].eqns.n;
+  const int n = noise_model->latest_state[obs->c].eqns.n;
+  int *const sub_log2 = obs->sub_log2;
+  const int block_size = obs->block_size;
+  const int num_blocks_w = obs->num_blocks_w;
+  const uint8_t *const flat_blocks = obs->flat_blocks;
+  double *A = obs->row_A + by * n * n;
+  double *b = obs->row_b + by * n;
+  int num_observations = 0;
+
+  const int y_o = by * (block_size >> sub_log2[1]);
+  for (int bx = 0; bx < num_blocks_w; ++bx) {
+    const int x_o = bx * (block_size >> sub_log2[0]);
+    if (!flat_blocks[by * num_blocks_w + bx]) {
+      continue;
+    }
+    int y_start =
+        (by > 0 && flat_blocks[(by - 1) * num_blocks_w + bx]) ? 0 : lag;
+    int x_start = (bx > 0 && flat_blocks[by * num_blocks_w + bx - 1]) ? 0 : lag;
+    int y_end =
+        AOMMIN((obs->h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
+               block_size >> sub_log2[1]);
+    int x_end = AOMMIN(
+        (obs->w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]) - lag,
+        (bx + 1 < num_blocks_w && flat_blocks[by * num_blocks_w + bx + 1])
+            ? (block_size >> sub_log2[0])
+            : ((block_size >> sub_log2[0]) - lag));
+    for (int y = y_start; y < y_end; ++y) {
+      for (int x = x_start; x < x_end; ++x) {
+        const double val =
+            noise_model->params.use_highbd
+                ? extract_ar_row_highbd(
+                      noise_model->coords, num_coords,
+                      (const uint16_t *const)obs->data,
+                      (const uint16_t *const)obs->denoised, obs->stride,
+                      obs->sub_log2, (const uint16_t *const)obs->alt_data,
+                      (const uint16_t *const)obs->alt_denoised,
+                      obs->alt_stride, x + x_o, y + y_o, buffer)
+                : extract_ar_row_lowbd(
+                      noise_model->coords, num_coords, obs->data,
+                      obs->denoised, obs->stride, obs->sub_log2,
+                      obs->alt_data, obs->alt_denoised, obs->alt_stride,
+                      x + x_o, y + y_o, buffer);
+        for (int i = 0; i < n; ++i) {
+          for (int j = 0; j < n; ++j) {
+            A[i * n + j] +=
+                (buffer[i] * buffer[j]) / (normalization * normalization);
+          }
+          b[i] += (buffer[i] * val) / (normalization * normalization);
+        }
+        num_observations++;
+      }
+    }
+  }
+  obs->row_num_observations[by] = num_observations;
+}
 
+static int block_observations_hook(void *arg1, void *unused) {
+  const noise_observations_job_t *const job =
+      (const noise_observations_job_t *)arg1;
+  const noise_observations_t *const obs = job->obs;
+  const int num_coords = obs->noise_model->n;
+  (void)unused;
+  double *buffer = (double *)aom_malloc(sizeof(*buffer) * (num_coords + 1));
   if (!buffer) {
     fprintf(stderr, "Unable to allocate buffer of size %d\n", num_coords + 1);
     return 0;
   }
-  for (int by = 0; by < num_blocks_h; ++by) {
-    const int y_o = by * (block_size >> sub_log2[1]);
-    for (int bx = 0; bx < num_blocks_w; ++bx) {
-      const int x_o = bx * (block_size >> sub_log2[0]);
-      if (!flat_blocks[by * num_blocks_w + bx]) {
-        continue;
-      }
-      int y_start =
-          (by > 0 && flat_blocks[(by - 1) * num_blocks_w + bx]) ? 0 : lag;
-      int x_start =
-          (bx > 0 && flat_blocks[by * num_blocks_w + bx - 1]) ? 0 : lag;
-      int y_end = AOMMIN((h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
-                         block_size >> sub_log2[1]);
-      int x_end = AOMMIN(
-          (w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]) - lag,
-          (bx + 1 < num_blocks_w && flat_blocks[by * num_blocks_w + bx + 1])
-              ? (block_size >> sub_log2[0])
-              : ((block_size >> sub_log2[0]) - lag));
-      for (int y = y_start; y < y_end; ++y) {
-        for (int x = x_start; x < x_end; ++x) {
-          const double val =
-              noise_model->params.use_highbd
-                  ? extract_ar_row_highbd(noise_model->coords, num_coords,
-                                          (const uint16_t *const)data,
-                                          (const uint16_t *const)denoised,
-                                          stride, sub_log2,
-                                          (const uint16_t *const)alt_data,
-                                          (const uint16_t *const)alt_denoised,
-                                          alt_stride, x + x_o, y + y_o, buffer)
-                  : extract_ar_row_lowbd(noise_model->coords, num_coords, data,
-                                         denoised, stride, sub_log2, alt_data,
-                                         alt_denoised, alt_stride, x + x_o,
-                                         y + y_o, buffer);
-          for (int i = 0; i < n; ++i) {
-            for (int j = 0; j < n; ++j) {
-              A[i * n + j] +=
-                  (buffer[i] * buffer[j]) / (normalization * normalization);
-            }
-            b[i] += (buffer[i] * val) / (normalization * normalization);
-          }
-          noise_model->latest_state[c].num_observations++;
-        }
-      }
-    }
+  for (int by = job->start_row; by < obs->num_blocks_h; by += job->row_step) {
+    add_block_observations_in_row(obs, by, buffer);
   }
   aom_free(buffer);
   return 1;
 }
 
-static void add_noise_std_observations(
-    aom_noise_model_t *noise_model, int c, const double *coeffs,
-    const uint8_t *const data, const uint8_t *const denoised, int w, int h,
-    int stride, int sub_log2[2], const uint8_t *const alt_data, int alt_stride,
-    const uint8_t *const flat_blocks, int block_size, int num_blocks_w,
-    int num_blocks_h) {
-  const int num_coords = noise_model->n;
-  aom_noise_strength_solver_t *noise_strength_solver =
-      &noise_model->latest_state[c].strength_solver;
+// Gathers the observations of each block row in its own equation system, on
+// the workers, then adds up the rows in order. The sums do not depend on the
+// number of workers.
+static int add_block_observations(aom_noise_model_t *noise_model,
+                                  noise_observations_t *obs,
+                                  noise_observations_job_t *jobs, int num_jobs,
+                                  AVxWorker *workers) {
+  aom_noise_state_t *const state = &noise_model->latest_state[obs->c];
+  const int n = state->eqns.n;
+  memset(obs->row_A, 0, sizeof(*obs->row_A) * n * n * obs->num_blocks_h);
+  memset(obs->row_b, 0, sizeof(*obs->row_b) * n * obs->num_blocks_h);
+  if (!run_jobs(workers, block_observations_hook, jobs, sizeof(*jobs),
+                num_jobs)) {
+    return 0;
+  }
+  for (int by = 0; by < obs->num_blocks_h; ++by) {
+    const double *const A = obs->row_A + by * n * n;
+    const double *const b = obs->row_b + by * n;
+    for (int i = 0; i < n * n; ++i) state->eqns.A[i] += A[i];
+    for (int i = 0; i < n; ++i) state->eqns.b[i] += b[i];
+    state->num_observations += obs->row_num_observations[by];
+  }
+  return 1;
+}
 
+// Measures the noise strength of the flat blocks of block row by.
+static void measure_noise_std_in_row(const noise_observations_t *obs, int by) {
+  const aom_noise_model_t *const noise_model = obs->noise_model;
+  const int c = obs->c;
+  const int num_coords = noise_model->n;
+  const double *coeffs = noise_model->latest_state[c].eqns.x;
+  int *const sub_log2 = obs->sub_log2;
+  const int block_size = obs->block_size;
+  const int w = obs->w;
+  const int h = obs->h;
   const aom_noise_strength_solver_t *noise_strength_luma =
       &noise_model->latest_state[0].strength_solver;
   const double luma_gain = noise_model->latest_state[0].ar_gain;
   const double noise_gain = noise_model->latest_state[c].ar_gain;
-  for (int by = 0; by < num_blocks_h; ++by) {
-    const int y_o = by * (block_size >> sub_log2[1]);
-    for (int bx = 0; bx < num_blocks_w; ++bx) {
-      const int x_o = bx * (block_size >> sub_log2[0]);
-      if (!flat_blocks[by * num_blocks_w + bx]) {
-        continue;
-      }
-      const int num_samples_h =
-          AOMMIN((h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
-                 block_size >> sub_log2[1]);
-      const int num_samples_w =
-          AOMMIN((w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]),
-                 (block_size >> sub_log2[0]));
-      // Make sure that we have a reasonable amount of samples to consider the
-      // block
-      if (num_samples_w * num_samples_h > block_size) {
-        const double block_mean = get_block_mean(
-            alt_data ? alt_data : data, w, h, alt_data ? alt_stride : stride,
-            x_o << sub_log2[0], y_o << sub_log2[1], block_size,
-            noise_model->params.use_highbd);
-        const double noise_var = get_noise_var(
-            data, denoised, stride, w >> sub_log2[0], h >> sub_log2[1], x_o,
-            y_o, block_size >> sub_log2[0], block_size >> sub_log2[1],
-            noise_model->params.use_highbd);
-        // We want to remove the part of the noise that came from being
-        // correlated with luma. Note that the noise solver for luma must
-        // have already been run.
-        const double luma_strength =
-            c > 0 ? luma_gain * noise_strength_solver_get_value(
-                                    noise_strength_luma, block_mean)
-                  : 0;
-        const double corr = c > 0 ? coeffs[num_coords] : 0;
-        // Chroma noise:
-        //    N(0, noise_var) = N(0, uncorr_var) + corr * N(0, luma_strength^2)
-        // The uncorrelated component:
-        //   uncorr_var = noise_var - (corr * luma_strength)^2
-        // But don't allow fully correlated noise (hence the max), since the
-        // synthesis cannot model it.
-        const double uncorr_std = sqrt(
-            AOMMAX(noise_var / 16, noise_var - pow(corr * luma_strength, 2)));
-        // After we've removed correlation with luma, undo the gain that will
-        // come from running the IIR filter.
-        const double adjusted_strength = uncorr_std / noise_gain;
-        aom_noise_strength_solver_add_measurement(
-            noise_strength_solver, block_mean, adjusted_strength);
-      }
+  const int y_o = by * (block_size >> sub_log2[1]);
+  for (int bx = 0; bx < obs->num_blocks_w; ++bx) {
+    const int block_index = by * obs->num_blocks_w + bx;
+    const int x_o = bx * (block_size >> sub_log2[0]);
+    obs->measured[block_index] = 0;
+    if (!obs->flat_blocks[block_index]) {
+      continue;
     }
+    const int num_samples_h =
+        AOMMIN((h >> sub_log2[1]) - by * (block_size >> sub_log2[1]),
+               block_size >> sub_log2[1]);
+    const int num_samples_w =
+        AOMMIN((w >> sub_log2[0]) - bx * (block_size >> sub_log2[0]),
+               (block_size >> sub_log2[0]));
+    // Make sure that we have a reasonable amount of samples to consider the
+    // block
+    if (num_samples_w * num_samples_h > block_size) {
+      const double block_mean = get_block_mean(
+          obs->alt_data ? obs->alt_data : obs->data, w, h,
+          obs->alt_data ? obs->alt_stride : obs->stride, x_o << sub_log2[0],
+          y_o << sub_log2[1], block_size, noise_model->params.use_highbd);
+      const double noise_var = get_noise_var(
+          obs->data, obs->denoised, obs->stride, w >> sub_log2[0],
+          h >> sub_log2[1], x_o, y_o, block_size >> sub_log2[0],
+          block_size >> sub_log2[1], noise_model->params.use_highbd);
+      // We want to remove the part of the noise that came from being
+      // correlated with luma. Note that the noise solver for luma must
+      // have already been run.
+      const double luma_strength =
+          c > 0 ? luma_gain * noise_strength_solver_get_value(
+                                  noise_strength_luma, block_mean)
+                : 0;
+      const double corr = c > 0 ? coeffs[num_coords] : 0;
+      // Chroma noise:
+      //    N(0, noise_var) = N(0, uncorr_var) + corr * N(0, luma_strength^2)
+      // The uncorrelated component:
+      //   uncorr_var = noise_var - (corr * luma_strength)^2
+      // But don't allow fully correlated noise (hence the max), since the
+      // synthesis cannot model it.
+      const double uncorr_std = sqrt(
+          AOMMAX(noise_var / 16, noise_var - pow(corr * luma_strength, 2)));
+      // After we've removed correlation with luma, undo the gain that will
+      // come from running the IIR filter.
+      const double adjusted_strength = uncorr_std / noise_gain;
+      obs->block_means[block_index] = block_mean;
+      obs->block_strengths[block_index] = adjusted_strength;
+      obs->measured[block_index] = 1;
+    }
+  }
+}
+
+static int noise_std_hook(void *arg1, void *unused) {
+  const noise_observations_job_t *const job =
+      (const noise_observations_job_t *)arg1;
+  (void)unused;
+  for (int by = job->start_row; by < job->obs->num_blocks_h;
+       by += job->row_step) {
+    measure_noise_std_in_row(job->obs, by);
+  }
+  return 1;
+}
+
+// Measures the noise strength of the blocks on the workers, then adds the
+// measurements to the solver in raster order.
+static void add_noise_std_observations(aom_noise_model_t *noise_model,
+                                       const noise_observations_t *obs,
+                                       noise_observations_job_t *jobs,
+                                       int num_jobs, AVxWorker *workers) {
+  aom_noise_strength_solver_t *noise_strength_solver =
+      &noise_model->latest_state[obs->c].strength_solver;
+  run_jobs(workers, noise_std_hook, jobs, sizeof(*jobs), num_jobs);
+  for (int i = 0; i < obs->num_blocks_w * obs->num_blocks_h; ++i) {
+    if (!obs->measured[i]) continue;
+    aom_noise_strength_solver_add_measurement(
+        noise_strength_solver, obs->block_means[i], obs->block_strengths[i]);
   }
 }
 
@@ -1002,8 +1215,23 @@ aom_noise_status_t aom_noise_model_update(
     aom_noise_model_t *const noise_model, const uint8_t *const data[3],
     const uint8_t *const denoised[3], int w, int h, int stride[3],
     int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size) {
+  return aom_noise_model_update_mt(noise_model, data, denoised, w, h, stride,
+                                   chroma_sub_log2, flat_blocks, block_size,
+                                   NULL, 0);
+}
+
+aom_noise_status_t aom_noise_model_update_mt(
+    aom_noise_model_t *const noise_model, const uint8_t *const data[3],
+    const uint8_t *const denoised[3], int w, int h, int stride[3],
+    int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size,
+    AVxWorker *workers, int num_workers) {
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
+  const int num_jobs = get_num_jobs(workers, num_workers, num_blocks_h);
+  const int n = noise_model->latest_state[0].eqns.n + 1;
+  noise_observations_t obs;
+  noise_observations_job_t *jobs = NULL;
+  aom_noise_status_t status = AOM_NOISE_STATUS_OK;
   int y_model_different = 0;
   int num_blocks = 0;
   int i = 0, channel = 0;
@@ -1038,6 +1266,39 @@ aom_noise_status_t aom_noise_model_update(
     return AOM_NOISE_STATUS_INSUFFICIENT_FLAT_BLOCKS;
   }
 
+  // The chroma equation systems have one more coefficient than luma, so the
+  // per row systems are sized for chroma.
+  memset(&obs, 0, sizeof(obs));
+  obs.noise_model = noise_model;
+  obs.w = w;
+  obs.h = h;
+  obs.flat_blocks = flat_blocks;
+  obs.block_size = block_size;
+  obs.num_blocks_w = num_blocks_w;
+  obs.num_blocks_h = num_blocks_h;
+  obs.row_A = (double *)aom_malloc(sizeof(*obs.row_A) * n * n * num_blocks_h);
+  obs.row_b = (double *)aom_malloc(sizeof(*obs.row_b) * n * num_blocks_h);
+  obs.row_num_observations = (int *)aom_malloc(
+      sizeof(*obs.row_num_observations) * num_blocks_h);
+  obs.block_means = (double *)aom_malloc(sizeof(*obs.block_means) *
+                                         num_blocks_w * num_blocks_h);
+  obs.block_strengths = (double *)aom_malloc(sizeof(*obs.block_strengths) *
+                                             num_blocks_w * num_blocks_h);
+  obs.measured = (uint8_t *)aom_malloc(sizeof(*obs.measured) * num_blocks_w *
+                                       num_blocks_h);
+  jobs = (noise_observations_job_t *)aom_malloc(sizeof(*jobs) * num_jobs);
+  if (!obs.row_A || !obs.row_b || !obs.row_num_observations ||
+      !obs.block_means || !obs.block_strengths || !obs.measured || !jobs) {
+    fprintf(stderr, "Unable to allocate the noise observation buffers\n");
+    status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+    goto done;
+  }
+  for (i = 0; i < num_jobs; ++i) {
+    jobs[i].obs = &obs;
+    jobs[i].start_row = i;
+    jobs[i].row_step = num_jobs;
+  }
+
   for (channel = 0; channel < 3; ++channel) {
     int no_subsampling[2] = { 0, 0 };
     const uint8_t *alt_data = channel > 0 ? data[0] : 0;
@@ -1045,12 +1306,18 @@ aom_noise_status_t aom_noise_model_update(
     int *sub = channel > 0 ? chroma_sub_log2 : no_subsampling;
     const int is_chroma = channel != 0;
     if (!data[channel] || !denoised[channel]) break;
-    if (!add_block_observations(noise_model, channel, data[channel],
-                                denoised[channel], w, h, stride[channel], sub,
-                                alt_data, alt_denoised, stride[0], flat_blocks,
-                                block_size, num_blocks_w, num_blocks_h)) {
+    obs.c = channel;
+    obs.data = data[channel];
+    obs.denoised = denoised[channel];
+    obs.stride = stride[channel];
+    obs.sub_log2 = sub;
+    obs.alt_data = alt_data;
+    obs.alt_denoised = alt_denoised;
+    obs.alt_stride = stride[0];
+    if (!add_block_observations(noise_model, &obs, jobs, num_jobs, workers)) {
       fprintf(stderr, "Adding block observation failed\n");
-      return AOM_NOISE_STATUS_INTERNAL_ERROR;
+      status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+      goto done;
     }
 
     if (!ar_equation_system_solve(&noise_model->latest_state[channel],
@@ -1061,19 +1328,18 @@ aom_noise_status_t aom_noise_model_update(
       } else {
         fprintf(stderr, "Solving latest noise equation system failed %d!\n",
                 channel);
-        return AOM_NOISE_STATUS_INTERNAL_ERROR;
+        status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+        goto done;
       }
     }
 
-    add_noise_std_observations(
-        noise_model, channel, noise_model->latest_state[channel].eqns.x,
-        data[channel], denoised[channel], w, h, stride[channel], sub, alt_data,
-        stride[0], flat_blocks, block_size, num_blocks_w, num_blocks_h);
+    add_noise_std_observations(noise_model, &obs, jobs, num_jobs, workers);
 
     if (!aom_noise_strength_solver_solve(
             &noise_model->latest_state[channel].strength_solver)) {
       fprintf(stderr, "Solving latest noise strength failed!\n");
-      return AOM_NOISE_STATUS_INTERNAL_ERROR;
+      status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+      goto done;
     }
 
     // Check noise characteristics and return if error.
@@ -1099,7 +1365,8 @@ aom_noise_status_t aom_noise_model_update(
       } else {
         fprintf(stderr, "Solving combined noise equation system failed %d!\n",
                 channel);
-        return AOM_NOISE_STATUS_INTERNAL_ERROR;
+        status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+        goto done;
       }
     }
 
@@ -1110,12 +1377,22 @@ aom_noise_status_t aom_noise_model_update(
     if (!aom_noise_strength_solver_solve(
             &noise_model->combined_state[channel].strength_solver)) {
       fprintf(stderr, "Solving combined noise strength failed!\n");
-      return AOM_NOISE_STATUS_INTERNAL_ERROR;
+      status = AOM_NOISE_STATUS_INTERNAL_ERROR;
+      goto done;
     }
   }
 
-  return y_model_different ? AOM_NOISE_STATUS_DIFFERENT_NOISE_TYPE
-                           : AOM_NOISE_STATUS_OK;
+  if (y_model_different) status = AOM_NOISE_STATUS_DIFFERENT_NOISE_TYPE;
+
+done:
+  aom_free(jobs);
+  aom_free(obs.measured);
+  aom_free(obs.block_strengths);
+  aom_free(obs.block_means);
+  aom_free(obs.row_num_observations);
+  aom_free(obs.row_b);
+  aom_free(obs.row_A);
+  return status;
 }
 
 void aom_noise_model_save_latest(aom_noise_model_t *noise_model) {
@@ -1276,12 +1553,6 @@ int aom_noise_model_get_grain_parameters(aom_noise_model_t *const noise_model,
   return 1;
 }
 
-static void pointwise_multiply(const float *a, float *b, int n) {
-  for (int i = 0; i < n; ++i) {
-    b[i] *= a[i];
-  }
-}
-
 static float *get_half_cos_window(int block_size) {
   float *window_function =
       (float *)aom_malloc(block_size * block_size * sizeof(*window_function));
@@ -1330,20 +1601,158 @@ static float *get_half_cos_window(int block_size) {
 DITHER_AND_QUANTIZE(uint8_t, lowbd);
 DITHER_AND_QUANTIZE(uint16_t, highbd);
 
+// One of the half overlapped block-set passes of aom_wiener_denoise_2d_mt()
+// over a plane. The dimensions are those of the plane.
+typedef struct {
+  const aom_flat_block_finder_t *block_finder;
+  const uint8_t *data;
+  int w;
+  int h;
+  int stride;
+  int block_w;
+  int block_h;
+  int offsx;
+  int offsy;
+  int num_blocks_w;
+  int num_blocks_h;
+  const float *window;
+  const float *psd;
+  float *result;
+  int result_stride;
+} wiener_pass_t;
+
+// The block rows from start_row - 1, every row_step rows, that a job filters
+// in each pass, along with the buffers it filters them in.
+typedef struct {
+  const wiener_pass_t *pass;
+  int start_row;
+  int row_step;
+  float *plane;
+  float *block;
+  double *plane_d;
+  double *block_d;
+  struct aom_noise_tx_t *tx_full;
+  struct aom_noise_tx_t *tx_chroma;
+  struct aom_noise_tx_t *tx;
+} wiener_job_t;
+
+static void wiener_denoise_row(const wiener_pass_t *pass, int by,
+                               const wiener_job_t *job) {
+  const int block_w = pass->block_w;
+  const int block_h = pass->block_h;
+  const int pixels_per_block = block_w * block_h;
+  const float *const window_function = pass->window;
+  float *const plane = job->plane;
+  float *const block = job->block;
+  for (int bx = -1; bx < pass->num_blocks_w; ++bx) {
+    aom_flat_block_finder_extract_block(
+        pass->block_finder, pass->data, pass->w, pass->h, pass->stride,
+        bx * block_w + pass->offsx, by * block_h + pass->offsy, job->plane_d,
+        job->block_d);
+    for (int j = 0; j < pixels_per_block; ++j) {
+      block[j] = (float)job->block_d[j];
+      plane[j] = (float)job->plane_d[j];
+    }
+    aom_noise_pointwise_multiply(window_function, block, pixels_per_block);
+    aom_noise_tx_forward(job->tx, block);
+    aom_noise_tx_filter(job->tx, pass->psd);
+    aom_noise_tx_inverse(job->tx, block);
+
+    // Apply window function to the plane approximation (we will apply
+    // it to the sum of plane + block when composing the results).
+    aom_noise_pointwise_multiply(window_function, plane, pixels_per_block);
+
+    for (int y = 0; y < block_h; ++y) {
+      const int y_result = y + (by + 1) * block_h + pass->offsy;
+      float *const result = pass->result + y_result * pass->result_stride;
+      for (int x = 0; x < block_w; ++x) {
+        const int x_result = x + (bx + 1) * block_w + pass->offsx;
+        result[x_result] += (block[y * block_w + x] + plane[y * block_w + x]) *
+                            window_function[y * block_w + x];
+      }
+    }
+  }
+}
+
+static int wiener_denoise_hook(void *arg1, void *unused) {
+  const wiener_job_t *const job = (const wiener_job_t *)arg1;
+  const wiener_pass_t *const pass = job->pass;
+  (void)unused;
+  // Each block row only adds to its own rows of the result, so the rows of a
+  // pass can be filtered in any order.
+  for (int by = job->start_row - 1; by < pass->num_blocks_h;
+       by += job->row_step) {
+    wiener_denoise_row(pass, by, job);
+  }
+  return 1;
+}
+
+static void free_wiener_jobs(wiener_job_t *jobs, int num_jobs) {
+  if (!jobs) return;
+  for (int i = 0; i < num_jobs; ++i) {
+    aom_free(jobs[i].plane);
+    aom_free(jobs[i].block);
+    aom_free(jobs[i].plane_d);
+    aom_free(jobs[i].block_d);
+    if (jobs[i].tx_chroma != jobs[i].tx_full)
+      aom_noise_tx_free(jobs[i].tx_chroma);
+    aom_noise_tx_free(jobs[i].tx_full);
+  }
+  aom_free(jobs);
+}
+
+static wiener_job_t *alloc_wiener_jobs(int num_jobs, int block_size,
+                                       int chroma_sub) {
+  wiener_job_t *jobs = (wiener_job_t *)aom_calloc(num_jobs, sizeof(*jobs));
+  if (!jobs) return NULL;
+  for (int i = 0; i < num_jobs; ++i) {
+    wiener_job_t *const job = &jobs[i];
+    job->start_row = i;
+    job->row_step = num_jobs;
+    job->plane =
+        (float *)aom_malloc(block_size * block_size * sizeof(*job->plane));
+    job->block = (float *)aom_memalign(
+        32, 2 * block_size * block_size * sizeof(*job->block));
+    job->plane_d =
+        (double *)aom_malloc(block_size * block_size * sizeof(*job->plane_d));
+    job->block_d =
+        (double *)aom_malloc(block_size * block_size * sizeof(*job->block_d));
+    job->tx_full = aom_noise_tx_malloc(block_size);
+    job->tx_chroma = chroma_sub != 0
+                         ? aom_noise_tx_malloc(block_size >> chroma_sub)
+                         : job->tx_full;
+    if (!job->plane || !job->block || !job->plane_d || !job->block_d ||
+        !job->tx_full || !job->tx_chroma) {
+      free_wiener_jobs(jobs, num_jobs);
+      return NULL;
+    }
+  }
+  return jobs;
+}
+
 int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
                           int w, int h, int stride[3], int chroma_sub[2],
                           float *noise_psd[3], int block_size, int bit_depth,
                           int use_highbd) {
-  float *plane = NULL, *block = NULL, *window_full = NULL,
-        *window_chroma = NULL;
-  double *block_d = NULL, *plane_d = NULL;
-  struct aom_noise_tx_t *tx_full = NULL;
-  struct aom_noise_tx_t *tx_chroma = NULL;
+  return aom_wiener_denoise_2d_mt(data, denoised, w, h, stride, chroma_sub,
+                                  noise_psd, block_size, bit_depth, use_highbd,
+                                  NULL, 0);
+}
+
+int aom_wiener_denoise_2d_mt(const uint8_t *const data[3],
+                             uint8_t *denoised[3], int w, int h, int stride[3],
+                             int chroma_sub[2], float *noise_psd[3],
+                             int block_size, int bit_depth, int use_highbd,
+                             AVxWorker *workers, int num_workers) {
+  float *window_full = NULL, *window_chroma = NULL;
   const int num_blocks_w = (w + block_size - 1) / block_size;
   const int num_blocks_h = (h + block_size - 1) / block_size;
   const int result_stride = (num_blocks_w + 2) * block_size;
   const int result_height = (num_blocks_h + 2) * block_size;
+  // The passes filter the block rows from -1 to num_blocks_h - 1.
+  const int num_jobs = get_num_jobs(workers, num_workers, num_blocks_h + 1);
   float *result = NULL;
+  wiener_job_t *jobs = NULL;
   int init_success = 1;
   aom_flat_block_finder_t block_finder_full;
   aom_flat_block_finder_t block_finder_chroma;
@@ -1358,83 +1767,56 @@ int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
                                              bit_depth, use_highbd);
   result = (float *)aom_malloc((num_blocks_h + 2) * block_size * result_stride *
                                sizeof(*result));
-  plane = (float *)aom_malloc(block_size * block_size * sizeof(*plane));
-  block =
-      (float *)aom_memalign(32, 2 * block_size * block_size * sizeof(*block));
-  block_d = (double *)aom_malloc(block_size * block_size * sizeof(*block_d));
-  plane_d = (double *)aom_malloc(block_size * block_size * sizeof(*plane_d));
+  jobs = alloc_wiener_jobs(num_jobs, block_size, chroma_sub[0]);
   window_full = get_half_cos_window(block_size);
-  tx_full = aom_noise_tx_malloc(block_size);
 
   if (chroma_sub[0] != 0) {
     init_success &= aom_flat_block_finder_init(&block_finder_chroma,
                                                block_size >> chroma_sub[0],
                                                bit_depth, use_highbd);
     window_chroma = get_half_cos_window(block_size >> chroma_sub[0]);
-    tx_chroma = aom_noise_tx_malloc(block_size >> chroma_sub[0]);
   } else {
     window_chroma = window_full;
-    tx_chroma = tx_full;
   }
 
-  init_success &= (tx_full != NULL) && (tx_chroma != NULL) && (plane != NULL) &&
-                  (plane_d != NULL) && (block != NULL) && (block_d != NULL) &&
-                  (window_full != NULL) && (window_chroma != NULL) &&
-                  (result != NULL);
+  init_success &= (jobs != NULL) && (window_full != NULL) &&
+                  (window_chroma != NULL) && (result != NULL);
   for (int c = init_success ? 0 : 3; c < 3; ++c) {
-    float *window_function = c == 0 ? window_full : window_chroma;
     aom_flat_block_finder_t *block_finder = &block_finder_full;
     const int chroma_sub_h = c > 0 ? chroma_sub[1] : 0;
     const int chroma_sub_w = c > 0 ? chroma_sub[0] : 0;
-    struct aom_noise_tx_t *tx =
-        (c > 0 && chroma_sub[0] > 0) ? tx_chroma : tx_full;
+    wiener_pass_t pass;
     if (!data[c] || !denoised[c]) continue;
     if (c > 0 && chroma_sub[0] != 0) {
       block_finder = &block_finder_chroma;
     }
+    pass.block_finder = block_finder;
+    pass.data = data[c];
+    pass.w = w >> chroma_sub_w;
+    pass.h = h >> chroma_sub_h;
+    pass.stride = stride[c];
+    pass.block_w = block_size >> chroma_sub_w;
+    pass.block_h = block_size >> chroma_sub_h;
+    pass.num_blocks_w = num_blocks_w;
+    pass.num_blocks_h = num_blocks_h;
+    pass.window = c == 0 ? window_full : window_chroma;
+    pass.psd = noise_psd[c];
+    pass.result = result;
+    pass.result_stride = result_stride;
+    for (int i = 0; i < num_jobs; ++i) {
+      jobs[i].pass = &pass;
+      jobs[i].tx = (c > 0 && chroma_sub[0] > 0) ? jobs[i].tx_chroma
+                                                : jobs[i].tx_full;
+    }
     memset(result, 0, sizeof(*result) * result_stride * result_height);
-    // Do overlapped block processing (half overlapped). The block rows can
-    // easily be done in parallel
-    for (int offsy = 0; offsy < (block_size >> chroma_sub_h);
-         offsy += (block_size >> chroma_sub_h) / 2) {
-      for (int offsx = 0; offsx < (block_size >> chroma_sub_w);
-           offsx += (block_size >> chroma_sub_w) / 2) {
-        // Pad the boundary when processing each block-set.
-        for (int by = -1; by < num_blocks_h; ++by) {
-          for (int bx = -1; bx < num_blocks_w; ++bx) {
-            const int pixels_per_block =
-                (block_size >> chroma_sub_w) * (block_size >> chroma_sub_h);
-            aom_flat_block_finder_extract_block(
-                block_finder, data[c], w >> chroma_sub_w, h >> chroma_sub_h,
-                stride[c], bx * (block_size >> chroma_sub_w) + offsx,
-                by * (block_size >> chroma_sub_h) + offsy, plane_d, block_d);
-            for (int j = 0; j < pixels_per_block; ++j) {
-              block[j] = (float)block_d[j];
-              plane[j] = (float)plane_d[j];
-            }
-            pointwise_multiply(window_function, block, pixels_per_block);
-            aom_noise_tx_forward(tx, block);
-            aom_noise_tx_filter(tx, noise_psd[c]);
-            aom_noise_tx_inverse(tx, block);
-
-            // Apply window function to the plane approximation (we will apply
-            // it to the sum of plane + block when composing the results).
-            pointwise_multiply(window_function, plane, pixels_per_block);
-
-            for (int y = 0; y < (block_size >> chroma_sub_h); ++y) {
-              const int y_result =
-                  y + (by + 1) * (block_size >> chroma_sub_h) + offsy;
-              for (int x = 0; x < (block_size >> chroma_sub_w); ++x) {
-                const int x_result =
-                    x + (bx + 1) * (block_size >> chroma_sub_w) + offsx;
-                result[y_result * result_stride + x_result] +=
-                    (block[y * (block_size >> chroma_sub_w) + x] +
-                     plane[y * (block_size >> chroma_sub_w) + x]) *
-                    window_function[y * (block_size >> chroma_sub_w) + x];
-              }
-            }
-          }
-        }
+    // Do overlapped block processing (half overlapped). The passes overlap, so
+    // they run one after the other, with the block rows of each pass split
+    // between the jobs.
+    for (pass.offsy = 0; pass.offsy < pass.block_h;
+         pass.offsy += pass.block_h / 2) {
+      for (pass.offsx = 0; pass.offsx < pass.block_w;
+           pass.offsx += pass.block_w / 2) {
+        run_jobs(workers, wiener_denoise_hook, jobs, sizeof(*jobs), num_jobs);
       }
     }
     if (use_highbd) {
@@ -1448,19 +1830,13 @@ int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
     }
   }
   aom_free(result);
-  aom_free(plane);
-  aom_free(block);
-  aom_free(plane_d);
-  aom_free(block_d);
   aom_free(window_full);
-
-  aom_noise_tx_free(tx_full);
+  free_wiener_jobs(jobs, num_jobs);
 
   aom_flat_block_finder_free(&block_finder_full);
   if (chroma_sub[0] != 0) {
     aom_flat_block_finder_free(&block_finder_chroma);
     aom_free(window_chroma);
-    aom_noise_tx_free(tx_chroma);
   }
   return init_success;
 }
@@ -1590,6 +1966,13 @@ static int denoise_and_model_realloc_if_necessary(
 int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
                               YV12_BUFFER_CONFIG *sd,
                               aom_film_grain_t *film_grain) {
+  return aom_denoise_and_model_run_mt(ctx, sd, film_grain, NULL, 0);
+}
+
+int aom_denoise_and_model_run_mt(struct aom_denoise_and_model_t *ctx,
+                                 YV12_BUFFER_CONFIG *sd,
+                                 aom_film_grain_t *film_grain,
+                                 AVxWorker *workers, int num_workers) {
   const int block_size = ctx->block_size;
   const int use_highbd = (sd->flags & YV12_FLAG_HIGHBITDEPTH) != 0;
   uint8_t *raw_data[3] = {
@@ -1606,20 +1989,22 @@ int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
     return 0;
   }
 
-  aom_flat_block_finder_run(&ctx->flat_block_finder, data[0], sd->y_width,
-                            sd->y_height, strides[0], ctx->flat_blocks);
+  aom_flat_block_finder_run_mt(&ctx->flat_block_finder, data[0], sd->y_width,
+                               sd->y_height, strides[0], ctx->flat_blocks,
+                               workers, num_workers);
 
-  if (!aom_wiener_denoise_2d(data, ctx->denoised, sd->y_width, sd->y_height,
-                             strides, chroma_sub_log2, ctx->noise_psd,
-                             block_size, ctx->bit_depth, use_highbd)) {
+  if (!aom_wiener_denoise_2d_mt(data, ctx->denoised, sd->y_width, sd->y_height,
+                                strides, chroma_sub_log2, ctx->noise_psd,
+                                block_size, ctx->bit_depth, use_highbd,
+                                workers, num_workers)) {
     fprintf(stderr, "Unable to denoise image\n");
     return 0;
   }
 
-  const aom_noise_status_t status = aom_noise_model_update(
+  const aom_noise_status_t status = aom_noise_model_update_mt(
       &ctx->noise_model, data, (const uint8_t *const *)ctx->denoised,
       sd->y_width, sd->y_height, strides, chroma_sub_log2, ctx->flat_blocks,
-      block_size);
+      block_size, workers, num_workers);
   int have_noise_estimate = 0;
   if (status == AOM_NOISE_STATUS_OK) {
     have_noise_estimate = 1;
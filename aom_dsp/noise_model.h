@@ -19,6 +19,7 @@ extern "C" {
 #include <stdint.h>
 #include "aom_dsp/grain_synthesis.h"
 #include "aom_scale/yv12config.h"
+#include "aom_util/aom_thread.h"
 
 /*!\brief Wrapper of data required to represent linear system of eqns and soln.
  */
@@ -157,6 +158,17 @@ int aom_flat_block_finder_run(const aom_flat_block_finder_t *block_finder,
                               const uint8_t *const data, int w, int h,
                               int stride, uint8_t *flat_blocks);
 
+/*!\brief Runs the flat block finder with the block rows split between up to
+ * num_workers of the given workers.
+ *
+ * The result is the same as that of aom_flat_block_finder_run. When workers
+ * is NULL the blocks are scored on the calling thread.
+ */
+int aom_flat_block_finder_run_mt(const aom_flat_block_finder_t *block_finder,
+                                 const uint8_t *const data, int w, int h,
+                                 int stride, uint8_t *flat_blocks,
+                                 AVxWorker *workers, int num_workers);
+
 // The noise shape indicates the allowed coefficients in the AR model.
 enum {
   AOM_NOISE_SHAPE_DIAMOND = 0,
@@ -244,6 +256,19 @@ aom_noise_status_t aom_noise_model_update(
     const uint8_t *const denoised[3], int w, int h, int strides[3],
     int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size);
 
+/*!\brief Updates the noise model, gathering the observations of the block
+ * rows on up to num_workers of the given workers.
+ *
+ * The observations of each block row are summed separately and then added
+ * together in order, so the model does not depend on the number of workers.
+ * When workers is NULL the observations are gathered on the calling thread.
+ */
+aom_noise_status_t aom_noise_model_update_mt(
+    aom_noise_model_t *const noise_model, const uint8_t *const data[3],
+    const uint8_t *const denoised[3], int w, int h, int strides[3],
+    int chroma_sub_log2[2], const uint8_t *const flat_blocks, int block_size,
+    AVxWorker *workers, int num_workers);
+
 /*\brief Save the "latest" estimate into the "combined" estimate.
  *
  * This is meant to be called when the noise modeling detected a change
@@ -282,6 +307,18 @@ int aom_wiener_denoise_2d(const uint8_t *const data[3], uint8_t *denoised[3],
                           float *noise_psd[3], int block_size, int bit_depth,
                           int use_highbd);
 
+/*!\brief Performs the Wiener filter denoising with the block rows split
+ * between up to num_workers of the given workers.
+ *
+ * The result is the same as that of aom_wiener_denoise_2d. When workers is
+ * NULL the blocks are filtered on the calling thread.
+ */
+int aom_wiener_denoise_2d_mt(const uint8_t *const data[3],
+                             uint8_t *denoised[3], int w, int h, int stride[3],
+                             int chroma_sub_log2[2], float *noise_psd[3],
+                             int block_size, int bit_depth, int use_highbd,
+                             AVxWorker *workers, int num_workers);
+
 struct aom_denoise_and_model_t;
 
 /*!\brief Denoise the buffer and model the residual noise.
@@ -301,6 +338,17 @@ struct aom_denoise_and_model_t;
 int aom_denoise_and_model_run(struct aom_denoise_and_model_t *ctx,
                               YV12_BUFFER_CONFIG *buf, aom_film_grain_t *grain);
 
+/*!\brief Denoise the buffer and model the residual noise, using up to
+ * num_workers of the given workers.
+ *
+ * See aom_denoise_and_model_run. The workers must have been reset and must
+ * not be in use by the caller for the duration of the call.
+ */
+int aom_denoise_and_model_run_mt(struct aom_denoise_and_model_t *ctx,
+                                 YV12_BUFFER_CONFIG *buf,
+                                 aom_film_grain_t *grain, AVxWorker *workers,
+                                 int num_workers);
+
 /*!\brief Allocates a context that can be used for denoising and noise modeling.
  *
  * \param[in]  bit_depth   Bit depth of buffers this will be run on.
@@ -0,0 +1,294 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+
+#include "config/aom_dsp_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_dsp/x86/synonyms.h"
+
+static INLINE __m256i clamp_epi32(__m256i v, __m256i min_v, __m256i max_v) {
+  return _mm256_min_epi32(_mm256_max_epi32(v, min_v), max_v);
+}
+
+// Returns (scale * grain + round) >> shift for 8 samples.
+static INLINE __m256i scale_grain(__m256i scale, const int *grain,
+                                  __m256i round, __m128i shift) {
+  const __m256i g = _mm256_loadu_si256((const __m256i *)grain);
+  return _mm256_sra_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(scale, g), round), shift);
+}
+
+// Looks up the 8 indices in the scaling function, interpolating between the
+// 256 entries for high bit depths like scale_LUT() in grain_synthesis.c. The
+// upper entry is clamped to the last one, which gives the same result as
+// returning the last entry directly.
+static INLINE __m256i highbd_scale_lut(const int *scaling_lut, __m256i index,
+                                       int bd) {
+  const int shift = bd - 8;
+  const __m128i shift_v = _mm_cvtsi32_si128(shift);
+  const __m256i x = _mm256_srl_epi32(index, shift_v);
+  const __m256i v0 = _mm256_i32gather_epi32(scaling_lut, x, 4);
+  if (!shift) return v0;
+
+  const __m256i x1 =
+      _mm256_min_epi32(_mm256_add_epi32(x, _mm256_set1_epi32(1)),
+                       _mm256_set1_epi32(255));
+  const __m256i v1 = _mm256_i32gather_epi32(scaling_lut, x1, 4);
+  const __m256i frac =
+      _mm256_and_si256(index, _mm256_set1_epi32((1 << shift) - 1));
+  const __m256i delta = _mm256_add_epi32(
+      _mm256_mullo_epi32(_mm256_sub_epi32(v1, v0), frac),
+      _mm256_set1_epi32(1 << (shift - 1)));
+  return _mm256_add_epi32(v0, _mm256_sra_epi32(delta, shift_v));
+}
+
+// [ v7 v6 v5 v4 | v3 v2 v1 v0 ] -> v7v6v5v4v3v2v1v0, for values in [0, 255].
+static INLINE __m128i pack_u8(__m256i v) {
+  const __m256i v16 = _mm256_packs_epi32(v, v);
+  const __m256i v8 = _mm256_packus_epi16(v16, v16);
+  return _mm_unpacklo_epi32(_mm256_castsi256_si128(v8),
+                            _mm256_extracti128_si256(v8, 1));
+}
+
+// [ v7 v6 v5 v4 | v3 v2 v1 v0 ] -> [ v7 v6 v5 v4 v3 v2 v1 v0 ], for values
+// that fit in 16 bits.
+static INLINE __m128i pack_u16(__m256i v) {
+  const __m256i v16 = _mm256_packus_epi32(v, v);
+  return _mm_unpacklo_epi64(_mm256_castsi256_si128(v16),
+                            _mm256_extracti128_si256(v16, 1));
+}
+
+void aom_film_grain_add_luma_noise_avx2(uint8_t *luma, int luma_stride,
+                                        const int *grain, int grain_stride,
+                                        int width, int height,
+                                        const int *scaling_lut,
+                                        int scaling_shift, int min_luma,
+                                        int max_luma) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i min_v = _mm256_set1_epi32(min_luma);
+  const __m256i max_v = _mm256_set1_epi32(max_luma);
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = luma + i * luma_stride;
+    const int *const grain_row = grain + i * grain_stride;
+    int j = 0;
+    for (; j + 8 <= width; j += 8) {
+      const __m256i pix = _mm256_cvtepu8_epi32(xx_loadl_64(row + j));
+      const __m256i scale = _mm256_i32gather_epi32(scaling_lut, pix, 4);
+      const __m256i noise = scale_grain(scale, grain_row + j, round, shift);
+      const __m256i res =
+          clamp_epi32(_mm256_add_epi32(pix, noise), min_v, max_v);
+      xx_storel_64(row + j, pack_u8(res));
+    }
+    if (j < width) {
+      aom_film_grain_add_luma_noise_c(row + j, luma_stride, grain_row + j,
+                                      grain_stride, width - j, 1, scaling_lut,
+                                      scaling_shift, min_luma, max_luma);
+    }
+  }
+}
+
+void aom_film_grain_add_chroma_noise_avx2(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i min_v = _mm256_set1_epi32(min_chroma);
+  const __m256i max_v = _mm256_set1_epi32(max_chroma);
+  const __m256i luma_mult_v = _mm256_set1_epi32(luma_mult);
+  const __m256i chroma_mult_v = _mm256_set1_epi32(chroma_mult);
+  const __m256i offset_v = _mm256_set1_epi32(offset);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max_index = _mm256_set1_epi32(255);
+  const __m256i one_16 = _mm256_set1_epi16(1);
+  const __m256i one_32 = _mm256_set1_epi32(1);
+
+  for (int i = 0; i < height; i++) {
+    uint8_t *const row = chroma + i * chroma_stride;
+    const uint8_t *const luma_row =
+        luma + (i << chroma_subsamp_y) * luma_stride;
+    const int *const grain_row = grain + i * grain_stride;
+    int j = 0;
+    for (; j + 8 <= width; j += 8) {
+      __m256i average_luma;
+      if (chroma_subsamp_x) {
+        // Sum the pairs of luma samples with a multiply-add by 1.
+        const __m256i l16 =
+            _mm256_cvtepu8_epi16(xx_loadu_128(luma_row + (j << 1)));
+        average_luma = _mm256_srai_epi32(
+            _mm256_add_epi32(_mm256_madd_epi16(l16, one_16), one_32), 1);
+      } else {
+        average_luma = _mm256_cvtepu8_epi32(xx_loadl_64(luma_row + j));
+      }
+      const __m256i pix = _mm256_cvtepu8_epi32(xx_loadl_64(row + j));
+      const __m256i merged = _mm256_add_epi32(
+          _mm256_srai_epi32(
+              _mm256_add_epi32(_mm256_mullo_epi32(average_luma, luma_mult_v),
+                               _mm256_mullo_epi32(pix, chroma_mult_v)),
+              6),
+          offset_v);
+      const __m256i index = clamp_epi32(merged, zero, max_index);
+      const __m256i scale = _mm256_i32gather_epi32(scaling_lut, index, 4);
+      const __m256i noise = scale_grain(scale, grain_row + j, round, shift);
+      const __m256i res =
+          clamp_epi32(_mm256_add_epi32(pix, noise), min_v, max_v);
+      xx_storel_64(row + j, pack_u8(res));
+    }
+    if (j < width) {
+      aom_film_grain_add_chroma_noise_c(
+          row + j, chroma_stride, luma_row + (j << chroma_subsamp_x),
+          luma_stride, grain_row + j, grain_stride, width - j, 1,
+          chroma_subsamp_x, chroma_subsamp_y, scaling_lut, scaling_shift,
+          luma_mult, chroma_mult, offset, min_chroma, max_chroma);
+    }
+  }
+}
+
+void aom_highbd_film_grain_add_luma_noise_avx2(
+    uint16_t *luma, int luma_stride, const int *grain, int grain_stride,
+    int width, int height, const int *scaling_lut, int scaling_shift,
+    int min_luma, int max_luma, int bd) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i min_v = _mm256_set1_epi32(min_luma);
+  const __m256i max_v = _mm256_set1_epi32(max_luma);
+
+  for (int i = 0; i < height; i++) {
+    uint16_t *const row = luma + i * luma_stride;
+    const int *const grain_row = grain + i * grain_stride;
+    int j = 0;
+    for (; j + 8 <= width; j += 8) {
+      const __m256i pix = _mm256_cvtepu16_epi32(xx_loadu_128(row + j));
+      const __m256i scale = highbd_scale_lut(scaling_lut, pix, bd);
+      const __m256i noise = scale_grain(scale, grain_row + j, round, shift);
+      const __m256i res =
+          clamp_epi32(_mm256_add_epi32(pix, noise), min_v, max_v);
+      xx_storeu_128(row + j, pack_u16(res));
+    }
+    if (j < width) {
+      aom_highbd_film_grain_add_luma_noise_c(
+          row + j, luma_stride, grain_row + j, grain_stride, width - j, 1,
+          scaling_lut, scaling_shift, min_luma, max_luma, bd);
+    }
+  }
+}
+
+void aom_highbd_film_grain_add_chroma_noise_avx2(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma, int bd) {
+  const __m256i round = _mm256_set1_epi32(1 << (scaling_shift - 1));
+  const __m128i shift = _mm_cvtsi32_si128(scaling_shift);
+  const __m256i min_v = _mm256_set1_epi32(min_chroma);
+  const __m256i max_v = _mm256_set1_epi32(max_chroma);
+  const __m256i luma_mult_v = _mm256_set1_epi32(luma_mult);
+  const __m256i chroma_mult_v = _mm256_set1_epi32(chroma_mult);
+  const __m256i offset_v = _mm256_set1_epi32(offset);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i max_index = _mm256_set1_epi32((256 << (bd - 8)) - 1);
+  const __m256i one_16 = _mm256_set1_epi16(1);
+  const __m256i one_32 = _mm256_set1_epi32(1);
+
+  for (int i = 0; i < height; i++) {
+    uint16_t *const row = chroma + i * chroma_stride;
+    const uint16_t *const luma_row =
+        luma + (i << chroma_subsamp_y) * luma_stride;
+    const int *const grain_row = grain + i * grain_stride;
+    int j = 0;
+    for (; j + 8 <= width; j += 8) {
+      __m256i average_luma;
+      if (chroma_subsamp_x) {
+        // The samples have at most 12 bits, so the signed multiply-add by 1
+        // sums the pairs of luma samples.
+        const __m256i l16 =
+            _mm256_loadu_si256((const __m256i *)(luma_row + (j << 1)));
+        average_luma = _mm256_srai_epi32(
+            _mm256_add_epi32(_mm256_madd_epi16(l16, one_16), one_32), 1);
+      } else {
+        average_luma = _mm256_cvtepu16_epi32(xx_loadu_128(luma_row + j));
+      }
+      const __m256i pix = _mm256_cvtepu16_epi32(xx_loadu_128(row + j));
+      const __m256i merged = _mm256_add_epi32(
+          _mm256_srai_epi32(
+              _mm256_add_epi32(_mm256_mullo_epi32(average_luma, luma_mult_v),
+                               _mm256_mullo_epi32(pix, chroma_mult_v)),
+              6),
+          offset_v);
+      const __m256i index = clamp_epi32(merged, zero, max_index);
+      const __m256i scale = highbd_scale_lut(scaling_lut, index, bd);
+      const __m256i noise = scale_grain(scale, grain_row + j, round, shift);
+      const __m256i res =
+          clamp_epi32(_mm256_add_epi32(pix, noise), min_v, max_v);
+      xx_storeu_128(row + j, pack_u16(res));
+    }
+    if (j < width) {
+      aom_highbd_film_grain_add_chroma_noise_c(
+          row + j, chroma_stride, luma_row + (j << chroma_subsamp_x),
+          luma_stride, grain_row + j, grain_stride, width - j, 1,
+          chroma_subsamp_x, chroma_subsamp_y, scaling_lut, scaling_shift,
+          luma_mult, chroma_mult, offset, min_chroma, max_chroma, bd);
+    }
+  }
+}
+
+// Returns (top * top_weight + bottom * bottom_weight + 16) >> 5, clamped to
+// the grain range, for 8 samples.
+static INLINE __m256i blend_8(const int *top, const int *bottom,
+                              __m256i top_weight, __m256i bottom_weight,
+                              __m256i min_v, __m256i max_v) {
+  const __m256i t = _mm256_loadu_si256((const __m256i *)top);
+  const __m256i b = _mm256_loadu_si256((const __m256i *)bottom);
+  const __m256i sum = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_mullo_epi32(t, top_weight),
+                       _mm256_mullo_epi32(b, bottom_weight)),
+      _mm256_set1_epi32(16));
+  return clamp_epi32(_mm256_srai_epi32(sum, 5), min_v, max_v);
+}
+
+void aom_film_grain_hor_overlap_avx2(const int *top, int top_stride,
+                                     const int *bottom, int bottom_stride,
+                                     int *dst, int dst_stride, int width,
+                                     int height, int min_value,
+                                     int max_value) {
+  if (height != 1 && height != 2) return;
+
+  const __m256i min_v = _mm256_set1_epi32(min_value);
+  const __m256i max_v = _mm256_set1_epi32(max_value);
+  const __m256i top_weight = _mm256_set1_epi32(height == 1 ? 23 : 27);
+  const __m256i bottom_weight = _mm256_set1_epi32(height == 1 ? 22 : 17);
+
+  int j = 0;
+  for (; j + 8 <= width; j += 8) {
+    // dst may be the same as top, so both rows are loaded before the store.
+    const __m256i res0 = blend_8(top + j, bottom + j, top_weight,
+                                 bottom_weight, min_v, max_v);
+    if (height == 2) {
+      const __m256i res1 =
+          blend_8(top + top_stride + j, bottom + bottom_stride + j,
+                  bottom_weight, top_weight, min_v, max_v);
+      _mm256_storeu_si256((__m256i *)(dst + dst_stride + j), res1);
+    }
+    _mm256_storeu_si256((__m256i *)(dst + j), res0);
+  }
+  if (j < width) {
+    aom_film_grain_hor_overlap_c(top + j, top_stride, bottom + j,
+                                 bottom_stride, dst + j, dst_stride, width - j,
+                                 height, min_value, max_value);
+  }
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <immintrin.h>
+#include <math.h>
+
+#include "config/aom_dsp_rtcd.h"
+
+// Filters 4 complex coefficients per iteration, with the real and imaginary
+// parts of each coefficient in adjacent lanes. The operations are the same as
+// in the C version, so the results match exactly.
+void aom_noise_tx_wiener_filter_avx2(float *tx_block, const float *psd,
+                                     int n) {
+  const float kBeta = 1.1f;
+  const float kEps = 1e-6f;
+  // The C version compares the power to 1e-6 in double precision, which for a
+  // float power is the same as comparing it to the next float above 1e-6.
+  float min_power = (float)1e-6;
+  if ((double)min_power <= 1e-6) min_power = nextafterf(min_power, 1.0f);
+
+  const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+  const __m256 min_coeff = _mm256_set1_ps(1e-8f);
+  const __m256 beta = _mm256_set1_ps(kBeta);
+  const __m256 eps = _mm256_set1_ps(kEps);
+  const __m256 min_power_v = _mm256_set1_ps(min_power);
+  const __m256 noise_gain = _mm256_set1_ps((kBeta - 1.0f) / kBeta);
+  int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    const __m256 c = _mm256_loadu_ps(tx_block + 2 * i);
+    const __m256 c_abs =
+        _mm256_max_ps(_mm256_andnot_ps(sign_mask, c), min_coeff);
+    const __m256 c_sq = _mm256_mul_ps(c_abs, c_abs);
+    // Sum the squares of the real and imaginary parts, in both lanes.
+    const __m256 p = _mm256_add_ps(c_sq, _mm256_permute_ps(c_sq, 0xb1));
+
+    const __m128 psd_4 = _mm_loadu_ps(psd + i);
+    const __m256 psd_8 = _mm256_insertf128_ps(
+        _mm256_castps128_ps256(_mm_unpacklo_ps(psd_4, psd_4)),
+        _mm_unpackhi_ps(psd_4, psd_4), 1);
+
+    const __m256 is_signal = _mm256_and_ps(
+        _mm256_cmp_ps(p, _mm256_mul_ps(beta, psd_8), _CMP_GT_OQ),
+        _mm256_cmp_ps(p, min_power_v, _CMP_GE_OQ));
+    const __m256 signal_gain = _mm256_div_ps(_mm256_sub_ps(p, psd_8),
+                                             _mm256_max_ps(p, eps));
+    const __m256 gain = _mm256_blendv_ps(noise_gain, signal_gain, is_signal);
+    _mm256_storeu_ps(tx_block + 2 * i, _mm256_mul_ps(c, gain));
+  }
+  if (i < n) aom_noise_tx_wiener_filter_c(tx_block + 2 * i, psd + i, n - i);
+}
+
+void aom_noise_pointwise_multiply_avx2(const float *a, float *b, int n) {
+  int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm256_storeu_ps(
+        b + i, _mm256_mul_ps(_mm256_loadu_ps(b + i), _mm256_loadu_ps(a + i)));
+  }
+  for (; i < n; ++i) {
+    b[i] *= a[i];
+  }
+}
@@ -15,6 +15,13 @@
 #include <string.h>
 #include "include/aom_mem_intrnl.h"
 #include "aom/aom_integer.h"
+#if CONFIG_MEM_POOL
+#include "aom_ports/aom_once.h"
+#include "aom_ports/bitops.h"
+#if CONFIG_MULTITHREAD
+#include "aom_util/aom_thread.h"
+#endif
+#endif  // CONFIG_MEM_POOL
 
 #if defined(AOM_MAX_ALLOCABLE_MEMORY)
 // Returns 0 in case of overflow of nmemb * size.
@@ -27,6 +34,260 @@ static int check_size_argument_overflow(uint64_t nmemb, uint64_t size) {
 }
 #endif
 
+#if CONFIG_MEM_POOL
+// Pooled allocator. Blocks are rounded up to one of NUM_SIZE_CLASSES size
+// classes, four per power of two from 256 bytes to 1 GB, and freed blocks are
+// kept on a free list per class for reuse, up to MEM_POOL_MAX_CACHED_BYTES in
+// total. Blocks of HUGE_PAGE_SIZE or more are mapped separately and, where
+// supported, backed by transparent huge pages.
+//
+// Every block is charged to the usage counter selected on the allocating
+// thread (see aom_mem_usage_select()), and credited back to the same counter
+// when it is freed, whichever thread frees it.
+
+#define MIN_SIZE_CLASS_LOG2 8
+#define MAX_SIZE_CLASS_LOG2 30
+#define NUM_SIZE_CLASSES (4 * (MAX_SIZE_CLASS_LOG2 - MIN_SIZE_CLASS_LOG2) + 1)
+#define HUGE_PAGE_SIZE ((size_t)2 << 20)
+
+#ifndef MEM_POOL_MAX_CACHED_BYTES
+#if SIZE_MAX > (1ULL << 32)
+#define MEM_POOL_MAX_CACHED_BYTES ((size_t)1 << 30)
+#else
+#define MEM_POOL_MAX_CACHED_BYTES ((size_t)1 << 28)
+#endif
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+#if defined(__linux__) && defined(MAP_ANONYMOUS)
+#define USE_MMAP 1
+#else
+#define USE_MMAP 0
+#endif
+
+#if defined(_MSC_VER)
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+struct aom_mem_usage {
+  size_t bytes;
+  size_t peak_bytes;
+  // The owner's reference plus one per block charged to this counter.
+  size_t refs;
+};
+
+// Stored immediately before every pointer returned by aom_memalign().
+typedef struct {
+  void *addr;                   // Start of the underlying block
+  size_t size;                  // Size of the underlying block
+  struct aom_mem_usage *usage;  // Counter charged for the block, or NULL
+  int size_class;               // -1 if the block is not pooled
+} BlockHeader;
+
+typedef struct FreeBlock {
+  struct FreeBlock *next;
+} FreeBlock;
+
+static FreeBlock *free_lists[NUM_SIZE_CLASSES];
+static size_t cached_bytes;
+// Counters not yet destroyed by their owner.
+static int num_usages;
+static THREAD_LOCAL struct aom_mem_usage *current_usage;
+
+#if CONFIG_MULTITHREAD
+static pthread_mutex_t pool_mutex;
+
+static void init_pool_mutex(void) { pthread_mutex_init(&pool_mutex, NULL); }
+
+static void lock_pool(void) {
+  aom_once(init_pool_mutex);
+  pthread_mutex_lock(&pool_mutex);
+}
+
+static void unlock_pool(void) { pthread_mutex_unlock(&pool_mutex); }
+#else
+static void lock_pool(void) {}
+static void unlock_pool(void) {}
+#endif  // CONFIG_MULTITHREAD
+
+static size_t get_class_size(int size_class) {
+  const int log2 = MIN_SIZE_CLASS_LOG2 + size_class / 4;
+  return (size_t)(4 + size_class % 4) << (log2 - 2);
+}
+
+// Returns the smallest size class that holds size bytes, or -1 if size is
+// larger than the largest class.
+static int get_size_class(size_t size) {
+  if (size <= ((size_t)1 << MIN_SIZE_CLASS_LOG2)) return 0;
+  if (size > ((size_t)1 << MAX_SIZE_CLASS_LOG2)) return -1;
+  const int log2 = get_msb((unsigned int)(size - 1));
+  const size_t quarter = (size_t)1 << (log2 - 2);
+  const int steps = (int)((size - 1 - ((size_t)1 << log2)) / quarter) + 1;
+  return 4 * (log2 - MIN_SIZE_CLASS_LOG2) + steps;
+}
+
+static void *alloc_block(size_t size) {
+#if USE_MMAP
+  if (size >= HUGE_PAGE_SIZE) {
+    void *const addr = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return NULL;
+#if defined(MADV_HUGEPAGE)
+    madvise(addr, size, MADV_HUGEPAGE);
+#endif
+    return addr;
+  }
+#endif
+  return malloc(size);
+}
+
+static void free_block(void *addr, size_t size) {
+#if USE_MMAP
+  if (size >= HUGE_PAGE_SIZE) {
+    munmap(addr, size);
+    return;
+  }
+#endif
+  (void)size;
+  free(addr);
+}
+
+static void release_usage(struct aom_mem_usage *usage) {
+  if (--usage->refs == 0) free(usage);
+}
+
+void *aom_memalign(size_t align, size_t size) {
+  // Keep the header naturally aligned.
+  if (align < DEFAULT_ALIGNMENT) align = DEFAULT_ALIGNMENT;
+  const size_t aligned_size = size + align - 1 + sizeof(BlockHeader);
+#if defined(AOM_MAX_ALLOCABLE_MEMORY)
+  if (!check_size_argument_overflow(1, aligned_size)) return NULL;
+#endif
+  const int size_class = get_size_class(aligned_size);
+  const size_t block_size =
+      size_class >= 0 ? get_class_size(size_class) : aligned_size;
+  void *addr = NULL;
+
+  lock_pool();
+  if (size_class >= 0 && free_lists[size_class] != NULL) {
+    FreeBlock *const block = free_lists[size_class];
+    free_lists[size_class] = block->next;
+    cached_bytes -= block_size;
+    addr = block;
+  }
+  unlock_pool();
+
+  if (addr == NULL) {
+    addr = size_class >= 0 ? alloc_block(block_size) : malloc(block_size);
+    if (addr == NULL) return NULL;
+  }
+
+  void *const x =
+      align_addr((unsigned char *)addr + sizeof(BlockHeader), align);
+  BlockHeader *const header = (BlockHeader *)x - 1;
+  header->addr = addr;
+  header->size = block_size;
+  header->usage = current_usage;
+  header->size_class = size_class;
+  if (header->usage != NULL) {
+    lock_pool();
+    header->usage->bytes += block_size;
+    if (header->usage->bytes > header->usage->peak_bytes)
+      header->usage->peak_bytes = header->usage->bytes;
+    ++header->usage->refs;
+    unlock_pool();
+  }
+  return x;
+}
+
+void aom_free(void *memblk) {
+  if (memblk) {
+    const BlockHeader header = *((BlockHeader *)memblk - 1);
+    int cached = 0;
+
+    lock_pool();
+    if (header.usage != NULL) {
+      header.usage->bytes -= header.size;
+      release_usage(header.usage);
+    }
+    if (header.size_class >= 0 &&
+        cached_bytes + header.size <= MEM_POOL_MAX_CACHED_BYTES) {
+      FreeBlock *const block = (FreeBlock *)header.addr;
+      block->next = free_lists[header.size_class];
+      free_lists[header.size_class] = block;
+      cached_bytes += header.size;
+      cached = 1;
+    }
+    unlock_pool();
+
+    if (!cached) {
+      if (header.size_class >= 0)
+        free_block(header.addr, header.size);
+      else
+        free(header.addr);
+    }
+  }
+}
+
+// Must be called with the pool locked.
+static void trim_pool(void) {
+  for (int i = 0; i < NUM_SIZE_CLASSES; ++i) {
+    while (free_lists[i] != NULL) {
+      FreeBlock *const block = free_lists[i];
+      free_lists[i] = block->next;
+      free_block(block, get_class_size(i));
+    }
+  }
+  cached_bytes = 0;
+}
+
+void aom_mem_pool_trim(void) {
+  lock_pool();
+  trim_pool();
+  unlock_pool();
+}
+
+aom_mem_usage_t *aom_mem_usage_create(void) {
+  aom_mem_usage_t *const usage = (aom_mem_usage_t *)calloc(1, sizeof(*usage));
+  if (usage) {
+    usage->refs = 1;
+    lock_pool();
+    ++num_usages;
+    unlock_pool();
+  }
+  return usage;
+}
+
+void aom_mem_usage_destroy(aom_mem_usage_t *usage) {
+  if (usage) {
+    lock_pool();
+    release_usage(usage);
+    // Each codec instance owns a counter, so the cache is not kept once the
+    // last instance is destroyed.
+    if (--num_usages == 0) trim_pool();
+    unlock_pool();
+  }
+}
+
+aom_mem_usage_t *aom_mem_usage_select(aom_mem_usage_t *usage) {
+  aom_mem_usage_t *const prev = current_usage;
+  current_usage = usage;
+  return prev;
+}
+
+size_t aom_mem_usage_get(const aom_mem_usage_t *usage, size_t *peak_bytes) {
+  size_t bytes = 0;
+  lock_pool();
+  if (usage) bytes = usage->bytes;
+  if (peak_bytes) *peak_bytes = usage ? usage->peak_bytes : 0;
+  unlock_pool();
+  return bytes;
+}
+#else
 static size_t GetAlignedMallocSize(size_t size, size_t align) {
   return size + align - 1 + ADDRESS_STORAGE_SIZE;
 }
@@ -60,6 +321,31 @@ void *aom_memalign(size_t align, size_t size) {
   return x;
 }
 
+void aom_free(void *memblk) {
+  if (memblk) {
+    void *addr = GetActualMallocAddress(memblk);
+    free(addr);
+  }
+}
+
+void aom_mem_pool_trim(void) {}
+
+aom_mem_usage_t *aom_mem_usage_create(void) { return NULL; }
+
+void aom_mem_usage_destroy(aom_mem_usage_t *usage) { (void)usage; }
+
+aom_mem_usage_t *aom_mem_usage_select(aom_mem_usage_t *usage) {
+  (void)usage;
+  return NULL;
+}
+
+size_t aom_mem_usage_get(const aom_mem_usage_t *usage, size_t *peak_bytes) {
+  (void)usage;
+  if (peak_bytes) *peak_bytes = 0;
+  return 0;
+}
+#endif  // CONFIG_MEM_POOL
+
 void *aom_malloc(size_t size) { return aom_memalign(DEFAULT_ALIGNMENT, size); }
 
 void *aom_calloc(size_t num, size_t size) {
@@ -69,13 +355,6 @@ void *aom_calloc(size_t num, size_t size) {
   return x;
 }
 
-void aom_free(void *memblk) {
-  if (memblk) {
-    void *addr = GetActualMallocAddress(memblk);
-    free(addr);
-  }
-}
-
 void *aom_memset16(void *dest, int val, size_t length) {
   size_t i;
   uint16_t *dest16 = (uint16_t *)dest;
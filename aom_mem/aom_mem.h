@@ -38,6 +38,26 @@ void *aom_calloc(size_t num, size_t size);
 void aom_free(void *memblk);
 void *aom_memset16(void *dest, int val, size_t length);
 
+// Memory usage accounting, available when built with CONFIG_MEM_POOL. A
+// usage counter is charged for every block allocated by a thread while the
+// counter is selected on that thread, until the block is freed. Otherwise
+// aom_mem_usage_create() returns NULL and the other functions do nothing.
+typedef struct aom_mem_usage aom_mem_usage_t;
+
+aom_mem_usage_t *aom_mem_usage_create(void);
+// The counter stays valid until all the blocks charged to it are freed.
+void aom_mem_usage_destroy(aom_mem_usage_t *usage);
+// Selects the counter charged on the calling thread, which may be NULL, and
+// returns the previous one.
+aom_mem_usage_t *aom_mem_usage_select(aom_mem_usage_t *usage);
+// Returns the bytes currently charged to the counter, and the maximum so far
+// in *peak_bytes if it is not NULL.
+size_t aom_mem_usage_get(const aom_mem_usage_t *usage, size_t *peak_bytes);
+
+// Returns the blocks cached by the pooled allocator to the system. Also done
+// when the last counter is destroyed, i.e. with the last codec instance.
+void aom_mem_pool_trim(void);
+
 #include <string.h>
 
 #ifdef AOM_MEM_PLTFRM
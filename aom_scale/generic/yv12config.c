@@ -33,6 +33,7 @@ int aom_free_frame_buffer(YV12_BUFFER_CONFIG *ybf) {
       aom_free(ybf->buffer_alloc);
     }
     if (ybf->y_buffer_8bit) aom_free(ybf->y_buffer_8bit);
+    aom_free(ybf->corners);
 
     /* buffer_alloc isn't accessed by most functions.  Rather y_buffer,
       u_buffer and v_buffer point to buffer_alloc and are used.  Clear out
@@ -166,6 +167,7 @@ static int realloc_frame_buffer_aligned(
       }
     }
 
+    ybf->corners_valid = 0;
     ybf->corrupted = 0; /* assume not corrupted by errors */
     return 0;
   }
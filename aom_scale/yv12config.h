@@ -87,6 +87,12 @@ typedef struct yv12_buffer_config {
   uint8_t *y_buffer_8bit;
   int buf_8bit_valid;
 
+  // FAST corners of the (8-bit) luma plane for use in global motion detection.
+  // They are allocated and computed on-demand.
+  int *corners;
+  int num_corners;
+  int corners_valid;
+
   uint8_t *buffer_alloc;
   size_t buffer_alloc_sz;
   int border;
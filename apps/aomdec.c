@@ -106,6 +106,8 @@ static const arg_def_t outallarg = ARG_DEF(
     NULL, "all-layers", 0, "Output all decoded frames of a scalable bitstream");
 static const arg_def_t skipfilmgrain =
     ARG_DEF(NULL, "skip-film-grain", 0, "Skip film grain application");
+static const arg_def_t frameparallelarg = ARG_DEF(
+    NULL, "frame-parallel", 1, "Number of frames to decode in parallel");
 
 static const arg_def_t *all_args[] = {
   &help,           &codecarg,   &use_yv12,      &use_i420,
@@ -114,7 +116,7 @@ static const arg_def_t *all_args[] = {
   &outputfile,     &threadsarg, &verbosearg,    &scalearg,
   &fb_arg,         &md5arg,     &framestatsarg, &continuearg,
   &outbitdeptharg, &isannexb,   &oppointarg,    &outallarg,
-  &skipfilmgrain,  NULL
+  &skipfilmgrain,  &frameparallelarg, NULL
 };
 
 #if CONFIG_LIBYUV
@@ -460,6 +462,7 @@ static int main_loop(int argc, const char **argv_) {
   int operating_point = 0;
   int output_all_layers = 0;
   int skip_film_grain = 0;
+  unsigned int frame_parallel_depth = 0;
   aom_image_t *scaled_img = NULL;
   aom_image_t *img_shifted = NULL;
   int frame_avail, got_data, flush_decoder = 0;
@@ -576,6 +579,8 @@ static int main_loop(int argc, const char **argv_) {
       output_all_layers = 1;
     } else if (arg_match(&arg, &skipfilmgrain, argi)) {
       skip_film_grain = 1;
+    } else if (arg_match(&arg, &frameparallelarg, argi)) {
+      frame_parallel_depth = arg_parse_uint(&arg);
     } else {
       argj++;
     }
@@ -709,6 +714,20 @@ static int main_loop(int argc, const char **argv_) {
     goto fail;
   }
 
+  if (aom_codec_control(&decoder, AV1D_SET_FRAME_PARALLEL_DEPTH,
+                        frame_parallel_depth)) {
+    fprintf(stderr, "Failed to set frame_parallel_depth: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+
+  // The frames are only written out, so the grain can be added in place.
+  if (aom_codec_control(&decoder, AV1D_SET_FILM_GRAIN_IN_PLACE, 1)) {
+    fprintf(stderr, "Failed to set film_grain_in_place: %s\n",
+            aom_codec_error(&decoder));
+    goto fail;
+  }
+
   if (arg_skip) fprintf(stderr, "Skipping first %d frames.\n", arg_skip);
   while (arg_skip) {
     if (read_frame(&input, &buf, &bytes_in_buffer, &buffer_size)) break;
@@ -14,6 +14,7 @@
 #include "config/aom_config.h"
 #include "config/aom_version.h"
 
+#include "aom_mem/aom_mem.h"
 #include "aom_ports/aom_once.h"
 #include "aom_ports/mem_ops.h"
 #include "aom_ports/system_state.h"
@@ -948,6 +949,23 @@ static aom_codec_err_t ctrl_get_quantizer64(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_get_mem_usage(aom_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  size_t *const arg = va_arg(args, size_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->base.mem_usage == NULL) return AOM_CODEC_INCAPABLE;
+  arg[0] = aom_mem_usage_get(ctx->base.mem_usage, &arg[1]);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_frame_stats(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  aom_enc_frame_stats_t *const arg = va_arg(args, aom_enc_frame_stats_t *);
+  if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
+  *arg = ctx->cpi->frame_stats;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t update_extra_cfg(aom_codec_alg_priv_t *ctx,
                                         const struct av1_extracfg *extra_cfg) {
   const aom_codec_err_t res = validate_config(ctx, &ctx->cfg, extra_cfg);
@@ -1641,6 +1659,10 @@ static aom_codec_err_t encoder_init(aom_codec_ctx_t *ctx,
     ctx->priv->enc.total_encoders = 1;
     priv->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
     if (priv->buffer_pool == NULL) return AOM_CODEC_MEM_ERROR;
+    priv->buffer_pool->frame_bufs = (RefCntBuffer *)aom_calloc(
+        FRAME_BUFFERS, sizeof(*priv->buffer_pool->frame_bufs));
+    if (priv->buffer_pool->frame_bufs == NULL) return AOM_CODEC_MEM_ERROR;
+    priv->buffer_pool->num_frame_bufs = FRAME_BUFFERS;
 
 #if CONFIG_MULTITHREAD
     if (pthread_mutex_init(&priv->buffer_pool->pool_mutex, NULL)) {
@@ -1685,6 +1707,7 @@ static aom_codec_err_t encoder_destroy(aom_codec_alg_priv_t *ctx) {
 #if CONFIG_MULTITHREAD
   pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
 #endif
+  aom_free(ctx->buffer_pool->frame_bufs);
   aom_free(ctx->buffer_pool);
   aom_free(ctx);
   return AOM_CODEC_OK;
@@ -1704,6 +1727,12 @@ static aom_codec_frame_flags_t get_frame_pkt_flags(const AV1_COMP *cpi,
   return flags;
 }
 
+// Returns an image the encoder did not queue to the application.
+static void release_image(const aom_image_t *img) {
+  if (img != NULL && img->release_cb != NULL)
+    img->release_cb(img->release_cb_priv);
+}
+
 static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
                                       const aom_image_t *img,
                                       aom_codec_pts_t pts,
@@ -1714,8 +1743,14 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   AV1_COMP *const cpi = ctx->cpi;
   const aom_rational64_t *const timestamp_ratio = &ctx->timestamp_ratio;
   volatile aom_codec_pts_t ptsvol = pts;
+  // Set once av1_receive_raw_frame() returns, as the lookahead then owns the
+  // release callback. An error raised before that leaves it to this function.
+  volatile int img_queued = 0;
 
-  if (cpi == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (cpi == NULL) {
+    release_image(img);
+    return AOM_CODEC_INVALID_PARAM;
+  }
 
   if (img != NULL) {
     res = validate_img(ctx, img);
@@ -1730,6 +1765,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
         free(ctx->cx_data);
         ctx->cx_data = (unsigned char *)malloc(ctx->cx_data_sz);
         if (ctx->cx_data == NULL) {
+          release_image(img);
           return AOM_CODEC_MEM_ERROR;
         }
       }
@@ -1757,10 +1793,15 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
     cpi->common.error.setjmp = 0;
     res = update_error_state(ctx, &cpi->common.error);
     aom_clear_system_state();
+    av1_release_pack_writers(cpi);
+    if (!img_queued) release_image(img);
     return res;
   }
   cpi->common.error.setjmp = 1;
 
+  // AV1E_GET_FRAME_STATS reports on the frames encoded by this call.
+  av1_zero(cpi->frame_stats);
+
   // Note(yunqing): While applying encoding flags, always start from enabling
   // all, and then modifying according to the flags. Previous frame's flags are
   // overwritten.
@@ -1786,13 +1827,16 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
     if (img != NULL) {
       YV12_BUFFER_CONFIG sd;
       res = image2yuvconfig(img, &sd);
+      // The border guessed from the stride is only trusted for copying.
+      if (img->release_cb != NULL) sd.border = (int)img->border;
 
       // Store the original flags in to the frame buffer. Will extract the
       // key frame flag when we actually encode this frame.
-      if (av1_receive_raw_frame(cpi, flags | ctx->next_frame_flags, &sd,
-                                dst_time_stamp, dst_end_time_stamp)) {
-        res = update_error_state(ctx, &cpi->common.error);
-      }
+      const int receive_err = av1_receive_raw_frame(
+          cpi, flags | ctx->next_frame_flags, &sd, dst_time_stamp,
+          dst_end_time_stamp, img->release_cb, img->release_cb_priv);
+      img_queued = 1;
+      if (receive_err) res = update_error_state(ctx, &cpi->common.error);
       ctx->next_frame_flags = 0;
     }
 
@@ -1824,28 +1868,32 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
     int has_fwd_keyframe = 0;
     // invisible frames get packed with the next visible frame
     while (cx_data_sz - index_size >= ctx->cx_data_sz / 2 &&
-           !is_frame_visible &&
-           -1 != av1_get_compressed_data(cpi, &lib_flags, &frame_size, cx_data,
-                                         &dst_time_stamp, &dst_end_time_stamp,
-                                         !img, timestamp_ratio)) {
+           !is_frame_visible) {
+      const int write_temporal_delimiter =
+          !cpi->common.spatial_layer_id && !ctx->pending_frame_count;
+      // Leave room for the temporal delimiter in front of the frame, rather
+      // than moving the frame once it is coded.
+      const size_t td_size =
+          write_temporal_delimiter ? 1 + aom_uleb_size_in_bytes(0) : 0;
+
+      if (av1_get_compressed_data(cpi, &lib_flags, &frame_size,
+                                  cx_data + td_size, &dst_time_stamp,
+                                  &dst_end_time_stamp, !img,
+                                  timestamp_ratio) == -1) {
+        break;
+      }
       cpi->seq_params_locked = 1;
       if (frame_size) {
         if (ctx->pending_cx_data == 0) ctx->pending_cx_data = cx_data;
 
-        const int write_temporal_delimiter =
-            !cpi->common.spatial_layer_id && !ctx->pending_frame_count;
-
         if (write_temporal_delimiter) {
           uint32_t obu_header_size = 1;
           const uint32_t obu_payload_size = 0;
           const size_t length_field_size =
               aom_uleb_size_in_bytes(obu_payload_size);
 
-          if (ctx->pending_cx_data) {
-            const size_t move_offset = length_field_size + 1;
-            memmove(ctx->pending_cx_data + move_offset, ctx->pending_cx_data,
-                    frame_size);
-          }
+          assert(ctx->pending_cx_data == cx_data);
+          assert(td_size == obu_header_size + length_field_size);
           const uint32_t obu_header_offset = 0;
           obu_header_size = av1_write_obu_header(
               cpi, OBU_TEMPORAL_DELIMITER, 0,
@@ -1943,6 +1991,7 @@ static aom_codec_err_t encoder_encode(aom_codec_alg_priv_t *ctx,
   }
 
   cpi->common.error.setjmp = 0;
+  if (!img_queued) release_image(img);
   return res;
 }
 
@@ -2344,6 +2393,8 @@ static aom_codec_ctrl_fn_map_t encoder_ctrl_maps[] = {
   { AV1E_SET_CHROMA_SUBSAMPLING_X, ctrl_set_chroma_subsampling_x },
   { AV1E_SET_CHROMA_SUBSAMPLING_Y, ctrl_set_chroma_subsampling_y },
   { AV1E_GET_SEQ_LEVEL_IDX, ctrl_get_seq_level_idx },
+  { AV1E_GET_MEM_USAGE, ctrl_get_mem_usage },
+  { AV1E_GET_FRAME_STATS, ctrl_get_frame_stats },
   { -1, NULL },
 };
 
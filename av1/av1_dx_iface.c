@@ -21,6 +21,7 @@
 #include "aom/aom_decoder.h"
 #include "aom_dsp/bitreader_buffer.h"
 #include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
 #include "aom_ports/mem_ops.h"
 #include "aom_util/aom_thread.h"
 
@@ -35,6 +36,19 @@
 
 #include "av1/av1_iface_common.h"
 
+// A shown frame collected from a FrameWorker in frame parallel decode.
+typedef struct FrameOutput {
+  RefCntBuffer *buf;
+  void *user_priv;
+  int temporal_id;
+  int spatial_id;
+} FrameOutput;
+
+// The most frames that frame parallel decode can complete in one
+// decoder_decode() call: one per FrameWorker plus the temporal unit being
+// submitted.
+#define MAX_FRAME_OUTPUTS (MAX_FRAME_PARALLEL_DEPTH + 1)
+
 struct aom_codec_alg_priv {
   aom_codec_priv_t base;
   aom_codec_dec_cfg_t cfg;
@@ -54,20 +68,43 @@ struct aom_codec_alg_priv {
   unsigned int tile_mode;
   unsigned int ext_tile_debug;
   unsigned int row_mt;
+  unsigned int film_grain_mt;
+  unsigned int film_grain_in_place;
   EXTERNAL_REFERENCES ext_refs;
   unsigned int is_annexb;
   int operating_point;
   int output_all_layers;
 
-  // TODO(wtc): This can be simplified. num_frame_workers is always 1, and
-  // next_output_worker_id is always 0. The frame_workers array of size 1 can
-  // be replaced by a single AVxWorker.
+  // num_frame_workers is 1 unless frame parallel decode is enabled, in which
+  // case next_output_worker_id is unused.
   AVxWorker *frame_workers;
   int num_frame_workers;
   int next_output_worker_id;
 
+  // Frame parallel decode. Frames are handed to the FrameWorkers round-robin:
+  // next_submit_worker_id gets the next frame and last_submit_worker_id got
+  // the previous one (-1 before the first frame).
+  unsigned int frame_parallel_depth;
+  int frame_parallel_decode;
+  int next_submit_worker_id;
+  int last_submit_worker_id;
+  // Last shown frame of the temporal unit being collected, and whether a
+  // frame of that temporal unit failed to decode.
+  FrameOutput pending_output;
+  int pending_output_error;
+  // Frames to be returned by decoder_get_frame().
+  FrameOutput outputs[MAX_FRAME_OUTPUTS];
+  size_t num_outputs;
+
   aom_image_t image_with_grain;
-  aom_codec_frame_buffer_t grain_image_frame_buffers[MAX_NUM_SPATIAL_LAYERS];
+  // Film grain parameters of the last frame returned by decoder_get_frame().
+  aom_film_grain_t last_grain_params;
+  // Grain templates and scaling functions, reused across frames with the
+  // same film grain parameters.
+  aom_film_grain_cache_t grain_cache;
+  aom_codec_frame_buffer_t
+      grain_image_frame_buffers[AOMMAX(MAX_NUM_SPATIAL_LAYERS,
+                                       MAX_FRAME_OUTPUTS)];
   size_t num_grain_image_frame_buffers;
   int need_resync;  // wait for key/intra-only frame
   // BufferPool that holds all reference frames. Shared by all the FrameWorkers.
@@ -111,6 +148,7 @@ static aom_codec_err_t decoder_init(aom_codec_ctx_t *ctx,
     priv->num_grain_image_frame_buffers = 0;
     // Turn row_mt on by default.
     priv->row_mt = 1;
+    priv->film_grain_mt = 1;
 
     // Turn on normal tile coding mode by default.
     // 0 is for normal tile coding mode, and 1 is for large scale tile coding
@@ -131,6 +169,11 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
       aom_get_worker_interface()->end(worker);
+#if CONFIG_MULTITHREAD
+      pthread_mutex_destroy(&frame_worker_data->stats_mutex);
+      pthread_cond_destroy(&frame_worker_data->stats_cond);
+#endif
+      aom_free(frame_worker_data->scratch_buffer);
       aom_free(frame_worker_data->pbi->common.tpl_mvs);
       frame_worker_data->pbi->common.tpl_mvs = NULL;
       av1_remove_common(&frame_worker_data->pbi->common);
@@ -140,6 +183,8 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
     }
 #if CONFIG_MULTITHREAD
     pthread_mutex_destroy(&ctx->buffer_pool->pool_mutex);
+    pthread_mutex_destroy(&ctx->buffer_pool->progress_mutex);
+    pthread_cond_destroy(&ctx->buffer_pool->progress_cond);
 #endif
   }
 
@@ -150,8 +195,10 @@ static aom_codec_err_t decoder_destroy(aom_codec_alg_priv_t *ctx) {
     }
     av1_free_ref_frame_buffers(ctx->buffer_pool);
     av1_free_internal_frame_buffers(&ctx->buffer_pool->int_frame_buffers);
+    aom_free(ctx->buffer_pool->frame_bufs);
   }
 
+  av1_free_film_grain_cache(&ctx->grain_cache);
   aom_free(ctx->frame_workers);
   aom_free(ctx->buffer_pool);
   aom_free(ctx);
@@ -423,17 +470,40 @@ static void set_default_ppflags(aom_postproc_cfg_t *cfg) {
 
 static int frame_worker_hook(void *arg1, void *arg2) {
   FrameWorkerData *const frame_worker_data = (FrameWorkerData *)arg1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
   const uint8_t *data = frame_worker_data->data;
   (void)arg2;
 
-  int result = av1_receive_compressed_data(frame_worker_data->pbi,
-                                           frame_worker_data->data_size, &data);
+  aom_mem_usage_t *const prev_usage =
+      aom_mem_usage_select(frame_worker_data->mem_usage);
+  int result = av1_receive_compressed_data(pbi, frame_worker_data->data_size,
+                                           &data);
   frame_worker_data->data_end = data;
 
+  if (pbi->frame_parallel_decode) {
+    // The frame data may end with OBUs that follow the frame, such as
+    // metadata. Consume them here, as serial decode does with the next call.
+    const uint8_t *const data_end =
+        frame_worker_data->data + frame_worker_data->data_size;
+    while (result == 0 && data < data_end) {
+      if (data[0] == 0) {
+        ++data;  // Allow extra zero bytes after the frame end
+      } else {
+        result = av1_receive_compressed_data(pbi, (size_t)(data_end - data),
+                                             &data);
+      }
+    }
+  }
+
   if (result != 0) {
     // Check decode result in serial decode.
-    frame_worker_data->pbi->need_resync = 1;
+    pbi->need_resync = 1;
   }
+
+  // Frames without tile data (e.g. show_existing_frame), frames using
+  // superres and failed frames hand over their context only here.
+  if (pbi->frame_parallel_decode) av1_frameworker_signal_context_ready(pbi);
+  aom_mem_usage_select(prev_usage);
   return !result;
 }
 
@@ -444,19 +514,50 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
   ctx->last_show_frame = NULL;
   ctx->next_output_worker_id = 0;
   ctx->need_resync = 1;
-  ctx->num_frame_workers = 1;
+  // Large scale tile decoding, outputting all layers and inspection look at
+  // the decoder state of each frame from the application thread, so they
+  // always decode serially.
+  ctx->frame_parallel_decode = CONFIG_MULTITHREAD &&
+                               ctx->frame_parallel_depth > 1 &&
+                               !ctx->tile_mode && !ctx->output_all_layers;
+#if CONFIG_INSPECTION
+  if (ctx->inspect_cb != NULL) ctx->frame_parallel_decode = 0;
+#endif
+  ctx->num_frame_workers =
+      ctx->frame_parallel_decode ? (int)ctx->frame_parallel_depth : 1;
   if (ctx->num_frame_workers > MAX_DECODE_THREADS)
     ctx->num_frame_workers = MAX_DECODE_THREADS;
+  ctx->next_submit_worker_id = 0;
+  ctx->last_submit_worker_id = -1;
   ctx->flushed = 0;
 
   ctx->buffer_pool = (BufferPool *)aom_calloc(1, sizeof(BufferPool));
   if (ctx->buffer_pool == NULL) return AOM_CODEC_MEM_ERROR;
+  ctx->buffer_pool->frame_parallel_decode = ctx->frame_parallel_decode;
+  // In frame parallel decode, each frame in flight additionally holds its
+  // cur_frame, a pending output frame and a buffer that dropped out of the
+  // reference map of a later frame.
+  const int num_frame_bufs =
+      FRAME_BUFFERS +
+      (ctx->frame_parallel_decode ? 3 * ctx->num_frame_workers : 0);
+  ctx->buffer_pool->frame_bufs = (RefCntBuffer *)aom_calloc(
+      num_frame_bufs, sizeof(*ctx->buffer_pool->frame_bufs));
+  if (ctx->buffer_pool->frame_bufs == NULL) {
+    set_error_detail(ctx, "Failed to allocate frame buffers");
+    return AOM_CODEC_MEM_ERROR;
+  }
+  ctx->buffer_pool->num_frame_bufs = num_frame_bufs;
 
 #if CONFIG_MULTITHREAD
   if (pthread_mutex_init(&ctx->buffer_pool->pool_mutex, NULL)) {
     set_error_detail(ctx, "Failed to allocate buffer pool mutex");
     return AOM_CODEC_MEM_ERROR;
   }
+  if (pthread_mutex_init(&ctx->buffer_pool->progress_mutex, NULL) ||
+      pthread_cond_init(&ctx->buffer_pool->progress_cond, NULL)) {
+    set_error_detail(ctx, "Failed to allocate frame progress sync");
+    return AOM_CODEC_MEM_ERROR;
+  }
 #endif
 
   ctx->frame_workers = (AVxWorker *)aom_malloc(ctx->num_frame_workers *
@@ -477,20 +578,35 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
       return AOM_CODEC_MEM_ERROR;
     }
     frame_worker_data = (FrameWorkerData *)worker->data1;
+    memset(frame_worker_data, 0, sizeof(*frame_worker_data));
+#if CONFIG_MULTITHREAD
+    if (pthread_mutex_init(&frame_worker_data->stats_mutex, NULL) ||
+        pthread_cond_init(&frame_worker_data->stats_cond, NULL)) {
+      set_error_detail(ctx, "Failed to allocate frame worker sync");
+      return AOM_CODEC_MEM_ERROR;
+    }
+#endif
     frame_worker_data->pbi = av1_decoder_create(ctx->buffer_pool);
     if (frame_worker_data->pbi == NULL) {
       set_error_detail(ctx, "Failed to allocate frame_worker_data");
       return AOM_CODEC_MEM_ERROR;
     }
     frame_worker_data->pbi->common.options = &ctx->cfg.cfg;
+    frame_worker_data->mem_usage = ctx->base.mem_usage;
     frame_worker_data->worker_id = i;
     frame_worker_data->frame_context_ready = 0;
     frame_worker_data->received_frame = 0;
     frame_worker_data->pbi->allow_lowbitdepth = ctx->cfg.allow_lowbitdepth;
 
     // If decoding in serial mode, FrameWorker thread could create tile worker
-    // thread or loopfilter thread.
-    frame_worker_data->pbi->max_threads = ctx->cfg.threads;
+    // thread or loopfilter thread. In frame parallel mode the FrameWorkers
+    // split the threads between them.
+    frame_worker_data->pbi->max_threads =
+        ctx->frame_parallel_decode
+            ? AOMMAX(1, (int)ctx->cfg.threads / ctx->num_frame_workers)
+            : (int)ctx->cfg.threads;
+    frame_worker_data->pbi->frame_worker_owner = worker;
+    frame_worker_data->pbi->frame_parallel_decode = ctx->frame_parallel_decode;
     frame_worker_data->pbi->inv_tile_order = ctx->invert_tile_order;
     frame_worker_data->pbi->common.large_scale_tile = ctx->tile_mode;
     frame_worker_data->pbi->common.is_annexb = ctx->is_annexb;
@@ -502,8 +618,9 @@ static aom_codec_err_t init_decoder(aom_codec_alg_priv_t *ctx) {
     frame_worker_data->pbi->row_mt = ctx->row_mt;
 
     worker->hook = frame_worker_hook;
-    // The main thread acts as Frame Worker 0.
-    if (i != 0 && !winterface->reset(worker)) {
+    // The main thread acts as Frame Worker 0, unless frames are decoded in
+    // parallel.
+    if ((i != 0 || ctx->frame_parallel_decode) && !winterface->reset(worker)) {
       set_error_detail(ctx, "Frame Worker thread creation failed");
       return AOM_CODEC_MEM_ERROR;
     }
@@ -575,6 +692,212 @@ static aom_codec_err_t decode_one(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+// Releases the frame buffer held by 'output', if any.
+static void release_frame_output(BufferPool *const pool, FrameOutput *output) {
+  if (output->buf == NULL) return;
+  lock_buffer_pool(pool);
+  decrease_ref_count(output->buf, pool);
+  unlock_buffer_pool(pool);
+  output->buf = NULL;
+}
+
+// Waits for the frame worker to finish its frame and takes over the frame it
+// shows. Once the last frame of a temporal unit is done, the last frame shown
+// in the temporal unit is queued for decoder_get_frame().
+static aom_codec_err_t sync_frame_worker(aom_codec_alg_priv_t *ctx,
+                                         AVxWorker *const worker) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+  BufferPool *const pool = ctx->buffer_pool;
+  aom_codec_err_t res = AOM_CODEC_OK;
+
+  if (!frame_worker_data->received_frame) return AOM_CODEC_OK;
+  frame_worker_data->received_frame = 0;
+
+  if (winterface->sync(worker)) {
+    check_resync(ctx, pbi);
+  } else {
+    ctx->need_resync = 1;
+    ctx->pending_output_error = 1;
+    res = update_error_state(ctx, &pbi->common.error);
+  }
+
+  if (pbi->num_output_frames > 0) {
+    assert(pbi->num_output_frames == 1);
+    release_frame_output(pool, &ctx->pending_output);
+    ctx->pending_output.buf = pbi->output_frames[0];
+    ctx->pending_output.user_priv = frame_worker_data->user_priv;
+    ctx->pending_output.temporal_id = pbi->common.temporal_layer_id;
+    ctx->pending_output.spatial_id = pbi->common.spatial_layer_id;
+    pbi->num_output_frames = 0;
+  }
+
+  if (frame_worker_data->last_in_temporal_unit) {
+    if (ctx->pending_output.buf != NULL && !ctx->pending_output_error &&
+        !ctx->need_resync) {
+      assert(ctx->num_outputs < MAX_FRAME_OUTPUTS);
+      ctx->outputs[ctx->num_outputs++] = ctx->pending_output;
+      ctx->pending_output.buf = NULL;
+    }
+    release_frame_output(pool, &ctx->pending_output);
+    ctx->pending_output_error = 0;
+  }
+  return res;
+}
+
+// Waits for all frames in flight, oldest first.
+static aom_codec_err_t sync_all_frame_workers(aom_codec_alg_priv_t *ctx) {
+  aom_codec_err_t res = AOM_CODEC_OK;
+  for (int i = 0; i < ctx->num_frame_workers; ++i) {
+    const int worker_id =
+        (ctx->next_submit_worker_id + i) % ctx->num_frame_workers;
+    const aom_codec_err_t worker_res =
+        sync_frame_worker(ctx, &ctx->frame_workers[worker_id]);
+    if (res == AOM_CODEC_OK) res = worker_res;
+  }
+  return res;
+}
+
+// Returns the size of the next frame in [data, data_end): the OBUs before its
+// frame header, the frame header and its tile groups, and the OBUs up to the
+// next frame header, sequence header or temporal delimiter. If the OBUs cannot
+// be parsed, returns the remaining size and leaves the error to the decoder.
+static size_t get_frame_data_size(const uint8_t *data,
+                                  const uint8_t *data_end) {
+  const uint8_t *p = data;
+  int seen_frame_header = 0;
+  while (p < data_end) {
+    ObuHeader obu_header;
+    size_t payload_size;
+    size_t bytes_read;
+    // Zero bytes after the frame end are padding.
+    if (seen_frame_header && p[0] == 0) break;
+    if (aom_read_obu_header_and_size(p, (size_t)(data_end - p), 0, &obu_header,
+                                     &payload_size,
+                                     &bytes_read) != AOM_CODEC_OK ||
+        payload_size > (size_t)(data_end - p) - bytes_read) {
+      return (size_t)(data_end - data);
+    }
+    const int is_frame_header = obu_header.type == OBU_FRAME ||
+                                obu_header.type == OBU_FRAME_HEADER;
+    if (seen_frame_header &&
+        (is_frame_header || obu_header.type == OBU_SEQUENCE_HEADER ||
+         obu_header.type == OBU_TEMPORAL_DELIMITER)) {
+      break;
+    }
+    seen_frame_header |= is_frame_header;
+    p += bytes_read + payload_size;
+  }
+  return (size_t)(p - data);
+}
+
+// Hands one frame to the next frame worker, once the frame it decoded before
+// has been collected. Errors of that earlier frame are reported in
+// 'sync_res'.
+static aom_codec_err_t decode_one_frame_parallel(aom_codec_alg_priv_t *ctx,
+                                                 const uint8_t *data,
+                                                 size_t data_sz,
+                                                 void *user_priv,
+                                                 int last_in_temporal_unit,
+                                                 aom_codec_err_t *sync_res) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+
+  if (!ctx->si.h) {
+    int is_intra_only = 0;
+    ctx->si.is_annexb = ctx->is_annexb;
+    const aom_codec_err_t res =
+        decoder_peek_si_internal(data, data_sz, &ctx->si, &is_intra_only);
+    if (res != AOM_CODEC_OK) return res;
+
+    if (!ctx->si.is_kf && !is_intra_only) return AOM_CODEC_ERROR;
+  }
+
+  AVxWorker *const worker = &ctx->frame_workers[ctx->next_submit_worker_id];
+  FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
+  AV1Decoder *const pbi = frame_worker_data->pbi;
+  const aom_codec_err_t res = sync_frame_worker(ctx, worker);
+  if (*sync_res == AOM_CODEC_OK) *sync_res = res;
+
+  // The application may reuse its buffer once aom_codec_decode() returns.
+  if (frame_worker_data->scratch_buffer_size < data_sz) {
+    aom_free(frame_worker_data->scratch_buffer);
+    frame_worker_data->scratch_buffer = (uint8_t *)aom_malloc(data_sz);
+    if (frame_worker_data->scratch_buffer == NULL) {
+      frame_worker_data->scratch_buffer_size = 0;
+      set_error_detail(ctx, "Failed to allocate frame data buffer");
+      return AOM_CODEC_MEM_ERROR;
+    }
+    frame_worker_data->scratch_buffer_size = data_sz;
+  }
+  if (data_sz > 0) memcpy(frame_worker_data->scratch_buffer, data, data_sz);
+  frame_worker_data->data = frame_worker_data->scratch_buffer;
+  frame_worker_data->data_size = data_sz;
+  frame_worker_data->user_priv = user_priv;
+  frame_worker_data->last_in_temporal_unit = last_in_temporal_unit;
+  frame_worker_data->received_frame = 1;
+
+  pbi->common.byte_alignment = ctx->byte_alignment;
+  pbi->common.skip_loop_filter = ctx->skip_loop_filter;
+  pbi->common.skip_film_grain = ctx->skip_film_grain;
+  pbi->dec_tile_row = ctx->decode_tile_row;
+  pbi->dec_tile_col = ctx->decode_tile_col;
+  pbi->row_mt = ctx->row_mt;
+  pbi->common.is_annexb = ctx->is_annexb;
+
+  // Continue from the state the previous frame leaves behind. This waits
+  // until the previous frame has been parsed.
+  if (ctx->last_submit_worker_id >= 0) {
+    av1_frameworker_copy_context(
+        pbi, &ctx->frame_workers[ctx->last_submit_worker_id]);
+  }
+  frame_worker_data->frame_context_ready = 0;
+
+  worker->had_error = 0;
+  winterface->launch(worker);
+
+  ctx->last_submit_worker_id = ctx->next_submit_worker_id;
+  ctx->next_submit_worker_id =
+      (ctx->next_submit_worker_id + 1) % ctx->num_frame_workers;
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t decode_frame_parallel(aom_codec_alg_priv_t *ctx,
+                                             const uint8_t *data_start,
+                                             const uint8_t *data_end,
+                                             void *user_priv) {
+  aom_codec_err_t sync_res = AOM_CODEC_OK;
+
+  while (data_start < data_end) {
+    uint64_t frame_size;
+    if (ctx->is_annexb) {
+      // read the size of this frame unit
+      size_t length_of_size;
+      if (aom_uleb_decode(data_start, (size_t)(data_end - data_start),
+                          &frame_size, &length_of_size) != 0) {
+        return AOM_CODEC_CORRUPT_FRAME;
+      }
+      data_start += length_of_size;
+      if (frame_size > (size_t)(data_end - data_start))
+        return AOM_CODEC_CORRUPT_FRAME;
+    } else {
+      frame_size = get_frame_data_size(data_start, data_end);
+    }
+
+    // Allow extra zero bytes after the frame end
+    const uint8_t *next_frame = data_start + frame_size;
+    while (next_frame < data_end && next_frame[0] == 0) ++next_frame;
+
+    const aom_codec_err_t res = decode_one_frame_parallel(
+        ctx, data_start, (size_t)frame_size, user_priv, next_frame == data_end,
+        &sync_res);
+    if (res != AOM_CODEC_OK) return res;
+    data_start = next_frame;
+  }
+
+  return sync_res;
+}
+
 #if CONFIG_INSPECTION
 // This function enables the inspector to inspect non visible frames.
 static aom_codec_err_t decoder_inspect(aom_codec_alg_priv_t *ctx,
@@ -625,17 +948,25 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
   if (ctx->frame_workers) {
     BufferPool *const pool = ctx->buffer_pool;
     lock_buffer_pool(pool);
-    for (int i = 0; i < ctx->num_frame_workers; ++i) {
-      AVxWorker *const worker = &ctx->frame_workers[i];
-      FrameWorkerData *const frame_worker_data =
-          (FrameWorkerData *)worker->data1;
-      struct AV1Decoder *pbi = frame_worker_data->pbi;
-      for (size_t j = 0; j < pbi->num_output_frames; j++) {
-        decrease_ref_count(pbi->output_frames[j], pool);
+    if (ctx->frame_parallel_decode) {
+      for (size_t j = 0; j < ctx->num_outputs; j++) {
+        decrease_ref_count(ctx->outputs[j].buf, pool);
+      }
+      ctx->num_outputs = 0;
+    } else {
+      for (int i = 0; i < ctx->num_frame_workers; ++i) {
+        AVxWorker *const worker = &ctx->frame_workers[i];
+        FrameWorkerData *const frame_worker_data =
+            (FrameWorkerData *)worker->data1;
+        struct AV1Decoder *pbi = frame_worker_data->pbi;
+        for (size_t j = 0; j < pbi->num_output_frames; j++) {
+          decrease_ref_count(pbi->output_frames[j], pool);
+        }
+        pbi->num_output_frames = 0;
       }
-      pbi->num_output_frames = 0;
     }
-    unlock_buffer_pool(pool);
+    // Frame workers may be allocating frame buffers concurrently in frame
+    // parallel decode.
     for (size_t j = 0; j < ctx->num_grain_image_frame_buffers; j++) {
       pool->release_fb_cb(pool->cb_priv, &ctx->grain_image_frame_buffers[j]);
       ctx->grain_image_frame_buffers[j].data = NULL;
@@ -643,12 +974,21 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
       ctx->grain_image_frame_buffers[j].priv = NULL;
     }
     ctx->num_grain_image_frame_buffers = 0;
+    unlock_buffer_pool(pool);
+
+    // AV1D_GET_FRAME_STATS reports on the frames decoded by this call.
+    if (!ctx->frame_parallel_decode) {
+      FrameWorkerData *const frame_worker_data =
+          (FrameWorkerData *)ctx->frame_workers[0].data1;
+      av1_zero(frame_worker_data->pbi->frame_stats);
+    }
   }
 
   /* Sanity checks */
   /* NULL data ptr allowed if data_sz is 0 too */
   if (data == NULL && data_sz == 0) {
     ctx->flushed = 1;
+    if (ctx->frame_parallel_decode) return sync_all_frame_workers(ctx);
     return AOM_CODEC_OK;
   }
   if (data == NULL || data_sz == 0) return AOM_CODEC_INVALID_PARAM;
@@ -679,7 +1019,14 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
     data_end = data_start + temporal_unit_size;
   }
 
+  if (ctx->frame_parallel_decode)
+    return decode_frame_parallel(ctx, data_start, data_end, user_priv);
+
   // Decode in serial mode.
+  FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_workers[0].data1;
+  struct aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
   while (data_start < data_end) {
     uint64_t frame_size;
     if (ctx->is_annexb) {
@@ -687,17 +1034,20 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
       size_t length_of_size;
       if (aom_uleb_decode(data_start, (size_t)(data_end - data_start),
                           &frame_size, &length_of_size) != 0) {
-        return AOM_CODEC_CORRUPT_FRAME;
+        res = AOM_CODEC_CORRUPT_FRAME;
+        break;
       }
       data_start += length_of_size;
-      if (frame_size > (size_t)(data_end - data_start))
-        return AOM_CODEC_CORRUPT_FRAME;
+      if (frame_size > (size_t)(data_end - data_start)) {
+        res = AOM_CODEC_CORRUPT_FRAME;
+        break;
+      }
     } else {
       frame_size = (uint64_t)(data_end - data_start);
     }
 
     res = decode_one(ctx, &data_start, (size_t)frame_size, user_priv);
-    if (res != AOM_CODEC_OK) return res;
+    if (res != AOM_CODEC_OK) break;
 
     // Allow extra zero bytes after the frame end
     while (data_start < data_end) {
@@ -706,6 +1056,9 @@ static aom_codec_err_t decoder_decode(aom_codec_alg_priv_t *ctx,
       ++data_start;
     }
   }
+  aom_usec_timer_mark(&timer);
+  frame_worker_data->pbi->frame_stats.total_time +=
+      aom_usec_timer_elapsed(&timer);
 
   return res;
 }
@@ -717,42 +1070,94 @@ typedef struct {
 
 static void *AllocWithGetFrameBufferCb(void *priv, size_t size) {
   AllocCbParam *param = (AllocCbParam *)priv;
-  if (param->pool->get_fb_cb(param->pool->cb_priv, size, param->fb) < 0)
-    return NULL;
+  lock_buffer_pool(param->pool);
+  const int ret = param->pool->get_fb_cb(param->pool->cb_priv, size, param->fb);
+  unlock_buffer_pool(param->pool);
+  if (ret < 0) return NULL;
   if (param->fb->data == NULL || param->fb->size < size) return NULL;
   return param->fb->data;
 }
 
+// Returns 1 if the output frame buffer is only held to be output, so that the
+// film grain can be added to it without a copy.
+static int is_output_only(BufferPool *const pool, const RefCntBuffer *buf) {
+  lock_buffer_pool(pool);
+  const int output_only = buf->ref_count == 1;
+  unlock_buffer_pool(pool);
+  return output_only;
+}
+
 // If grain_params->apply_grain is false, returns img. Otherwise, adds film
-// grain to img, saves the result in grain_img, and returns grain_img.
+// grain to img, saves the result in grain_img, and returns grain_img. With
+// AV1D_SET_FILM_GRAIN_IN_PLACE, the grain is instead added to img, and img is
+// returned, when output_frame_buf is not a reference frame.
 static aom_image_t *add_grain_if_needed(aom_codec_alg_priv_t *ctx,
                                         aom_image_t *img,
                                         aom_image_t *grain_img,
-                                        aom_film_grain_t *grain_params) {
+                                        aom_film_grain_t *grain_params,
+                                        RefCntBuffer *output_frame_buf) {
   if (!grain_params->apply_grain) return img;
 
-  const int w_even = ALIGN_POWER_OF_TWO(img->d_w, 1);
-  const int h_even = ALIGN_POWER_OF_TWO(img->d_h, 1);
-
   BufferPool *const pool = ctx->buffer_pool;
-  aom_codec_frame_buffer_t *fb =
-      &ctx->grain_image_frame_buffers[ctx->num_grain_image_frame_buffers];
-  AllocCbParam param;
-  param.pool = pool;
-  param.fb = fb;
-  if (!aom_img_alloc_with_cb(grain_img, img->fmt, w_even, h_even, 16,
-                             AllocWithGetFrameBufferCb, &param)) {
-    return NULL;
+  aom_codec_frame_buffer_t *fb = NULL;
+  if (ctx->film_grain_in_place && is_output_only(pool, output_frame_buf)) {
+    // The frame buffer is aligned to 8 pixels and has a border, so it has
+    // room for the grain of the even width and height.
+    grain_img = img;
+  } else {
+    const int w_even = ALIGN_POWER_OF_TWO(img->d_w, 1);
+    const int h_even = ALIGN_POWER_OF_TWO(img->d_h, 1);
+
+    fb = &ctx->grain_image_frame_buffers[ctx->num_grain_image_frame_buffers];
+    AllocCbParam param;
+    param.pool = pool;
+    param.fb = fb;
+    if (!aom_img_alloc_with_cb(grain_img, img->fmt, w_even, h_even, 16,
+                               AllocWithGetFrameBufferCb, &param)) {
+      return NULL;
+    }
+
+    grain_img->user_priv = img->user_priv;
+    grain_img->fb_priv = fb->priv;
   }
 
-  grain_img->user_priv = img->user_priv;
-  grain_img->fb_priv = fb->priv;
-  if (av1_add_film_grain(grain_params, img, grain_img)) {
-    pool->release_fb_cb(pool->cb_priv, fb);
+  // The tile workers are idle once the frame is decoded, unless other frames
+  // are being decoded in parallel.
+  AV1Decoder *pbi = NULL;
+  AVxWorker *workers = NULL;
+  int num_workers = 0;
+  if (!ctx->frame_parallel_decode && ctx->frame_workers != NULL) {
+    FrameWorkerData *const frame_worker_data =
+        (FrameWorkerData *)ctx->frame_workers[0].data1;
+    pbi = frame_worker_data->pbi;
+    if (ctx->film_grain_mt) {
+      workers = pbi->tile_workers;
+      num_workers = pbi->num_workers;
+    }
+  }
+  struct aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  if (av1_add_film_grain_mt(grain_params, img, grain_img, &ctx->grain_cache,
+                            workers, num_workers)) {
+    if (fb != NULL) {
+      lock_buffer_pool(pool);
+      pool->release_fb_cb(pool->cb_priv, fb);
+      unlock_buffer_pool(pool);
+    }
     return NULL;
   }
+  if (pbi != NULL) {
+    add_stage_time(pbi, 0, AOM_DEC_STAGE_FILM_GRAIN, &timer);
+    pbi->frame_stats.total_time += aom_usec_timer_elapsed(&timer);
+  }
 
-  ctx->num_grain_image_frame_buffers++;
+  if (fb != NULL) {
+    ctx->num_grain_image_frame_buffers++;
+  } else {
+    // Nothing else reads the parameters of this frame buffer. Clearing them
+    // keeps the grain from being added twice if the frame is returned again.
+    output_frame_buf->film_grain_params.apply_grain = 0;
+  }
   return grain_img;
 }
 
@@ -768,6 +1173,26 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
   // simply a pointer to an integer index
   uintptr_t *index = (uintptr_t *)iter;
 
+  if (ctx->frame_parallel_decode) {
+    if (*index >= ctx->num_outputs) return NULL;
+    const FrameOutput *const output = &ctx->outputs[*index];
+    RefCntBuffer *const output_frame_buf = output->buf;
+    ctx->last_show_frame = output_frame_buf;
+    yuvconfig2image(&ctx->img, &output_frame_buf->buf, output->user_priv);
+    ctx->img.fb_priv = output_frame_buf->raw_frame_buffer.priv;
+    img = &ctx->img;
+    img->temporal_id = output->temporal_id;
+    img->spatial_id = output->spatial_id;
+    // Frames in flight may read the grain parameters of this frame, so work
+    // on a copy.
+    aom_film_grain_t grain_params = output_frame_buf->film_grain_params;
+    ctx->last_grain_params = grain_params;
+    if (ctx->skip_film_grain) grain_params.apply_grain = 0;
+    *index += 1;  // Advance the iterator to point to the next image
+    return add_grain_if_needed(ctx, img, &ctx->image_with_grain, &grain_params,
+                               output_frame_buf);
+  }
+
   if (ctx->frame_workers != NULL) {
     do {
       // NOTE(david.barker): This code does not support multiple worker threads
@@ -795,6 +1220,7 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
           RefCntBuffer *const output_frame_buf = pbi->output_frames[*index];
           ctx->last_show_frame = output_frame_buf;
           if (ctx->need_resync) return NULL;
+          ctx->last_grain_params = *grain_params;
           yuvconfig2image(&ctx->img, sd, frame_worker_data->user_priv);
 
           if (!pbi->ext_tile_debug && cm->large_scale_tile) {
@@ -849,8 +1275,9 @@ static aom_image_t *decoder_get_frame(aom_codec_alg_priv_t *ctx,
           img->temporal_id = cm->temporal_layer_id;
           img->spatial_id = cm->spatial_layer_id;
           if (cm->skip_film_grain) grain_params->apply_grain = 0;
-          aom_image_t *res = add_grain_if_needed(
-              ctx, img, &ctx->image_with_grain, grain_params);
+          aom_image_t *res =
+              add_grain_if_needed(ctx, img, &ctx->image_with_grain,
+                                  grain_params, output_frame_buf);
           if (!res) {
             aom_internal_error(&pbi->common.error, AOM_CODEC_CORRUPT_FRAME,
                                "Grain systhesis failed\n");
@@ -889,6 +1316,7 @@ static aom_codec_err_t decoder_set_fb_fn(
 static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *const data = va_arg(args, av1_ref_frame_t *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
 
   if (data) {
     av1_ref_frame_t *const frame = data;
@@ -906,6 +1334,7 @@ static aom_codec_err_t ctrl_set_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_copy_reference(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   const av1_ref_frame_t *const frame = va_arg(args, av1_ref_frame_t *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (frame) {
     YV12_BUFFER_CONFIG sd;
     AVxWorker *const worker = ctx->frame_workers;
@@ -920,6 +1349,7 @@ static aom_codec_err_t ctrl_copy_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   av1_ref_frame_t *data = va_arg(args, av1_ref_frame_t *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (data) {
     YV12_BUFFER_CONFIG *fb;
     AVxWorker *const worker = ctx->frame_workers;
@@ -936,6 +1366,7 @@ static aom_codec_err_t ctrl_get_reference(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_new_frame_image(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   aom_image_t *new_img = va_arg(args, aom_image_t *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (new_img) {
     YV12_BUFFER_CONFIG new_frame;
     AVxWorker *const worker = ctx->frame_workers;
@@ -955,6 +1386,7 @@ static aom_codec_err_t ctrl_get_new_frame_image(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_copy_new_frame_image(aom_codec_alg_priv_t *ctx,
                                                  va_list args) {
   aom_image_t *img = va_arg(args, aom_image_t *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (img) {
     YV12_BUFFER_CONFIG new_frame;
     AVxWorker *const worker = ctx->frame_workers;
@@ -990,6 +1422,7 @@ static aom_codec_err_t ctrl_set_dbg_options(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_last_ref_updates(aom_codec_alg_priv_t *ctx,
                                                  va_list args) {
   int *const update_info = va_arg(args, int *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
 
   if (update_info) {
     if (ctx->frame_workers) {
@@ -1010,6 +1443,7 @@ static aom_codec_err_t ctrl_get_last_ref_updates(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_last_quantizer(aom_codec_alg_priv_t *ctx,
                                                va_list args) {
   int *const arg = va_arg(args, int *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (arg == NULL) return AOM_CODEC_INVALID_PARAM;
   *arg =
       ((FrameWorkerData *)ctx->frame_workers[0].data1)->pbi->common.base_qindex;
@@ -1021,7 +1455,11 @@ static aom_codec_err_t ctrl_get_frame_corrupted(aom_codec_alg_priv_t *ctx,
   int *corrupted = va_arg(args, int *);
 
   if (corrupted) {
-    if (ctx->frame_workers) {
+    if (ctx->frame_parallel_decode) {
+      if (ctx->last_show_frame != NULL)
+        *corrupted = ctx->last_show_frame->buf.corrupted;
+      return AOM_CODEC_OK;
+    } else if (ctx->frame_workers) {
       AVxWorker *const worker = ctx->frame_workers;
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
@@ -1039,12 +1477,96 @@ static aom_codec_err_t ctrl_get_frame_corrupted(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_INVALID_PARAM;
 }
 
+static aom_codec_err_t ctrl_get_mem_usage(aom_codec_alg_priv_t *ctx,
+                                          va_list args) {
+  size_t *const mem_usage = va_arg(args, size_t *);
+
+  if (mem_usage == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->base.mem_usage == NULL) return AOM_CODEC_INCAPABLE;
+  mem_usage[0] = aom_mem_usage_get(ctx->base.mem_usage, &mem_usage[1]);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_get_frame_stats(aom_codec_alg_priv_t *ctx,
+                                            va_list args) {
+  aom_dec_frame_stats_t *const stats = va_arg(args, aom_dec_frame_stats_t *);
+
+  if (stats == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
+  if (ctx->frame_workers == NULL) return AOM_CODEC_ERROR;
+
+  const FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)ctx->frame_workers[0].data1;
+  const AV1Decoder *const pbi = frame_worker_data->pbi;
+  *stats = pbi->frame_stats;
+  stats->num_threads =
+      AOMMIN(AOMMAX(pbi->max_threads, 1), AOM_DEC_STATS_MAX_THREADS);
+  for (int i = 0; i < AOM_DEC_STAGES; ++i) {
+    stats->stage_time[i] = 0;
+    for (int thread = 0; thread < stats->num_threads; ++thread)
+      stats->stage_time[i] += stats->thread_time[thread][i];
+  }
+  return AOM_CODEC_OK;
+}
+
+static void copy_film_grain_params(aom_film_grain_params_t *dst,
+                                   const aom_film_grain_t *src) {
+  memset(dst, 0, sizeof(*dst));
+  dst->apply_grain = src->apply_grain;
+  if (!src->apply_grain) return;
+  dst->random_seed = src->random_seed;
+  dst->num_y_points = src->num_y_points;
+  memcpy(dst->scaling_points_y, src->scaling_points_y,
+         sizeof(dst->scaling_points_y));
+  dst->num_cb_points = src->num_cb_points;
+  memcpy(dst->scaling_points_cb, src->scaling_points_cb,
+         sizeof(dst->scaling_points_cb));
+  dst->num_cr_points = src->num_cr_points;
+  memcpy(dst->scaling_points_cr, src->scaling_points_cr,
+         sizeof(dst->scaling_points_cr));
+  dst->chroma_scaling_from_luma = src->chroma_scaling_from_luma;
+  dst->scaling_shift = src->scaling_shift;
+  dst->ar_coeff_lag = src->ar_coeff_lag;
+  memcpy(dst->ar_coeffs_y, src->ar_coeffs_y, sizeof(dst->ar_coeffs_y));
+  memcpy(dst->ar_coeffs_cb, src->ar_coeffs_cb, sizeof(dst->ar_coeffs_cb));
+  memcpy(dst->ar_coeffs_cr, src->ar_coeffs_cr, sizeof(dst->ar_coeffs_cr));
+  dst->ar_coeff_shift = src->ar_coeff_shift;
+  dst->grain_scale_shift = src->grain_scale_shift;
+  dst->cb_mult = src->cb_mult;
+  dst->cb_luma_mult = src->cb_luma_mult;
+  dst->cb_offset = src->cb_offset;
+  dst->cr_mult = src->cr_mult;
+  dst->cr_luma_mult = src->cr_luma_mult;
+  dst->cr_offset = src->cr_offset;
+  dst->overlap_flag = src->overlap_flag;
+  dst->clip_to_restricted_range = src->clip_to_restricted_range;
+  dst->bit_depth = src->bit_depth;
+}
+
+static aom_codec_err_t ctrl_get_film_grain_params(aom_codec_alg_priv_t *ctx,
+                                                  va_list args) {
+  aom_film_grain_params_t *const grain_params =
+      va_arg(args, aom_film_grain_params_t *);
+
+  if (grain_params == NULL) return AOM_CODEC_INVALID_PARAM;
+  if (ctx->last_show_frame == NULL) return AOM_CODEC_ERROR;
+  copy_film_grain_params(grain_params, &ctx->last_grain_params);
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_err_t ctrl_get_frame_size(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   int *const frame_size = va_arg(args, int *);
 
   if (frame_size) {
-    if (ctx->frame_workers) {
+    if (ctx->frame_parallel_decode) {
+      // Frame workers are busy with later frames, so report the size of the
+      // last output frame.
+      if (ctx->last_show_frame == NULL) return AOM_CODEC_ERROR;
+      frame_size[0] = ctx->last_show_frame->width;
+      frame_size[1] = ctx->last_show_frame->height;
+      return AOM_CODEC_OK;
+    } else if (ctx->frame_workers) {
       AVxWorker *const worker = ctx->frame_workers;
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
@@ -1063,6 +1585,7 @@ static aom_codec_err_t ctrl_get_frame_size(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_frame_header_info(aom_codec_alg_priv_t *ctx,
                                                   va_list args) {
   aom_tile_data *const frame_header_info = va_arg(args, aom_tile_data *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
 
   if (frame_header_info) {
     if (ctx->frame_workers) {
@@ -1084,6 +1607,7 @@ static aom_codec_err_t ctrl_get_frame_header_info(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_tile_data(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   aom_tile_data *const tile_data = va_arg(args, aom_tile_data *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
 
   if (tile_data) {
     if (ctx->frame_workers) {
@@ -1125,7 +1649,12 @@ static aom_codec_err_t ctrl_get_render_size(aom_codec_alg_priv_t *ctx,
   int *const render_size = va_arg(args, int *);
 
   if (render_size) {
-    if (ctx->frame_workers) {
+    if (ctx->frame_parallel_decode) {
+      if (ctx->last_show_frame == NULL) return AOM_CODEC_ERROR;
+      render_size[0] = ctx->last_show_frame->buf.render_width;
+      render_size[1] = ctx->last_show_frame->buf.render_height;
+      return AOM_CODEC_OK;
+    } else if (ctx->frame_workers) {
       AVxWorker *const worker = ctx->frame_workers;
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
@@ -1147,7 +1676,11 @@ static aom_codec_err_t ctrl_get_bit_depth(aom_codec_alg_priv_t *ctx,
   AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
 
   if (bit_depth) {
-    if (worker) {
+    if (ctx->frame_parallel_decode) {
+      if (ctx->last_show_frame == NULL) return AOM_CODEC_ERROR;
+      *bit_depth = ctx->last_show_frame->buf.bit_depth;
+      return AOM_CODEC_OK;
+    } else if (worker) {
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
       const AV1_COMMON *const cm = &frame_worker_data->pbi->common;
@@ -1182,7 +1715,13 @@ static aom_codec_err_t ctrl_get_img_format(aom_codec_alg_priv_t *ctx,
   AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
 
   if (img_fmt) {
-    if (worker) {
+    if (ctx->frame_parallel_decode) {
+      if (ctx->last_show_frame == NULL) return AOM_CODEC_ERROR;
+      const YV12_BUFFER_CONFIG *const buf = &ctx->last_show_frame->buf;
+      *img_fmt = get_img_format(buf->subsampling_x, buf->subsampling_y,
+                                (buf->flags & YV12_FLAG_HIGHBITDEPTH) != 0);
+      return AOM_CODEC_OK;
+    } else if (worker) {
       FrameWorkerData *const frame_worker_data =
           (FrameWorkerData *)worker->data1;
       const AV1_COMMON *const cm = &frame_worker_data->pbi->common;
@@ -1202,6 +1741,7 @@ static aom_codec_err_t ctrl_get_img_format(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_tile_size(aom_codec_alg_priv_t *ctx,
                                           va_list args) {
   unsigned int *const tile_size = va_arg(args, unsigned int *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
 
   if (tile_size) {
@@ -1223,6 +1763,7 @@ static aom_codec_err_t ctrl_get_tile_size(aom_codec_alg_priv_t *ctx,
 static aom_codec_err_t ctrl_get_tile_count(aom_codec_alg_priv_t *ctx,
                                            va_list args) {
   unsigned int *const tile_count = va_arg(args, unsigned int *);
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
 
   if (tile_count) {
     AVxWorker *const worker = &ctx->frame_workers[ctx->next_output_worker_id];
@@ -1258,7 +1799,9 @@ static aom_codec_err_t ctrl_set_byte_alignment(aom_codec_alg_priv_t *ctx,
     return AOM_CODEC_INVALID_PARAM;
 
   ctx->byte_alignment = byte_alignment;
-  if (ctx->frame_workers) {
+  // In frame parallel decode, this takes effect from the next frame
+  // submitted to a frame worker.
+  if (ctx->frame_workers && !ctx->frame_parallel_decode) {
     AVxWorker *const worker = ctx->frame_workers;
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
     frame_worker_data->pbi->common.byte_alignment = byte_alignment;
@@ -1270,7 +1813,7 @@ static aom_codec_err_t ctrl_set_skip_loop_filter(aom_codec_alg_priv_t *ctx,
                                                  va_list args) {
   ctx->skip_loop_filter = va_arg(args, int);
 
-  if (ctx->frame_workers) {
+  if (ctx->frame_workers && !ctx->frame_parallel_decode) {
     AVxWorker *const worker = ctx->frame_workers;
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
     frame_worker_data->pbi->common.skip_loop_filter = ctx->skip_loop_filter;
@@ -1283,7 +1826,7 @@ static aom_codec_err_t ctrl_set_skip_film_grain(aom_codec_alg_priv_t *ctx,
                                                 va_list args) {
   ctx->skip_film_grain = va_arg(args, int);
 
-  if (ctx->frame_workers) {
+  if (ctx->frame_workers && !ctx->frame_parallel_decode) {
     AVxWorker *const worker = ctx->frame_workers;
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
     frame_worker_data->pbi->common.skip_film_grain = ctx->skip_film_grain;
@@ -1299,6 +1842,7 @@ static aom_codec_err_t ctrl_get_accounting(aom_codec_alg_priv_t *ctx,
   (void)args;
   return AOM_CODEC_INCAPABLE;
 #else
+  if (ctx->frame_parallel_decode) return AOM_CODEC_INCAPABLE;
   if (ctx->frame_workers) {
     AVxWorker *const worker = ctx->frame_workers;
     FrameWorkerData *const frame_worker_data = (FrameWorkerData *)worker->data1;
@@ -1372,6 +1916,28 @@ static aom_codec_err_t ctrl_set_row_mt(aom_codec_alg_priv_t *ctx,
   return AOM_CODEC_OK;
 }
 
+static aom_codec_err_t ctrl_set_film_grain_mt(aom_codec_alg_priv_t *ctx,
+                                              va_list args) {
+  ctx->film_grain_mt = va_arg(args, unsigned int);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_film_grain_in_place(aom_codec_alg_priv_t *ctx,
+                                                    va_list args) {
+  ctx->film_grain_in_place = va_arg(args, unsigned int);
+  return AOM_CODEC_OK;
+}
+
+static aom_codec_err_t ctrl_set_frame_parallel_depth(aom_codec_alg_priv_t *ctx,
+                                                     va_list args) {
+  const unsigned int depth = va_arg(args, unsigned int);
+  if (depth > MAX_FRAME_PARALLEL_DEPTH) return AOM_CODEC_INVALID_PARAM;
+  // The frame workers are set up with the first frame.
+  if (ctx->frame_workers != NULL) return AOM_CODEC_ERROR;
+  ctx->frame_parallel_depth = depth;
+  return AOM_CODEC_OK;
+}
+
 static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_COPY_REFERENCE, ctrl_copy_reference },
 
@@ -1396,6 +1962,9 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1D_SET_ROW_MT, ctrl_set_row_mt },
   { AV1D_SET_EXT_REF_PTR, ctrl_set_ext_ref_ptr },
   { AV1D_SET_SKIP_FILM_GRAIN, ctrl_set_skip_film_grain },
+  { AV1D_SET_FRAME_PARALLEL_DEPTH, ctrl_set_frame_parallel_depth },
+  { AV1D_SET_FILM_GRAIN_MT, ctrl_set_film_grain_mt },
+  { AV1D_SET_FILM_GRAIN_IN_PLACE, ctrl_set_film_grain_in_place },
 
   // Getters
   { AOMD_GET_FRAME_CORRUPTED, ctrl_get_frame_corrupted },
@@ -1413,6 +1982,9 @@ static aom_codec_ctrl_fn_map_t decoder_ctrl_maps[] = {
   { AV1_GET_REFERENCE, ctrl_get_reference },
   { AV1D_GET_FRAME_HEADER_INFO, ctrl_get_frame_header_info },
   { AV1D_GET_TILE_DATA, ctrl_get_tile_data },
+  { AV1D_GET_MEM_USAGE, ctrl_get_mem_usage },
+  { AV1D_GET_FRAME_STATS, ctrl_get_frame_stats },
+  { AV1D_GET_FILM_GRAIN_PARAMS, ctrl_get_film_grain_params },
 
   { -1, NULL },
 };
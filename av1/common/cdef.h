@@ -41,9 +41,23 @@ int av1_cdef_compute_sb_list(const AV1_COMMON *const cm, int mi_row, int mi_col,
                              cdef_list *dlist, BLOCK_SIZE bsize);
 void av1_cdef_frame(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, MACROBLOCKD *xd);
 
+// Filter block rows are filtered in place, so the unfiltered lines on both
+// sides of each boundary between 64x64 filter block rows are saved first.
+// linebuf[plane] holds 2 * CDEF_VBORDER lines of av1_cdef_linebuf_stride()
+// pixels per filter block row. The boundary below row fbr must be saved before
+// rows fbr and fbr + 1 are filtered; the rows can then be filtered in any
+// order. xd must have its planes set up at the top left of the frame.
+int av1_cdef_linebuf_stride(const AV1_COMMON *cm);
+void av1_cdef_save_fb_row_boundary(const AV1_COMMON *cm, const MACROBLOCKD *xd,
+                                   uint16_t *const *linebuf, int fbr);
+void av1_cdef_fb_row(const AV1_COMMON *cm, const MACROBLOCKD *xd,
+                     uint16_t *const *linebuf, int fbr);
+
+// Picks the CDEF strengths of the frame. The filter block rows are searched
+// on num_workers of the given workers when num_workers > 1.
 void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
                      AV1_COMMON *cm, MACROBLOCKD *xd, int pick_method,
-                     int rdmult);
+                     int rdmult, AVxWorker *workers, int num_workers);
 
 #ifdef __cplusplus
 }  // extern "C"
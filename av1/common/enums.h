@@ -597,6 +597,10 @@ enum {
 
 #define REF_FRAMES_LOG2 3
 
+// Maximum number of frames the decoder may have in flight at once in frame
+// parallel decode mode.
+#define MAX_FRAME_PARALLEL_DEPTH 4
+
 // REF_FRAMES for the cm->ref_frame_map array, 1 scratch frame for the new
 // frame in cm->cur_frame, INTER_REFS_PER_FRAME for scaled references on the
 // encoder in the cpi->scaled_ref_buf array.
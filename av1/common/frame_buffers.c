@@ -11,6 +11,7 @@
 
 #include <assert.h>
 
+#include "av1/common/enums.h"
 #include "av1/common/frame_buffers.h"
 #include "aom_mem/aom_mem.h"
 
@@ -18,8 +19,11 @@ int av1_alloc_internal_frame_buffers(InternalFrameBufferList *list) {
   assert(list != NULL);
   av1_free_internal_frame_buffers(list);
 
-  list->num_internal_frame_buffers =
-      AOM_MAXIMUM_REF_BUFFERS + AOM_MAXIMUM_WORK_BUFFERS;
+  // The extra buffers cover the frames in flight in frame parallel decode.
+  // Their data is only allocated on first use.
+  list->num_internal_frame_buffers = AOM_MAXIMUM_REF_BUFFERS +
+                                     AOM_MAXIMUM_WORK_BUFFERS +
+                                     3 * MAX_FRAME_PARALLEL_DEPTH;
   list->int_fb = (InternalFrameBuffer *)aom_calloc(
       list->num_internal_frame_buffers, sizeof(*list->int_fb));
   if (list->int_fb == NULL) {
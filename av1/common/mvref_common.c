@@ -1016,6 +1016,9 @@ void av1_setup_motion_field(AV1_COMMON *cm) {
       cm->ref_frame_side[ref_frame] = -1;
   }
 
+  // The projected motion field is only used with allow_ref_frame_mvs.
+  if (!cm->allow_ref_frame_mvs) return;
+
   int ref_stamp = MFMV_STACK_SIZE - 1;
 
   if (ref_buf[LAST_FRAME - LAST_FRAME] != NULL) {
@@ -158,6 +158,15 @@ typedef struct RefCntBuffer {
   int8_t mode_deltas[MAX_MODE_LF_DELTAS];
 
   FRAME_CONTEXT frame_context;
+
+  // Frame parallel decode only: number of luma rows of this frame that are
+  // fully reconstructed, or INT_MAX once decoding of the frame has finished.
+  // Protected by BufferPool.progress_mutex.
+  int decoded_rows;
+  // Frame parallel decode only: whether the motion vectors and segmentation
+  // map of this frame are final, which they are once its tiles are decoded.
+  // Protected by BufferPool.progress_mutex.
+  int tiles_decoded;
 } RefCntBuffer;
 
 typedef struct BufferPool {
@@ -170,13 +179,24 @@ typedef struct BufferPool {
   pthread_mutex_t pool_mutex;
 #endif
 
+  // Set when several FrameWorkers decode frames concurrently. A frame worker
+  // then waits on progress_cond until the reference rows it predicts from
+  // have been decoded.
+  int frame_parallel_decode;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t progress_mutex;
+  pthread_cond_t progress_cond;
+#endif
+
   // Private data associated with the frame buffer callbacks.
   void *cb_priv;
 
   aom_get_frame_buffer_cb_fn_t get_fb_cb;
   aom_release_frame_buffer_cb_fn_t release_fb_cb;
 
-  RefCntBuffer frame_bufs[FRAME_BUFFERS];
+  // FRAME_BUFFERS frame buffers, and more in frame parallel decode.
+  RefCntBuffer *frame_bufs;
+  int num_frame_bufs;
 
   // Frame buffers allocated internally by the codec.
   InternalFrameBufferList int_frame_buffers;
@@ -584,10 +604,10 @@ static INLINE int get_free_fb(AV1_COMMON *cm) {
   int i;
 
   lock_buffer_pool(cm->buffer_pool);
-  for (i = 0; i < FRAME_BUFFERS; ++i)
+  for (i = 0; i < cm->buffer_pool->num_frame_bufs; ++i)
     if (frame_bufs[i].ref_count == 0) break;
 
-  if (i != FRAME_BUFFERS) {
+  if (i != cm->buffer_pool->num_frame_bufs) {
     if (frame_bufs[i].buf.use_external_reference_buffers) {
       // If this frame buffer's y_buffer, u_buffer, and v_buffer point to the
       // external reference buffers. Restore the buffer pointers to point to the
@@ -625,6 +645,7 @@ static INLINE RefCntBuffer *assign_cur_frame_new_fb(AV1_COMMON *const cm) {
 
   cm->cur_frame = &cm->buffer_pool->frame_bufs[new_fb_idx];
   cm->cur_frame->buf.buf_8bit_valid = 0;
+  cm->cur_frame->buf.corners_valid = 0;
   av1_zero(cm->cur_frame->interp_filter_selected);
   return cm->cur_frame;
 }
@@ -25,6 +25,7 @@
 #include "av1/common/resize.h"
 
 #include "config/aom_scale_rtcd.h"
+#include "config/av1_rtcd.h"
 
 // Filters for interpolation (0.5-band) - note this also filters integer pels.
 static const InterpKernel filteredinterp_filters500[(1 << RS_SUBPEL_BITS)] = {
@@ -214,8 +215,12 @@ const int16_t av1_resize_filter_normative[(
 #define filteredinterp_filters1000 av1_resize_filter_normative
 
 // Filters for factor of 2 downsampling.
-static const int16_t av1_down2_symeven_half_filter[] = { 56, 12, -3, -1 };
-static const int16_t av1_down2_symodd_half_filter[] = { 64, 35, 0, -3 };
+const int16_t av1_down2_symeven_half_filter[DOWN2_SYMEVEN_HALF_TAPS] = {
+  56, 12, -3, -1
+};
+const int16_t av1_down2_symodd_half_filter[DOWN2_SYMODD_HALF_TAPS] = {
+  64, 35, 0, -3
+};
 
 static const InterpKernel *choose_interp_filter(int in_length, int out_length) {
   int out_length16 = out_length * 16;
@@ -431,8 +436,8 @@ static int32_t get_upscale_convolve_x0(int in_length, int out_length,
   return (int32_t)((uint32_t)x0 & RS_SCALE_SUBPEL_MASK);
 }
 
-static void down2_symeven(const uint8_t *const input, int length,
-                          uint8_t *output) {
+void av1_down2_symeven_c(const uint8_t *const input, int length,
+                         uint8_t *output) {
   // Actual filter len = 2 * filter_len_half.
   const int16_t *filter = av1_down2_symeven_half_filter;
   const int filter_len_half = sizeof(av1_down2_symeven_half_filter) / 2;
@@ -486,8 +491,8 @@ static void down2_symeven(const uint8_t *const input, int length,
   }
 }
 
-static void down2_symodd(const uint8_t *const input, int length,
-                         uint8_t *output) {
+void av1_down2_symodd_c(const uint8_t *const input, int length,
+                        uint8_t *output) {
   // Actual filter len = 2 * filter_len_half - 1.
   const int16_t *filter = av1_down2_symodd_half_filter;
   const int filter_len_half = sizeof(av1_down2_symodd_half_filter) / 2;
@@ -584,9 +589,9 @@ static void resize_multistep(const uint8_t *const input, int length,
       else
         out = (s & 1 ? otmp2 : otmp);
       if (filteredlength & 1)
-        down2_symodd(in, filteredlength, out);
+        av1_down2_symodd(in, filteredlength, out);
       else
-        down2_symeven(in, filteredlength, out);
+        av1_down2_symeven(in, filteredlength, out);
       filteredlength = proj_filteredlength;
     }
     if (filteredlength != olength) {
@@ -603,21 +608,22 @@ static void upscale_multistep_double_prec(const double *const input, int length,
   interpolate_double_prec(input, length, output, olength);
 }
 
-static void fill_col_to_arr(uint8_t *img, int stride, int len, uint8_t *arr) {
-  int i;
-  uint8_t *iptr = img;
-  uint8_t *aptr = arr;
-  for (i = 0; i < len; ++i, iptr += stride) {
-    *aptr++ = *iptr;
-  }
-}
-
-static void fill_arr_to_col(uint8_t *img, int stride, int len, uint8_t *arr) {
-  int i;
-  uint8_t *iptr = img;
-  uint8_t *aptr = arr;
-  for (i = 0; i < len; ++i, iptr += stride) {
-    *iptr = *aptr++;
+// Size of the square tiles used to transpose a plane, small enough that the
+// source rows of a tile stay in the cache.
+#define TRANSPOSE_TILE_SIZE 32
+
+// Writes the columns of the width x height plane in src as the rows of dst.
+static void transpose_plane(const uint8_t *src, int src_stride, int width,
+                            int height, uint8_t *dst, int dst_stride) {
+  for (int i = 0; i < height; i += TRANSPOSE_TILE_SIZE) {
+    const int i_end = AOMMIN(i + TRANSPOSE_TILE_SIZE, height);
+    for (int j = 0; j < width; j += TRANSPOSE_TILE_SIZE) {
+      const int j_end = AOMMIN(j + TRANSPOSE_TILE_SIZE, width);
+      for (int c = j; c < j_end; ++c) {
+        for (int r = i; r < i_end; ++r)
+          dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
   }
 }
 
@@ -645,13 +651,15 @@ void av1_resize_plane(const uint8_t *const input, int height, int width,
                       int in_stride, uint8_t *output, int height2, int width2,
                       int out_stride) {
   int i;
-  uint8_t *intbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * width2 * height);
+  // The vertical pass runs on the transposed plane, so that it filters
+  // contiguous rows. intbuf holds the horizontally resized rows and then the
+  // vertically resized columns, colbuf holds the columns before that.
+  uint8_t *intbuf =
+      (uint8_t *)aom_malloc(sizeof(uint8_t) * width2 * AOMMAX(height, height2));
+  uint8_t *colbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * width2 * height);
   uint8_t *tmpbuf =
       (uint8_t *)aom_malloc(sizeof(uint8_t) * AOMMAX(width, height));
-  uint8_t *arrbuf = (uint8_t *)aom_malloc(sizeof(uint8_t) * height);
-  uint8_t *arrbuf2 = (uint8_t *)aom_malloc(sizeof(uint8_t) * height2);
-  if (intbuf == NULL || tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL)
-    goto Error;
+  if (intbuf == NULL || colbuf == NULL || tmpbuf == NULL) goto Error;
   assert(width > 0);
   assert(height > 0);
   assert(width2 > 0);
@@ -659,17 +667,16 @@ void av1_resize_plane(const uint8_t *const input, int height, int width,
   for (i = 0; i < height; ++i)
     resize_multistep(input + in_stride * i, width, intbuf + width2 * i, width2,
                      tmpbuf);
-  for (i = 0; i < width2; ++i) {
-    fill_col_to_arr(intbuf + i, width2, height, arrbuf);
-    resize_multistep(arrbuf, height, arrbuf2, height2, tmpbuf);
-    fill_arr_to_col(output + i, out_stride, height2, arrbuf2);
-  }
+  transpose_plane(intbuf, width2, width2, height, colbuf, height);
+  for (i = 0; i < width2; ++i)
+    resize_multistep(colbuf + height * i, height, intbuf + height2 * i, height2,
+                     tmpbuf);
+  transpose_plane(intbuf, height2, height2, width2, output, out_stride);
 
 Error:
   aom_free(intbuf);
+  aom_free(colbuf);
   aom_free(tmpbuf);
-  aom_free(arrbuf);
-  aom_free(arrbuf2);
 }
 
 void av1_upscale_plane_double_prec(const double *const input, int height,
@@ -850,8 +857,8 @@ static void highbd_interpolate(const uint16_t *const input, int in_length,
                           &interp_filters[0][0], SUBPEL_TAPS);
 }
 
-static void highbd_down2_symeven(const uint16_t *const input, int length,
-                                 uint16_t *output, int bd) {
+void av1_highbd_down2_symeven_c(const uint16_t *const input, int length,
+                                uint16_t *output, int bd) {
   // Actual filter len = 2 * filter_len_half.
   static const int16_t *filter = av1_down2_symeven_half_filter;
   const int filter_len_half = sizeof(av1_down2_symeven_half_filter) / 2;
@@ -905,8 +912,8 @@ static void highbd_down2_symeven(const uint16_t *const input, int length,
   }
 }
 
-static void highbd_down2_symodd(const uint16_t *const input, int length,
-                                uint16_t *output, int bd) {
+void av1_highbd_down2_symodd_c(const uint16_t *const input, int length,
+                               uint16_t *output, int bd) {
   // Actual filter len = 2 * filter_len_half - 1.
   static const int16_t *filter = av1_down2_symodd_half_filter;
   const int filter_len_half = sizeof(av1_down2_symodd_half_filter) / 2;
@@ -981,9 +988,9 @@ static void highbd_resize_multistep(const uint16_t *const input, int length,
       else
         out = (s & 1 ? otmp2 : otmp);
       if (filteredlength & 1)
-        highbd_down2_symodd(in, filteredlength, out, bd);
+        av1_highbd_down2_symodd(in, filteredlength, out, bd);
       else
-        highbd_down2_symeven(in, filteredlength, out, bd);
+        av1_highbd_down2_symeven(in, filteredlength, out, bd);
       filteredlength = proj_filteredlength;
     }
     if (filteredlength != olength) {
@@ -994,23 +1001,18 @@ static void highbd_resize_multistep(const uint16_t *const input, int length,
   }
 }
 
-static void highbd_fill_col_to_arr(uint16_t *img, int stride, int len,
-                                   uint16_t *arr) {
-  int i;
-  uint16_t *iptr = img;
-  uint16_t *aptr = arr;
-  for (i = 0; i < len; ++i, iptr += stride) {
-    *aptr++ = *iptr;
-  }
-}
-
-static void highbd_fill_arr_to_col(uint16_t *img, int stride, int len,
-                                   uint16_t *arr) {
-  int i;
-  uint16_t *iptr = img;
-  uint16_t *aptr = arr;
-  for (i = 0; i < len; ++i, iptr += stride) {
-    *iptr = *aptr++;
+static void highbd_transpose_plane(const uint16_t *src, int src_stride,
+                                   int width, int height, uint16_t *dst,
+                                   int dst_stride) {
+  for (int i = 0; i < height; i += TRANSPOSE_TILE_SIZE) {
+    const int i_end = AOMMIN(i + TRANSPOSE_TILE_SIZE, height);
+    for (int j = 0; j < width; j += TRANSPOSE_TILE_SIZE) {
+      const int j_end = AOMMIN(j + TRANSPOSE_TILE_SIZE, width);
+      for (int c = j; c < j_end; ++c) {
+        for (int r = i; r < i_end; ++r)
+          dst[c * dst_stride + r] = src[r * src_stride + c];
+      }
+    }
   }
 }
 
@@ -1018,29 +1020,29 @@ void av1_highbd_resize_plane(const uint8_t *const input, int height, int width,
                              int in_stride, uint8_t *output, int height2,
                              int width2, int out_stride, int bd) {
   int i;
-  uint16_t *intbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * width2 * height);
+  // See av1_resize_plane() for the use of the buffers.
+  uint16_t *intbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * width2 *
+                                            AOMMAX(height, height2));
+  uint16_t *colbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * width2 * height);
   uint16_t *tmpbuf =
       (uint16_t *)aom_malloc(sizeof(uint16_t) * AOMMAX(width, height));
-  uint16_t *arrbuf = (uint16_t *)aom_malloc(sizeof(uint16_t) * height);
-  uint16_t *arrbuf2 = (uint16_t *)aom_malloc(sizeof(uint16_t) * height2);
-  if (intbuf == NULL || tmpbuf == NULL || arrbuf == NULL || arrbuf2 == NULL)
-    goto Error;
+  if (intbuf == NULL || colbuf == NULL || tmpbuf == NULL) goto Error;
   for (i = 0; i < height; ++i) {
     highbd_resize_multistep(CONVERT_TO_SHORTPTR(input + in_stride * i), width,
                             intbuf + width2 * i, width2, tmpbuf, bd);
   }
+  highbd_transpose_plane(intbuf, width2, width2, height, colbuf, height);
   for (i = 0; i < width2; ++i) {
-    highbd_fill_col_to_arr(intbuf + i, width2, height, arrbuf);
-    highbd_resize_multistep(arrbuf, height, arrbuf2, height2, tmpbuf, bd);
-    highbd_fill_arr_to_col(CONVERT_TO_SHORTPTR(output + i), out_stride, height2,
-                           arrbuf2);
+    highbd_resize_multistep(colbuf + height * i, height, intbuf + height2 * i,
+                            height2, tmpbuf, bd);
   }
+  highbd_transpose_plane(intbuf, height2, height2, width2,
+                         CONVERT_TO_SHORTPTR(output), out_stride);
 
 Error:
   aom_free(intbuf);
+  aom_free(colbuf);
   aom_free(tmpbuf);
-  aom_free(arrbuf);
-  aom_free(arrbuf2);
 }
 
 static void highbd_upscale_normative_rect(const uint8_t *const input,
@@ -114,6 +114,13 @@ extern const int16_t av1_resize_filter_normative[1 << RS_SUBPEL_BITS]
 
 int32_t av1_get_upscale_convolve_step(int in_length, int out_length);
 
+// Half of the symmetric filters used to downscale by a factor of 2, for inputs
+// of even and odd length respectively.
+#define DOWN2_SYMEVEN_HALF_TAPS 4
+#define DOWN2_SYMODD_HALF_TAPS 4
+extern const int16_t av1_down2_symeven_half_filter[DOWN2_SYMEVEN_HALF_TAPS];
+extern const int16_t av1_down2_symodd_half_filter[DOWN2_SYMODD_HALF_TAPS];
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
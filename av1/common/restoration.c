@@ -1085,10 +1085,10 @@ static void filter_frame_on_unit(const RestorationTileLimits *limits,
       rsi->optimized_lr);
 }
 
-void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
-                                            YV12_BUFFER_CONFIG *frame,
-                                            AV1_COMMON *cm, int optimized_lr,
-                                            int num_planes) {
+static void loop_restoration_filter_init(AV1LrStruct *lr_ctxt,
+                                        YV12_BUFFER_CONFIG *frame,
+                                        AV1_COMMON *cm, int optimized_lr,
+                                        int num_planes, int extend_frame) {
   const SequenceHeader *const seq_params = &cm->seq_params;
   const int bit_depth = seq_params->bit_depth;
   const int highbd = seq_params->use_highbitdepth;
@@ -1119,9 +1119,11 @@ void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
     const int plane_height = frame->crop_heights[is_uv];
     FilterFrameCtxt *lr_plane_ctxt = &lr_ctxt->ctxt[plane];
 
-    av1_extend_frame(frame->buffers[plane], plane_width, plane_height,
-                     frame->strides[is_uv], RESTORATION_BORDER,
-                     RESTORATION_BORDER, highbd);
+    if (extend_frame) {
+      av1_extend_frame(frame->buffers[plane], plane_width, plane_height,
+                       frame->strides[is_uv], RESTORATION_BORDER,
+                       RESTORATION_BORDER, highbd);
+    }
 
     lr_plane_ctxt->rsi = rsi;
     lr_plane_ctxt->ss_x = is_uv && seq_params->subsampling_x;
@@ -1137,6 +1139,99 @@ void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
   }
 }
 
+void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
+                                            YV12_BUFFER_CONFIG *frame,
+                                            AV1_COMMON *cm, int optimized_lr,
+                                            int num_planes) {
+  loop_restoration_filter_init(lr_ctxt, frame, cm, optimized_lr, num_planes,
+                               1);
+}
+
+void av1_loop_restoration_filter_rows_init(AV1LrStruct *lr_ctxt,
+                                           YV12_BUFFER_CONFIG *frame,
+                                           AV1_COMMON *cm, int num_planes) {
+  loop_restoration_filter_init(lr_ctxt, frame, cm, 0, num_planes, 0);
+}
+
+// Extend the borders of rows [row_start, row_end) of a plane by
+// RESTORATION_BORDER pixels, including the rows above the top and below the
+// bottom of the plane if the range reaches them.
+static void extend_frame_rows(uint8_t *data, int width, int height,
+                              int stride, int row_start, int row_end,
+                              int highbd) {
+  av1_extend_frame(data + row_start * stride, width, row_end - row_start,
+                   stride, RESTORATION_BORDER, 0, highbd);
+
+  uint8_t *const data_p =
+      REAL_PTR(highbd, data) - (RESTORATION_BORDER << highbd);
+  const int line_bytes = (width + 2 * RESTORATION_BORDER) << highbd;
+  const int byte_stride = stride << highbd;
+  if (row_start == 0) {
+    for (int i = -RESTORATION_BORDER; i < 0; ++i)
+      memcpy(data_p + i * byte_stride, data_p, line_bytes);
+  }
+  if (row_end == height) {
+    for (int i = height; i < height + RESTORATION_BORDER; ++i)
+      memcpy(data_p + i * byte_stride, data_p + (height - 1) * byte_stride,
+             line_bytes);
+  }
+}
+
+void av1_loop_restoration_filter_rows(AV1LrStruct *lr_ctxt, int plane,
+                                      int row_start, int row_end,
+                                      int32_t *tmpbuf,
+                                      RestorationLineBuffers *rlbs) {
+  typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src_ybc,
+                           YV12_BUFFER_CONFIG *dst_ybc, int hstart, int hend,
+                           int vstart, int vend);
+  static const copy_fun copy_funs[3] = { aom_yv12_partial_coloc_copy_y,
+                                         aom_yv12_partial_coloc_copy_u,
+                                         aom_yv12_partial_coloc_copy_v };
+  FilterFrameCtxt *const ctxt = &lr_ctxt->ctxt[plane];
+  const RestorationInfo *const rsi = ctxt->rsi;
+  const AV1PixelRect *const tile_rect = &ctxt->tile_rect;
+  const int is_uv = plane > 0;
+  const int unit_size = rsi->restoration_unit_size;
+  const int tile_h = tile_rect->bottom - tile_rect->top;
+  const int ext_size = unit_size * 3 / 2;
+  const int voffset = RESTORATION_UNIT_OFFSET >> ctxt->ss_y;
+  const int tile_idx = LR_TILE_COL + LR_TILE_ROW * LR_TILE_COLS;
+  const int unit_idx0 = tile_idx * rsi->units_per_tile;
+  assert(rsi->frame_restoration_type != RESTORE_NONE);
+  assert(row_start < row_end && row_end <= tile_rect->bottom);
+
+  extend_frame_rows(ctxt->data8, lr_ctxt->frame->crop_widths[is_uv],
+                    tile_h, ctxt->data_stride, row_start, row_end,
+                    ctxt->highbd);
+
+  // Walk the restoration unit rows as foreach_rest_unit_in_tile() does, and
+  // filter the part of each one that lies inside [row_start, row_end).
+  int y0 = 0, i = 0;
+  while (y0 < tile_h) {
+    const int remaining_h = tile_h - y0;
+    const int h = (remaining_h < ext_size) ? remaining_h : unit_size;
+
+    RestorationTileLimits limits;
+    limits.v_start = AOMMAX(tile_rect->top, tile_rect->top + y0 - voffset);
+    limits.v_end = tile_rect->top + y0 + h;
+    if (limits.v_end < tile_rect->bottom) limits.v_end -= voffset;
+    limits.v_start = AOMMAX(limits.v_start, row_start);
+    limits.v_end = AOMMIN(limits.v_end, row_end);
+    if (limits.v_start < limits.v_end) {
+      av1_foreach_rest_unit_in_row(
+          &limits, tile_rect, lr_ctxt->on_rest_unit, i, unit_size, unit_idx0,
+          rsi->horz_units_per_tile, rsi->vert_units_per_tile, plane, ctxt,
+          tmpbuf, rlbs, av1_lr_sync_read_dummy, av1_lr_sync_write_dummy, NULL);
+    }
+
+    y0 += h;
+    ++i;
+  }
+
+  copy_funs[plane](lr_ctxt->dst, lr_ctxt->frame, tile_rect->left,
+                   tile_rect->right, row_start, row_end);
+}
+
 void av1_loop_restoration_copy_planes(AV1LrStruct *loop_rest_ctxt,
                                       AV1_COMMON *cm, int num_planes) {
   typedef void (*copy_fun)(const YV12_BUFFER_CONFIG *src_ybc,
@@ -1474,7 +1569,8 @@ static void save_cdef_boundary_lines(const YV12_BUFFER_CONFIG *frame,
 
 static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                          int use_highbd, int plane,
-                                         AV1_COMMON *cm, int after_cdef) {
+                                         AV1_COMMON *cm, int after_cdef,
+                                         int row_start, int row_end) {
   const int is_uv = plane > 0;
   const int ss_y = is_uv && cm->seq_params.subsampling_y;
   const int stripe_height = RESTORATION_PROC_UNIT_SIZE >> ss_y;
@@ -1506,13 +1602,20 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
     const int use_deblock_above = (frame_stripe > 0);
     const int use_deblock_below = (y1 < plane_height);
 
+    // Only save the lines which are read from rows [row_start, row_end).
+    const int save_above =
+        (after_cdef ? y0 : y0 - RESTORATION_CTX_VERT) >= row_start &&
+        (after_cdef ? y0 : y0 - RESTORATION_CTX_VERT) < row_end;
+    const int save_below = (after_cdef ? y1 - 1 : y1) >= row_start &&
+                           (after_cdef ? y1 - 1 : y1) < row_end;
+
     if (!after_cdef) {
       // Save deblocked context where needed.
-      if (use_deblock_above) {
+      if (use_deblock_above && save_above) {
         save_deblock_boundary_lines(frame, cm, plane, y0 - RESTORATION_CTX_VERT,
                                     frame_stripe, use_highbd, 1, boundaries);
       }
-      if (use_deblock_below) {
+      if (use_deblock_below && save_below) {
         save_deblock_boundary_lines(frame, cm, plane, y1, frame_stripe,
                                     use_highbd, 0, boundaries);
       }
@@ -1523,11 +1626,11 @@ static void save_tile_row_boundary_lines(const YV12_BUFFER_CONFIG *frame,
       //
       // In addition, we need to save copies of the outermost line within
       // the tile, rather than using data from outside the tile.
-      if (!use_deblock_above) {
+      if (!use_deblock_above && save_above) {
         save_cdef_boundary_lines(frame, cm, plane, y0, frame_stripe, use_highbd,
                                  1, boundaries);
       }
-      if (!use_deblock_below) {
+      if (!use_deblock_below && save_below) {
         save_cdef_boundary_lines(frame, cm, plane, y1 - 1, frame_stripe,
                                  use_highbd, 0, boundaries);
       }
@@ -1543,6 +1646,19 @@ void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
   const int num_planes = av1_num_planes(cm);
   const int use_highbd = cm->seq_params.use_highbitdepth;
   for (int p = 0; p < num_planes; ++p) {
-    save_tile_row_boundary_lines(frame, use_highbd, p, cm, after_cdef);
+    save_tile_row_boundary_lines(frame, use_highbd, p, cm, after_cdef, 0,
+                                 INT_MAX);
+  }
+}
+
+void av1_loop_restoration_save_boundary_lines_rows(
+    const YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm, int after_cdef,
+    int row_start, int row_end) {
+  const int num_planes = av1_num_planes(cm);
+  const int use_highbd = cm->seq_params.use_highbitdepth;
+  for (int p = 0; p < num_planes; ++p) {
+    const int ss_y = p > 0 && cm->seq_params.subsampling_y;
+    save_tile_row_boundary_lines(frame, use_highbd, p, cm, after_cdef,
+                                 row_start >> ss_y, row_end >> ss_y);
   }
 }
@@ -355,10 +355,32 @@ int av1_loop_restoration_corners_in_sb(const struct AV1Common *cm, int plane,
 void av1_loop_restoration_save_boundary_lines(const YV12_BUFFER_CONFIG *frame,
                                               struct AV1Common *cm,
                                               int after_cdef);
+// Like av1_loop_restoration_save_boundary_lines(), but only saves the lines
+// which are copied from luma rows [row_start, row_end) of the frame.
+void av1_loop_restoration_save_boundary_lines_rows(
+    const YV12_BUFFER_CONFIG *frame, struct AV1Common *cm, int after_cdef,
+    int row_start, int row_end);
 void av1_loop_restoration_filter_frame_init(AV1LrStruct *lr_ctxt,
                                             YV12_BUFFER_CONFIG *frame,
                                             struct AV1Common *cm,
                                             int optimized_lr, int num_planes);
+
+// Row based loop restoration, for callers which filter the frame a few
+// processing stripes at a time as the rows become ready. The init function
+// does not extend the frame borders; av1_loop_restoration_filter_rows() does
+// that for the rows it filters. Each call filters the rows
+// [row_start, row_end) of a plane, which must start and end on processing
+// stripe boundaries, into lr_ctxt->dst and copies them back into the frame.
+// The stripes of a plane must be filtered in order, one call at a time, and
+// their boundary lines must be saved beforehand.
+void av1_loop_restoration_filter_rows_init(AV1LrStruct *lr_ctxt,
+                                           YV12_BUFFER_CONFIG *frame,
+                                           struct AV1Common *cm,
+                                           int num_planes);
+void av1_loop_restoration_filter_rows(AV1LrStruct *lr_ctxt, int plane,
+                                      int row_start, int row_end,
+                                      int32_t *tmpbuf,
+                                      RestorationLineBuffers *rlbs);
 void av1_loop_restoration_copy_planes(AV1LrStruct *loop_rest_ctxt,
                                       struct AV1Common *cm, int num_planes);
 void av1_foreach_rest_unit_in_row(
@@ -15,6 +15,7 @@
 #include "aom_dsp/aom_dsp_common.h"
 #include "aom_mem/aom_mem.h"
 #include "av1/common/av1_loopfilter.h"
+#include "av1/common/cdef.h"
 #include "av1/common/entropymode.h"
 #include "av1/common/thread_common.h"
 #include "av1/common/reconinter.h"
@@ -921,3 +922,201 @@ void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
   foreach_rest_unit_in_planes_mt(loop_rest_ctxt, workers, num_workers, lr_sync,
                                  cm);
 }
+
+// Allocate memory for cdef row synchronization
+static void cdef_alloc(AV1CdefSync *cdef_sync, AV1_COMMON *cm, int rows,
+                       int linebuf_stride, int num_workers) {
+  cdef_sync->rows = rows;
+  cdef_sync->linebuf_stride = linebuf_stride;
+#if CONFIG_MULTITHREAD
+  {
+    int i;
+
+    CHECK_MEM_ERROR(cm, cdef_sync->mutex_,
+                    aom_malloc(sizeof(*(cdef_sync->mutex_)) * rows));
+    if (cdef_sync->mutex_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_mutex_init(&cdef_sync->mutex_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, cdef_sync->cond_,
+                    aom_malloc(sizeof(*(cdef_sync->cond_)) * rows));
+    if (cdef_sync->cond_) {
+      for (i = 0; i < rows; ++i) {
+        pthread_cond_init(&cdef_sync->cond_[i], NULL);
+      }
+    }
+
+    CHECK_MEM_ERROR(cm, cdef_sync->job_mutex,
+                    aom_malloc(sizeof(*(cdef_sync->job_mutex))));
+    if (cdef_sync->job_mutex) {
+      pthread_mutex_init(cdef_sync->job_mutex, NULL);
+    }
+  }
+#endif  // CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(
+      cm, cdef_sync->cdefworkerdata,
+      aom_malloc(num_workers * sizeof(*(cdef_sync->cdefworkerdata))));
+  cdef_sync->num_workers = num_workers;
+
+  CHECK_MEM_ERROR(cm, cdef_sync->boundary_saved,
+                  aom_malloc(sizeof(*(cdef_sync->boundary_saved)) * rows));
+  for (int j = 0; j < MAX_MB_PLANE; j++) {
+    CHECK_MEM_ERROR(cm, cdef_sync->linebuf[j],
+                    aom_malloc(sizeof(*(cdef_sync->linebuf[j])) * rows * 2 *
+                               CDEF_VBORDER * linebuf_stride));
+  }
+}
+
+// Deallocate cdef synchronization related mutex and data
+void av1_cdef_dealloc(AV1CdefSync *cdef_sync) {
+  if (cdef_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    int i;
+    if (cdef_sync->mutex_ != NULL) {
+      for (i = 0; i < cdef_sync->rows; ++i) {
+        pthread_mutex_destroy(&cdef_sync->mutex_[i]);
+      }
+      aom_free(cdef_sync->mutex_);
+    }
+    if (cdef_sync->cond_ != NULL) {
+      for (i = 0; i < cdef_sync->rows; ++i) {
+        pthread_cond_destroy(&cdef_sync->cond_[i]);
+      }
+      aom_free(cdef_sync->cond_);
+    }
+    if (cdef_sync->job_mutex != NULL) {
+      pthread_mutex_destroy(cdef_sync->job_mutex);
+      aom_free(cdef_sync->job_mutex);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(cdef_sync->cdefworkerdata);
+    aom_free(cdef_sync->boundary_saved);
+    for (int j = 0; j < MAX_MB_PLANE; j++) {
+      aom_free(cdef_sync->linebuf[j]);
+    }
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*cdef_sync);
+  }
+}
+
+static INLINE void cdef_sync_read(AV1CdefSync *const cdef_sync, int r) {
+#if CONFIG_MULTITHREAD
+  if (r) {
+    pthread_mutex_t *const mutex = &cdef_sync->mutex_[r - 1];
+    pthread_mutex_lock(mutex);
+
+    while (!cdef_sync->boundary_saved[r - 1]) {
+      pthread_cond_wait(&cdef_sync->cond_[r - 1], mutex);
+    }
+    pthread_mutex_unlock(mutex);
+  }
+#else
+  (void)cdef_sync;
+  (void)r;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static INLINE void cdef_sync_write(AV1CdefSync *const cdef_sync, int r) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&cdef_sync->mutex_[r]);
+
+  cdef_sync->boundary_saved[r] = 1;
+
+  pthread_cond_broadcast(&cdef_sync->cond_[r]);
+  pthread_mutex_unlock(&cdef_sync->mutex_[r]);
+#else
+  (void)cdef_sync;
+  (void)r;
+#endif  // CONFIG_MULTITHREAD
+}
+
+static int get_cdef_next_fb_row(AV1CdefSync *cdef_sync, int *fbr) {
+  int ret = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(cdef_sync->job_mutex);
+#endif
+
+  if (cdef_sync->next_fb_row < cdef_sync->rows) {
+    *fbr = cdef_sync->next_fb_row++;
+    ret = 1;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(cdef_sync->job_mutex);
+#endif
+
+  return ret;
+}
+
+// Row-based multi-threaded cdef hook
+static int cdef_row_worker(void *arg1, void *arg2) {
+  AV1CdefSync *const cdef_sync = (AV1CdefSync *)arg1;
+  CdefWorkerData *const cdef_data = (CdefWorkerData *)arg2;
+  int fbr;
+
+  while (get_cdef_next_fb_row(cdef_sync, &fbr)) {
+    // Row fbr filters the lines saved along with the boundary above it, and
+    // reads that boundary as its top border.
+    cdef_sync_read(cdef_sync, fbr);
+
+    av1_cdef_save_fb_row_boundary(cdef_data->cm, cdef_data->xd,
+                                  cdef_sync->linebuf, fbr);
+    cdef_sync_write(cdef_sync, fbr);
+
+    av1_cdef_fb_row(cdef_data->cm, cdef_data->xd, cdef_sync->linebuf, fbr);
+  }
+  return 1;
+}
+
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, AV1_COMMON *cm,
+                       MACROBLOCKD *xd, AVxWorker *workers, int num_workers,
+                       AV1CdefSync *cdef_sync) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  const int num_planes = av1_num_planes(cm);
+  // Number of 64x64 filter block rows
+  const int fb_rows = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  const int linebuf_stride = av1_cdef_linebuf_stride(cm);
+  int i;
+
+  if (fb_rows != cdef_sync->rows ||
+      linebuf_stride != cdef_sync->linebuf_stride ||
+      num_workers > cdef_sync->num_workers) {
+    av1_cdef_dealloc(cdef_sync);
+    cdef_alloc(cdef_sync, cm, fb_rows, linebuf_stride, num_workers);
+  }
+
+  memset(cdef_sync->boundary_saved, 0,
+         sizeof(*(cdef_sync->boundary_saved)) * fb_rows);
+  cdef_sync->next_fb_row = 0;
+
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0,
+                       num_planes);
+
+  // Set up cdef thread data.
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    CdefWorkerData *const cdef_data = &cdef_sync->cdefworkerdata[i];
+
+    cdef_data->cm = cm;
+    cdef_data->xd = xd;
+    worker->hook = cdef_row_worker;
+    worker->data1 = cdef_sync;
+    worker->data2 = cdef_data;
+
+    // Start cdef
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+}
@@ -97,6 +97,34 @@ typedef struct AV1LrSyncData {
   int jobs_dequeued;
 } AV1LrSync;
 
+typedef struct CdefWorkerData {
+  struct AV1Common *cm;
+  struct macroblockd *xd;
+} CdefWorkerData;
+
+// CDEF row synchronization
+typedef struct AV1CdefSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  // Set once the boundary lines below each 64x64 filter block row are saved.
+  int *boundary_saved;
+  int rows;
+  // Saved unfiltered lines around each filter block row boundary.
+  uint16_t *linebuf[MAX_MB_PLANE];
+  int linebuf_stride;
+
+  CdefWorkerData *cdefworkerdata;
+  int num_workers;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
+  // Filter block rows are handed out top to bottom.
+  int next_fb_row;
+} AV1CdefSync;
+
 // Deallocate loopfilter synchronization related mutex and data.
 void av1_loop_filter_dealloc(AV1LfSync *lf_sync);
 
@@ -115,6 +143,11 @@ void av1_loop_restoration_filter_frame_mt(YV12_BUFFER_CONFIG *frame,
                                           void *lr_ctxt);
 void av1_loop_restoration_dealloc(AV1LrSync *lr_sync, int num_workers);
 
+void av1_cdef_frame_mt(YV12_BUFFER_CONFIG *frame, struct AV1Common *cm,
+                       struct macroblockd *xd, AVxWorker *workers,
+                       int num_workers, AV1CdefSync *cdef_sync);
+void av1_cdef_dealloc(AV1CdefSync *cdef_sync);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "av1/common/convolve.h"
+#include "av1/common/resize.h"
+#include "aom_dsp/x86/synonyms.h"
+#include "aom_dsp/x86/synonyms_avx2.h"
+
+// Computes the source offsets and loads the filters of the 8 output pixels
+// starting at x. Output pixel k shares a register with output pixel k + 4,
+// one in each 128-bit lane.
+//
+// The output pixels past the width rounded up to a multiple of 4 reuse the
+// first pixel, so that, like the SSE4.1 version, this reads and writes at
+// most 3 pixels past the width.
+static INLINE int prepare_filters(const int16_t *x_filters, int x_qn,
+                                  int x_step_qn, int w_left, int offsets[8],
+                                  __m256i fil[4]) {
+  const int num_pixels = AOMMIN((w_left + 3) & ~3, 8);
+  __m128i fil_16[8];
+  for (int k = 0; k < 8; ++k) {
+    const int qn = x_qn + (k < num_pixels ? k : 0) * x_step_qn;
+    const int x_filter_idx =
+        (qn & RS_SCALE_SUBPEL_MASK) >> RS_SCALE_EXTRA_BITS;
+    assert(x_filter_idx <= RS_SUBPEL_MASK);
+    offsets[k] = qn >> RS_SCALE_SUBPEL_BITS;
+    fil_16[k] =
+        xx_loadu_128(&x_filters[x_filter_idx * UPSCALE_NORMATIVE_TAPS]);
+  }
+  for (int k = 0; k < 4; ++k) fil[k] = yy_set_m128i(fil_16[k + 4], fil_16[k]);
+  return num_pixels;
+}
+
+static INLINE __m256i load_8_taps_pair(const uint8_t *lo, const uint8_t *hi) {
+  return _mm256_cvtepu8_epi16(
+      _mm_unpacklo_epi64(xx_loadl_64(lo), xx_loadl_64(hi)));
+}
+
+// Multiplies the source pixels by the filters and sums the 8 taps, i.e.
+// ([ s7..s0 | s7..s0 ] x 4) -> [ x7 x6 x5 x4 | x3 x2 x1 x0 ], then divides
+// down by (1 << FILTER_BITS), rounding to nearest.
+static INLINE __m256i convolve_8(const __m256i src[4], const __m256i fil[4]) {
+  const __m256i round_add = _mm256_set1_epi32((1 << FILTER_BITS) >> 1);
+  const __m256i conv0_32 = _mm256_madd_epi16(src[0], fil[0]);
+  const __m256i conv1_32 = _mm256_madd_epi16(src[1], fil[1]);
+  const __m256i conv2_32 = _mm256_madd_epi16(src[2], fil[2]);
+  const __m256i conv3_32 = _mm256_madd_epi16(src[3], fil[3]);
+  const __m256i conv01_32 = _mm256_hadd_epi32(conv0_32, conv1_32);
+  const __m256i conv23_32 = _mm256_hadd_epi32(conv2_32, conv3_32);
+  const __m256i conv_32 = _mm256_hadd_epi32(conv01_32, conv23_32);
+  return _mm256_srai_epi32(_mm256_add_epi32(conv_32, round_add), FILTER_BITS);
+}
+
+// Note: If the crop width is not a multiple of 4, then, unlike the C version,
+// this function will overwrite some of the padding on the right hand side of
+// the frame, the same as av1_convolve_horiz_rs_sse4_1().
+void av1_convolve_horiz_rs_avx2(const uint8_t *src, int src_stride,
+                                uint8_t *dst, int dst_stride, int w, int h,
+                                const int16_t *x_filters, int x0_qn,
+                                int x_step_qn) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  const __m256i zero = _mm256_setzero_si256();
+
+  int x_qn = x0_qn;
+  for (int x = 0; x < w; x += 8, x_qn += 8 * x_step_qn) {
+    int offsets[8];
+    __m256i fil[4];
+    const int num_pixels =
+        prepare_filters(x_filters, x_qn, x_step_qn, w - x, offsets, fil);
+
+    const uint8_t *src_y = src;
+    uint8_t *dst_y = dst + x;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      // Load up the source data and zero-extend it to 16-bit precision, with
+      // the 8 taps of output pixel k in the low lane and those of output
+      // pixel k + 4 in the high lane.
+      __m256i src_16[4];
+      src_16[0] = load_8_taps_pair(&src_y[offsets[0]], &src_y[offsets[4]]);
+      src_16[1] = load_8_taps_pair(&src_y[offsets[1]], &src_y[offsets[5]]);
+      src_16[2] = load_8_taps_pair(&src_y[offsets[2]], &src_y[offsets[6]]);
+      src_16[3] = load_8_taps_pair(&src_y[offsets[3]], &src_y[offsets[7]]);
+      const __m256i shifted_32 = convolve_8(src_16, fil);
+
+      // Pack down to 8 bits, i.e.
+      // [ x7 x6 x5 x4 | x3 x2 x1 x0 ] -> [ .. x7x6x5x4 | .. x3x2x1x0 ]
+      const __m256i shifted_16 = _mm256_packus_epi32(shifted_32, zero);
+      const __m256i shifted_8 = _mm256_packus_epi16(shifted_16, zero);
+      const __m128i res = _mm_unpacklo_epi32(
+          _mm256_castsi256_si128(shifted_8),
+          _mm256_extracti128_si256(shifted_8, 1));
+
+      if (num_pixels == 8)
+        xx_storel_64(dst_y, res);
+      else
+        xx_storel_32(dst_y, res);
+    }
+  }
+}
+
+// Note: If the crop width is not a multiple of 4, then, unlike the C version,
+// this function will overwrite some of the padding on the right hand side of
+// the frame, the same as av1_highbd_convolve_horiz_rs_sse4_1().
+void av1_highbd_convolve_horiz_rs_avx2(const uint16_t *src, int src_stride,
+                                       uint16_t *dst, int dst_stride, int w,
+                                       int h, const int16_t *x_filters,
+                                       int x0_qn, int x_step_qn, int bd) {
+  assert(UPSCALE_NORMATIVE_TAPS == 8);
+  assert(bd == 8 || bd == 10 || bd == 12);
+
+  src -= UPSCALE_NORMATIVE_TAPS / 2 - 1;
+
+  const __m256i zero = _mm256_setzero_si256();
+  const __m128i clip_maximum = _mm_set1_epi16((1 << bd) - 1);
+
+  int x_qn = x0_qn;
+  for (int x = 0; x < w; x += 8, x_qn += 8 * x_step_qn) {
+    int offsets[8];
+    __m256i fil[4];
+    const int num_pixels =
+        prepare_filters(x_filters, x_qn, x_step_qn, w - x, offsets, fil);
+
+    const uint16_t *src_y = src;
+    uint16_t *dst_y = dst + x;
+    for (int y = 0; y < h; y++, src_y += src_stride, dst_y += dst_stride) {
+      __m256i src_16[4];
+      src_16[0] = yy_loadu2_128(&src_y[offsets[4]], &src_y[offsets[0]]);
+      src_16[1] = yy_loadu2_128(&src_y[offsets[5]], &src_y[offsets[1]]);
+      src_16[2] = yy_loadu2_128(&src_y[offsets[6]], &src_y[offsets[2]]);
+      src_16[3] = yy_loadu2_128(&src_y[offsets[7]], &src_y[offsets[3]]);
+      const __m256i shifted_32 = convolve_8(src_16, fil);
+
+      // Pack down to 16 bits and clip the values at (1 << bd) - 1, i.e.
+      // [ x7 x6 x5 x4 | x3 x2 x1 x0 ] -> [ x7 x6 x5 x4 x3 x2 x1 x0 ]
+      const __m256i shifted_16 = _mm256_packus_epi32(shifted_32, zero);
+      const __m128i res = _mm_unpacklo_epi64(
+          _mm256_castsi256_si128(shifted_16),
+          _mm256_extracti128_si256(shifted_16, 1));
+      const __m128i clipped_16 = _mm_min_epi16(res, clip_maximum);
+
+      if (num_pixels == 8)
+        xx_storeu_128(dst_y, clipped_16);
+      else
+        xx_storel_64(dst_y, clipped_16);
+    }
+  }
+}
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <smmintrin.h>
+
+#include "config/av1_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "av1/common/resize.h"
+#include "aom_dsp/x86/synonyms.h"
+
+// The vector loops compute 8 output pixels from input pixels [i - 4, i + 28),
+// where i is the position of the first one. The pixels near the ends of the
+// input are computed by the scalar code, which clamps the taps to the input.
+#define DOWN2_LEFT_PIXELS 4
+#define DOWN2_LOAD_PIXELS 32
+
+// A vector of 8 even or odd input pixels, E[n] = input[2 * n] and
+// O[n] = input[2 * n + 1]. lo holds [n - 2, n + 6) and hi [n + 6, n + 14),
+// where output pixel n is the first one computed.
+typedef struct {
+  __m128i lo;
+  __m128i hi;
+} Down2Pixels;
+
+// Returns E[n + s .. n + s + 8) or O[n + s .. n + s + 8), for -2 <= s <= 2.
+#define DOWN2_SHIFT(p, s) _mm_alignr_epi8((p).hi, (p).lo, 2 * ((s) + 2))
+
+static INLINE __m128i pair_filter(const int16_t *filter) {
+  return _mm_set1_epi32((int)(uint16_t)filter[0] |
+                        ((int)(uint16_t)filter[1] << 16));
+}
+
+// Sums t0 * f[0] + t1 * f[1] + t2 * f[2] + t3 * f[3], where t0..t3 are the
+// sums of the pixel pairs which share a tap, and rounds the 8 results. f01 and
+// f23 hold the pairs of taps, as returned by pair_filter().
+static INLINE void down2_filter_8(__m128i t0, __m128i t1, __m128i t2,
+                                  __m128i t3, __m128i f01, __m128i f23,
+                                  __m128i *res_lo, __m128i *res_hi) {
+  const __m128i round_add = _mm_set1_epi32(1 << (FILTER_BITS - 1));
+  const __m128i sum_lo =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(t0, t1), f01),
+                    _mm_madd_epi16(_mm_unpacklo_epi16(t2, t3), f23));
+  const __m128i sum_hi =
+      _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(t0, t1), f01),
+                    _mm_madd_epi16(_mm_unpackhi_epi16(t2, t3), f23));
+  *res_lo = _mm_srai_epi32(_mm_add_epi32(sum_lo, round_add), FILTER_BITS);
+  *res_hi = _mm_srai_epi32(_mm_add_epi32(sum_hi, round_add), FILTER_BITS);
+}
+
+// Output n = f[0] * (E[n] + O[n]) + f[1] * (O[n - 1] + E[n + 1]) +
+//            f[2] * (E[n - 1] + O[n + 1]) + f[3] * (O[n - 2] + E[n + 2])
+static INLINE void down2_symeven_8(Down2Pixels e, Down2Pixels o, __m128i f01,
+                                   __m128i f23, __m128i *res_lo,
+                                   __m128i *res_hi) {
+  const __m128i t0 = _mm_add_epi16(DOWN2_SHIFT(e, 0), DOWN2_SHIFT(o, 0));
+  const __m128i t1 = _mm_add_epi16(DOWN2_SHIFT(o, -1), DOWN2_SHIFT(e, 1));
+  const __m128i t2 = _mm_add_epi16(DOWN2_SHIFT(e, -1), DOWN2_SHIFT(o, 1));
+  const __m128i t3 = _mm_add_epi16(o.lo, DOWN2_SHIFT(e, 2));
+  down2_filter_8(t0, t1, t2, t3, f01, f23, res_lo, res_hi);
+}
+
+// Output n = f[0] * E[n] + f[1] * (O[n - 1] + O[n]) +
+//            f[2] * (E[n - 1] + E[n + 1]) + f[3] * (O[n - 2] + O[n + 1])
+static INLINE void down2_symodd_8(Down2Pixels e, Down2Pixels o, __m128i f01,
+                                  __m128i f23, __m128i *res_lo,
+                                  __m128i *res_hi) {
+  const __m128i t0 = DOWN2_SHIFT(e, 0);
+  const __m128i t1 = _mm_add_epi16(DOWN2_SHIFT(o, -1), DOWN2_SHIFT(o, 0));
+  const __m128i t2 = _mm_add_epi16(DOWN2_SHIFT(e, -1), DOWN2_SHIFT(e, 1));
+  const __m128i t3 = _mm_add_epi16(o.lo, DOWN2_SHIFT(o, 1));
+  down2_filter_8(t0, t1, t2, t3, f01, f23, res_lo, res_hi);
+}
+
+// Splits input[i - 4, i + 28) into even and odd pixels.
+static INLINE void load_down2_pixels(const uint8_t *input, Down2Pixels *e,
+                                     Down2Pixels *o) {
+  const __m128i mask = _mm_set1_epi16(0xff);
+  const __m128i a = xx_loadu_128(input - DOWN2_LEFT_PIXELS);
+  const __m128i b = xx_loadu_128(input - DOWN2_LEFT_PIXELS + 16);
+  e->lo = _mm_and_si128(a, mask);
+  e->hi = _mm_and_si128(b, mask);
+  o->lo = _mm_srli_epi16(a, 8);
+  o->hi = _mm_srli_epi16(b, 8);
+}
+
+static INLINE void highbd_load_down2_pixels(const uint16_t *input,
+                                            Down2Pixels *e, Down2Pixels *o) {
+  const __m128i mask = _mm_set1_epi32(0xffff);
+  __m128i a[4];
+  for (int k = 0; k < 4; ++k)
+    a[k] = xx_loadu_128(input - DOWN2_LEFT_PIXELS + 8 * k);
+  e->lo =
+      _mm_packus_epi32(_mm_and_si128(a[0], mask), _mm_and_si128(a[1], mask));
+  e->hi =
+      _mm_packus_epi32(_mm_and_si128(a[2], mask), _mm_and_si128(a[3], mask));
+  o->lo = _mm_packus_epi32(_mm_srli_epi32(a[0], 16), _mm_srli_epi32(a[1], 16));
+  o->hi = _mm_packus_epi32(_mm_srli_epi32(a[2], 16), _mm_srli_epi32(a[3], 16));
+}
+
+static INLINE void store_8(uint8_t *output, __m128i res_lo, __m128i res_hi) {
+  const __m128i res_16 = _mm_packs_epi32(res_lo, res_hi);
+  xx_storel_64(output, _mm_packus_epi16(res_16, res_16));
+}
+
+static INLINE void highbd_store_8(uint16_t *output, __m128i res_lo,
+                                  __m128i res_hi, int bd) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i clip_maximum = _mm_set1_epi32((1 << bd) - 1);
+  res_lo = _mm_min_epi32(_mm_max_epi32(res_lo, zero), clip_maximum);
+  res_hi = _mm_min_epi32(_mm_max_epi32(res_hi, zero), clip_maximum);
+  xx_storeu_128(output, _mm_packus_epi32(res_lo, res_hi));
+}
+
+// Scalar versions for the pixels near the ends of the input. These clamp all
+// the taps, which gives the same result as the C code for any position.
+static INLINE int down2_symeven_px(const uint8_t *input, int length, int i) {
+  const int16_t *filter = av1_down2_symeven_half_filter;
+  int sum = (1 << (FILTER_BITS - 1));
+  for (int j = 0; j < DOWN2_SYMEVEN_HALF_TAPS; ++j) {
+    sum += (input[AOMMAX(i - j, 0)] + input[AOMMIN(i + 1 + j, length - 1)]) *
+           filter[j];
+  }
+  return sum >> FILTER_BITS;
+}
+
+static INLINE int down2_symodd_px(const uint8_t *input, int length, int i) {
+  const int16_t *filter = av1_down2_symodd_half_filter;
+  int sum = (1 << (FILTER_BITS - 1)) + input[i] * filter[0];
+  for (int j = 1; j < DOWN2_SYMODD_HALF_TAPS; ++j) {
+    sum += (input[AOMMAX(i - j, 0)] + input[AOMMIN(i + j, length - 1)]) *
+           filter[j];
+  }
+  return sum >> FILTER_BITS;
+}
+
+static INLINE int highbd_down2_symeven_px(const uint16_t *input, int length,
+                                          int i) {
+  const int16_t *filter = av1_down2_symeven_half_filter;
+  int sum = (1 << (FILTER_BITS - 1));
+  for (int j = 0; j < DOWN2_SYMEVEN_HALF_TAPS; ++j) {
+    sum += (input[AOMMAX(i - j, 0)] + input[AOMMIN(i + 1 + j, length - 1)]) *
+           filter[j];
+  }
+  return sum >> FILTER_BITS;
+}
+
+static INLINE int highbd_down2_symodd_px(const uint16_t *input, int length,
+                                         int i) {
+  const int16_t *filter = av1_down2_symodd_half_filter;
+  int sum = (1 << (FILTER_BITS - 1)) + input[i] * filter[0];
+  for (int j = 1; j < DOWN2_SYMODD_HALF_TAPS; ++j) {
+    sum += (input[AOMMAX(i - j, 0)] + input[AOMMIN(i + j, length - 1)]) *
+           filter[j];
+  }
+  return sum >> FILTER_BITS;
+}
+
+void av1_down2_symeven_sse4_1(const uint8_t *const input, int length,
+                              uint8_t *output) {
+  assert(DOWN2_SYMEVEN_HALF_TAPS == 4);
+  const __m128i f01 = pair_filter(av1_down2_symeven_half_filter);
+  const __m128i f23 = pair_filter(av1_down2_symeven_half_filter + 2);
+  int i = 0;
+  for (; i < DOWN2_LEFT_PIXELS && i < length; i += 2)
+    output[i >> 1] = clip_pixel(down2_symeven_px(input, length, i));
+  for (; i + DOWN2_LOAD_PIXELS - DOWN2_LEFT_PIXELS <= length; i += 16) {
+    Down2Pixels e, o;
+    __m128i res_lo, res_hi;
+    load_down2_pixels(input + i, &e, &o);
+    down2_symeven_8(e, o, f01, f23, &res_lo, &res_hi);
+    store_8(output + (i >> 1), res_lo, res_hi);
+  }
+  for (; i < length; i += 2)
+    output[i >> 1] = clip_pixel(down2_symeven_px(input, length, i));
+}
+
+void av1_down2_symodd_sse4_1(const uint8_t *const input, int length,
+                             uint8_t *output) {
+  assert(DOWN2_SYMODD_HALF_TAPS == 4);
+  const __m128i f01 = pair_filter(av1_down2_symodd_half_filter);
+  const __m128i f23 = pair_filter(av1_down2_symodd_half_filter + 2);
+  int i = 0;
+  for (; i < DOWN2_LEFT_PIXELS && i < length; i += 2)
+    output[i >> 1] = clip_pixel(down2_symodd_px(input, length, i));
+  for (; i + DOWN2_LOAD_PIXELS - DOWN2_LEFT_PIXELS <= length; i += 16) {
+    Down2Pixels e, o;
+    __m128i res_lo, res_hi;
+    load_down2_pixels(input + i, &e, &o);
+    down2_symodd_8(e, o, f01, f23, &res_lo, &res_hi);
+    store_8(output + (i >> 1), res_lo, res_hi);
+  }
+  for (; i < length; i += 2)
+    output[i >> 1] = clip_pixel(down2_symodd_px(input, length, i));
+}
+
+void av1_highbd_down2_symeven_sse4_1(const uint16_t *const input, int length,
+                                     uint16_t *output, int bd) {
+  assert(DOWN2_SYMEVEN_HALF_TAPS == 4);
+  const __m128i f01 = pair_filter(av1_down2_symeven_half_filter);
+  const __m128i f23 = pair_filter(av1_down2_symeven_half_filter + 2);
+  int i = 0;
+  for (; i < DOWN2_LEFT_PIXELS && i < length; i += 2) {
+    output[i >> 1] =
+        clip_pixel_highbd(highbd_down2_symeven_px(input, length, i), bd);
+  }
+  for (; i + DOWN2_LOAD_PIXELS - DOWN2_LEFT_PIXELS <= length; i += 16) {
+    Down2Pixels e, o;
+    __m128i res_lo, res_hi;
+    highbd_load_down2_pixels(input + i, &e, &o);
+    down2_symeven_8(e, o, f01, f23, &res_lo, &res_hi);
+    highbd_store_8(output + (i >> 1), res_lo, res_hi, bd);
+  }
+  for (; i < length; i += 2) {
+    output[i >> 1] =
+        clip_pixel_highbd(highbd_down2_symeven_px(input, length, i), bd);
+  }
+}
+
+void av1_highbd_down2_symodd_sse4_1(const uint16_t *const input, int length,
+                                    uint16_t *output, int bd) {
+  assert(DOWN2_SYMODD_HALF_TAPS == 4);
+  const __m128i f01 = pair_filter(av1_down2_symodd_half_filter);
+  const __m128i f23 = pair_filter(av1_down2_symodd_half_filter + 2);
+  int i = 0;
+  for (; i < DOWN2_LEFT_PIXELS && i < length; i += 2) {
+    output[i >> 1] =
+        clip_pixel_highbd(highbd_down2_symodd_px(input, length, i), bd);
+  }
+  for (; i + DOWN2_LOAD_PIXELS - DOWN2_LEFT_PIXELS <= length; i += 16) {
+    Down2Pixels e, o;
+    __m128i res_lo, res_hi;
+    highbd_load_down2_pixels(input + i, &e, &o);
+    down2_symodd_8(e, o, f01, f23, &res_lo, &res_hi);
+    highbd_store_8(output + (i >> 1), res_lo, res_hi, bd);
+  }
+  for (; i < length; i += 2) {
+    output[i >> 1] =
+        clip_pixel_highbd(highbd_down2_symodd_px(input, length, i), bd);
+  }
+}
@@ -628,6 +628,20 @@ static INLINE void dec_calc_subpel_params(
   }
 }
 
+// In frame parallel decode, waits until the rows of 'ref_buf' read by the
+// prediction of 'block' have been decoded. Warped prediction may read from
+// anywhere in the reference frame.
+static INLINE void dec_wait_for_ref_rows(const AV1_COMMON *cm,
+                                         const RefCntBuffer *ref_buf,
+                                         const PadBlock *block, int ss_y,
+                                         int do_warp) {
+  BufferPool *const pool = cm->buffer_pool;
+  if (!pool->frame_parallel_decode) return;
+  int rows = ref_buf->buf.y_crop_height;
+  if (!do_warp) rows = AOMMIN(rows, (block->y1 + AOM_INTERP_EXTEND) << ss_y);
+  av1_frameworker_wait(pool, ref_buf, rows);
+}
+
 static INLINE void dec_build_inter_predictors(const AV1_COMMON *cm,
                                               MACROBLOCKD *xd, int plane,
                                               const MB_MODE_INFO *mi,
@@ -735,6 +749,7 @@ static INLINE void dec_build_inter_predictors(const AV1_COMMON *cm,
         dec_calc_subpel_params(xd, sf, mv, plane, pre_x, pre_y, x, y, pre_buf,
                                &subpel_params, bw, bh, &block, mi_x, mi_y,
                                &scaled_mv, &subpel_x_mv, &subpel_y_mv);
+        if (!is_intrabc) dec_wait_for_ref_rows(cm, ref_buf, &block, ss_y, 0);
         pre = pre_buf->buf0 + block.y0 * pre_buf->stride + block.x0;
         src_stride = pre_buf->stride;
         highbd = is_cur_buf_hbd(xd);
@@ -794,6 +809,11 @@ static INLINE void dec_build_inter_predictors(const AV1_COMMON *cm,
                                     build_for_obmc, sf, NULL));
       do_warp = (do_warp && xd->cur_frame_force_integer_mv == 0);
 
+      if (!is_intrabc) {
+        dec_wait_for_ref_rows(cm, get_ref_frame_buf(cm, mi->ref_frame[ref]),
+                              &block, ss_y, do_warp);
+      }
+
       extend_mc_border(sf, pre_buf, scaled_mv, block, subpel_x_mv, subpel_y_mv,
                        do_warp, is_intrabc, highbd, xd->mc_buf[ref], &pre[ref],
                        &src_stride[ref]);
@@ -1694,6 +1714,8 @@ static void setup_segmentation(AV1_COMMON *const cm,
   if (cm->seg.enabled && cm->prev_frame &&
       (cm->mi_rows == cm->prev_frame->mi_rows) &&
       (cm->mi_cols == cm->prev_frame->mi_cols)) {
+    // In frame parallel decode, the previous frame may still be decoding.
+    av1_frameworker_wait_tiles(cm->buffer_pool, cm->prev_frame);
     cm->last_frame_seg_map = cm->prev_frame->seg_map;
   } else {
     cm->last_frame_seg_map = NULL;
@@ -2916,6 +2938,18 @@ static void decode_tile(AV1Decoder *pbi, ThreadData *const td, int tile_row,
   aom_merge_corrupted_flag(&td->xd.corrupted, corrupted);
 }
 
+// Whether any of the loop filter, CDEF or loop restoration is applied to the
+// frame.
+static int frame_has_post_filter(const AV1_COMMON *const cm) {
+  return cm->lf.filter_level[0] || cm->lf.filter_level[1] ||
+         (!cm->skip_loop_filter && !cm->coded_lossless &&
+          (cm->cdef_info.cdef_bits || cm->cdef_info.cdef_strengths[0] ||
+           cm->cdef_info.cdef_uv_strengths[0])) ||
+         cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+         cm->rst_info[2].frame_restoration_type != RESTORE_NONE;
+}
+
 static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
                                    const uint8_t *data_end, int start_tile,
                                    int end_tile) {
@@ -3000,6 +3034,13 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
     td->xd.tmp_obmc_bufs[j] = td->tmp_obmc_bufs[j];
   }
 
+  // Without any post filter, the rows of a tile row are final once its tiles
+  // are decoded, so the frames predicting from them can go ahead.
+  const int signal_tile_rows = pbi->frame_parallel_decode &&
+                               !cm->large_scale_tile && !inv_row_order &&
+                               !av1_superres_scaled(cm) &&
+                               !frame_has_post_filter(cm);
+
   for (tile_row = tile_rows_start; tile_row < tile_rows_end; ++tile_row) {
     const int row = inv_row_order ? tile_rows - 1 - tile_row : tile_row;
 
@@ -3041,6 +3082,14 @@ static const uint8_t *decode_tiles(AV1Decoder *pbi, const uint8_t *data,
         aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
                            "Failed to decode tile data");
     }
+
+    if (signal_tile_rows && (row + 1) * cm->tile_cols - 1 <= end_tile) {
+      TileInfo tile_info;
+      av1_tile_set_row(&tile_info, cm, row);
+      av1_frameworker_broadcast(
+          cm->buffer_pool, cm->cur_frame,
+          AOMMIN(tile_info.mi_row_end << MI_SIZE_LOG2, cm->height));
+    }
   }
 
   if (cm->large_scale_tile) {
@@ -3143,12 +3192,16 @@ static int tile_worker_hook(void *arg1, void *arg2) {
     if (cur_job_info != NULL) {
       const TileBufferDec *const tile_buffer = cur_job_info->tile_buffer;
       TileDataDec *const tile_data = cur_job_info->tile_data;
+      struct aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
       tile_worker_hook_init(pbi, thread_data, tile_buffer, tile_data,
                             allow_update_cdf);
       // decode tile
       int tile_row = tile_data->tile_info.tile_row;
       int tile_col = tile_data->tile_info.tile_col;
       decode_tile(pbi, td, tile_row, tile_col);
+      add_stage_time(pbi, thread_data->stats_thread, AOM_DEC_STAGE_TILE_DECODE,
+                     &timer);
     } else {
       break;
     }
@@ -3388,6 +3441,8 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
     if (cur_job_info != NULL) {
       const TileBufferDec *const tile_buffer = cur_job_info->tile_buffer;
       TileDataDec *const tile_data = cur_job_info->tile_data;
+      struct aom_usec_timer timer;
+      aom_usec_timer_start(&timer);
       tile_worker_hook_init(pbi, thread_data, tile_buffer, tile_data,
                             allow_update_cdf);
 #if CONFIG_MULTITHREAD
@@ -3399,6 +3454,8 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
 #endif
       // decode tile
       parse_tile_row_mt(pbi, td, tile_data);
+      add_stage_time(pbi, thread_data->stats_thread,
+                     AOM_DEC_STAGE_ENTROPY_DECODE, &timer);
 #if CONFIG_MULTITHREAD
       pthread_mutex_lock(pbi->row_mt_mutex_);
 #endif
@@ -3452,12 +3509,16 @@ static int row_mt_worker_hook(void *arg1, void *arg2) {
         pbi->tile_data + tile_row * cm->tile_cols + tile_col;
     AV1DecRowMTSync *dec_row_mt_sync = &tile_data->dec_row_mt_sync;
     TileInfo tile_info = tile_data->tile_info;
+    struct aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
 
     av1_tile_init(&td->xd.tile, cm, tile_row, tile_col);
     av1_init_macroblockd(cm, &td->xd, NULL);
     td->xd.error_info = &thread_data->error_info;
 
     decode_tile_sb_row(pbi, td, tile_info, mi_row);
+    add_stage_time(pbi, thread_data->stats_thread, AOM_DEC_STAGE_RECON,
+                   &timer);
 
 #if CONFIG_MULTITHREAD
     pthread_mutex_lock(pbi->row_mt_mutex_);
@@ -3598,11 +3659,14 @@ static void launch_dec_workers(AV1Decoder *pbi, const uint8_t *data_end,
                                int num_workers) {
   const AVxWorkerInterface *const winterface = aom_get_worker_interface();
 
+  aom_usec_timer_start(&pbi->workers_timer);
   for (int worker_idx = 0; worker_idx < num_workers; ++worker_idx) {
     AVxWorker *const worker = &pbi->tile_workers[worker_idx];
     DecWorkerData *const thread_data = (DecWorkerData *)worker->data1;
 
     thread_data->data_end = data_end;
+    thread_data->stats_thread = get_stats_thread(worker_idx, num_workers);
+    thread_data->busy_time = get_busy_time(pbi, thread_data->stats_thread);
 
     worker->had_error = 0;
     if (worker_idx == num_workers - 1) {
@@ -3622,6 +3686,14 @@ static void sync_dec_workers(AV1Decoder *pbi, int num_workers) {
     aom_merge_corrupted_flag(&corrupted, !winterface->sync(worker));
   }
 
+  aom_usec_timer_mark(&pbi->workers_timer);
+  const uint64_t elapsed = aom_usec_timer_elapsed(&pbi->workers_timer);
+  for (int worker_idx = 0; worker_idx < num_workers; ++worker_idx) {
+    const DecWorkerData *const thread_data = pbi->thread_data + worker_idx;
+    add_idle_time(pbi, thread_data->stats_thread, thread_data->busy_time,
+                  elapsed);
+  }
+
   pbi->mb.corrupted = corrupted;
 }
 
@@ -4620,7 +4692,7 @@ static INLINE void reset_frame_buffers(AV1_COMMON *cm) {
   lock_buffer_pool(cm->buffer_pool);
   reset_ref_frame_map(cm);
   assert(cm->cur_frame->ref_count == 1);
-  for (i = 0; i < FRAME_BUFFERS; ++i) {
+  for (i = 0; i < cm->buffer_pool->num_frame_bufs; ++i) {
     // Reset all unreferenced frame buffers. We can also reset cm->cur_frame
     // because we are the sole owner of cm->cur_frame.
     if (frame_bufs[i].ref_count > 0 && &frame_bufs[i] != cm->cur_frame) {
@@ -4951,6 +5023,8 @@ static int read_uncompressed_header(AV1Decoder *pbi,
           }
           unlock_buffer_pool(pool);
           set_planes_to_neutral_grey(seq_params, &buf->buf, 0);
+          buf->decoded_rows = INT_MAX;
+          buf->tiles_decoded = 1;
 
           cm->ref_frame_map[ref_idx] = buf;
           buf->order_hint = order_hint;
@@ -5349,6 +5423,12 @@ uint32_t av1_decode_frame_headers_and_setup(AV1Decoder *pbi,
 
   cm->setup_mi(cm);
 
+  // The motion field is projected from the motion vectors of the reference
+  // frames, which may still be decoding in frame parallel decode.
+  if (cm->allow_ref_frame_mvs) {
+    for (int ref = LAST_FRAME; ref <= ALTREF_FRAME; ++ref)
+      av1_frameworker_wait_tiles(cm->buffer_pool, get_ref_frame_buf(cm, ref));
+  }
   av1_setup_motion_field(cm);
 
   av1_setup_block_planes(xd, cm->seq_params.subsampling_x,
@@ -5384,6 +5464,449 @@ static void setup_frame_info(AV1Decoder *pbi) {
   }
 }
 
+#if !CONFIG_LPF_MASK
+static void post_filter_alloc(AV1PostFilterSync *pf_sync, AV1_COMMON *cm,
+                              int lf_rows, int cdef_rows, int lr_rows,
+                              int cdef_linebuf_stride, int num_workers) {
+  pf_sync->lf_rows = lf_rows;
+  pf_sync->cdef_rows = cdef_rows;
+  pf_sync->lr_rows = lr_rows;
+  pf_sync->cdef_linebuf_stride = cdef_linebuf_stride;
+  pf_sync->num_workers = num_workers;
+#if CONFIG_MULTITHREAD
+  CHECK_MEM_ERROR(cm, pf_sync->mutex_,
+                  aom_malloc(sizeof(*(pf_sync->mutex_))));
+  if (pf_sync->mutex_) pthread_mutex_init(pf_sync->mutex_, NULL);
+
+  CHECK_MEM_ERROR(cm, pf_sync->cond_, aom_malloc(sizeof(*(pf_sync->cond_))));
+  if (pf_sync->cond_) pthread_cond_init(pf_sync->cond_, NULL);
+#endif  // CONFIG_MULTITHREAD
+
+  CHECK_MEM_ERROR(cm, pf_sync->lf_vert_done,
+                  aom_malloc(sizeof(*(pf_sync->lf_vert_done)) * lf_rows));
+  CHECK_MEM_ERROR(cm, pf_sync->lf_done,
+                  aom_malloc(sizeof(*(pf_sync->lf_done)) * lf_rows));
+  CHECK_MEM_ERROR(
+      cm, pf_sync->cdef_boundary_saved,
+      aom_malloc(sizeof(*(pf_sync->cdef_boundary_saved)) * cdef_rows));
+  CHECK_MEM_ERROR(cm, pf_sync->cdef_done,
+                  aom_malloc(sizeof(*(pf_sync->cdef_done)) * cdef_rows));
+  CHECK_MEM_ERROR(cm, pf_sync->lr_done,
+                  aom_malloc(sizeof(*(pf_sync->lr_done)) * lr_rows));
+  for (int j = 0; j < MAX_MB_PLANE; j++) {
+    CHECK_MEM_ERROR(cm, pf_sync->cdef_linebuf[j],
+                    aom_malloc(sizeof(*(pf_sync->cdef_linebuf[j])) *
+                               cdef_rows * 2 * CDEF_VBORDER *
+                               cdef_linebuf_stride));
+  }
+  CHECK_MEM_ERROR(cm, pf_sync->job_queue,
+                  aom_malloc(sizeof(*(pf_sync->job_queue)) *
+                             (lf_rows + cdef_rows + lr_rows)));
+
+  CHECK_MEM_ERROR(cm, pf_sync->workerdata,
+                  aom_calloc(num_workers, sizeof(*(pf_sync->workerdata))));
+  for (int worker_idx = 0; worker_idx < num_workers; ++worker_idx) {
+    PostFilterWorkerData *const pf_data = &pf_sync->workerdata[worker_idx];
+    if (worker_idx < num_workers - 1) {
+      CHECK_MEM_ERROR(cm, pf_data->rst_tmpbuf,
+                      (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+      CHECK_MEM_ERROR(cm, pf_data->rlbs,
+                      aom_malloc(sizeof(RestorationLineBuffers)));
+    }
+  }
+}
+#endif  // !CONFIG_LPF_MASK
+
+// Deallocate the post filter pipeline related mutex and data
+void av1_post_filter_dealloc(AV1PostFilterSync *pf_sync) {
+  if (pf_sync != NULL) {
+#if CONFIG_MULTITHREAD
+    if (pf_sync->mutex_ != NULL) {
+      pthread_mutex_destroy(pf_sync->mutex_);
+      aom_free(pf_sync->mutex_);
+    }
+    if (pf_sync->cond_ != NULL) {
+      pthread_cond_destroy(pf_sync->cond_);
+      aom_free(pf_sync->cond_);
+    }
+#endif  // CONFIG_MULTITHREAD
+    aom_free(pf_sync->lf_vert_done);
+    aom_free(pf_sync->lf_done);
+    aom_free(pf_sync->cdef_boundary_saved);
+    aom_free(pf_sync->cdef_done);
+    aom_free(pf_sync->lr_done);
+    for (int j = 0; j < MAX_MB_PLANE; j++) {
+      aom_free(pf_sync->cdef_linebuf[j]);
+    }
+    aom_free(pf_sync->job_queue);
+    if (pf_sync->workerdata != NULL) {
+      // The last worker shares cm->rst_tmpbuf and cm->rlbs.
+      for (int worker_idx = 0; worker_idx < pf_sync->num_workers - 1;
+           worker_idx++) {
+        aom_free(pf_sync->workerdata[worker_idx].rst_tmpbuf);
+        aom_free(pf_sync->workerdata[worker_idx].rlbs);
+      }
+      aom_free(pf_sync->workerdata);
+    }
+    // clear the structure as the source of this call may be a resize in which
+    // case this call will be followed by an _alloc() which may fail.
+    av1_zero(*pf_sync);
+  }
+}
+
+#if !CONFIG_LPF_MASK
+// Waits until done[row] is set. Every step of the pipeline shares one mutex
+// and condition variable, as the work done per row is large compared to the
+// cost of waking up the waiting workers.
+static INLINE void post_filter_sync_read(AV1PostFilterSync *const pf_sync,
+                                         const int *done, int row) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+  while (!done[row]) pthread_cond_wait(pf_sync->cond_, pf_sync->mutex_);
+  pthread_mutex_unlock(pf_sync->mutex_);
+#else
+  (void)pf_sync;
+  (void)done;
+  (void)row;
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Returns the number of luma rows at the top of the frame which are final,
+// given the progress of the last step of the pipeline.
+static int post_filter_rows_done(const AV1_COMMON *const cm,
+                                 const AV1PostFilterSync *const pf_sync) {
+  if (pf_sync->do_loop_restoration) {
+    int s = 0;
+    while (s < pf_sync->lr_rows && pf_sync->lr_done[s]) ++s;
+    if (s == pf_sync->lr_rows) return cm->height;
+    // Filtering the next stripe temporarily overwrites the RESTORATION_BORDER
+    // chroma rows above it.
+    return AOMMAX(0, s * RESTORATION_PROC_UNIT_SIZE -
+                         RESTORATION_UNIT_OFFSET - 2 * RESTORATION_BORDER);
+  }
+  int f = 0;
+  while (f < pf_sync->cdef_rows && pf_sync->cdef_done[f]) ++f;
+  if (f == pf_sync->cdef_rows) return cm->height;
+  return f * (MI_SIZE_64X64 << MI_SIZE_LOG2);
+}
+
+static INLINE void post_filter_sync_write(AV1Decoder *const pbi,
+                                          AV1PostFilterSync *const pf_sync,
+                                          int *done, int row) {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  done[row] = 1;
+  if (pbi->frame_parallel_decode && done != pf_sync->lf_vert_done &&
+      done != pf_sync->lf_done && done != pf_sync->cdef_boundary_saved) {
+    AV1_COMMON *const cm = &pbi->common;
+    const int rows_done = post_filter_rows_done(cm, pf_sync);
+    if (rows_done > pf_sync->rows_done) {
+      pf_sync->rows_done = rows_done;
+      av1_frameworker_broadcast(cm->buffer_pool, cm->cur_frame, rows_done);
+    }
+  }
+#if CONFIG_MULTITHREAD
+  pthread_cond_broadcast(pf_sync->cond_);
+  pthread_mutex_unlock(pf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+}
+
+// Queues the jobs in an order in which each one only depends on the jobs
+// before it, so that the rows are filtered from top to bottom with all three
+// steps running close behind each other.
+static void enqueue_post_filter_jobs(AV1PostFilterSync *const pf_sync) {
+  AV1PostFilterJobInfo *job_queue = pf_sync->job_queue;
+  int cdef_row = 0, lr_row = 0;
+
+  for (int lf_row = 0; lf_row < pf_sync->lf_rows; ++lf_row) {
+    if (pf_sync->do_loop_filter) {
+      job_queue->stage = POST_FILTER_LOOP_FILTER;
+      job_queue->row = lf_row;
+      job_queue++;
+    }
+    // A CDEF filter block row needs the loop filter done on the 64x64 rows
+    // below it as well, as their top edge filter modifies its last rows.
+    while (cdef_row < pf_sync->cdef_rows &&
+           AOMMIN(pf_sync->lf_rows - 1, (cdef_row + 1) >> 1) <= lf_row) {
+      job_queue->stage = POST_FILTER_CDEF;
+      job_queue->row = cdef_row;
+      job_queue++;
+      cdef_row++;
+    }
+    while (pf_sync->do_loop_restoration && lr_row < pf_sync->lr_rows &&
+           AOMMIN(lr_row, pf_sync->cdef_rows - 1) < cdef_row) {
+      job_queue->stage = POST_FILTER_LOOP_RESTORATION;
+      job_queue->row = lr_row;
+      job_queue++;
+      lr_row++;
+    }
+  }
+  assert(cdef_row == pf_sync->cdef_rows);
+  assert(lr_row == (pf_sync->do_loop_restoration ? pf_sync->lr_rows : 0));
+  pf_sync->jobs_enqueued = (int)(job_queue - pf_sync->job_queue);
+  pf_sync->jobs_dequeued = 0;
+}
+
+static AV1PostFilterJobInfo *get_post_filter_job_info(
+    AV1PostFilterSync *const pf_sync) {
+  AV1PostFilterJobInfo *cur_job_info = NULL;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(pf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  if (pf_sync->jobs_dequeued < pf_sync->jobs_enqueued) {
+    cur_job_info = pf_sync->job_queue + pf_sync->jobs_dequeued;
+    pf_sync->jobs_dequeued++;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(pf_sync->mutex_);
+#endif  // CONFIG_MULTITHREAD
+  return cur_job_info;
+}
+
+static void post_filter_lf_row_dir(AV1_COMMON *const cm, MACROBLOCKD *xd,
+                                   struct macroblockd_plane *planes,
+                                   int mi_row, int dir) {
+  const int num_planes = av1_num_planes(cm);
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (plane == 0 && !(cm->lf.filter_level[0]) && !(cm->lf.filter_level[1]))
+      break;
+    else if (plane == 1 && !(cm->lf.filter_level_u))
+      continue;
+    else if (plane == 2 && !(cm->lf.filter_level_v))
+      continue;
+
+    for (int mi_col = 0; mi_col < cm->mi_cols; mi_col += MAX_MIB_SIZE) {
+      av1_setup_dst_planes(planes, cm->seq_params.sb_size, &cm->cur_frame->buf,
+                           mi_row, mi_col, plane, plane + 1);
+      if (dir == 0)
+        av1_filter_block_plane_vert(cm, xd, plane, &planes[plane], mi_row,
+                                    mi_col);
+      else
+        av1_filter_block_plane_horz(cm, xd, plane, &planes[plane], mi_row,
+                                    mi_col);
+    }
+  }
+}
+
+static void post_filter_lr_row(AV1Decoder *const pbi,
+                               PostFilterWorkerData *const pf_data,
+                               int lr_row) {
+  AV1_COMMON *const cm = &pbi->common;
+  const int num_planes = av1_num_planes(cm);
+  const int row_start =
+      lr_row * RESTORATION_PROC_UNIT_SIZE - RESTORATION_UNIT_OFFSET;
+  const int row_end = row_start + RESTORATION_PROC_UNIT_SIZE;
+
+  av1_loop_restoration_save_boundary_lines_rows(&cm->cur_frame->buf, cm, 1,
+                                                row_start, row_end);
+  for (int plane = 0; plane < num_planes; ++plane) {
+    if (cm->rst_info[plane].frame_restoration_type == RESTORE_NONE) continue;
+    const int is_uv = plane > 0;
+    const int ss_y = is_uv && cm->seq_params.subsampling_y;
+    const int plane_height = cm->cur_frame->buf.crop_heights[is_uv];
+    const int plane_row_start = AOMMAX(0, row_start >> ss_y);
+    const int plane_row_end = AOMMIN(plane_height, row_end >> ss_y);
+    if (plane_row_start >= plane_row_end) continue;
+    av1_loop_restoration_filter_rows(&pbi->lr_ctxt, plane, plane_row_start,
+                                     plane_row_end, pf_data->rst_tmpbuf,
+                                     pf_data->rlbs);
+  }
+}
+
+// Row based pipelined post filter hook
+static int post_filter_row_worker(void *arg1, void *arg2) {
+  AV1PostFilterSync *const pf_sync = (AV1PostFilterSync *)arg1;
+  PostFilterWorkerData *const pf_data = (PostFilterWorkerData *)arg2;
+  AV1Decoder *const pbi = pf_data->pbi;
+  AV1_COMMON *const cm = &pbi->common;
+  MACROBLOCKD *const xd = &pbi->mb;
+  AV1PostFilterJobInfo *cur_job_info;
+  struct aom_usec_timer timer;
+
+  while ((cur_job_info = get_post_filter_job_info(pf_sync)) != NULL) {
+    const int row = cur_job_info->row;
+    switch (cur_job_info->stage) {
+      case POST_FILTER_LOOP_FILTER: {
+        const int mi_row = row << MAX_MIB_SIZE_LOG2;
+        aom_usec_timer_start(&timer);
+        post_filter_lf_row_dir(cm, xd, pf_data->planes, mi_row, 0);
+        add_stage_time(pbi, pf_data->stats_thread, AOM_DEC_STAGE_LOOP_FILTER,
+                       &timer);
+        post_filter_sync_write(pbi, pf_sync, pf_sync->lf_vert_done, row);
+        // The horizontal edges at the top of this row modify the pixels at
+        // the bottom of the row above, which must be filtered vertically
+        // first.
+        if (row > 0)
+          post_filter_sync_read(pf_sync, pf_sync->lf_vert_done, row - 1);
+        aom_usec_timer_start(&timer);
+        post_filter_lf_row_dir(cm, xd, pf_data->planes, mi_row, 1);
+        add_stage_time(pbi, pf_data->stats_thread, AOM_DEC_STAGE_LOOP_FILTER,
+                       &timer);
+        post_filter_sync_write(pbi, pf_sync, pf_sync->lf_done, row);
+        break;
+      }
+      case POST_FILTER_CDEF: {
+        post_filter_sync_read(pf_sync, pf_sync->lf_done, row >> 1);
+        post_filter_sync_read(pf_sync, pf_sync->lf_done,
+                              AOMMIN(pf_sync->lf_rows - 1, (row + 1) >> 1));
+        if (row > 0)
+          post_filter_sync_read(pf_sync, pf_sync->cdef_boundary_saved,
+                                row - 1);
+        aom_usec_timer_start(&timer);
+        if (pf_sync->do_loop_restoration) {
+          const int fb_size = MI_SIZE_64X64 << MI_SIZE_LOG2;
+          av1_loop_restoration_save_boundary_lines_rows(
+              &cm->cur_frame->buf, cm, 0, row * fb_size, (row + 1) * fb_size);
+        }
+        if (pf_sync->do_cdef)
+          av1_cdef_save_fb_row_boundary(cm, xd, pf_sync->cdef_linebuf, row);
+        post_filter_sync_write(pbi, pf_sync, pf_sync->cdef_boundary_saved,
+                               row);
+        if (pf_sync->do_cdef)
+          av1_cdef_fb_row(cm, xd, pf_sync->cdef_linebuf, row);
+        add_stage_time(pbi, pf_data->stats_thread, AOM_DEC_STAGE_CDEF, &timer);
+        post_filter_sync_write(pbi, pf_sync, pf_sync->cdef_done, row);
+        break;
+      }
+      case POST_FILTER_LOOP_RESTORATION: {
+        // Stripes are filtered in order: each one temporarily overwrites the
+        // rows next to it in the neighbouring stripes.
+        if (row > 0) post_filter_sync_read(pf_sync, pf_sync->lr_done, row - 1);
+        post_filter_sync_read(pf_sync, pf_sync->cdef_done,
+                              AOMMIN(row, pf_sync->cdef_rows - 1));
+        aom_usec_timer_start(&timer);
+        post_filter_lr_row(pbi, pf_data, row);
+        add_stage_time(pbi, pf_data->stats_thread,
+                       AOM_DEC_STAGE_LOOP_RESTORATION, &timer);
+        post_filter_sync_write(pbi, pf_sync, pf_sync->lr_done, row);
+        break;
+      }
+      default: assert(0);
+    }
+  }
+  return 1;
+}
+
+// Runs the loop filter, CDEF and loop restoration as one pipeline over the
+// rows of the frame. Not used with superres, which needs the whole frame to be
+// through CDEF before it is upscaled for loop restoration. Single threaded
+// decoding keeps the frame by frame filters, except in frame parallel decode,
+// where the pipeline lets the next frame start on the rows already filtered.
+static void post_filter_frame(AV1Decoder *pbi) {
+  AV1_COMMON *const cm = &pbi->common;
+  MACROBLOCKD *const xd = &pbi->mb;
+  AV1PostFilterSync *const pf_sync = &pbi->post_filter_sync;
+  const int num_planes = av1_num_planes(cm);
+  const int num_workers = pbi->num_workers > 1 ? pbi->num_workers : 1;
+  const int lf_rows = (cm->mi_rows + MAX_MIB_SIZE - 1) >> MAX_MIB_SIZE_LOG2;
+  const int cdef_rows = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
+  const int lr_rows =
+      (cm->height + RESTORATION_UNIT_OFFSET + RESTORATION_PROC_UNIT_SIZE - 1) /
+      RESTORATION_PROC_UNIT_SIZE;
+  const int cdef_linebuf_stride = av1_cdef_linebuf_stride(cm);
+  const int do_loop_filter = cm->lf.filter_level[0] || cm->lf.filter_level[1];
+  const int do_loop_restoration =
+      cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
+      cm->rst_info[2].frame_restoration_type != RESTORE_NONE;
+  const int do_cdef =
+      !cm->skip_loop_filter && !cm->coded_lossless &&
+      (cm->cdef_info.cdef_bits || cm->cdef_info.cdef_strengths[0] ||
+       cm->cdef_info.cdef_uv_strengths[0]);
+
+  if (!frame_has_post_filter(cm)) return;
+
+  if (pf_sync->lf_rows != lf_rows || pf_sync->cdef_rows != cdef_rows ||
+      pf_sync->lr_rows != lr_rows ||
+      pf_sync->cdef_linebuf_stride != cdef_linebuf_stride ||
+      pf_sync->num_workers != num_workers) {
+    av1_post_filter_dealloc(pf_sync);
+    post_filter_alloc(pf_sync, cm, lf_rows, cdef_rows, lr_rows,
+                      cdef_linebuf_stride, num_workers);
+  }
+  memset(pf_sync->lf_vert_done, 0, sizeof(*pf_sync->lf_vert_done) * lf_rows);
+  memset(pf_sync->lf_done, 0, sizeof(*pf_sync->lf_done) * lf_rows);
+  memset(pf_sync->cdef_boundary_saved, 0,
+         sizeof(*pf_sync->cdef_boundary_saved) * cdef_rows);
+  memset(pf_sync->cdef_done, 0, sizeof(*pf_sync->cdef_done) * cdef_rows);
+  memset(pf_sync->lr_done, 0, sizeof(*pf_sync->lr_done) * lr_rows);
+  pf_sync->rows_done = 0;
+  pf_sync->do_loop_filter = do_loop_filter;
+  pf_sync->do_cdef = do_cdef;
+  pf_sync->do_loop_restoration = do_loop_restoration;
+
+  if (pf_sync->do_loop_filter) {
+    av1_loop_filter_frame_init(cm, 0, num_planes);
+  } else {
+    // Nothing to deblock: mark the loop filter rows as done up front.
+    for (int i = 0; i < lf_rows; ++i) {
+      pf_sync->lf_vert_done[i] = 1;
+      pf_sync->lf_done[i] = 1;
+    }
+  }
+  av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, &cm->cur_frame->buf,
+                       0, 0, 0, num_planes);
+  if (do_loop_restoration) {
+    av1_loop_restoration_filter_rows_init(&pbi->lr_ctxt, &cm->cur_frame->buf,
+                                          cm, num_planes);
+  }
+  enqueue_post_filter_jobs(pf_sync);
+
+  for (int i = 0; i < num_workers; ++i) {
+    PostFilterWorkerData *const pf_data = &pf_sync->workerdata[i];
+    pf_data->pbi = pbi;
+    av1_zero(pf_data->planes);
+    for (int plane = 0; plane < num_planes; ++plane) {
+      pf_data->planes[plane].subsampling_x = xd->plane[plane].subsampling_x;
+      pf_data->planes[plane].subsampling_y = xd->plane[plane].subsampling_y;
+    }
+    if (i == num_workers - 1) {
+      pf_data->rst_tmpbuf = cm->rst_tmpbuf;
+      pf_data->rlbs = cm->rlbs;
+    }
+  }
+
+  if (num_workers == 1) {
+    pf_sync->workerdata[0].stats_thread = 0;
+    post_filter_row_worker(pf_sync, &pf_sync->workerdata[0]);
+    return;
+  }
+
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  aom_usec_timer_start(&pbi->workers_timer);
+  // The last worker runs on this thread, once the others are launched.
+  for (int i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &pbi->tile_workers[i];
+    PostFilterWorkerData *const pf_data = &pf_sync->workerdata[i];
+    worker->hook = post_filter_row_worker;
+    worker->data1 = pf_sync;
+    worker->data2 = pf_data;
+    pf_data->stats_thread = get_stats_thread(i, num_workers);
+    pf_data->busy_time = get_busy_time(pbi, pf_data->stats_thread);
+
+    // Start post filtering
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  // Wait till all rows are finished
+  for (int i = 0; i < num_workers; ++i) {
+    winterface->sync(&pbi->tile_workers[i]);
+  }
+
+  aom_usec_timer_mark(&pbi->workers_timer);
+  const uint64_t elapsed = aom_usec_timer_elapsed(&pbi->workers_timer);
+  for (int i = 0; i < num_workers; ++i) {
+    const PostFilterWorkerData *const pf_data = &pf_sync->workerdata[i];
+    add_idle_time(pbi, pf_data->stats_thread, pf_data->busy_time, elapsed);
+  }
+}
+#endif  // !CONFIG_LPF_MASK
+
 void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                     const uint8_t *data_end,
                                     const uint8_t **p_data_end, int start_tile,
@@ -5394,19 +5917,37 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
 
   if (initialize_flag) setup_frame_info(pbi);
   const int num_planes = av1_num_planes(cm);
+
+  // Without the frame end update of the CDFs, everything the next frame parses
+  // against is final after the header. In frame parallel decode, the next
+  // frame can then start while the tiles of this frame are decoded, waiting
+  // on the rows, motion vectors and segmentation map it reads. Superres
+  // reallocates the frame buffer during upscaling, so that case waits for the
+  // end of the frame.
+  if (initialize_flag && pbi->frame_parallel_decode &&
+      cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_DISABLED &&
+      !av1_superres_scaled(cm)) {
+    cm->cur_frame->frame_context = *cm->fc;
+    pbi->decoding_first_frame = 0;
+    av1_frameworker_signal_context_ready(pbi);
+  }
 #if CONFIG_LPF_MASK
   av1_loop_filter_frame_init(cm, 0, num_planes);
 #endif
 
   if (pbi->max_threads > 1 && !(cm->large_scale_tile && !pbi->ext_tile_debug) &&
-      pbi->row_mt)
+      pbi->row_mt) {
     *p_data_end =
         decode_tiles_row_mt(pbi, data, data_end, start_tile, end_tile);
-  else if (pbi->max_threads > 1 && tile_count_tg > 1 &&
-           !(cm->large_scale_tile && !pbi->ext_tile_debug))
+  } else if (pbi->max_threads > 1 && tile_count_tg > 1 &&
+             !(cm->large_scale_tile && !pbi->ext_tile_debug)) {
     *p_data_end = decode_tiles_mt(pbi, data, data_end, start_tile, end_tile);
-  else
+  } else {
+    struct aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
     *p_data_end = decode_tiles(pbi, data, data_end, start_tile, end_tile);
+    add_stage_time(pbi, 0, AOM_DEC_STAGE_TILE_DECODE, &timer);
+  }
 
   // If the bit stream is monochrome, set the U and V buffers to a constant.
   if (num_planes < 3) {
@@ -5417,8 +5958,44 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     return;
   }
 
+  if (!xd->corrupted) {
+    if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
+      assert(cm->context_update_tile_id < pbi->allocated_tiles);
+      *cm->fc = pbi->tile_data[cm->context_update_tile_id].tctx;
+      av1_reset_cdf_symbol_counters(cm->fc);
+    }
+  } else {
+    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
+                       "Decode failed. Frame data is corrupted.");
+  }
+
+  if (!cm->large_scale_tile) {
+    cm->cur_frame->frame_context = *cm->fc;
+  }
+
+  // Everything the next frame parses against is final now, so in frame
+  // parallel decode it can start while this frame is being filtered, unless
+  // it already started after the header.
+  if (pbi->frame_parallel_decode) {
+    av1_frameworker_signal_tiles_decoded(cm->buffer_pool, cm->cur_frame);
+    if (!av1_superres_scaled(cm)) {
+      pbi->decoding_first_frame = 0;
+      av1_frameworker_signal_context_ready(pbi);
+    }
+  }
+
+#if !CONFIG_LPF_MASK
+  if (!cm->allow_intrabc && !cm->single_tile_decoding &&
+      !av1_superres_scaled(cm) &&
+      (pbi->num_workers > 1 || pbi->frame_parallel_decode)) {
+    post_filter_frame(pbi);
+  } else
+#endif  // !CONFIG_LPF_MASK
   if (!cm->allow_intrabc && !cm->single_tile_decoding) {
+    // The multithreaded filters below are timed as a whole on this thread.
+    struct aom_usec_timer timer;
     if (cm->lf.filter_level[0] || cm->lf.filter_level[1]) {
+      aom_usec_timer_start(&timer);
       if (pbi->num_workers > 1) {
         av1_loop_filter_frame_mt(
             &cm->cur_frame->buf, cm, &pbi->mb, 0, num_planes, 0,
@@ -5433,6 +6010,7 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
 #endif
                               0, num_planes, 0);
       }
+      add_stage_time(pbi, 0, AOM_DEC_STAGE_LOOP_FILTER, &timer);
     }
 
     const int do_loop_restoration =
@@ -5447,15 +6025,28 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
     const int optimized_loop_restoration = !do_cdef && !do_superres;
 
     if (!optimized_loop_restoration) {
+      aom_usec_timer_start(&timer);
       if (do_loop_restoration)
         av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
                                                  cm, 0);
 
-      if (do_cdef) av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->mb);
+      if (do_cdef) {
+        if (pbi->num_workers > 1) {
+          av1_cdef_frame_mt(&pbi->common.cur_frame->buf, cm, &pbi->mb,
+                            pbi->tile_workers, pbi->num_workers,
+                            &pbi->cdef_row_sync);
+        } else {
+          av1_cdef_frame(&pbi->common.cur_frame->buf, cm, &pbi->mb);
+        }
+      }
+      add_stage_time(pbi, 0, AOM_DEC_STAGE_CDEF, &timer);
 
+      aom_usec_timer_start(&timer);
       superres_post_decode(pbi);
+      add_stage_time(pbi, 0, AOM_DEC_STAGE_SUPERRES, &timer);
 
       if (do_loop_restoration) {
+        aom_usec_timer_start(&timer);
         av1_loop_restoration_save_boundary_lines(&pbi->common.cur_frame->buf,
                                                  cm, 1);
         if (pbi->num_workers > 1) {
@@ -5468,11 +6059,13 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                             cm, optimized_loop_restoration,
                                             &pbi->lr_ctxt);
         }
+        add_stage_time(pbi, 0, AOM_DEC_STAGE_LOOP_RESTORATION, &timer);
       }
     } else {
       // In no cdef and no superres case. Provide an optimized version of
       // loop_restoration_filter.
       if (do_loop_restoration) {
+        aom_usec_timer_start(&timer);
         if (pbi->num_workers > 1) {
           av1_loop_restoration_filter_frame_mt(
               (YV12_BUFFER_CONFIG *)xd->cur_buf, cm, optimized_loop_restoration,
@@ -5483,6 +6076,7 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
                                             cm, optimized_loop_restoration,
                                             &pbi->lr_ctxt);
         }
+        add_stage_time(pbi, 0, AOM_DEC_STAGE_LOOP_RESTORATION, &timer);
       }
     }
   }
@@ -5490,25 +6084,9 @@ void av1_decode_tg_tiles_and_wrapup(AV1Decoder *pbi, const uint8_t *data,
   av1_zero_array(cm->lf.lfm, cm->lf.lfm_num);
 #endif
 
-  if (!xd->corrupted) {
-    if (cm->refresh_frame_context == REFRESH_FRAME_CONTEXT_BACKWARD) {
-      assert(cm->context_update_tile_id < pbi->allocated_tiles);
-      *cm->fc = pbi->tile_data[cm->context_update_tile_id].tctx;
-      av1_reset_cdf_symbol_counters(cm->fc);
-    }
-  } else {
-    aom_internal_error(&cm->error, AOM_CODEC_CORRUPT_FRAME,
-                       "Decode failed. Frame data is corrupted.");
-  }
-
 #if CONFIG_INSPECTION
   if (pbi->inspect_cb != NULL) {
     (*pbi->inspect_cb)(pbi, pbi->inspect_ctx);
   }
 #endif
-
-  // Non frame parallel update frame context here.
-  if (!cm->large_scale_tile) {
-    cm->cur_frame->frame_context = *cm->fc;
-  }
 }
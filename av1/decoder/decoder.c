@@ -191,11 +191,13 @@ void av1_decoder_remove(AV1Decoder *pbi) {
     av1_dec_row_mt_dealloc(&tile_data->dec_row_mt_sync);
   }
   aom_free(pbi->tile_data);
+  av1_post_filter_dealloc(&pbi->post_filter_sync);
   aom_free(pbi->tile_workers);
 
   if (pbi->num_workers > 0) {
     av1_loop_filter_dealloc(&pbi->lf_row_sync);
     av1_loop_restoration_dealloc(&pbi->lr_row_sync, pbi->num_workers);
+    av1_cdef_dealloc(&pbi->cdef_row_sync);
     av1_dealloc_dec_jobs(&pbi->tile_mt_info);
   }
 
@@ -455,6 +457,11 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
     cm->error.error_code = AOM_CODEC_MEM_ERROR;
     return 1;
   }
+  // The buffer decoded by this call, unless it turns out to be a
+  // show_existing_frame. Other frame workers may wait on its progress.
+  RefCntBuffer *const new_frame = cm->cur_frame;
+  new_frame->decoded_rows = 0;
+  new_frame->tiles_decoded = 0;
 
   if (!pbi->camera_frame_header_ready) pbi->hold_ref_buf = 0;
 
@@ -474,6 +481,8 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
       winterface->sync(&pbi->tile_workers[i]);
     }
 
+    if (cm->cur_frame == new_frame)
+      av1_frameworker_broadcast(cm->buffer_pool, new_frame, INT_MAX);
     release_frame_buffers(pbi);
     aom_clear_system_state();
     return -1;
@@ -484,6 +493,11 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
   int frame_decoded =
       aom_decode_frame_from_obus(pbi, source, source + size, psource);
 
+  // Unblock the frame workers predicting from this frame, whether or not it
+  // decoded successfully.
+  if (cm->cur_frame == new_frame)
+    av1_frameworker_broadcast(cm->buffer_pool, new_frame, INT_MAX);
+
   if (frame_decoded < 0) {
     assert(cm->error.error_code != AOM_CODEC_OK);
     release_frame_buffers(pbi);
@@ -506,6 +520,7 @@ int av1_receive_compressed_data(AV1Decoder *pbi, size_t size,
 
   if (frame_decoded) {
     pbi->decoding_first_frame = 0;
+    ++pbi->frame_stats.frames;
   }
 
   if (cm->error.error_code != AOM_CODEC_OK) {
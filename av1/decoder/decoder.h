@@ -15,7 +15,9 @@
 #include "config/aom_config.h"
 
 #include "aom/aom_codec.h"
+#include "aom/aomdx.h"
 #include "aom_dsp/bitreader.h"
+#include "aom_ports/aom_timer.h"
 #include "aom_scale/yv12config.h"
 #include "aom_util/aom_thread.h"
 
@@ -118,6 +120,63 @@ typedef struct AV1DecRowMTInfo {
   int row_mt_exit;
 } AV1DecRowMTInfo;
 
+typedef enum {
+  POST_FILTER_LOOP_FILTER,
+  POST_FILTER_CDEF,
+  POST_FILTER_LOOP_RESTORATION,
+} POST_FILTER_STAGE;
+
+typedef struct AV1PostFilterJobInfo {
+  POST_FILTER_STAGE stage;
+  int row;
+} AV1PostFilterJobInfo;
+
+typedef struct PostFilterWorkerData {
+  struct AV1Decoder *pbi;
+  struct macroblockd_plane planes[MAX_MB_PLANE];
+  int32_t *rst_tmpbuf;
+  RestorationLineBuffers *rlbs;
+  // See DecWorkerData.
+  int stats_thread;
+  uint64_t busy_time;
+} PostFilterWorkerData;
+
+// Row pipelined deblocking, CDEF and loop restoration. The loop filter runs on
+// 128 pixel superblock rows, CDEF on 64 pixel filter block rows and loop
+// restoration on 64 pixel processing stripes, so that a row can be in CDEF or
+// loop restoration while the rows below it are still being deblocked.
+typedef struct AV1PostFilterSyncData {
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *mutex_;
+  pthread_cond_t *cond_;
+#endif
+  int lf_rows;
+  int cdef_rows;
+  int lr_rows;
+  // Per row progress of each step, protected by mutex_.
+  int *lf_vert_done;
+  int *lf_done;
+  int *cdef_boundary_saved;
+  int *cdef_done;
+  int *lr_done;
+  // Luma rows of the frame which are final.
+  int rows_done;
+
+  int do_loop_filter;
+  int do_cdef;
+  int do_loop_restoration;
+  // Unfiltered lines around the CDEF filter block row boundaries.
+  uint16_t *cdef_linebuf[MAX_MB_PLANE];
+  int cdef_linebuf_stride;
+
+  PostFilterWorkerData *workerdata;
+  int num_workers;
+
+  AV1PostFilterJobInfo *job_queue;
+  int jobs_enqueued;
+  int jobs_dequeued;
+} AV1PostFilterSync;
+
 typedef struct TileDataDec {
   TileInfo tile_info;
   aom_reader bit_reader;
@@ -164,6 +223,8 @@ typedef struct AV1Decoder {
   AVxWorker lf_worker;
   AV1LfSync lf_row_sync;
   AV1LrSync lr_row_sync;
+  AV1CdefSync cdef_row_sync;
+  AV1PostFilterSync post_filter_sync;
   AV1LrStruct lr_ctxt;
   AVxWorker *tile_workers;
   int num_workers;
@@ -246,6 +307,17 @@ typedef struct AV1Decoder {
 #endif
 
   AV1DecRowMTInfo frame_row_mt_info;
+
+  // Frame parallel decode: the FrameWorker this decoder belongs to, and
+  // whether several FrameWorkers decode consecutive frames concurrently.
+  AVxWorker *frame_worker_owner;
+  int frame_parallel_decode;
+
+  // Time spent in each stage by the last call to aom_codec_decode(), reported
+  // by AV1D_GET_FRAME_STATS, and the timer of the tile workers from launch to
+  // sync, which gives their idle time.
+  aom_dec_frame_stats_t frame_stats;
+  struct aom_usec_timer workers_timer;
 } AV1Decoder;
 
 // Returns 0 on success. Sets pbi->common.error.error_code to a nonzero error
@@ -276,8 +348,51 @@ void av1_dealloc_dec_jobs(struct AV1DecTileMTData *tile_mt_info);
 
 void av1_dec_row_mt_dealloc(AV1DecRowMTSync *dec_row_mt_sync);
 
+void av1_post_filter_dealloc(AV1PostFilterSync *pf_sync);
+
 void av1_dec_free_cb_buf(AV1Decoder *pbi);
 
+// Returns the entry of frame_stats.thread_time for worker 'worker_idx' of
+// 'num_workers', or -1 if it is past the last entry. The last worker runs on
+// the decoding thread.
+static INLINE int get_stats_thread(int worker_idx, int num_workers) {
+  if (worker_idx == num_workers - 1) return 0;
+  return worker_idx + 1 < AOM_DEC_STATS_MAX_THREADS ? worker_idx + 1 : -1;
+}
+
+// Adds the time since 'timer' was started to 'stage' of 'stats_thread'.
+static INLINE void add_stage_time(AV1Decoder *pbi, int stats_thread,
+                                  aom_dec_stage_t stage,
+                                  struct aom_usec_timer *timer) {
+  aom_usec_timer_mark(timer);
+  if (stats_thread < 0) return;
+  pbi->frame_stats.thread_time[stats_thread][stage] +=
+      aom_usec_timer_elapsed(timer);
+}
+
+// Returns the time 'stats_thread' spent working in the current frame stats.
+static INLINE uint64_t get_busy_time(const AV1Decoder *pbi, int stats_thread) {
+  uint64_t busy_time = 0;
+  if (stats_thread < 0) return 0;
+  for (int i = 0; i < AOM_DEC_STAGES; ++i) {
+    if (i != AOM_DEC_STAGE_IDLE)
+      busy_time += pbi->frame_stats.thread_time[stats_thread][i];
+  }
+  return busy_time;
+}
+
+// Adds the time 'stats_thread' did not spend working since 'busy_time' was
+// read, out of the 'elapsed' time the tile workers ran, to its idle time.
+static INLINE void add_idle_time(AV1Decoder *pbi, int stats_thread,
+                                 uint64_t busy_time, uint64_t elapsed) {
+  if (stats_thread < 0) return;
+  busy_time = get_busy_time(pbi, stats_thread) - busy_time;
+  if (elapsed > busy_time) {
+    pbi->frame_stats.thread_time[stats_thread][AOM_DEC_STAGE_IDLE] +=
+        elapsed - busy_time;
+  }
+}
+
 static INLINE void decrease_ref_count(RefCntBuffer *const buf,
                                       BufferPool *const pool) {
   if (buf != NULL) {
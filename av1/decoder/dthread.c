@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2016, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+
+#include "config/aom_config.h"
+
+#include "av1/common/onyxc_int.h"
+#include "av1/decoder/decoder.h"
+#include "av1/decoder/dthread.h"
+
+void av1_frameworker_wait(BufferPool *pool, const RefCntBuffer *ref_buf,
+                          int row) {
+#if CONFIG_MULTITHREAD
+  if (!pool->frame_parallel_decode || ref_buf == NULL) return;
+  pthread_mutex_lock(&pool->progress_mutex);
+  while (ref_buf->decoded_rows < row)
+    pthread_cond_wait(&pool->progress_cond, &pool->progress_mutex);
+  pthread_mutex_unlock(&pool->progress_mutex);
+#else
+  (void)pool;
+  (void)ref_buf;
+  (void)row;
+#endif
+}
+
+void av1_frameworker_broadcast(BufferPool *pool, RefCntBuffer *buf, int row) {
+  if (buf == NULL) return;
+#if CONFIG_MULTITHREAD
+  if (pool->frame_parallel_decode) {
+    pthread_mutex_lock(&pool->progress_mutex);
+    buf->decoded_rows = row;
+    if (row == INT_MAX) buf->tiles_decoded = 1;
+    pthread_cond_broadcast(&pool->progress_cond);
+    pthread_mutex_unlock(&pool->progress_mutex);
+    return;
+  }
+#else
+  (void)pool;
+#endif
+  buf->decoded_rows = row;
+  if (row == INT_MAX) buf->tiles_decoded = 1;
+}
+
+void av1_frameworker_wait_tiles(BufferPool *pool, const RefCntBuffer *ref_buf) {
+#if CONFIG_MULTITHREAD
+  if (!pool->frame_parallel_decode || ref_buf == NULL) return;
+  pthread_mutex_lock(&pool->progress_mutex);
+  while (!ref_buf->tiles_decoded)
+    pthread_cond_wait(&pool->progress_cond, &pool->progress_mutex);
+  pthread_mutex_unlock(&pool->progress_mutex);
+#else
+  (void)pool;
+  (void)ref_buf;
+#endif
+}
+
+void av1_frameworker_signal_tiles_decoded(BufferPool *pool,
+                                          RefCntBuffer *buf) {
+#if CONFIG_MULTITHREAD
+  if (pool->frame_parallel_decode) {
+    pthread_mutex_lock(&pool->progress_mutex);
+    buf->tiles_decoded = 1;
+    pthread_cond_broadcast(&pool->progress_cond);
+    pthread_mutex_unlock(&pool->progress_mutex);
+    return;
+  }
+#else
+  (void)pool;
+#endif
+  buf->tiles_decoded = 1;
+}
+
+void av1_frameworker_signal_context_ready(AV1Decoder *pbi) {
+  FrameWorkerData *const frame_worker_data =
+      (FrameWorkerData *)pbi->frame_worker_owner->data1;
+  AV1_COMMON *const cm = &pbi->common;
+  BufferPool *const pool = cm->buffer_pool;
+
+  if (frame_worker_data->frame_context_ready) return;
+
+  // While the current frame holds cm->next_ref_frame_map, that is the map the
+  // next frame will see once this frame is swapped in.
+  RefCntBuffer *const *const ref_frame_map =
+      pbi->hold_ref_buf ? cm->next_ref_frame_map : cm->ref_frame_map;
+  lock_buffer_pool(pool);
+  for (int i = 0; i < REF_FRAMES; ++i) {
+    frame_worker_data->ref_frame_map[i] = ref_frame_map[i];
+    if (ref_frame_map[i] != NULL) ++ref_frame_map[i]->ref_count;
+  }
+  unlock_buffer_pool(pool);
+  frame_worker_data->need_resync = pbi->need_resync;
+  frame_worker_data->decoding_first_frame = pbi->decoding_first_frame;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&frame_worker_data->stats_mutex);
+  frame_worker_data->frame_context_ready = 1;
+  pthread_cond_signal(&frame_worker_data->stats_cond);
+  pthread_mutex_unlock(&frame_worker_data->stats_mutex);
+#else
+  frame_worker_data->frame_context_ready = 1;
+#endif
+}
+
+void av1_frameworker_copy_context(AV1Decoder *dst,
+                                  AVxWorker *const src_worker) {
+  FrameWorkerData *const src_worker_data = (FrameWorkerData *)src_worker->data1;
+  const AV1Decoder *const src = src_worker_data->pbi;
+  AV1_COMMON *const dst_cm = &dst->common;
+  const AV1_COMMON *const src_cm = &src->common;
+  BufferPool *const pool = dst_cm->buffer_pool;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(&src_worker_data->stats_mutex);
+  while (!src_worker_data->frame_context_ready)
+    pthread_cond_wait(&src_worker_data->stats_cond,
+                      &src_worker_data->stats_mutex);
+  pthread_mutex_unlock(&src_worker_data->stats_mutex);
+#endif
+  assert(src_worker_data->frame_context_ready);
+
+  lock_buffer_pool(pool);
+  for (int i = 0; i < REF_FRAMES; ++i) {
+    decrease_ref_count(dst_cm->ref_frame_map[i], pool);
+    dst_cm->ref_frame_map[i] = src_worker_data->ref_frame_map[i];
+    src_worker_data->ref_frame_map[i] = NULL;
+  }
+  unlock_buffer_pool(pool);
+
+  dst->need_resync = src_worker_data->need_resync;
+  dst->decoding_first_frame = src_worker_data->decoding_first_frame;
+  dst->sequence_header_ready = src->sequence_header_ready;
+  dst->sequence_header_changed = src->sequence_header_changed;
+  dst->current_operating_point = src->current_operating_point;
+
+  dst_cm->seq_params = src_cm->seq_params;
+  dst_cm->timing_info_present = src_cm->timing_info_present;
+  dst_cm->timing_info = src_cm->timing_info;
+  dst_cm->buffer_model = src_cm->buffer_model;
+  memcpy(dst_cm->op_params, src_cm->op_params, sizeof(dst_cm->op_params));
+  dst_cm->number_temporal_layers = src_cm->number_temporal_layers;
+  dst_cm->number_spatial_layers = src_cm->number_spatial_layers;
+  dst_cm->current_frame = src_cm->current_frame;
+  dst_cm->current_frame_id = src_cm->current_frame_id;
+  memcpy(dst_cm->ref_frame_id, src_cm->ref_frame_id,
+         sizeof(dst_cm->ref_frame_id));
+  memcpy(dst_cm->valid_for_referencing, src_cm->valid_for_referencing,
+         sizeof(dst_cm->valid_for_referencing));
+  *dst_cm->default_frame_context = *src_cm->default_frame_context;
+}
@@ -16,6 +16,7 @@
 
 #include "aom_util/aom_thread.h"
 #include "aom/internal/aom_codec_internal.h"
+#include "av1/common/enums.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -23,12 +24,18 @@ extern "C" {
 
 struct AV1Common;
 struct AV1Decoder;
+struct BufferPool;
+struct RefCntBuffer;
 struct ThreadData;
 
 typedef struct DecWorkerData {
   struct ThreadData *td;
   const uint8_t *data_end;
   struct aom_internal_error_info error_info;
+  // Entry of the frame stats the worker's thread reports to (-1 for none),
+  // and its busy time when the worker was launched.
+  int stats_thread;
+  uint64_t busy_time;
 } DecWorkerData;
 
 // WorkerData for the FrameWorker thread. It contains all the information of
@@ -43,8 +50,57 @@ typedef struct FrameWorkerData {
   int received_frame;
   int frame_context_ready;  // Current frame's context is ready to read.
   int frame_decoded;        // Finished decoding current frame.
+
+  // Frame parallel decode only.
+  // Private copy of the frame data, which has to outlive the
+  // aom_codec_decode() call that submitted it.
+  uint8_t *scratch_buffer;
+  size_t scratch_buffer_size;
+  // Whether this frame is the last one of its temporal unit.
+  int last_in_temporal_unit;
+  // State the next frame starts from, captured when frame_context_ready is
+  // set. The references in ref_frame_map are handed over to the next frame.
+  struct RefCntBuffer *ref_frame_map[REF_FRAMES];
+  int need_resync;
+  int decoding_first_frame;
+  // Memory usage counter of the decoder instance, charged for allocations on
+  // the frame worker thread.
+  struct aom_mem_usage *mem_usage;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t stats_mutex;
+  pthread_cond_t stats_cond;
+#endif
 } FrameWorkerData;
 
+// Waits until the first 'row' luma rows of 'ref_buf' have been decoded.
+void av1_frameworker_wait(struct BufferPool *pool,
+                          const struct RefCntBuffer *ref_buf, int row);
+
+// Marks the first 'row' luma rows of 'buf' as decoded and wakes up the frame
+// workers waiting on them. Pass INT_MAX once the whole frame is done, which
+// also marks its tiles as decoded.
+void av1_frameworker_broadcast(struct BufferPool *pool,
+                               struct RefCntBuffer *buf, int row);
+
+// Waits until the tiles of 'ref_buf' have been decoded, so that its motion
+// vectors and segmentation map are final.
+void av1_frameworker_wait_tiles(struct BufferPool *pool,
+                                const struct RefCntBuffer *ref_buf);
+
+// Marks the tiles of 'buf' as decoded and wakes up the frame workers waiting
+// on them.
+void av1_frameworker_signal_tiles_decoded(struct BufferPool *pool,
+                                          struct RefCntBuffer *buf);
+
+// Captures the state the next frame depends on and sets frame_context_ready.
+// Does nothing if the context of the current frame was already signalled.
+void av1_frameworker_signal_context_ready(struct AV1Decoder *pbi);
+
+// Waits for the context of the frame decoded by 'src_worker' to be ready,
+// then copies it into 'dst'. 'dst' takes over the reference map snapshot.
+void av1_frameworker_copy_context(struct AV1Decoder *dst,
+                                  AVxWorker *const src_worker);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
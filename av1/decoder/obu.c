@@ -752,6 +752,7 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
   int is_first_tg_obu_received = 1;
   uint32_t frame_header_size = 0;
   ObuHeader obu_header;
+  struct aom_usec_timer timer;
   memset(&obu_header, 0, sizeof(obu_header));
   pbi->seen_frame_header = 0;
   pbi->next_start_tile = 0;
@@ -823,7 +824,9 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
         pbi->next_start_tile = 0;
         break;
       case OBU_SEQUENCE_HEADER:
+        aom_usec_timer_start(&timer);
         decoded_payload_size = read_sequence_header_obu(pbi, &rb);
+        add_stage_time(pbi, 0, AOM_DEC_STAGE_HEADER, &timer);
         if (cm->error.error_code != AOM_CODEC_OK) return -1;
         break;
       case OBU_FRAME_HEADER:
@@ -844,8 +847,10 @@ int aom_decode_frame_from_obus(struct AV1Decoder *pbi, const uint8_t *data,
         // Only decode first frame header received
         if (!pbi->seen_frame_header ||
             (cm->large_scale_tile && !pbi->camera_frame_header_ready)) {
+          aom_usec_timer_start(&timer);
           frame_header_size = read_frame_header_obu(
               pbi, &rb, data, p_data_end, obu_header.type != OBU_FRAME);
+          add_stage_time(pbi, 0, AOM_DEC_STAGE_HEADER, &timer);
           pbi->seen_frame_header = 1;
           if (!pbi->ext_tile_debug && cm->large_scale_tile)
             pbi->camera_frame_header_ready = 1;
@@ -36,6 +36,22 @@ int av1_write_uleb_obu_size(uint32_t obu_header_size, uint32_t obu_payload_size,
 int av1_pack_bitstream(AV1_COMP *const cpi, uint8_t *dst, size_t *size,
                        int *const largest_tile_id);
 
+// Codes the modes and tokens of one tile with the thread data td, leaving the
+// coded tile in the finished pack_bc writer of its TileDataEnc.
+void av1_pack_tile(AV1_COMP *const cpi, ThreadData *const td, int tile_row,
+                   int tile_col);
+
+// Releases the pack_bc writers left behind when packing is interrupted by an
+// error.
+void av1_release_pack_writers(AV1_COMP *const cpi);
+
+// Clears the statistics gathered in td while packing tiles.
+void av1_reset_pack_bs_thread_data(ThreadData *const td);
+
+// Merges the statistics gathered in td while packing tiles into cpi.
+void av1_accumulate_pack_bs_thread_data(AV1_COMP *const cpi,
+                                        const ThreadData *const td);
+
 void av1_write_tx_type(const AV1_COMMON *const cm, const MACROBLOCKD *xd,
                        int blk_row, int blk_col, int plane, TX_SIZE tx_size,
                        aom_writer *w);
@@ -414,6 +414,10 @@ struct macroblock {
   int cnn_output_valid;
   float cnn_buffer[CNN_OUT_BUF_SIZE];
   float log_q;
+  // Logits of the blocks below 64x64 indexed by quad_tree_idx, valid for the
+  // four children of the block at each index set in cnn_logits_valid.
+  float cnn_logits[85];
+  int cnn_logits_valid[21];
 #endif
 };
 
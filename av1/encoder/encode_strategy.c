@@ -559,7 +559,9 @@ static struct lookahead_entry *setup_arf_or_arf2(
 #if !CONFIG_REALTIME_ONLY
       if (oxcf->arnr_max_frames > 0) {
         // Produce the filtered ARF frame.
+        start_stage_timing(cpi, AOM_ENC_STAGE_TEMPORAL_FILTER);
         av1_temporal_filter(cpi, arf_src_index);
+        end_stage_timing(cpi, AOM_ENC_STAGE_TEMPORAL_FILTER);
         aom_extend_frame_borders(&cpi->alt_ref_buffer, av1_num_planes(cm));
         *temporal_filtered = 1;
       }
@@ -1168,7 +1170,15 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
       frame_params.frame_type == KEY_FRAME && frame_params.show_frame) {
     av1_configure_buffer_updates(cpi, &frame_params, frame_update_type, 0);
     av1_set_frame_size(cpi, cm->width, cm->height);
+#if CONFIG_COLLECT_COMPONENT_TIMING
+    start_timing(cpi, av1_tpl_setup_stats_time);
+#endif
+    start_stage_timing(cpi, AOM_ENC_STAGE_TPL);
     av1_tpl_setup_stats(cpi, &frame_input);
+    end_stage_timing(cpi, AOM_ENC_STAGE_TPL);
+#if CONFIG_COLLECT_COMPONENT_TIMING
+    end_timing(cpi, av1_tpl_setup_stats_time);
+#endif
   }
 #endif  // ENABLE_KF_TPL
 
@@ -1180,7 +1190,15 @@ int av1_encode_strategy(AV1_COMP *const cpi, size_t *const size,
       if (cpi->gf_group.index == 1 && cpi->oxcf.enable_tpl_model) {
         av1_configure_buffer_updates(cpi, &frame_params, frame_update_type, 0);
         av1_set_frame_size(cpi, cm->width, cm->height);
+#if CONFIG_COLLECT_COMPONENT_TIMING
+        start_timing(cpi, av1_tpl_setup_stats_time);
+#endif
+        start_stage_timing(cpi, AOM_ENC_STAGE_TPL);
         av1_tpl_setup_stats(cpi, &frame_input);
+        end_stage_timing(cpi, AOM_ENC_STAGE_TPL);
+#if CONFIG_COLLECT_COMPONENT_TIMING
+        end_timing(cpi, av1_tpl_setup_stats_time);
+#endif
         assert(cpi->num_gf_group_show_frames == 1);
       }
     }
@@ -47,7 +47,6 @@
 #include "av1/encoder/aq_complexity.h"
 #include "av1/encoder/aq_cyclicrefresh.h"
 #include "av1/encoder/aq_variance.h"
-#include "av1/encoder/corner_detect.h"
 #include "av1/encoder/global_motion.h"
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encodemb.h"
@@ -4203,6 +4202,7 @@ void av1_alloc_tile_data(AV1_COMP *cpi) {
     for (tile_col = 0; tile_col < tile_cols; ++tile_col) {
       TileDataEnc *const tile_data =
           &cpi->tile_data[tile_row * tile_cols + tile_col];
+      av1_zero(tile_data->pack_bc);
       int i, j;
       for (i = 0; i < BLOCK_SIZES_ALL; ++i) {
         for (j = 0; j < MAX_MODES; ++j) {
@@ -4387,10 +4387,7 @@ static int gm_get_params_cost(const WarpedMotionParams *gm,
   return (params_cost << AV1_PROB_COST_SHIFT);
 }
 
-static int do_gm_search_logic(SPEED_FEATURES *const sf, int num_refs_using_gm,
-                              int frame) {
-  (void)num_refs_using_gm;
-  (void)frame;
+static int do_gm_search_logic(const SPEED_FEATURES *const sf, int frame) {
   switch (sf->gm_search_type) {
     case GM_FULL_SEARCH: return 1;
     case GM_REDUCED_REF_SEARCH_SKIP_L2_L3:
@@ -4540,6 +4537,351 @@ static INLINE int skip_gm_frame(AV1_COMMON *const cm, int ref_frame) {
   return 0;
 }
 
+// Scratch buffers used by one thread of the global motion search.
+typedef struct {
+  MotionModel params_by_motion[RANSAC_NUM_MOTIONS];
+  uint8_t *segment_map;
+} GlobalMotionThreadData;
+
+typedef struct GlobalMotionSearchCtxt {
+  AV1_COMP *cpi;
+  YV12_BUFFER_CONFIG *ref_buf[REF_FRAMES];
+  unsigned char *frm_buffer;
+  int *frm_corners;
+  int num_frm_corners;
+  int segment_map_w;
+  int segment_map_h;
+  // Reference frames searched by the current batch, and the index of the next
+  // one to hand out.
+  int frames[INTER_REFS_PER_FRAME];
+  int num_frames;
+  int next_frame_idx;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
+} GlobalMotionSearchCtxt;
+
+// Searches the global motion parameters of a single reference frame and
+// stores them in cm->global_motion[frame]. Only td and that entry are written,
+// so different reference frames can be searched at the same time.
+static void compute_global_motion_for_ref(GlobalMotionSearchCtxt *ctxt,
+                                          GlobalMotionThreadData *td,
+                                          int frame) {
+  AV1_COMP *const cpi = ctxt->cpi;
+  AV1_COMMON *const cm = &cpi->common;
+  const MACROBLOCKD *const xd = &cpi->td.mb.e_mbd;
+  YV12_BUFFER_CONFIG *const ref_buf = ctxt->ref_buf[frame];
+  MotionModel *const params_by_motion = td->params_by_motion;
+  uint8_t *const segment_map = td->segment_map;
+  const int segment_map_w = ctxt->segment_map_w;
+  const WarpedMotionParams *ref_params =
+      cm->prev_frame ? &cm->prev_frame->global_motion[frame]
+                     : &default_warp_params;
+  const double *params_this_motion;
+  int inliers_by_motion[RANSAC_NUM_MOTIONS];
+  WarpedMotionParams tmp_wm_params;
+  // clang-format off
+  static const double kIdentityParams[MAX_PARAMDIM - 1] = {
+    0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
+  };
+  // clang-format on
+  TransformationType model;
+
+  aom_clear_system_state();
+
+  // TODO(sarahparker, debargha): Explore do_adaptive_gm_estimation = 1
+  const int do_adaptive_gm_estimation = 0;
+
+  const int ref_frame_dist = get_relative_dist(
+      &cm->seq_params.order_hint_info, cm->current_frame.order_hint,
+      cm->cur_frame->ref_order_hints[frame - LAST_FRAME]);
+  const GlobalMotionEstimationType gm_estimation_type =
+      cm->seq_params.order_hint_info.enable_order_hint &&
+              abs(ref_frame_dist) <= 2 && do_adaptive_gm_estimation
+          ? GLOBAL_MOTION_DISFLOW_BASED
+          : GLOBAL_MOTION_FEATURE_BASED;
+  for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES_ENC; ++model) {
+    int64_t best_warp_error = INT64_MAX;
+    // Initially set all params to identity.
+    for (int i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+      memcpy(params_by_motion[i].params, kIdentityParams,
+             (MAX_PARAMDIM - 1) * sizeof(*(params_by_motion[i].params)));
+    }
+
+    av1_compute_global_motion(
+        model, ctxt->frm_buffer, cpi->source->y_width, cpi->source->y_height,
+        cpi->source->y_stride, ctxt->frm_corners, ctxt->num_frm_corners,
+        ref_buf, cpi->common.seq_params.bit_depth,
+        gm_estimation_type, inliers_by_motion, params_by_motion,
+        RANSAC_NUM_MOTIONS);
+
+    for (int i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
+      if (inliers_by_motion[i] == 0) continue;
+
+      params_this_motion = params_by_motion[i].params;
+      av1_convert_model_to_params(params_this_motion, &tmp_wm_params);
+
+      if (tmp_wm_params.wmtype != IDENTITY) {
+        av1_compute_feature_segmentation_map(
+            segment_map, segment_map_w, ctxt->segment_map_h,
+            params_by_motion[i].inliers, params_by_motion[i].num_inliers);
+
+        const int64_t warp_error = av1_refine_integerized_param(
+            &tmp_wm_params, tmp_wm_params.wmtype, is_cur_buf_hbd(xd), xd->bd,
+            ref_buf->y_buffer, ref_buf->y_width, ref_buf->y_height,
+            ref_buf->y_stride, cpi->source->y_buffer, cpi->source->y_width,
+            cpi->source->y_height, cpi->source->y_stride, 5, best_warp_error,
+            segment_map, segment_map_w);
+        if (warp_error < best_warp_error) {
+          best_warp_error = warp_error;
+          // Save the wm_params modified by
+          // av1_refine_integerized_param() rather than motion index to
+          // avoid rerunning refine() below.
+          memcpy(&(cm->global_motion[frame]), &tmp_wm_params,
+                 sizeof(WarpedMotionParams));
+        }
+      }
+    }
+    if (cm->global_motion[frame].wmtype <= AFFINE)
+      if (!av1_get_shear_params(&cm->global_motion[frame]))
+        cm->global_motion[frame] = default_warp_params;
+
+    if (cm->global_motion[frame].wmtype == TRANSLATION) {
+      cm->global_motion[frame].wmmat[0] =
+          convert_to_trans_prec(cm->allow_high_precision_mv,
+                                cm->global_motion[frame].wmmat[0]) *
+          GM_TRANS_ONLY_DECODE_FACTOR;
+      cm->global_motion[frame].wmmat[1] =
+          convert_to_trans_prec(cm->allow_high_precision_mv,
+                                cm->global_motion[frame].wmmat[1]) *
+          GM_TRANS_ONLY_DECODE_FACTOR;
+    }
+
+    if (cm->global_motion[frame].wmtype == IDENTITY) continue;
+
+    const int64_t ref_frame_error = av1_segmented_frame_error(
+        is_cur_buf_hbd(xd), xd->bd, ref_buf->y_buffer, ref_buf->y_stride,
+        cpi->source->y_buffer, cpi->source->y_width, cpi->source->y_height,
+        cpi->source->y_stride, segment_map, segment_map_w);
+
+    if (ref_frame_error == 0) continue;
+
+    // If the best error advantage found doesn't meet the threshold for
+    // this motion type, revert to IDENTITY.
+    if (!av1_is_enough_erroradvantage(
+            (double)best_warp_error / ref_frame_error,
+            gm_get_params_cost(&cm->global_motion[frame], ref_params,
+                               cm->allow_high_precision_mv),
+            cpi->sf.gm_erroradv_type)) {
+      cm->global_motion[frame] = default_warp_params;
+    }
+    if (cm->global_motion[frame].wmtype != IDENTITY) break;
+  }
+  aom_clear_system_state();
+}
+
+static int get_next_gm_frame(GlobalMotionSearchCtxt *const ctxt, int *frame) {
+  int ret = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(ctxt->job_mutex);
+#endif
+  if (ctxt->next_frame_idx < ctxt->num_frames) {
+    *frame = ctxt->frames[ctxt->next_frame_idx++];
+    ret = 1;
+  }
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(ctxt->job_mutex);
+#endif
+
+  return ret;
+}
+
+static int gm_search_worker(void *arg1, void *arg2) {
+  GlobalMotionSearchCtxt *const ctxt = (GlobalMotionSearchCtxt *)arg1;
+  GlobalMotionThreadData *const td = (GlobalMotionThreadData *)arg2;
+  int frame;
+
+  while (get_next_gm_frame(ctxt, &frame))
+    compute_global_motion_for_ref(ctxt, td, frame);
+  return 1;
+}
+
+// Searches every reference frame in ctxt->frames, one reference per worker at
+// a time. num_td is the number of entries in td, at most one per worker.
+static void compute_global_motion_for_refs(GlobalMotionSearchCtxt *const ctxt,
+                                           GlobalMotionThreadData *td,
+                                           int num_td) {
+  AV1_COMP *const cpi = ctxt->cpi;
+  const int num_workers = AOMMIN(num_td, ctxt->num_frames);
+
+  if (ctxt->num_frames == 0) return;
+  if (ctxt->num_frm_corners < 0) {
+    // compute interest points using FAST features
+    ctxt->num_frm_corners = av1_get_frame_corners(
+        cpi->source, cpi->common.seq_params.bit_depth, &ctxt->frm_corners);
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t job_mutex;
+  pthread_mutex_init(&job_mutex, NULL);
+  ctxt->job_mutex = &job_mutex;
+#endif
+  ctxt->next_frame_idx = 0;
+
+  if (num_workers <= 1) {
+    gm_search_worker(ctxt, &td[0]);
+  } else {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    int i;
+
+    for (i = 0; i < num_workers; ++i) {
+      AVxWorker *const worker = &cpi->workers[i];
+      worker->hook = gm_search_worker;
+      worker->data1 = ctxt;
+      worker->data2 = &td[i];
+
+      if (i == num_workers - 1) {
+        winterface->execute(worker);
+      } else {
+        winterface->launch(worker);
+      }
+    }
+
+    for (i = 0; i < num_workers; ++i) {
+      winterface->sync(&cpi->workers[i]);
+    }
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&job_mutex);
+  ctxt->job_mutex = NULL;
+#endif
+}
+
+// Computes cm->global_motion and cpi->gmparams_cost for every reference frame.
+// The reference frames are searched on the encoder workers when there are
+// several. LAST2 and LAST3 are searched in a second batch when
+// sf.selective_ref_gm is set, because whether they are searched at all
+// depends on the parameters found for GOLDEN.
+static void compute_global_motion(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  GlobalMotionSearchCtxt ctxt;
+  GlobalMotionThreadData td[INTER_REFS_PER_FRAME];
+  const int num_td = cpi->num_workers > 1
+                         ? AOMMIN(cpi->num_workers, INTER_REFS_PER_FRAME)
+                         : 1;
+  int dup_frame[REF_FRAMES];
+  int search_frame[REF_FRAMES];
+  int frame;
+
+  ctxt.cpi = cpi;
+  ctxt.num_frm_corners = -1;
+  ctxt.frm_buffer = cpi->source->y_buffer;
+  if (cpi->source->flags & YV12_FLAG_HIGHBITDEPTH) {
+    // The frame buffer is 16-bit, so we need to convert to 8 bits for the
+    // following code. We cache the result until the frame is released.
+    ctxt.frm_buffer =
+        av1_downconvert_frame(cpi->source, cpi->common.seq_params.bit_depth);
+  }
+  ctxt.segment_map_w =
+      (cpi->source->y_width + WARP_ERROR_BLOCK) >> WARP_ERROR_BLOCK_LOG;
+  ctxt.segment_map_h =
+      (cpi->source->y_height + WARP_ERROR_BLOCK) >> WARP_ERROR_BLOCK_LOG;
+#if CONFIG_MULTITHREAD
+  ctxt.job_mutex = NULL;
+#endif
+
+  for (int t = 0; t < num_td; ++t) {
+    for (int m = 0; m < RANSAC_NUM_MOTIONS; m++) {
+      memset(&td[t].params_by_motion[m], 0, sizeof(td[t].params_by_motion[m]));
+      CHECK_MEM_ERROR(
+          cm, td[t].params_by_motion[m].inliers,
+          aom_malloc(sizeof(*(td[t].params_by_motion[m].inliers)) * 2 *
+                     MAX_CORNERS));
+    }
+    CHECK_MEM_ERROR(cm, td[t].segment_map,
+                    aom_calloc(ctxt.segment_map_w * ctxt.segment_map_h,
+                               sizeof(*td[t].segment_map)));
+  }
+
+  // Find the references that share a buffer with a later one, and the ones
+  // that need a search of their own.
+  for (frame = ALTREF_FRAME; frame >= LAST_FRAME; --frame) {
+    int pframe;
+    ctxt.ref_buf[frame] = NULL;
+    RefCntBuffer *buf = get_ref_frame_buf(cm, frame);
+    if (buf != NULL) ctxt.ref_buf[frame] = &buf->buf;
+    cm->global_motion[frame] = default_warp_params;
+    // check for duplicate buffer
+    for (pframe = ALTREF_FRAME; pframe > frame; --pframe) {
+      if (ctxt.ref_buf[frame] == ctxt.ref_buf[pframe]) break;
+    }
+    dup_frame[frame] = pframe > frame ? pframe : NONE_FRAME;
+    search_frame[frame] =
+        pframe == frame && ctxt.ref_buf[frame] &&
+        ctxt.ref_buf[frame]->y_crop_width == cpi->source->y_crop_width &&
+        ctxt.ref_buf[frame]->y_crop_height == cpi->source->y_crop_height &&
+        do_gm_search_logic(&cpi->sf, frame);
+  }
+
+  ctxt.num_frames = 0;
+  for (frame = ALTREF_FRAME; frame >= LAST_FRAME; --frame) {
+    if (!search_frame[frame]) continue;
+    if (cpi->sf.selective_ref_gm &&
+        (frame == LAST3_FRAME || frame == LAST2_FRAME))
+      continue;
+    ctxt.frames[ctxt.num_frames++] = frame;
+  }
+  compute_global_motion_for_refs(&ctxt, td, num_td);
+
+  ctxt.num_frames = 0;
+  for (frame = ALTREF_FRAME; frame >= LAST_FRAME; --frame) {
+    if (dup_frame[frame] != NONE_FRAME) {
+      cm->global_motion[frame] = cm->global_motion[dup_frame[frame]];
+    }
+    if (frame == GOLDEN_FRAME) {
+      // GOLDEN is final now, so the second batch can be picked.
+      if (cpi->sf.selective_ref_gm) {
+        for (int f = LAST3_FRAME; f >= LAST2_FRAME; --f) {
+          if (search_frame[f] && !skip_gm_frame(cm, f))
+            ctxt.frames[ctxt.num_frames++] = f;
+        }
+      }
+      compute_global_motion_for_refs(&ctxt, td, num_td);
+    }
+  }
+
+  for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
+    const WarpedMotionParams *ref_params =
+        cm->prev_frame ? &cm->prev_frame->global_motion[frame]
+                       : &default_warp_params;
+    cpi->gmparams_cost[frame] =
+        gm_get_params_cost(&cm->global_motion[frame], ref_params,
+                           cm->allow_high_precision_mv) +
+        cpi->gmtype_cost[cm->global_motion[frame].wmtype] -
+        cpi->gmtype_cost[IDENTITY];
+  }
+
+  for (int t = 0; t < num_td; ++t) {
+    aom_free(td[t].segment_map);
+    for (int m = 0; m < RANSAC_NUM_MOTIONS; m++) {
+      aom_free(td[t].params_by_motion[m].inliers);
+    }
+  }
+
+  // clear disabled ref_frames
+  for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
+    const int ref_disabled =
+        !(cpi->ref_frame_flags & av1_ref_frame_flag_list[frame]);
+    if (ref_disabled && cpi->sf.recode_loop != DISALLOW_RECODE) {
+      cpi->gmparams_cost[frame] = 0;
+      cm->global_motion[frame] = default_warp_params;
+    }
+  }
+  cpi->global_motion_search_done = 1;
+}
+
 static void set_default_interp_skip_flags(AV1_COMP *cpi) {
   const int num_planes = av1_num_planes(&cpi->common);
   cpi->default_interp_skip_flags = (num_planes == 1)
@@ -4734,6 +5076,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   x->tx_search_count = 0;
 #endif  // CONFIG_SPEED_STATS
 
+  start_stage_timing(cpi, AOM_ENC_STAGE_MOTION_SEARCH);
 #if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_compute_global_motion_time);
 #endif
@@ -4741,187 +5084,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   av1_zero(cpi->gmparams_cost);
   if (cpi->common.current_frame.frame_type == INTER_FRAME && cpi->source &&
       cpi->oxcf.enable_global_motion && !cpi->global_motion_search_done) {
-    YV12_BUFFER_CONFIG *ref_buf[REF_FRAMES];
-    int frame;
-    MotionModel params_by_motion[RANSAC_NUM_MOTIONS];
-    for (int m = 0; m < RANSAC_NUM_MOTIONS; m++) {
-      memset(&params_by_motion[m], 0, sizeof(params_by_motion[m]));
-      params_by_motion[m].inliers =
-          aom_malloc(sizeof(*(params_by_motion[m].inliers)) * 2 * MAX_CORNERS);
-    }
-
-    const double *params_this_motion;
-    int inliers_by_motion[RANSAC_NUM_MOTIONS];
-    WarpedMotionParams tmp_wm_params;
-    // clang-format off
-    static const double kIdentityParams[MAX_PARAMDIM - 1] = {
-      0.0, 0.0, 1.0, 0.0, 0.0, 1.0, 0.0, 0.0
-    };
-    // clang-format on
-    int num_refs_using_gm = 0;
-    int num_frm_corners = -1;
-    int frm_corners[2 * MAX_CORNERS];
-    unsigned char *frm_buffer = cpi->source->y_buffer;
-    if (cpi->source->flags & YV12_FLAG_HIGHBITDEPTH) {
-      // The frame buffer is 16-bit, so we need to convert to 8 bits for the
-      // following code. We cache the result until the frame is released.
-      frm_buffer =
-          av1_downconvert_frame(cpi->source, cpi->common.seq_params.bit_depth);
-    }
-    const int segment_map_w =
-        (cpi->source->y_width + WARP_ERROR_BLOCK) >> WARP_ERROR_BLOCK_LOG;
-    const int segment_map_h =
-        (cpi->source->y_height + WARP_ERROR_BLOCK) >> WARP_ERROR_BLOCK_LOG;
-
-    uint8_t *segment_map =
-        aom_malloc(sizeof(*segment_map) * segment_map_w * segment_map_h);
-    memset(segment_map, 0,
-           sizeof(*segment_map) * segment_map_w * segment_map_h);
-
-    for (frame = ALTREF_FRAME; frame >= LAST_FRAME; --frame) {
-      ref_buf[frame] = NULL;
-      RefCntBuffer *buf = get_ref_frame_buf(cm, frame);
-      if (buf != NULL) ref_buf[frame] = &buf->buf;
-      int pframe;
-      cm->global_motion[frame] = default_warp_params;
-      const WarpedMotionParams *ref_params =
-          cm->prev_frame ? &cm->prev_frame->global_motion[frame]
-                         : &default_warp_params;
-      // check for duplicate buffer
-      for (pframe = ALTREF_FRAME; pframe > frame; --pframe) {
-        if (ref_buf[frame] == ref_buf[pframe]) break;
-      }
-      if (pframe > frame) {
-        memcpy(&cm->global_motion[frame], &cm->global_motion[pframe],
-               sizeof(WarpedMotionParams));
-      } else if (ref_buf[frame] &&
-                 ref_buf[frame]->y_crop_width == cpi->source->y_crop_width &&
-                 ref_buf[frame]->y_crop_height == cpi->source->y_crop_height &&
-                 do_gm_search_logic(&cpi->sf, num_refs_using_gm, frame) &&
-                 !(cpi->sf.selective_ref_gm && skip_gm_frame(cm, frame))) {
-        if (num_frm_corners < 0) {
-          // compute interest points using FAST features
-          num_frm_corners = av1_fast_corner_detect(
-              frm_buffer, cpi->source->y_width, cpi->source->y_height,
-              cpi->source->y_stride, frm_corners, MAX_CORNERS);
-        }
-        TransformationType model;
-
-        aom_clear_system_state();
-
-        // TODO(sarahparker, debargha): Explore do_adaptive_gm_estimation = 1
-        const int do_adaptive_gm_estimation = 0;
-
-        const int ref_frame_dist = get_relative_dist(
-            &cm->seq_params.order_hint_info, cm->current_frame.order_hint,
-            cm->cur_frame->ref_order_hints[frame - LAST_FRAME]);
-        const GlobalMotionEstimationType gm_estimation_type =
-            cm->seq_params.order_hint_info.enable_order_hint &&
-                    abs(ref_frame_dist) <= 2 && do_adaptive_gm_estimation
-                ? GLOBAL_MOTION_DISFLOW_BASED
-                : GLOBAL_MOTION_FEATURE_BASED;
-        for (model = ROTZOOM; model < GLOBAL_TRANS_TYPES_ENC; ++model) {
-          int64_t best_warp_error = INT64_MAX;
-          // Initially set all params to identity.
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            memcpy(params_by_motion[i].params, kIdentityParams,
-                   (MAX_PARAMDIM - 1) * sizeof(*(params_by_motion[i].params)));
-          }
-
-          av1_compute_global_motion(
-              model, frm_buffer, cpi->source->y_width, cpi->source->y_height,
-              cpi->source->y_stride, frm_corners, num_frm_corners,
-              ref_buf[frame], cpi->common.seq_params.bit_depth,
-              gm_estimation_type, inliers_by_motion, params_by_motion,
-              RANSAC_NUM_MOTIONS);
-
-          for (i = 0; i < RANSAC_NUM_MOTIONS; ++i) {
-            if (inliers_by_motion[i] == 0) continue;
-
-            params_this_motion = params_by_motion[i].params;
-            av1_convert_model_to_params(params_this_motion, &tmp_wm_params);
-
-            if (tmp_wm_params.wmtype != IDENTITY) {
-              av1_compute_feature_segmentation_map(
-                  segment_map, segment_map_w, segment_map_h,
-                  params_by_motion[i].inliers, params_by_motion[i].num_inliers);
-
-              const int64_t warp_error = av1_refine_integerized_param(
-                  &tmp_wm_params, tmp_wm_params.wmtype, is_cur_buf_hbd(xd),
-                  xd->bd, ref_buf[frame]->y_buffer, ref_buf[frame]->y_width,
-                  ref_buf[frame]->y_height, ref_buf[frame]->y_stride,
-                  cpi->source->y_buffer, cpi->source->y_width,
-                  cpi->source->y_height, cpi->source->y_stride, 5,
-                  best_warp_error, segment_map, segment_map_w);
-              if (warp_error < best_warp_error) {
-                best_warp_error = warp_error;
-                // Save the wm_params modified by
-                // av1_refine_integerized_param() rather than motion index to
-                // avoid rerunning refine() below.
-                memcpy(&(cm->global_motion[frame]), &tmp_wm_params,
-                       sizeof(WarpedMotionParams));
-              }
-            }
-          }
-          if (cm->global_motion[frame].wmtype <= AFFINE)
-            if (!av1_get_shear_params(&cm->global_motion[frame]))
-              cm->global_motion[frame] = default_warp_params;
-
-          if (cm->global_motion[frame].wmtype == TRANSLATION) {
-            cm->global_motion[frame].wmmat[0] =
-                convert_to_trans_prec(cm->allow_high_precision_mv,
-                                      cm->global_motion[frame].wmmat[0]) *
-                GM_TRANS_ONLY_DECODE_FACTOR;
-            cm->global_motion[frame].wmmat[1] =
-                convert_to_trans_prec(cm->allow_high_precision_mv,
-                                      cm->global_motion[frame].wmmat[1]) *
-                GM_TRANS_ONLY_DECODE_FACTOR;
-          }
-
-          if (cm->global_motion[frame].wmtype == IDENTITY) continue;
-
-          const int64_t ref_frame_error = av1_segmented_frame_error(
-              is_cur_buf_hbd(xd), xd->bd, ref_buf[frame]->y_buffer,
-              ref_buf[frame]->y_stride, cpi->source->y_buffer,
-              cpi->source->y_width, cpi->source->y_height,
-              cpi->source->y_stride, segment_map, segment_map_w);
-
-          if (ref_frame_error == 0) continue;
-
-          // If the best error advantage found doesn't meet the threshold for
-          // this motion type, revert to IDENTITY.
-          if (!av1_is_enough_erroradvantage(
-                  (double)best_warp_error / ref_frame_error,
-                  gm_get_params_cost(&cm->global_motion[frame], ref_params,
-                                     cm->allow_high_precision_mv),
-                  cpi->sf.gm_erroradv_type)) {
-            cm->global_motion[frame] = default_warp_params;
-          }
-          if (cm->global_motion[frame].wmtype != IDENTITY) break;
-        }
-        aom_clear_system_state();
-      }
-      if (cm->global_motion[frame].wmtype != IDENTITY) num_refs_using_gm++;
-      cpi->gmparams_cost[frame] =
-          gm_get_params_cost(&cm->global_motion[frame], ref_params,
-                             cm->allow_high_precision_mv) +
-          cpi->gmtype_cost[cm->global_motion[frame].wmtype] -
-          cpi->gmtype_cost[IDENTITY];
-    }
-    aom_free(segment_map);
-    // clear disabled ref_frames
-    for (frame = LAST_FRAME; frame <= ALTREF_FRAME; ++frame) {
-      const int ref_disabled =
-          !(cpi->ref_frame_flags & av1_ref_frame_flag_list[frame]);
-      if (ref_disabled && cpi->sf.recode_loop != DISALLOW_RECODE) {
-        cpi->gmparams_cost[frame] = 0;
-        cm->global_motion[frame] = default_warp_params;
-      }
-    }
-    cpi->global_motion_search_done = 1;
-    for (int m = 0; m < RANSAC_NUM_MOTIONS; m++) {
-      aom_free(params_by_motion[m].inliers);
-    }
+    compute_global_motion(cpi);
   }
   memcpy(cm->cur_frame->global_motion, cm->global_motion,
          REF_FRAMES * sizeof(WarpedMotionParams));
@@ -4936,6 +5099,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
 #if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_setup_motion_field_time);
 #endif
+  end_stage_timing(cpi, AOM_ENC_STAGE_MOTION_SEARCH);
 
   cpi->all_one_sided_refs =
       frame_is_intra_only(cm) ? 0 : av1_refs_are_one_sided(cm);
@@ -4943,6 +5107,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
   cm->current_frame.skip_mode_info.skip_mode_flag =
       check_skip_mode_enabled(cpi);
 
+  start_stage_timing(cpi, AOM_ENC_STAGE_RD_SEARCH);
   {
     cpi->row_mt_sync_read_ptr = av1_row_mt_sync_read_dummy;
     cpi->row_mt_sync_write_ptr = av1_row_mt_sync_write_dummy;
@@ -4960,6 +5125,7 @@ static void encode_frame_internal(AV1_COMP *cpi) {
         encode_tiles(cpi);
     }
   }
+  end_stage_timing(cpi, AOM_ENC_STAGE_RD_SEARCH);
 
   // If intrabc is allowed but never selected, reset the allow_intrabc flag.
   if (cm->allow_intrabc && !cpi->intrabc_used) cm->allow_intrabc = 0;
@@ -3155,6 +3155,7 @@ void av1_remove_compressor(AV1_COMP *cpi) {
         }
       }
       aom_free(thread_data->td->mask_buf);
+      aom_free(thread_data->td->rst_tmpbuf);
       aom_free(thread_data->td->counts);
       av1_free_pc_tree(thread_data->td, num_planes);
       aom_free(thread_data->td);
@@ -3167,12 +3168,14 @@ void av1_remove_compressor(AV1_COMP *cpi) {
   }
 #endif
   av1_row_mt_mem_dealloc(cpi);
+  av1_row_mt_sync_mem_dealloc(&cpi->fp_row_mt_sync);
   aom_free(cpi->tile_thr_data);
   aom_free(cpi->workers);
 
   if (cpi->num_workers > 1) {
     av1_loop_filter_dealloc(&cpi->lf_row_sync);
     av1_loop_restoration_dealloc(&cpi->lr_row_sync, cpi->num_workers);
+    av1_cdef_dealloc(&cpi->cdef_row_sync);
   }
 
   dealloc_compressor_data(cpi);
@@ -3246,6 +3249,8 @@ int av1_set_reference_enc(AV1_COMP *cpi, int idx, YV12_BUFFER_CONFIG *sd) {
   YV12_BUFFER_CONFIG *cfg = get_ref_frame(cm, idx);
   if (cfg) {
     aom_yv12_copy_frame(sd, cfg, num_planes);
+    cfg->buf_8bit_valid = 0;
+    cfg->corners_valid = 0;
     return 0;
   } else {
     return -1;
@@ -4232,7 +4237,9 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
 #endif
   if (use_loopfilter) {
     aom_clear_system_state();
+    start_stage_timing(cpi, AOM_ENC_STAGE_LOOP_FILTER_SEARCH);
     av1_pick_filter_level(cpi->source, cpi, cpi->sf.lpf_pick);
+    end_stage_timing(cpi, AOM_ENC_STAGE_LOOP_FILTER_SEARCH);
   } else {
     lf->filter_level[0] = 0;
     lf->filter_level[1] = 0;
@@ -4265,11 +4272,18 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
     start_timing(cpi, cdef_time);
 #endif
     // Find CDEF parameters
+    start_stage_timing(cpi, AOM_ENC_STAGE_CDEF_SEARCH);
     av1_cdef_search(&cm->cur_frame->buf, cpi->source, cm, xd,
-                    cpi->sf.cdef_pick_method, cpi->td.mb.rdmult);
+                    cpi->sf.cdef_pick_method, cpi->td.mb.rdmult, cpi->workers,
+                    cpi->num_workers);
+    end_stage_timing(cpi, AOM_ENC_STAGE_CDEF_SEARCH);
 
     // Apply the filter
-    av1_cdef_frame(&cm->cur_frame->buf, cm, xd);
+    if (cpi->num_workers > 1)
+      av1_cdef_frame_mt(&cm->cur_frame->buf, cm, xd, cpi->workers,
+                        cpi->num_workers, &cpi->cdef_row_sync);
+    else
+      av1_cdef_frame(&cm->cur_frame->buf, cm, xd);
 #if CONFIG_COLLECT_COMPONENT_TIMING
     end_timing(cpi, cdef_time);
 #endif
@@ -4287,7 +4301,9 @@ static void loopfilter_frame(AV1_COMP *cpi, AV1_COMMON *cm) {
 #endif
   if (use_restoration) {
     av1_loop_restoration_save_boundary_lines(&cm->cur_frame->buf, cm, 1);
+    start_stage_timing(cpi, AOM_ENC_STAGE_LR_SEARCH);
     av1_pick_filter_restoration(cpi->source, cpi);
+    end_stage_timing(cpi, AOM_ENC_STAGE_LR_SEARCH);
     if (cm->rst_info[0].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[1].frame_restoration_type != RESTORE_NONE ||
         cm->rst_info[2].frame_restoration_type != RESTORE_NONE) {
@@ -4332,6 +4348,16 @@ static void fix_interp_filter(InterpFilter *const interp_filter,
   }
 }
 
+// Packs the bitstream of the current frame, timing it for
+// AV1E_GET_FRAME_STATS.
+static int pack_bitstream(AV1_COMP *const cpi, uint8_t *dest, size_t *size,
+                          int *const largest_tile_id) {
+  start_stage_timing(cpi, AOM_ENC_STAGE_PACK_BITSTREAM);
+  const int res = av1_pack_bitstream(cpi, dest, size, largest_tile_id);
+  end_stage_timing(cpi, AOM_ENC_STAGE_PACK_BITSTREAM);
+  return res;
+}
+
 static void finalize_encoded_frame(AV1_COMP *const cpi) {
   AV1_COMMON *const cm = &cpi->common;
   CurrentFrame *const current_frame = &cm->current_frame;
@@ -4593,6 +4619,7 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
   set_size_independent_vars(cpi);
 
   cpi->source->buf_8bit_valid = 0;
+  cpi->source->corners_valid = 0;
 
   av1_setup_frame_size(cpi);
 
@@ -4697,7 +4724,7 @@ static int encode_with_recode_loop(AV1_COMP *cpi, size_t *size, uint8_t *dest) {
 
       finalize_encoded_frame(cpi);
       int largest_tile_id = 0;  // Output from bitstream: unused here
-      if (av1_pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
+      if (pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
         return AOM_CODEC_ERROR;
 
       rc->projected_frame_size = (int)(*size) << 3;
@@ -5143,7 +5170,7 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
     finalize_encoded_frame(cpi);
     // Build the bitstream
     int largest_tile_id = 0;  // Output from bitstream: unused here
-    if (av1_pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
+    if (pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
       return AOM_CODEC_ERROR;
 
     if (seq_params->frame_id_numbers_present_flag &&
@@ -5370,7 +5397,7 @@ static int encode_frame_to_data_rate(AV1_COMP *cpi, size_t *size,
 #if CONFIG_COLLECT_COMPONENT_TIMING
   start_timing(cpi, av1_pack_bitstream_final_time);
 #endif
-  if (av1_pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
+  if (pack_bitstream(cpi, dest, size, &largest_tile_id) != AOM_CODEC_OK)
     return AOM_CODEC_ERROR;
 #if CONFIG_COLLECT_COMPONENT_TIMING
   end_timing(cpi, av1_pack_bitstream_final_time);
@@ -5529,7 +5556,9 @@ int av1_encode(AV1_COMP *const cpi, uint8_t *const dest,
 
   if (cpi->oxcf.pass == 1) {
 #if !CONFIG_REALTIME_ONLY
+    start_stage_timing(cpi, AOM_ENC_STAGE_FIRST_PASS);
     av1_first_pass(cpi, frame_input->ts_duration);
+    end_stage_timing(cpi, AOM_ENC_STAGE_FIRST_PASS);
 #endif
   } else if (cpi->oxcf.pass == 0 || cpi->oxcf.pass == 2) {
     if (encode_frame_to_data_rate(cpi, &frame_results->size, dest) !=
@@ -5566,8 +5595,12 @@ static int apply_denoise_2d(AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
     }
     memset(cpi->film_grain_table, 0, sizeof(*cpi->film_grain_table));
   }
-  if (aom_denoise_and_model_run(cpi->denoise_and_model, sd,
-                                &cm->film_grain_params)) {
+  const int denoised =
+      (cpi->oxcf.row_mt == 1 && cpi->oxcf.max_threads > 1)
+          ? av1_denoise_and_model_row_mt(cpi, sd, &cm->film_grain_params)
+          : aom_denoise_and_model_run(cpi->denoise_and_model, sd,
+                                      &cm->film_grain_params);
+  if (denoised) {
     if (cm->film_grain_params.apply_grain) {
       aom_film_grain_table_append(cpi->film_grain_table, time_stamp, end_time,
                                   &cm->film_grain_params);
@@ -5579,7 +5612,9 @@ static int apply_denoise_2d(AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
 
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time) {
+                          int64_t end_time,
+                          aom_release_image_cb_fn_t release_cb,
+                          void *release_cb_priv) {
   AV1_COMMON *const cm = &cpi->common;
   const SequenceHeader *const seq_params = &cm->seq_params;
   int res = 0;
@@ -5589,24 +5624,8 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
 
   check_initial_width(cpi, use_highbitdepth, subsampling_x, subsampling_y);
 
-#if CONFIG_INTERNAL_STATS
-  struct aom_usec_timer timer;
-  aom_usec_timer_start(&timer);
-#endif
-#if CONFIG_DENOISE
-  if (cpi->oxcf.noise_level > 0)
-    if (apply_denoise_2d(cpi, sd, cpi->oxcf.noise_block_size,
-                         cpi->oxcf.noise_level, time_stamp, end_time) < 0)
-      res = -1;
-#endif  //  CONFIG_DENOISE
-
-  if (av1_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
-                         use_highbitdepth, frame_flags))
-    res = -1;
-#if CONFIG_INTERNAL_STATS
-  aom_usec_timer_mark(&timer);
-  cpi->time_receive_data += aom_usec_timer_elapsed(&timer);
-#endif
+  // The checks come first since av1_lookahead_push() takes over release_cb,
+  // even when it fails.
   if ((seq_params->profile == PROFILE_0) && !seq_params->monochrome &&
       (subsampling_x != 1 || subsampling_y != 1)) {
     aom_internal_error(&cm->error, AOM_CODEC_INVALID_PARAM,
@@ -5627,6 +5646,26 @@ int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
     res = -1;
   }
 
+#if CONFIG_INTERNAL_STATS
+  struct aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+#endif
+#if CONFIG_DENOISE
+  if (cpi->oxcf.noise_level > 0)
+    if (apply_denoise_2d(cpi, sd, cpi->oxcf.noise_block_size,
+                         cpi->oxcf.noise_level, time_stamp, end_time) < 0)
+      res = -1;
+#endif  //  CONFIG_DENOISE
+
+  if (av1_lookahead_push(cpi->lookahead, sd, time_stamp, end_time,
+                         use_highbitdepth, frame_flags, release_cb,
+                         release_cb_priv))
+    res = -1;
+#if CONFIG_INTERNAL_STATS
+  aom_usec_timer_mark(&timer);
+  cpi->time_receive_data += aom_usec_timer_elapsed(&timer);
+#endif
+
   return res;
 }
 
@@ -5757,6 +5796,8 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
 
   cm->showable_frame = 0;
   *size = 0;
+  struct aom_usec_timer frame_timer;
+  aom_usec_timer_start(&frame_timer);
 #if CONFIG_INTERNAL_STATS
   struct aom_usec_timer cmptimer;
   aom_usec_timer_start(&cmptimer);
@@ -5784,6 +5825,9 @@ int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
     // Returning -1 indicates no frame encoded; more input is required
     return -1;
   }
+  aom_usec_timer_mark(&frame_timer);
+  cpi->frame_stats.total_time += aom_usec_timer_elapsed(&frame_timer);
+  ++cpi->frame_stats.frames;
 #if CONFIG_INTERNAL_STATS
   aom_usec_timer_mark(&cmptimer);
   cpi->time_compress_data += aom_usec_timer_elapsed(&cmptimer);
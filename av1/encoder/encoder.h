@@ -50,6 +50,7 @@
 #include "aom_dsp/noise_model.h"
 #endif
 #include "aom/internal/aom_codec_internal.h"
+#include "aom_ports/aom_timer.h"
 #include "aom_util/aom_thread.h"
 
 #ifdef __cplusplus
@@ -182,6 +183,28 @@ typedef struct TplDepFrame {
   int mi_cols;
 } TplDepFrame;
 
+// Frame level state of the TPL model pass over one frame, shared by the
+// threads that run mc_flow_dispenser() on its block rows.
+typedef struct TplFrameCtxt {
+  int frame_idx;
+  BLOCK_SIZE bsize;
+  YV12_BUFFER_CONFIG *ref_frame[INTER_REFS_PER_FRAME];
+  struct scale_factors sf;
+} TplFrameCtxt;
+
+// Frame level state of the temporal filter building one ARF, shared by the
+// threads that filter its 32x32 block rows.
+typedef struct TemporalFilterCtxt {
+  YV12_BUFFER_CONFIG **frames;
+  int frame_count;
+  int alt_ref_index;
+  int strength;
+  double sigma;
+  struct scale_factors *ref_scale_factors;
+  int mb_rows;
+  int mb_cols;
+} TemporalFilterCtxt;
+
 typedef enum {
   COST_UPD_SB,
   COST_UPD_SBROW,
@@ -573,6 +596,9 @@ typedef struct TileDataEnc {
   InterModeRdModel inter_mode_rd_models[BLOCK_SIZES_ALL];
   AV1RowMTSync row_mt_sync;
   AV1RowMTInfo row_mt_info;
+  // Writer holding the tile once it is packed by av1_pack_tile(), until the
+  // tile groups are assembled and the tile is copied into place.
+  aom_writer pack_bc;
 } TileDataEnc;
 
 typedef struct {
@@ -615,9 +641,14 @@ typedef struct ThreadData {
   CompoundTypeRdBuffers comp_rd_buffer;
   CONV_BUF_TYPE *tmp_conv_dst;
   uint8_t *tmp_obmc_bufs[2];
+  // Scratch buffer of the loop restoration search, allocated on first use.
+  int32_t *rst_tmpbuf;
   int intrabc_used;
   int deltaq_used;
   FRAME_CONTEXT *tctx;
+  // Statistics gathered by this thread while packing tiles.
+  unsigned int max_mv_magnitude;
+  int interp_filter_selected[SWITCHABLE];
 } ThreadData;
 
 struct EncWorkerData;
@@ -660,7 +691,6 @@ typedef struct PartitionStats {
 #endif
 
 #if CONFIG_COLLECT_COMPONENT_TIMING
-#include "aom_ports/aom_timer.h"
 // Adjust the following to add new components.
 enum {
   encode_frame_to_data_rate_time,
@@ -672,6 +702,7 @@ enum {
   av1_encode_frame_time,
   av1_compute_global_motion_time,
   av1_setup_motion_field_time,
+  av1_tpl_setup_stats_time,
   encode_sb_time,
   rd_pick_partition_time,
   rd_pick_sb_modes_time,
@@ -699,6 +730,7 @@ static INLINE char const *get_component_name(int index) {
     case av1_compute_global_motion_time:
       return "av1_compute_global_motion_time";
     case av1_setup_motion_field_time: return "av1_setup_motion_field_time";
+    case av1_tpl_setup_stats_time: return "av1_tpl_setup_stats_time";
     case encode_sb_time: return "encode_sb_time";
     case rd_pick_partition_time: return "rd_pick_partition_time";
     case rd_pick_sb_modes_time: return "rd_pick_sb_modes_time";
@@ -745,6 +777,8 @@ typedef struct AV1_COMP {
   YV12_BUFFER_CONFIG scaled_last_source;
 
   TplDepFrame tpl_stats[MAX_LENGTH_TPL_FRAME_STATS];
+  TplFrameCtxt tpl_frame_ctxt;
+  TemporalFilterCtxt tf_ctxt;
 
   // For a still frame, this flag is set to 1 to skip partition search.
   int partition_search_skippable_frame;
@@ -863,6 +897,7 @@ typedef struct AV1_COMP {
   int tpl_gf_group_frames;
 
   TWO_PASS twopass;
+  FIRSTPASS_DATA firstpass_data;
 
   GF_GROUP gf_group;
 
@@ -979,6 +1014,7 @@ typedef struct AV1_COMP {
 
   AV1LfSync lf_row_sync;
   AV1LrSync lr_row_sync;
+  AV1CdefSync cdef_row_sync;
   AV1LrStruct lr_ctxt;
 
   aom_film_grain_table_t *film_grain_table;
@@ -990,6 +1026,18 @@ typedef struct AV1_COMP {
   int default_interp_skip_flags;
   int preserve_arf_as_gld;
   MultiThreadHandle multi_thread_ctxt;
+  // Row synchronization and row dispatch of the row based multi-threaded first
+  // pass, which codes the 16x16 macroblock rows of the whole frame.
+  AV1RowMTSync fp_row_mt_sync;
+  AV1RowMTInfo fp_row_mt_info;
+  // Row dispatch of the row based multi-threaded TPL model pass.
+  AV1RowMTInfo tpl_row_mt_info;
+  // Row dispatch of the row based multi-threaded temporal filter. The block
+  // rows are independent, so they need no synchronization.
+  AV1RowMTInfo tf_row_mt_info;
+  // Number of workers packing the tiles in av1_pack_tiles_mt(). Each worker
+  // packs every num_pack_workers-th tile, starting from its own index.
+  int num_pack_workers;
   void (*row_mt_sync_read_ptr)(AV1RowMTSync *const, int, int);
   void (*row_mt_sync_write_ptr)(AV1RowMTSync *const, int, int, const int);
 #if CONFIG_MULTITHREAD
@@ -1009,6 +1057,11 @@ typedef struct AV1_COMP {
   uint64_t frame_component_time[kTimingComponents];
 #endif
 
+  // Time spent in each stage by the frames of the current aom_codec_encode()
+  // call, returned by AV1E_GET_FRAME_STATS.
+  aom_enc_frame_stats_t frame_stats;
+  struct aom_usec_timer stage_timer[AOM_ENC_STAGES];
+
   // The following data are for AV1 bitstream levels.
   AV1_LEVEL target_seq_level_idx[MAX_NUM_OPERATING_POINTS];
   // Bit mask to indicate whether to keep level stats for corresponding
@@ -1077,10 +1130,14 @@ void av1_remove_compressor(AV1_COMP *cpi);
 void av1_change_config(AV1_COMP *cpi, const AV1EncoderConfig *oxcf);
 
 // receive a frames worth of data. caller can assume that a copy of this
-// frame is made and not just a copy of the pointer..
+// frame is made and not just a copy of the pointer, unless release_cb is
+// non-NULL: then the frame may be referenced until release_cb is called (see
+// av1_lookahead_push()).
 int av1_receive_raw_frame(AV1_COMP *cpi, aom_enc_frame_flags_t frame_flags,
                           YV12_BUFFER_CONFIG *sd, int64_t time_stamp,
-                          int64_t end_time_stamp);
+                          int64_t end_time_stamp,
+                          aom_release_image_cb_fn_t release_cb,
+                          void *release_cb_priv);
 
 int av1_get_compressed_data(AV1_COMP *cpi, unsigned int *frame_flags,
                             size_t *size, uint8_t *dest, int64_t *time_stamp,
@@ -1417,6 +1474,17 @@ static INLINE int av1_get_bsize_idx_for_part_stats(BLOCK_SIZE bsize) {
 }
 #endif
 
+// Times a stage of the encoder for AV1E_GET_FRAME_STATS. The stages are
+// coarse enough to be timed in every build.
+static INLINE void start_stage_timing(AV1_COMP *cpi, aom_enc_stage_t stage) {
+  aom_usec_timer_start(&cpi->stage_timer[stage]);
+}
+static INLINE void end_stage_timing(AV1_COMP *cpi, aom_enc_stage_t stage) {
+  aom_usec_timer_mark(&cpi->stage_timer[stage]);
+  cpi->frame_stats.stage_time[stage] +=
+      aom_usec_timer_elapsed(&cpi->stage_timer[stage]);
+}
+
 #if CONFIG_COLLECT_COMPONENT_TIMING
 static INLINE void start_timing(AV1_COMP *cpi, int component) {
   aom_usec_timer_start(&cpi->component_timer[component]);
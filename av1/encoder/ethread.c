@@ -10,11 +10,18 @@
  */
 
 #include "av1/encoder/av1_multi_thread.h"
+#include "av1/encoder/bitstream.h"
 #include "av1/encoder/encodeframe.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/ethread.h"
+#include "av1/encoder/firstpass.h"
 #include "av1/encoder/rdopt.h"
+#include "av1/encoder/temporal_filter.h"
+#include "av1/encoder/tpl_model.h"
 #include "aom_dsp/aom_dsp_common.h"
+#if CONFIG_DENOISE
+#include "aom_dsp/noise_model.h"
+#endif  // CONFIG_DENOISE
 
 static void accumulate_rd_opt(ThreadData *td, ThreadData *td_t) {
   for (int i = 0; i < REFERENCE_MODES; i++)
@@ -534,8 +541,11 @@ static void accumulate_counters_enc_workers(AV1_COMP *cpi, int num_workers) {
   }
 }
 
+// Sets up the workers to run hook. copy_search_state is 0 for the jobs that
+// only read the coded frame, such as packing, which need neither the counts
+// nor the hash values of the search.
 static void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
-                                int num_workers) {
+                                int num_workers, int copy_search_state) {
   for (int i = num_workers - 1; i >= 0; i--) {
     AVxWorker *const worker = &cpi->workers[i];
     EncWorkerData *const thread_data = &cpi->tile_thr_data[i];
@@ -558,17 +568,19 @@ static void prepare_enc_workers(AV1_COMP *cpi, AVxWorkerHook hook,
       thread_data->td->mb.inter_modes_info = thread_data->td->inter_modes_info;
       for (int x = 0; x < 2; x++) {
         for (int y = 0; y < 2; y++) {
-          memcpy(thread_data->td->hash_value_buffer[x][y],
-                 cpi->td.mb.hash_value_buffer[x][y],
-                 AOM_BUFFER_SIZE_FOR_BLOCK_HASH *
-                     sizeof(*thread_data->td->hash_value_buffer[0][0]));
+          if (copy_search_state) {
+            memcpy(thread_data->td->hash_value_buffer[x][y],
+                   cpi->td.mb.hash_value_buffer[x][y],
+                   AOM_BUFFER_SIZE_FOR_BLOCK_HASH *
+                       sizeof(*thread_data->td->hash_value_buffer[0][0]));
+          }
           thread_data->td->mb.hash_value_buffer[x][y] =
               thread_data->td->hash_value_buffer[x][y];
         }
       }
       thread_data->td->mb.mask_buf = thread_data->td->mask_buf;
     }
-    if (thread_data->td->counts != &cpi->counts) {
+    if (copy_search_state && thread_data->td->counts != &cpi->counts) {
       memcpy(thread_data->td->counts, &cpi->counts, sizeof(cpi->counts));
     }
 
@@ -606,7 +618,7 @@ void av1_encode_tiles_mt(AV1_COMP *cpi) {
   } else {
     num_workers = AOMMIN(num_workers, cpi->num_workers);
   }
-  prepare_enc_workers(cpi, enc_worker_hook, num_workers);
+  prepare_enc_workers(cpi, enc_worker_hook, num_workers, 1);
   launch_enc_workers(cpi, num_workers);
   sync_enc_workers(cpi, num_workers);
   accumulate_counters_enc_workers(cpi, num_workers);
@@ -696,9 +708,209 @@ void av1_encode_tiles_row_mt(AV1_COMP *cpi) {
     num_workers = AOMMIN(num_workers, cpi->num_workers);
   }
   assign_tile_to_thread(multi_thread_ctxt, tile_cols * tile_rows, num_workers);
-  prepare_enc_workers(cpi, enc_row_mt_worker_hook, num_workers);
+  prepare_enc_workers(cpi, enc_row_mt_worker_hook, num_workers, 1);
   launch_enc_workers(cpi, num_workers);
   sync_enc_workers(cpi, num_workers);
   if (cm->delta_q_info.delta_lf_present_flag) update_delta_lf_for_row_mt(cpi);
   accumulate_counters_enc_workers(cpi, num_workers);
 }
+
+static int fp_enc_row_mt_worker_hook(void *arg1, void *unused) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTInfo *const row_mt_info = &cpi->fp_row_mt_info;
+  (void)unused;
+
+  while (1) {
+    int mb_row;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(cpi->row_mt_mutex_);
+#endif
+    mb_row = row_mt_info->current_mi_row;
+    if (mb_row < cm->mb_rows) ++row_mt_info->current_mi_row;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(cpi->row_mt_mutex_);
+#endif
+    if (mb_row >= cm->mb_rows) break;
+
+    av1_first_pass_row(cpi, thread_data->td, mb_row);
+  }
+
+  return 1;
+}
+
+void av1_first_pass_row_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTSync *const row_mt_sync = &cpi->fp_row_mt_sync;
+  int num_workers = AOMMIN(cpi->oxcf.max_threads,
+                           AOMMIN((cm->mb_cols + 1) >> 1, cm->mb_rows));
+
+  if (row_mt_sync->rows != cm->mb_rows) {
+    av1_row_mt_sync_mem_dealloc(row_mt_sync);
+    av1_row_mt_sync_mem_alloc(row_mt_sync, cm, cm->mb_rows);
+  }
+  // Initialize cur_col to -1 for all rows.
+  memset(row_mt_sync->cur_col, -1,
+         sizeof(*row_mt_sync->cur_col) * cm->mb_rows);
+  cpi->fp_row_mt_info.current_mi_row = 0;
+  cpi->fp_row_mt_info.num_threads_working = 0;
+
+  // Only run once to create threads and allocate thread data.
+  if (cpi->num_workers == 0) {
+    create_enc_workers(cpi, num_workers);
+  } else {
+    num_workers = AOMMIN(num_workers, cpi->num_workers);
+  }
+  prepare_enc_workers(cpi, fp_enc_row_mt_worker_hook, num_workers, 1);
+  launch_enc_workers(cpi, num_workers);
+  sync_enc_workers(cpi, num_workers);
+}
+
+static int tpl_worker_hook(void *arg1, void *unused) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1_COMMON *const cm = &cpi->common;
+  AV1RowMTInfo *const row_mt_info = &cpi->tpl_row_mt_info;
+  const int mi_height = mi_size_high[cpi->tpl_frame_ctxt.bsize];
+  (void)unused;
+
+  while (1) {
+    int mi_row;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(cpi->row_mt_mutex_);
+#endif
+    mi_row = row_mt_info->current_mi_row;
+    if (mi_row < cm->mi_rows) row_mt_info->current_mi_row += mi_height;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(cpi->row_mt_mutex_);
+#endif
+    if (mi_row >= cm->mi_rows) break;
+
+    av1_mc_flow_dispenser_row(cpi, thread_data->td, mi_row);
+  }
+
+  return 1;
+}
+
+void av1_mc_flow_dispenser_mt(AV1_COMP *cpi) {
+  AV1_COMMON *const cm = &cpi->common;
+  const BLOCK_SIZE bsize = cpi->tpl_frame_ctxt.bsize;
+  const int tpl_rows =
+      (cm->mi_rows + mi_size_high[bsize] - 1) / mi_size_high[bsize];
+  int num_workers = AOMMIN(cpi->oxcf.max_threads, tpl_rows);
+
+  cpi->tpl_row_mt_info.current_mi_row = 0;
+  cpi->tpl_row_mt_info.num_threads_working = 0;
+
+  // Only run once to create threads and allocate thread data.
+  if (cpi->num_workers == 0) {
+    create_enc_workers(cpi, num_workers);
+  } else {
+    num_workers = AOMMIN(num_workers, cpi->num_workers);
+  }
+  prepare_enc_workers(cpi, tpl_worker_hook, num_workers, 1);
+  launch_enc_workers(cpi, num_workers);
+  sync_enc_workers(cpi, num_workers);
+}
+
+static int tf_worker_hook(void *arg1, void *unused) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1_COMP *const cpi = thread_data->cpi;
+  AV1RowMTInfo *const row_mt_info = &cpi->tf_row_mt_info;
+  const int mb_rows = cpi->tf_ctxt.mb_rows;
+  (void)unused;
+
+  while (1) {
+    int mb_row;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_lock(cpi->row_mt_mutex_);
+#endif
+    mb_row = row_mt_info->current_mi_row;
+    if (mb_row < mb_rows) row_mt_info->current_mi_row++;
+#if CONFIG_MULTITHREAD
+    pthread_mutex_unlock(cpi->row_mt_mutex_);
+#endif
+    if (mb_row >= mb_rows) break;
+
+    av1_temporal_filter_row(cpi, thread_data->td, mb_row);
+  }
+
+  return 1;
+}
+
+void av1_temporal_filter_row_mt(AV1_COMP *cpi) {
+  int num_workers = AOMMIN(cpi->oxcf.max_threads, cpi->tf_ctxt.mb_rows);
+
+  cpi->tf_row_mt_info.current_mi_row = 0;
+  cpi->tf_row_mt_info.num_threads_working = 0;
+
+  // Only run once to create threads and allocate thread data.
+  if (cpi->num_workers == 0) {
+    create_enc_workers(cpi, num_workers);
+  } else {
+    num_workers = AOMMIN(num_workers, cpi->num_workers);
+  }
+  prepare_enc_workers(cpi, tf_worker_hook, num_workers, 1);
+  launch_enc_workers(cpi, num_workers);
+  sync_enc_workers(cpi, num_workers);
+}
+
+static int pack_tile_worker_hook(void *arg1, void *unused) {
+  EncWorkerData *const thread_data = (EncWorkerData *)arg1;
+  AV1_COMP *const cpi = thread_data->cpi;
+  const AV1_COMMON *const cm = &cpi->common;
+  const int tile_cols = cm->tile_cols;
+  const int tile_rows = cm->tile_rows;
+  (void)unused;
+
+  av1_reset_pack_bs_thread_data(thread_data->td);
+  for (int t = thread_data->start; t < tile_rows * tile_cols;
+       t += cpi->num_pack_workers) {
+    av1_pack_tile(cpi, thread_data->td, t / tile_cols, t % tile_cols);
+  }
+
+  return 1;
+}
+
+void av1_pack_tiles_mt(AV1_COMP *cpi) {
+  const AV1_COMMON *const cm = &cpi->common;
+  int num_workers =
+      AOMMIN(cpi->oxcf.max_threads, cm->tile_cols * cm->tile_rows);
+
+  // Only run once to create threads and allocate thread data.
+  if (cpi->num_workers == 0) {
+    create_enc_workers(cpi, num_workers);
+  } else {
+    num_workers = AOMMIN(num_workers, cpi->num_workers);
+  }
+  cpi->num_pack_workers = num_workers;
+  prepare_enc_workers(cpi, pack_tile_worker_hook, num_workers, 0);
+  launch_enc_workers(cpi, num_workers);
+  sync_enc_workers(cpi, num_workers);
+
+  // The caller merges the statistics of cpi->td with those of the tiles it
+  // packs itself.
+  for (int i = 0; i < num_workers; ++i) {
+    const ThreadData *const td = cpi->tile_thr_data[i].td;
+    if (td != &cpi->td) av1_accumulate_pack_bs_thread_data(cpi, td);
+  }
+}
+
+#if CONFIG_DENOISE
+int av1_denoise_and_model_row_mt(AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                                 aom_film_grain_t *film_grain) {
+  const int block_size = cpi->oxcf.noise_block_size;
+  const int block_rows = (sd->y_height + block_size - 1) / block_size;
+  int num_workers = AOMMIN(cpi->oxcf.max_threads, block_rows);
+
+  // Only run once to create threads and allocate thread data.
+  if (cpi->num_workers == 0) {
+    create_enc_workers(cpi, num_workers);
+  } else {
+    num_workers = AOMMIN(num_workers, cpi->num_workers);
+  }
+  return aom_denoise_and_model_run_mt(cpi->denoise_and_model, sd, film_grain,
+                                      cpi->workers, num_workers);
+}
+#endif  // CONFIG_DENOISE
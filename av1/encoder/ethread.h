@@ -44,6 +44,32 @@ void av1_row_mt_sync_mem_alloc(AV1RowMTSync *row_mt_sync, struct AV1Common *cm,
 void av1_encode_tiles_mt(struct AV1_COMP *cpi);
 void av1_encode_tiles_row_mt(struct AV1_COMP *cpi);
 
+// Runs the first pass over all 16x16 macroblock rows using row based
+// multi-threading, with the wavefront synced on cpi->fp_row_mt_sync.
+void av1_first_pass_row_mt(struct AV1_COMP *cpi);
+
+// Runs the TPL model over the block rows of the frame in cpi->tpl_frame_ctxt
+// using row based multi-threading.
+void av1_mc_flow_dispenser_mt(struct AV1_COMP *cpi);
+
+// Filters the 32x32 block rows of the ARF described by cpi->tf_ctxt using row
+// based multi-threading. Each thread accumulates into its own buffers, so the
+// result matches the single threaded filter.
+void av1_temporal_filter_row_mt(struct AV1_COMP *cpi);
+
+// Packs each tile of the frame into the pack_bc writer of its TileDataEnc,
+// splitting the tiles between the encoder workers. The statistics gathered by
+// the workers are merged into cpi, except those of cpi->td.
+void av1_pack_tiles_mt(struct AV1_COMP *cpi);
+
+#if CONFIG_DENOISE
+// Denoises sd and models its noise into film_grain with cpi->denoise_and_model,
+// splitting the noise block rows between the encoder workers. Returns 0 on
+// error, like aom_denoise_and_model_run().
+int av1_denoise_and_model_row_mt(struct AV1_COMP *cpi, YV12_BUFFER_CONFIG *sd,
+                                 aom_film_grain_t *film_grain);
+#endif  // CONFIG_DENOISE
+
 void av1_accumulate_frame_counts(struct FRAME_COUNTS *acc_counts,
                                  const struct FRAME_COUNTS *counts);
 
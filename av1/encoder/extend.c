@@ -22,7 +22,8 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
                                   int extend_bottom, int extend_right) {
   int i, linesize;
 
-  // copy the left and right most columns out
+  // copy the left and right most columns out, or only extend them when
+  // src == dst
   const uint8_t *src_ptr1 = src;
   const uint8_t *src_ptr2 = src + w - 1;
   uint8_t *dst_ptr1 = dst - extend_left;
@@ -30,7 +31,7 @@ static void copy_and_extend_plane(const uint8_t *src, int src_pitch,
 
   for (i = 0; i < h; i++) {
     memset(dst_ptr1, src_ptr1[0], extend_left);
-    memcpy(dst_ptr1 + extend_left, src_ptr1, w);
+    if (src != dst) memcpy(dst_ptr1 + extend_left, src_ptr1, w);
     memset(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
@@ -65,7 +66,8 @@ static void highbd_copy_and_extend_plane(const uint8_t *src8, int src_pitch,
   uint16_t *src = CONVERT_TO_SHORTPTR(src8);
   uint16_t *dst = CONVERT_TO_SHORTPTR(dst8);
 
-  // copy the left and right most columns out
+  // copy the left and right most columns out, or only extend them when
+  // src == dst
   const uint16_t *src_ptr1 = src;
   const uint16_t *src_ptr2 = src + w - 1;
   uint16_t *dst_ptr1 = dst - extend_left;
@@ -73,7 +75,8 @@ static void highbd_copy_and_extend_plane(const uint8_t *src8, int src_pitch,
 
   for (i = 0; i < h; i++) {
     aom_memset16(dst_ptr1, src_ptr1[0], extend_left);
-    memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
+    if (src != dst)
+      memcpy(dst_ptr1 + extend_left, src_ptr1, w * sizeof(src_ptr1[0]));
     aom_memset16(dst_ptr2, src_ptr2[0], extend_right);
     src_ptr1 += src_pitch;
     src_ptr2 += src_pitch;
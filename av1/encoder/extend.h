@@ -19,6 +19,8 @@
 extern "C" {
 #endif
 
+// src and dst may be the same frame, in which case its borders are extended
+// in place.
 void av1_copy_and_extend_frame(const YV12_BUFFER_CONFIG *src,
                                YV12_BUFFER_CONFIG *dst);
 
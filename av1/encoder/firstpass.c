@@ -37,6 +37,7 @@
 #include "av1/encoder/encodemv.h"
 #include "av1/encoder/encoder.h"
 #include "av1/encoder/encode_strategy.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/extend.h"
 #include "av1/encoder/firstpass.h"
 #include "av1/encoder/mcomp.h"
@@ -318,9 +319,21 @@ static double raw_motion_error_stdev(int *raw_motion_err_list,
 
 #define UL_INTRA_THRESH 50
 #define INVALID_ROW -1
-void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
-  int mb_row, mb_col;
-  MACROBLOCK *const x = &cpi->td.mb;
+
+static const YV12_BUFFER_CONFIG *get_first_pass_alt_ref(const AV1_COMP *cpi) {
+  const int alt_offset =
+      16 - (cpi->common.current_frame.frame_number % 16);
+  if (alt_offset < 16) {
+    const struct lookahead_entry *const alt_buf =
+        av1_lookahead_peek(cpi->lookahead, alt_offset);
+    if (alt_buf != NULL) return &alt_buf->img;
+  }
+  return NULL;
+}
+
+void av1_first_pass_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
+  int mb_col;
+  MACROBLOCK *const x = &td->mb;
   AV1_COMMON *const cm = &cpi->common;
   CurrentFrame *const current_frame = &cm->current_frame;
   const SequenceHeader *const seq_params = &cm->seq_params;
@@ -330,10 +343,351 @@ void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
   struct macroblock_plane *const p = x->plane;
   struct macroblockd_plane *const pd = xd->plane;
   const PICK_MODE_CONTEXT *ctx =
-      &cpi->td.pc_root[MAX_MIB_SIZE_LOG2 - MIN_MIB_SIZE_LOG2]->none;
+      &td->pc_root[MAX_MIB_SIZE_LOG2 - MIN_MIB_SIZE_LOG2]->none;
+  AV1RowMTSync *const row_mt_sync = &cpi->fp_row_mt_sync;
   int i;
 
   int recon_yoffset, src_yoffset, recon_uvoffset;
+  const int intrapenalty = INTRA_MODE_PENALTY;
+  int recon_y_stride, src_y_stride, recon_uv_stride, uv_mb_height;
+
+  const YV12_BUFFER_CONFIG *const lst_yv12 =
+      get_ref_frame_yv12_buf(cm, LAST_FRAME);
+  const YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_yv12_buf(cm, GOLDEN_FRAME);
+  const YV12_BUFFER_CONFIG *alt_yv12 = get_first_pass_alt_ref(cpi);
+  YV12_BUFFER_CONFIG *const new_yv12 = &cm->cur_frame->buf;
+  const int qindex = find_fp_qindex(seq_params->bit_depth);
+  const int mb_scale = mi_size_wide[BLOCK_16X16];
+  FIRSTPASS_MB_STATS *mb_stats =
+      cpi->firstpass_data.mb_stats + mb_row * cm->mb_cols;
+  int *raw_motion_err_list =
+      cpi->firstpass_data.raw_motion_err_list + mb_row * cm->mb_cols;
+
+  for (i = 0; i < num_planes; ++i) {
+    p[i].coeff = ctx->coeff[i];
+    p[i].qcoeff = ctx->qcoeff[i];
+    pd[i].dqcoeff = ctx->dqcoeff[i];
+    p[i].eobs = ctx->eobs[i];
+    p[i].txb_entropy_ctx = ctx->txb_entropy_ctx[i];
+  }
+
+  // Tiling is ignored in the first pass.
+  av1_tile_init(&tile, cm, 0, 0);
+  src_y_stride = cpi->source->y_stride;
+  recon_y_stride = new_yv12->y_stride;
+  recon_uv_stride = new_yv12->uv_stride;
+  uv_mb_height = 16 >> (new_yv12->y_height > new_yv12->uv_height);
+
+  MV best_ref_mv = kZeroMv;
+
+  // Reset above block coeffs.
+  xd->up_available = (mb_row != 0);
+  recon_yoffset = (mb_row * recon_y_stride * 16);
+  src_yoffset = (mb_row * src_y_stride * 16);
+  recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
+  int alt_yv12_yoffset =
+      (alt_yv12 != NULL) ? mb_row * alt_yv12->y_stride * 16 : -1;
+
+  x->plane[0].src.buf = cpi->source->y_buffer + src_yoffset;
+  for (i = 1; i < num_planes; ++i) {
+    x->plane[i].src.buf = cpi->source->buffers[i] +
+                          mb_row * x->plane[1].src.stride * uv_mb_height;
+  }
+
+  // Set up limit values for motion vectors to prevent them extending
+  // outside the UMV borders.
+  x->mv_limits.row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
+  x->mv_limits.row_max =
+      ((cm->mb_rows - 1 - mb_row) * 16) + BORDER_MV_PIXELS_B16;
+
+  for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
+    int this_intra_error;
+    const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
+    const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
+    double log_intra;
+    int level_sample;
+    FIRSTPASS_MB_STATS *const stats = &mb_stats[mb_col];
+
+    // Wait for the macroblocks above and above right to be reconstructed.
+    (*(cpi->row_mt_sync_read_ptr))(row_mt_sync, mb_row, mb_col);
+
+    aom_clear_system_state();
+
+    const int idx_str = xd->mi_stride * mb_row * mb_scale + mb_col * mb_scale;
+    xd->mi = cm->mi_grid_visible + idx_str;
+    xd->mi[0] = cm->mi + idx_str;
+    xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
+    xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
+    xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
+    xd->left_available = (mb_col != 0);
+    xd->mi[0]->sb_type = bsize;
+    xd->mi[0]->ref_frame[0] = INTRA_FRAME;
+    set_mi_row_col(xd, &tile, mb_row * mb_scale, mi_size_high[bsize],
+                   mb_col * mb_scale, mi_size_wide[bsize], cm->mi_rows,
+                   cm->mi_cols);
+
+    set_plane_n4(xd, mi_size_wide[bsize], mi_size_high[bsize], num_planes);
+
+    // Do intra 16x16 prediction.
+    xd->mi[0]->segment_id = 0;
+    xd->lossless[xd->mi[0]->segment_id] = (qindex == 0);
+    xd->mi[0]->mode = DC_PRED;
+    xd->mi[0]->tx_size =
+        use_dc_pred ? (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
+    av1_encode_intra_block_plane(cpi, x, bsize, 0, 0, mb_row * 2, mb_col * 2);
+    this_intra_error = aom_get_mb_ss(x->plane[0].src_diff);
+
+    stats->intra_skip = this_intra_error < UL_INTRA_THRESH;
+
+    if (seq_params->use_highbitdepth) {
+      switch (seq_params->bit_depth) {
+        case AOM_BITS_8: break;
+        case AOM_BITS_10: this_intra_error >>= 4; break;
+        case AOM_BITS_12: this_intra_error >>= 8; break;
+        default:
+          assert(0 &&
+                 "seq_params->bit_depth should be AOM_BITS_8, "
+                 "AOM_BITS_10 or AOM_BITS_12");
+          return;
+      }
+    }
+
+    aom_clear_system_state();
+    log_intra = log(this_intra_error + 1.0);
+    if (log_intra < 10.0)
+      stats->intra_factor = 1.0 + ((10.0 - log_intra) * 0.05);
+    else
+      stats->intra_factor = 1.0;
+
+    if (seq_params->use_highbitdepth)
+      level_sample = CONVERT_TO_SHORTPTR(x->plane[0].src.buf)[0];
+    else
+      level_sample = x->plane[0].src.buf[0];
+    if ((level_sample < DARK_THRESH) && (log_intra < 9.0))
+      stats->brightness_factor = 1.0 + (0.01 * (DARK_THRESH - level_sample));
+    else
+      stats->brightness_factor = 1.0;
+
+    // Intrapenalty below deals with situations where the intra and inter
+    // error scores are very low (e.g. a plain black frame).
+    // We do not have special cases in first pass for 0,0 and nearest etc so
+    // all inter modes carry an overhead cost estimate for the mv.
+    // When the error score is very low this causes us to pick all or lots of
+    // INTRA modes and throw lots of key frames.
+    // This penalty adds a cost matching that of a 0,0 mv to the intra case.
+    this_intra_error += intrapenalty;
+
+    // Accumulate the intra error.
+    stats->intra_error = this_intra_error;
+
+    const int hbd = is_cur_buf_hbd(xd);
+    const int stride = x->plane[0].src.stride;
+    uint8_t *buf = x->plane[0].src.buf;
+    for (int r8 = 0; r8 < 2; ++r8) {
+      for (int c8 = 0; c8 < 2; ++c8) {
+        stats->frame_avg_wavelet_energy += av1_haar_ac_sad_8x8_uint8_input(
+            buf + c8 * 8 + r8 * 8 * stride, stride, hbd);
+      }
+    }
+
+    // Set up limit values for motion vectors to prevent them extending
+    // outside the UMV borders.
+    x->mv_limits.col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
+    x->mv_limits.col_max =
+        ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
+
+    if (!frame_is_intra_only(cm)) {  // Do a motion search
+      int tmp_err, motion_error, raw_motion_error;
+      // Assume 0,0 motion with no mv overhead.
+      MV mv = kZeroMv, tmp_mv = kZeroMv;
+      struct buf_2d unscaled_last_source_buf_2d;
+
+      xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
+      if (is_cur_buf_hbd(xd)) {
+        motion_error = highbd_get_prediction_error(
+            bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
+      } else {
+        motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                            &xd->plane[0].pre[0]);
+      }
+
+      // Compute the motion error of the 0,0 motion using the last source
+      // frame as the reference. Skip the further motion search on
+      // reconstructed frame if this error is small.
+      unscaled_last_source_buf_2d.buf =
+          cpi->unscaled_last_source->y_buffer + src_yoffset;
+      unscaled_last_source_buf_2d.stride = cpi->unscaled_last_source->y_stride;
+      if (is_cur_buf_hbd(xd)) {
+        raw_motion_error = highbd_get_prediction_error(
+            bsize, &x->plane[0].src, &unscaled_last_source_buf_2d, xd->bd);
+      } else {
+        raw_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                                &unscaled_last_source_buf_2d);
+      }
+
+      // TODO(pengchong): Replace the hard-coded threshold
+      if (raw_motion_error > 25) {
+        // Test last reference frame using the previous best mv as the
+        // starting point (best reference) for the search.
+        first_pass_motion_search(cpi, x, &best_ref_mv, &mv, &motion_error);
+
+        // If the current best reference mv is not centered on 0,0 then do a
+        // 0,0 based search as well.
+        if (!is_zero_mv(&best_ref_mv)) {
+          tmp_err = INT_MAX;
+          first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv, &tmp_err);
+
+          if (tmp_err < motion_error) {
+            motion_error = tmp_err;
+            mv = tmp_mv;
+          }
+        }
+
+        // Motion search in 2nd reference frame.
+        int gf_motion_error;
+        if ((current_frame->frame_number > 1) && gld_yv12 != NULL) {
+          // Assume 0,0 motion with no mv overhead.
+          xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
+          if (is_cur_buf_hbd(xd)) {
+            gf_motion_error = highbd_get_prediction_error(
+                bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
+          } else {
+            gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                                   &xd->plane[0].pre[0]);
+          }
+
+          first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv,
+                                   &gf_motion_error);
+
+          if (gf_motion_error < motion_error &&
+              gf_motion_error < this_intra_error)
+            stats->second_ref = 1;
+
+          // Reset to last frame as reference buffer.
+          xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
+          xd->plane[1].pre[0].buf = lst_yv12->u_buffer + recon_uvoffset;
+          xd->plane[2].pre[0].buf = lst_yv12->v_buffer + recon_uvoffset;
+
+          // In accumulating a score for the 2nd reference frame take the
+          // best of the motion predicted score and the intra coded error
+          // (just as will be done for) accumulation of "coded_error" for
+          // the last frame.
+          if (gf_motion_error < this_intra_error)
+            stats->sr_coded_error = gf_motion_error;
+          else
+            stats->sr_coded_error = this_intra_error;
+        } else {
+          gf_motion_error = motion_error;
+          stats->sr_coded_error = motion_error;
+        }
+
+        // Motion search in 3rd reference frame.
+        if (alt_yv12 != NULL) {
+          xd->plane[0].pre[0].buf = alt_yv12->y_buffer + alt_yv12_yoffset;
+          xd->plane[0].pre[0].stride = alt_yv12->y_stride;
+          int alt_motion_error;
+          if (is_cur_buf_hbd(xd)) {
+            alt_motion_error = highbd_get_prediction_error(
+                bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
+          } else {
+            alt_motion_error = get_prediction_error(bsize, &x->plane[0].src,
+                                                    &xd->plane[0].pre[0]);
+          }
+
+          first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv,
+                                   &alt_motion_error);
+
+          if (alt_motion_error < motion_error &&
+              alt_motion_error < gf_motion_error &&
+              alt_motion_error < this_intra_error)
+            stats->third_ref = 1;
+
+          // Reset to last frame as reference buffer.
+          xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
+          xd->plane[0].pre[0].stride = lst_yv12->y_stride;
+
+          // In accumulating a score for the 3rd reference frame take the
+          // best of the motion predicted score and the intra coded error
+          // (just as will be done for) accumulation of "coded_error" for
+          // the last frame.
+          stats->tr_coded_error = AOMMIN(alt_motion_error, this_intra_error);
+        } else {
+          stats->tr_coded_error = motion_error;
+        }
+      } else {
+        stats->sr_coded_error = motion_error;
+        stats->tr_coded_error = motion_error;
+      }
+
+      // Start by assuming that intra mode is best.
+      best_ref_mv.row = 0;
+      best_ref_mv.col = 0;
+
+      if (motion_error <= this_intra_error) {
+        aom_clear_system_state();
+
+        // Keep a count of cases where the inter and intra were very close
+        // and very low. This helps with scene cut detection for example in
+        // cropped clips with black bars at the sides or top and bottom.
+        if (((this_intra_error - intrapenalty) * 9 <= motion_error * 10) &&
+            (this_intra_error < (2 * intrapenalty))) {
+          stats->neutral_count = 1.0;
+          // Also track cases where the intra is not much worse than the inter
+          // and use this in limiting the GF/arf group length.
+        } else if ((this_intra_error > NCOUNT_INTRA_THRESH) &&
+                   (this_intra_error < (NCOUNT_INTRA_FACTOR * motion_error))) {
+          stats->neutral_count = (double)motion_error /
+                                 DOUBLE_DIVIDE_CHECK((double)this_intra_error);
+        }
+
+        mv.row *= 8;
+        mv.col *= 8;
+        this_intra_error = motion_error;
+        xd->mi[0]->mode = NEWMV;
+        xd->mi[0]->mv[0].as_mv = mv;
+        xd->mi[0]->tx_size = TX_4X4;
+        xd->mi[0]->ref_frame[0] = LAST_FRAME;
+        xd->mi[0]->ref_frame[1] = NONE_FRAME;
+        av1_enc_build_inter_predictor(cm, xd, mb_row * mb_scale,
+                                      mb_col * mb_scale, NULL, bsize,
+                                      AOM_PLANE_Y, AOM_PLANE_Y);
+        av1_encode_sby_pass1(cm, x, bsize);
+        stats->inter = 1;
+        stats->mv = mv;
+
+        best_ref_mv = mv;
+      }
+      raw_motion_err_list[mb_col] = raw_motion_error;
+    } else {
+      stats->sr_coded_error = this_intra_error;
+      stats->tr_coded_error = this_intra_error;
+    }
+    stats->coded_error = this_intra_error;
+
+    // Adjust to the next column of MBs.
+    x->plane[0].src.buf += 16;
+    x->plane[1].src.buf += uv_mb_height;
+    x->plane[2].src.buf += uv_mb_height;
+
+    recon_yoffset += 16;
+    src_yoffset += 16;
+    recon_uvoffset += uv_mb_height;
+    alt_yv12_yoffset += 16;
+
+    (*(cpi->row_mt_sync_write_ptr))(row_mt_sync, mb_row, mb_col, cm->mb_cols);
+  }
+  aom_clear_system_state();
+}
+
+void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
+  int mb_row, mb_col;
+  MACROBLOCK *const x = &cpi->td.mb;
+  AV1_COMMON *const cm = &cpi->common;
+  CurrentFrame *const current_frame = &cm->current_frame;
+  const SequenceHeader *const seq_params = &cm->seq_params;
+  const int num_planes = av1_num_planes(cm);
+  MACROBLOCKD *const xd = &x->e_mbd;
+
   int64_t intra_error = 0;
   int64_t frame_avg_wavelet_energy = 0;
   int64_t coded_error = 0;
@@ -347,7 +701,6 @@ void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
   int intercount = 0;
   int second_ref_count = 0;
   int third_ref_count = 0;
-  const int intrapenalty = INTRA_MODE_PENALTY;
   double neutral_count;
   int intra_skip_count = 0;
   int image_data_start_row = INVALID_ROW;
@@ -355,31 +708,17 @@ void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
   int sum_in_vectors = 0;
   MV lastmv = kZeroMv;
   TWO_PASS *twopass = &cpi->twopass;
-  int recon_y_stride, src_y_stride, recon_uv_stride, uv_mb_height;
 
   const YV12_BUFFER_CONFIG *const lst_yv12 =
       get_ref_frame_yv12_buf(cm, LAST_FRAME);
   const YV12_BUFFER_CONFIG *gld_yv12 = get_ref_frame_yv12_buf(cm, GOLDEN_FRAME);
-  const YV12_BUFFER_CONFIG *alt_yv12 = NULL;
-  const int alt_offset = 16 - (current_frame->frame_number % 16);
-  if (alt_offset < 16) {
-    const struct lookahead_entry *const alt_buf =
-        av1_lookahead_peek(cpi->lookahead, alt_offset);
-    if (alt_buf != NULL) {
-      alt_yv12 = &alt_buf->img;
-    }
-  }
   YV12_BUFFER_CONFIG *const new_yv12 = &cm->cur_frame->buf;
   double intra_factor;
   double brightness_factor;
   const int qindex = find_fp_qindex(seq_params->bit_depth);
-  const int mb_scale = mi_size_wide[BLOCK_16X16];
 
-  int *raw_motion_err_list;
+  FIRSTPASS_DATA *const fp_data = &cpi->firstpass_data;
   int raw_motion_err_counts = 0;
-  CHECK_MEM_ERROR(
-      cm, raw_motion_err_list,
-      aom_calloc(cm->mb_rows * cm->mb_cols, sizeof(*raw_motion_err_list)));
   // First pass code requires valid last and new frame buffers.
   assert(new_yv12 != NULL);
   assert(frame_is_intra_only(cm) || (lst_yv12 != NULL));
@@ -387,6 +726,13 @@ void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
   av1_setup_frame_size(cpi);
   aom_clear_system_state();
 
+  CHECK_MEM_ERROR(cm, fp_data->mb_stats,
+                  aom_calloc(cm->mb_rows * cm->mb_cols,
+                             sizeof(*fp_data->mb_stats)));
+  CHECK_MEM_ERROR(cm, fp_data->raw_motion_err_list,
+                  aom_calloc(cm->mb_rows * cm->mb_cols,
+                             sizeof(*fp_data->raw_motion_err_list)));
+
   xd->mi = cm->mi_grid_visible;
   xd->mi[0] = cm->mi;
   x->e_mbd.mi[0]->sb_type = BLOCK_16X16;
@@ -419,368 +765,98 @@ void av1_first_pass(AV1_COMP *cpi, const int64_t ts_duration) {
   xd->cfl.store_y = 0;
   av1_frame_init_quantizer(cpi);
 
-  for (i = 0; i < num_planes; ++i) {
-    p[i].coeff = ctx->coeff[i];
-    p[i].qcoeff = ctx->qcoeff[i];
-    pd[i].dqcoeff = ctx->dqcoeff[i];
-    p[i].eobs = ctx->eobs[i];
-    p[i].txb_entropy_ctx = ctx->txb_entropy_ctx[i];
-  }
-
   av1_init_mv_probs(cm);
   av1_initialize_rd_consts(cpi);
 
-  // Tiling is ignored in the first pass.
-  av1_tile_init(&tile, cm, 0, 0);
-  src_y_stride = cpi->source->y_stride;
-  recon_y_stride = new_yv12->y_stride;
-  recon_uv_stride = new_yv12->uv_stride;
-  uv_mb_height = 16 >> (new_yv12->y_height > new_yv12->uv_height);
+  if (cpi->oxcf.row_mt == 1 && cpi->oxcf.max_threads > 1) {
+    cpi->row_mt_sync_read_ptr = av1_row_mt_sync_read;
+    cpi->row_mt_sync_write_ptr = av1_row_mt_sync_write;
+    av1_first_pass_row_mt(cpi);
+  } else {
+    cpi->row_mt_sync_read_ptr = av1_row_mt_sync_read_dummy;
+    cpi->row_mt_sync_write_ptr = av1_row_mt_sync_write_dummy;
+    for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row)
+      av1_first_pass_row(cpi, &cpi->td, mb_row);
+  }
 
+  // Add up the macroblock results in raster order, as if the frame was coded
+  // by a single thread.
   for (mb_row = 0; mb_row < cm->mb_rows; ++mb_row) {
-    MV best_ref_mv = kZeroMv;
-
-    // Reset above block coeffs.
-    xd->up_available = (mb_row != 0);
-    recon_yoffset = (mb_row * recon_y_stride * 16);
-    src_yoffset = (mb_row * src_y_stride * 16);
-    recon_uvoffset = (mb_row * recon_uv_stride * uv_mb_height);
-    int alt_yv12_yoffset =
-        (alt_yv12 != NULL) ? mb_row * alt_yv12->y_stride * 16 : -1;
-
-    // Set up limit values for motion vectors to prevent them extending
-    // outside the UMV borders.
-    x->mv_limits.row_min = -((mb_row * 16) + BORDER_MV_PIXELS_B16);
-    x->mv_limits.row_max =
-        ((cm->mb_rows - 1 - mb_row) * 16) + BORDER_MV_PIXELS_B16;
-
     for (mb_col = 0; mb_col < cm->mb_cols; ++mb_col) {
-      int this_intra_error;
-      const int use_dc_pred = (mb_col || mb_row) && (!mb_col || !mb_row);
-      const BLOCK_SIZE bsize = get_bsize(cm, mb_row, mb_col);
-      double log_intra;
-      int level_sample;
-
-      aom_clear_system_state();
-
-      const int idx_str = xd->mi_stride * mb_row * mb_scale + mb_col * mb_scale;
-      xd->mi = cm->mi_grid_visible + idx_str;
-      xd->mi[0] = cm->mi + idx_str;
-      xd->plane[0].dst.buf = new_yv12->y_buffer + recon_yoffset;
-      xd->plane[1].dst.buf = new_yv12->u_buffer + recon_uvoffset;
-      xd->plane[2].dst.buf = new_yv12->v_buffer + recon_uvoffset;
-      xd->left_available = (mb_col != 0);
-      xd->mi[0]->sb_type = bsize;
-      xd->mi[0]->ref_frame[0] = INTRA_FRAME;
-      set_mi_row_col(xd, &tile, mb_row * mb_scale, mi_size_high[bsize],
-                     mb_col * mb_scale, mi_size_wide[bsize], cm->mi_rows,
-                     cm->mi_cols);
-
-      set_plane_n4(xd, mi_size_wide[bsize], mi_size_high[bsize], num_planes);
-
-      // Do intra 16x16 prediction.
-      xd->mi[0]->segment_id = 0;
-      xd->lossless[xd->mi[0]->segment_id] = (qindex == 0);
-      xd->mi[0]->mode = DC_PRED;
-      xd->mi[0]->tx_size =
-          use_dc_pred ? (bsize >= BLOCK_16X16 ? TX_16X16 : TX_8X8) : TX_4X4;
-      av1_encode_intra_block_plane(cpi, x, bsize, 0, 0, mb_row * 2, mb_col * 2);
-      this_intra_error = aom_get_mb_ss(x->plane[0].src_diff);
-
-      if (this_intra_error < UL_INTRA_THRESH) {
+      const FIRSTPASS_MB_STATS *const stats =
+          &fp_data->mb_stats[mb_row * cm->mb_cols + mb_col];
+
+      if (stats->intra_skip) {
         ++intra_skip_count;
       } else if ((mb_col > 0) && (image_data_start_row == INVALID_ROW)) {
         image_data_start_row = mb_row;
       }
-
-      if (seq_params->use_highbitdepth) {
-        switch (seq_params->bit_depth) {
-          case AOM_BITS_8: break;
-          case AOM_BITS_10: this_intra_error >>= 4; break;
-          case AOM_BITS_12: this_intra_error >>= 8; break;
-          default:
-            assert(0 &&
-                   "seq_params->bit_depth should be AOM_BITS_8, "
-                   "AOM_BITS_10 or AOM_BITS_12");
-            return;
-        }
-      }
-
-      aom_clear_system_state();
-      log_intra = log(this_intra_error + 1.0);
-      if (log_intra < 10.0)
-        intra_factor += 1.0 + ((10.0 - log_intra) * 0.05);
-      else
-        intra_factor += 1.0;
-
-      if (seq_params->use_highbitdepth)
-        level_sample = CONVERT_TO_SHORTPTR(x->plane[0].src.buf)[0];
-      else
-        level_sample = x->plane[0].src.buf[0];
-      if ((level_sample < DARK_THRESH) && (log_intra < 9.0))
-        brightness_factor += 1.0 + (0.01 * (DARK_THRESH - level_sample));
-      else
-        brightness_factor += 1.0;
-
-      // Intrapenalty below deals with situations where the intra and inter
-      // error scores are very low (e.g. a plain black frame).
-      // We do not have special cases in first pass for 0,0 and nearest etc so
-      // all inter modes carry an overhead cost estimate for the mv.
-      // When the error score is very low this causes us to pick all or lots of
-      // INTRA modes and throw lots of key frames.
-      // This penalty adds a cost matching that of a 0,0 mv to the intra case.
-      this_intra_error += intrapenalty;
-
-      // Accumulate the intra error.
-      intra_error += (int64_t)this_intra_error;
-
-      const int hbd = is_cur_buf_hbd(xd);
-      const int stride = x->plane[0].src.stride;
-      uint8_t *buf = x->plane[0].src.buf;
-      for (int r8 = 0; r8 < 2; ++r8) {
-        for (int c8 = 0; c8 < 2; ++c8) {
-          frame_avg_wavelet_energy += av1_haar_ac_sad_8x8_uint8_input(
-              buf + c8 * 8 + r8 * 8 * stride, stride, hbd);
-        }
-      }
-
-      // Set up limit values for motion vectors to prevent them extending
-      // outside the UMV borders.
-      x->mv_limits.col_min = -((mb_col * 16) + BORDER_MV_PIXELS_B16);
-      x->mv_limits.col_max =
-          ((cm->mb_cols - 1 - mb_col) * 16) + BORDER_MV_PIXELS_B16;
-
-      if (!frame_is_intra_only(cm)) {  // Do a motion search
-        int tmp_err, motion_error, raw_motion_error;
-        // Assume 0,0 motion with no mv overhead.
-        MV mv = kZeroMv, tmp_mv = kZeroMv;
-        struct buf_2d unscaled_last_source_buf_2d;
-
-        xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
-        if (is_cur_buf_hbd(xd)) {
-          motion_error = highbd_get_prediction_error(
-              bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
-        } else {
-          motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                              &xd->plane[0].pre[0]);
-        }
-
-        // Compute the motion error of the 0,0 motion using the last source
-        // frame as the reference. Skip the further motion search on
-        // reconstructed frame if this error is small.
-        unscaled_last_source_buf_2d.buf =
-            cpi->unscaled_last_source->y_buffer + src_yoffset;
-        unscaled_last_source_buf_2d.stride =
-            cpi->unscaled_last_source->y_stride;
-        if (is_cur_buf_hbd(xd)) {
-          raw_motion_error = highbd_get_prediction_error(
-              bsize, &x->plane[0].src, &unscaled_last_source_buf_2d, xd->bd);
-        } else {
-          raw_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                  &unscaled_last_source_buf_2d);
-        }
-
-        // TODO(pengchong): Replace the hard-coded threshold
-        if (raw_motion_error > 25) {
-          // Test last reference frame using the previous best mv as the
-          // starting point (best reference) for the search.
-          first_pass_motion_search(cpi, x, &best_ref_mv, &mv, &motion_error);
-
-          // If the current best reference mv is not centered on 0,0 then do a
-          // 0,0 based search as well.
-          if (!is_zero_mv(&best_ref_mv)) {
-            tmp_err = INT_MAX;
-            first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv, &tmp_err);
-
-            if (tmp_err < motion_error) {
-              motion_error = tmp_err;
-              mv = tmp_mv;
-            }
-          }
-
-          // Motion search in 2nd reference frame.
-          int gf_motion_error;
-          if ((current_frame->frame_number > 1) && gld_yv12 != NULL) {
-            // Assume 0,0 motion with no mv overhead.
-            xd->plane[0].pre[0].buf = gld_yv12->y_buffer + recon_yoffset;
-            if (is_cur_buf_hbd(xd)) {
-              gf_motion_error = highbd_get_prediction_error(
-                  bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
-            } else {
-              gf_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                     &xd->plane[0].pre[0]);
-            }
-
-            first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv,
-                                     &gf_motion_error);
-
-            if (gf_motion_error < motion_error &&
-                gf_motion_error < this_intra_error)
-              ++second_ref_count;
-
-            // Reset to last frame as reference buffer.
-            xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
-            xd->plane[1].pre[0].buf = lst_yv12->u_buffer + recon_uvoffset;
-            xd->plane[2].pre[0].buf = lst_yv12->v_buffer + recon_uvoffset;
-
-            // In accumulating a score for the 2nd reference frame take the
-            // best of the motion predicted score and the intra coded error
-            // (just as will be done for) accumulation of "coded_error" for
-            // the last frame.
-            if (gf_motion_error < this_intra_error)
-              sr_coded_error += gf_motion_error;
-            else
-              sr_coded_error += this_intra_error;
-          } else {
-            gf_motion_error = motion_error;
-            sr_coded_error += motion_error;
-          }
-
-          // Motion search in 3rd reference frame.
-          if (alt_yv12 != NULL) {
-            xd->plane[0].pre[0].buf = alt_yv12->y_buffer + alt_yv12_yoffset;
-            xd->plane[0].pre[0].stride = alt_yv12->y_stride;
-            int alt_motion_error;
-            if (is_cur_buf_hbd(xd)) {
-              alt_motion_error = highbd_get_prediction_error(
-                  bsize, &x->plane[0].src, &xd->plane[0].pre[0], xd->bd);
-            } else {
-              alt_motion_error = get_prediction_error(bsize, &x->plane[0].src,
-                                                      &xd->plane[0].pre[0]);
-            }
-
-            first_pass_motion_search(cpi, x, &kZeroMv, &tmp_mv,
-                                     &alt_motion_error);
-
-            if (alt_motion_error < motion_error &&
-                alt_motion_error < gf_motion_error &&
-                alt_motion_error < this_intra_error)
-              ++third_ref_count;
-
-            // Reset to last frame as reference buffer.
-            xd->plane[0].pre[0].buf = lst_yv12->y_buffer + recon_yoffset;
-            xd->plane[0].pre[0].stride = lst_yv12->y_stride;
-
-            // In accumulating a score for the 3rd reference frame take the
-            // best of the motion predicted score and the intra coded error
-            // (just as will be done for) accumulation of "coded_error" for
-            // the last frame.
-            tr_coded_error += AOMMIN(alt_motion_error, this_intra_error);
-          } else {
-            tr_coded_error += motion_error;
+      intra_factor += stats->intra_factor;
+      brightness_factor += stats->brightness_factor;
+      intra_error += (int64_t)stats->intra_error;
+      frame_avg_wavelet_energy += stats->frame_avg_wavelet_energy;
+      coded_error += (int64_t)stats->coded_error;
+      sr_coded_error += (int64_t)stats->sr_coded_error;
+      tr_coded_error += (int64_t)stats->tr_coded_error;
+      second_ref_count += stats->second_ref;
+      third_ref_count += stats->third_ref;
+      neutral_count += stats->neutral_count;
+
+      if (stats->inter) {
+        const MV mv = stats->mv;
+        sum_mvr += mv.row;
+        sum_mvr_abs += abs(mv.row);
+        sum_mvc += mv.col;
+        sum_mvc_abs += abs(mv.col);
+        sum_mvrs += mv.row * mv.row;
+        sum_mvcs += mv.col * mv.col;
+        ++intercount;
+
+        if (!is_zero_mv(&mv)) {
+          ++mvcount;
+
+          // Non-zero vector, was it different from the last non zero vector?
+          if (!is_equal_mv(&mv, &lastmv)) ++new_mv_count;
+          lastmv = mv;
+
+          // Does the row vector point inwards or outwards?
+          if (mb_row < cm->mb_rows / 2) {
+            if (mv.row > 0)
+              --sum_in_vectors;
+            else if (mv.row < 0)
+              ++sum_in_vectors;
+          } else if (mb_row > cm->mb_rows / 2) {
+            if (mv.row > 0)
+              ++sum_in_vectors;
+            else if (mv.row < 0)
+              --sum_in_vectors;
           }
-        } else {
-          sr_coded_error += motion_error;
-          tr_coded_error += motion_error;
-        }
 
-        // Start by assuming that intra mode is best.
-        best_ref_mv.row = 0;
-        best_ref_mv.col = 0;
-
-        if (motion_error <= this_intra_error) {
-          aom_clear_system_state();
-
-          // Keep a count of cases where the inter and intra were very close
-          // and very low. This helps with scene cut detection for example in
-          // cropped clips with black bars at the sides or top and bottom.
-          if (((this_intra_error - intrapenalty) * 9 <= motion_error * 10) &&
-              (this_intra_error < (2 * intrapenalty))) {
-            neutral_count += 1.0;
-            // Also track cases where the intra is not much worse than the inter
-            // and use this in limiting the GF/arf group length.
-          } else if ((this_intra_error > NCOUNT_INTRA_THRESH) &&
-                     (this_intra_error <
-                      (NCOUNT_INTRA_FACTOR * motion_error))) {
-            neutral_count += (double)motion_error /
-                             DOUBLE_DIVIDE_CHECK((double)this_intra_error);
-          }
-
-          mv.row *= 8;
-          mv.col *= 8;
-          this_intra_error = motion_error;
-          xd->mi[0]->mode = NEWMV;
-          xd->mi[0]->mv[0].as_mv = mv;
-          xd->mi[0]->tx_size = TX_4X4;
-          xd->mi[0]->ref_frame[0] = LAST_FRAME;
-          xd->mi[0]->ref_frame[1] = NONE_FRAME;
-          av1_enc_build_inter_predictor(cm, xd, mb_row * mb_scale,
-                                        mb_col * mb_scale, NULL, bsize,
-                                        AOM_PLANE_Y, AOM_PLANE_Y);
-          av1_encode_sby_pass1(cm, x, bsize);
-          sum_mvr += mv.row;
-          sum_mvr_abs += abs(mv.row);
-          sum_mvc += mv.col;
-          sum_mvc_abs += abs(mv.col);
-          sum_mvrs += mv.row * mv.row;
-          sum_mvcs += mv.col * mv.col;
-          ++intercount;
-
-          best_ref_mv = mv;
-
-          if (!is_zero_mv(&mv)) {
-            ++mvcount;
-
-            // Non-zero vector, was it different from the last non zero vector?
-            if (!is_equal_mv(&mv, &lastmv)) ++new_mv_count;
-            lastmv = mv;
-
-            // Does the row vector point inwards or outwards?
-            if (mb_row < cm->mb_rows / 2) {
-              if (mv.row > 0)
-                --sum_in_vectors;
-              else if (mv.row < 0)
-                ++sum_in_vectors;
-            } else if (mb_row > cm->mb_rows / 2) {
-              if (mv.row > 0)
-                ++sum_in_vectors;
-              else if (mv.row < 0)
-                --sum_in_vectors;
-            }
-
-            // Does the col vector point inwards or outwards?
-            if (mb_col < cm->mb_cols / 2) {
-              if (mv.col > 0)
-                --sum_in_vectors;
-              else if (mv.col < 0)
-                ++sum_in_vectors;
-            } else if (mb_col > cm->mb_cols / 2) {
-              if (mv.col > 0)
-                ++sum_in_vectors;
-              else if (mv.col < 0)
-                --sum_in_vectors;
-            }
+          // Does the col vector point inwards or outwards?
+          if (mb_col < cm->mb_cols / 2) {
+            if (mv.col > 0)
+              --sum_in_vectors;
+            else if (mv.col < 0)
+              ++sum_in_vectors;
+          } else if (mb_col > cm->mb_cols / 2) {
+            if (mv.col > 0)
+              ++sum_in_vectors;
+            else if (mv.col < 0)
+              --sum_in_vectors;
           }
         }
-        raw_motion_err_list[raw_motion_err_counts++] = raw_motion_error;
-      } else {
-        sr_coded_error += (int64_t)this_intra_error;
-        tr_coded_error += (int64_t)this_intra_error;
       }
-      coded_error += (int64_t)this_intra_error;
-
-      // Adjust to the next column of MBs.
-      x->plane[0].src.buf += 16;
-      x->plane[1].src.buf += uv_mb_height;
-      x->plane[2].src.buf += uv_mb_height;
-
-      recon_yoffset += 16;
-      src_yoffset += 16;
-      recon_uvoffset += uv_mb_height;
-      alt_yv12_yoffset += 16;
     }
-    // Adjust to the next row of MBs.
-    x->plane[0].src.buf += 16 * x->plane[0].src.stride - 16 * cm->mb_cols;
-    x->plane[1].src.buf +=
-        uv_mb_height * x->plane[1].src.stride - uv_mb_height * cm->mb_cols;
-    x->plane[2].src.buf +=
-        uv_mb_height * x->plane[1].src.stride - uv_mb_height * cm->mb_cols;
-
-    aom_clear_system_state();
   }
-  const double raw_err_stdev =
-      raw_motion_error_stdev(raw_motion_err_list, raw_motion_err_counts);
-  aom_free(raw_motion_err_list);
+  if (!frame_is_intra_only(cm))
+    raw_motion_err_counts = cm->mb_rows * cm->mb_cols;
+  aom_clear_system_state();
+  const double raw_err_stdev = raw_motion_error_stdev(
+      fp_data->raw_motion_err_list, raw_motion_err_counts);
+  aom_free(fp_data->raw_motion_err_list);
+  fp_data->raw_motion_err_list = NULL;
+  aom_free(fp_data->mb_stats);
+  fp_data->mb_stats = NULL;
 
   // Clamp the image start to rows/2. This number of rows is discarded top
   // and bottom as dead data so rows / 2 means the frame is blank.
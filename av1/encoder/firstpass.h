@@ -182,13 +182,50 @@ typedef struct {
   int extend_minq_fast;
 } TWO_PASS;
 
+// First pass results of one 16x16 macroblock. They are kept per macroblock
+// and added up in raster order once the whole frame is done, so that the frame
+// stats do not depend on the order in which the macroblock rows were coded.
+typedef struct {
+  // Intra and brightness factors of the macroblock.
+  double intra_factor;
+  double brightness_factor;
+  // Weighted count of a close intra and inter prediction error.
+  double neutral_count;
+  int64_t frame_avg_wavelet_energy;
+  int intra_error;
+  int coded_error;
+  int sr_coded_error;
+  int tr_coded_error;
+  // Set if the intra prediction error is small enough to count as a skip.
+  int intra_skip;
+  // Set if the golden frame, respectively the lookahead frame used as the
+  // third reference, gave the best prediction.
+  int second_ref;
+  int third_ref;
+  // Set if inter prediction with 'mv' was better than intra prediction.
+  int inter;
+  MV mv;
+} FIRSTPASS_MB_STATS;
+
+typedef struct {
+  // Results of each macroblock of the frame being coded, in raster order.
+  FIRSTPASS_MB_STATS *mb_stats;
+  // Error of each macroblock predicted from the last source frame with (0, 0)
+  // motion.
+  int *raw_motion_err_list;
+} FIRSTPASS_DATA;
+
 struct AV1_COMP;
 struct EncodeFrameParams;
 struct AV1EncoderConfig;
+struct ThreadData;
 
 void av1_init_first_pass(struct AV1_COMP *cpi);
 void av1_rc_get_first_pass_params(struct AV1_COMP *cpi);
 void av1_first_pass(struct AV1_COMP *cpi, const int64_t ts_duration);
+// Codes one row of 16x16 macroblocks in the first pass.
+void av1_first_pass_row(struct AV1_COMP *cpi, struct ThreadData *td,
+                        int mb_row);
 void av1_end_first_pass(struct AV1_COMP *cpi);
 
 void av1_twopass_zero_stats(FIRSTPASS_STATS *section);
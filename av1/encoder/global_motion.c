@@ -265,6 +265,30 @@ unsigned char *av1_downconvert_frame(YV12_BUFFER_CONFIG *frm, int bit_depth) {
   return buf_8bit;
 }
 
+int av1_get_frame_corners(YV12_BUFFER_CONFIG *frm, int bit_depth,
+                          int **corners) {
+  if (!frm->corners_valid) {
+    unsigned char *buf = frm->y_buffer;
+    if (frm->flags & YV12_FLAG_HIGHBITDEPTH) {
+      buf = av1_downconvert_frame(frm, bit_depth);
+    }
+    if (!frm->corners) {
+      frm->corners =
+          (int *)aom_malloc(2 * MAX_CORNERS * sizeof(*frm->corners));
+      if (!frm->corners) {
+        *corners = NULL;
+        return 0;
+      }
+    }
+    frm->num_corners =
+        av1_fast_corner_detect(buf, frm->y_width, frm->y_height, frm->y_stride,
+                               frm->corners, MAX_CORNERS);
+    frm->corners_valid = 1;
+  }
+  *corners = frm->corners;
+  return frm->num_corners;
+}
+
 static void get_inliers_from_indices(MotionModel *params,
                                      int *correspondences) {
   int *inliers_tmp = (int *)aom_malloc(2 * MAX_CORNERS * sizeof(*inliers_tmp));
@@ -318,7 +342,7 @@ static int compute_global_motion_feature_based(
   int num_ref_corners;
   int num_correspondences;
   int *correspondences;
-  int ref_corners[2 * MAX_CORNERS];
+  int *ref_corners;
   unsigned char *ref_buffer = ref->y_buffer;
   RansacFunc ransac = av1_get_ransac_type(type);
 
@@ -326,9 +350,7 @@ static int compute_global_motion_feature_based(
     ref_buffer = av1_downconvert_frame(ref, bit_depth);
   }
 
-  num_ref_corners =
-      av1_fast_corner_detect(ref_buffer, ref->y_width, ref->y_height,
-                             ref->y_stride, ref_corners, MAX_CORNERS);
+  num_ref_corners = av1_get_frame_corners(ref, bit_depth, &ref_corners);
 
   // find correspondences between the two images
   correspondences =
@@ -31,6 +31,13 @@ typedef enum {
 
 unsigned char *av1_downconvert_frame(YV12_BUFFER_CONFIG *frm, int bit_depth);
 
+// Sets *corners to the FAST corners of the luma plane of frm and returns their
+// number. The corners are detected on the first call and kept in frm until
+// corners_valid is cleared, so a reference frame is only analyzed once however
+// many frames are predicted from it.
+int av1_get_frame_corners(YV12_BUFFER_CONFIG *frm, int bit_depth,
+                          int **corners);
+
 typedef struct {
   double params[MAX_PARAMDIM - 1];
   int *inliers;
@@ -29,12 +29,55 @@ static struct lookahead_entry *pop(struct lookahead_ctx *ctx, int *idx) {
   return buf;
 }
 
+/* Point the entry back at its own buffer and release the external frame it
+ * referenced, if any. */
+static void release_external_frame(struct lookahead_entry *buf) {
+  if (buf->release_cb == NULL) return;
+  buf->img.y_buffer = buf->own_buffers[0];
+  buf->img.u_buffer = buf->own_buffers[1];
+  buf->img.v_buffer = buf->own_buffers[2];
+  buf->release_cb(buf->release_cb_priv);
+  buf->release_cb = NULL;
+  buf->release_cb_priv = NULL;
+  buf->borders_extended = 1;
+}
+
+/* The source can stand in for the entry's buffer only if every plane has the
+ * same geometry and at least as much border. */
+static int can_reference_frame(const YV12_BUFFER_CONFIG *src,
+                               const YV12_BUFFER_CONFIG *img) {
+  return src->y_crop_width == img->y_crop_width &&
+         src->y_crop_height == img->y_crop_height &&
+         src->uv_crop_width == img->uv_crop_width &&
+         src->uv_crop_height == img->uv_crop_height &&
+         src->y_width == img->y_width && src->y_height == img->y_height &&
+         src->uv_width == img->uv_width && src->uv_height == img->uv_height &&
+         src->y_stride == img->y_stride && src->uv_stride == img->uv_stride &&
+         src->subsampling_x == img->subsampling_x &&
+         src->subsampling_y == img->subsampling_y &&
+         (src->flags & YV12_FLAG_HIGHBITDEPTH) ==
+             (img->flags & YV12_FLAG_HIGHBITDEPTH) &&
+         src->border >= img->border;
+}
+
+/* Extend the borders of an external frame on its first use. */
+static struct lookahead_entry *extend_borders(struct lookahead_entry *buf) {
+  if (buf != NULL && !buf->borders_extended) {
+    av1_copy_and_extend_frame(&buf->img, &buf->img);
+    buf->borders_extended = 1;
+  }
+  return buf;
+}
+
 void av1_lookahead_destroy(struct lookahead_ctx *ctx) {
   if (ctx) {
     if (ctx->buf) {
       int i;
 
-      for (i = 0; i < ctx->max_sz; i++) aom_free_frame_buffer(&ctx->buf[i].img);
+      for (i = 0; i < ctx->max_sz; i++) {
+        release_external_frame(&ctx->buf[i]);
+        aom_free_frame_buffer(&ctx->buf[i].img);
+      }
       free(ctx->buf);
     }
     free(ctx);
@@ -61,7 +104,8 @@ struct lookahead_ctx *av1_lookahead_init(
     ctx->max_sz = depth;
     ctx->buf = calloc(depth, sizeof(*ctx->buf));
     if (!ctx->buf) goto fail;
-    for (i = 0; i < depth; i++)
+    for (i = 0; i < depth; i++) {
+      ctx->buf[i].borders_extended = 1;
       if (is_scale) {
         if (aom_alloc_frame_buffer(
                 &ctx->buf[i].img, width, height, subsampling_x, subsampling_y,
@@ -75,6 +119,7 @@ struct lookahead_ctx *av1_lookahead_init(
                 legacy_byte_alignment, NULL, NULL, NULL))
           goto fail;
       }
+    }
   }
   return ctx;
 fail:
@@ -86,7 +131,9 @@ fail:
 
 int av1_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       aom_enc_frame_flags_t flags) {
+                       aom_enc_frame_flags_t flags,
+                       aom_release_image_cb_fn_t release_cb,
+                       void *release_cb_priv) {
   struct lookahead_entry *buf;
 #if USE_PARTIAL_COPY
   int row, col, active_end;
@@ -101,9 +148,30 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
   int subsampling_y = src->subsampling_y;
   int larger_dimensions, new_dimensions;
 
-  if (ctx->sz + 1 + MAX_PRE_FRAMES > ctx->max_sz) return 1;
+  if (ctx->sz + 1 + MAX_PRE_FRAMES > ctx->max_sz) {
+    if (release_cb != NULL) release_cb(release_cb_priv);
+    return 1;
+  }
   ctx->sz++;
   buf = pop(ctx, &ctx->write_idx);
+  release_external_frame(buf);
+
+  buf->ts_start = ts_start;
+  buf->ts_end = ts_end;
+  buf->flags = flags;
+
+  if (release_cb != NULL && can_reference_frame(src, &buf->img)) {
+    buf->own_buffers[0] = buf->img.y_buffer;
+    buf->own_buffers[1] = buf->img.u_buffer;
+    buf->own_buffers[2] = buf->img.v_buffer;
+    buf->img.y_buffer = src->y_buffer;
+    buf->img.u_buffer = src->u_buffer;
+    buf->img.v_buffer = src->v_buffer;
+    buf->release_cb = release_cb;
+    buf->release_cb_priv = release_cb_priv;
+    buf->borders_extended = 0;
+    return 0;
+  }
 
   new_dimensions = width != buf->img.y_crop_width ||
                    height != buf->img.y_crop_height ||
@@ -159,8 +227,10 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
       memset(&new_img, 0, sizeof(new_img));
       if (aom_alloc_frame_buffer(&new_img, width, height, subsampling_x,
                                  subsampling_y, use_highbitdepth,
-                                 AOM_BORDER_IN_PIXELS, 0))
+                                 AOM_BORDER_IN_PIXELS, 0)) {
+        if (release_cb != NULL) release_cb(release_cb_priv);
         return 1;
+      }
       aom_free_frame_buffer(&buf->img);
       buf->img = new_img;
     } else if (new_dimensions) {
@@ -177,9 +247,7 @@ int av1_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
   }
 #endif
 
-  buf->ts_start = ts_start;
-  buf->ts_end = ts_end;
-  buf->flags = flags;
+  if (release_cb != NULL) release_cb(release_cb_priv);
   return 0;
 }
 
@@ -191,7 +259,7 @@ struct lookahead_entry *av1_lookahead_pop(struct lookahead_ctx *ctx,
     buf = pop(ctx, &ctx->read_idx);
     ctx->sz--;
   }
-  return buf;
+  return extend_borders(buf);
 }
 
 struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx,
@@ -214,7 +282,7 @@ struct lookahead_entry *av1_lookahead_peek(struct lookahead_ctx *ctx,
     }
   }
 
-  return buf;
+  return extend_borders(buf);
 }
 
 unsigned int av1_lookahead_depth(struct lookahead_ctx *ctx) { return ctx->sz; }
@@ -13,6 +13,7 @@
 #define AOM_AV1_ENCODER_LOOKAHEAD_H_
 
 #include "aom_scale/yv12config.h"
+#include "aom/aom_image.h"
 #include "aom/aom_integer.h"
 
 #ifdef __cplusplus
@@ -26,6 +27,13 @@ struct lookahead_entry {
   int64_t ts_start;
   int64_t ts_end;
   aom_enc_frame_flags_t flags;
+  // Set while img references an external frame rather than the entry's own
+  // buffer, whose plane pointers are kept in own_buffers meanwhile.
+  aom_release_image_cb_fn_t release_cb;
+  void *release_cb_priv;
+  uint8_t *own_buffers[3];
+  // Whether the borders of an external frame have been extended yet.
+  int borders_extended;
 };
 
 // The max of past frames we want to keep in the queue.
@@ -58,6 +66,13 @@ void av1_lookahead_destroy(struct lookahead_ctx *ctx);
  * This function will copy the source image into a new framebuffer with
  * the expected stride/border.
  *
+ * If release_cb is non-NULL and the source already has the expected
+ * stride/border, the entry references the source instead of copying it and
+ * its borders are extended in place when the entry is first popped or peeked.
+ * release_cb(release_cb_priv) is called once the entry no longer references
+ * the source: when its slot is reused or the queue is destroyed, or before
+ * returning if the source was copied or could not be queued.
+ *
  * If active_map is non-NULL and there is only one frame in the queue, then copy
  * only active macroblocks.
  *
@@ -67,10 +82,14 @@ void av1_lookahead_destroy(struct lookahead_ctx *ctx);
  * \param[in] ts_end      Timestamp for the end of this frame
  * \param[in] flags       Flags set on this frame
  * \param[in] active_map  Map that specifies which macroblock is active
+ * \param[in] release_cb  Release callback of an externally owned source
+ * \param[in] release_cb_priv  Private data passed to release_cb
  */
 int av1_lookahead_push(struct lookahead_ctx *ctx, YV12_BUFFER_CONFIG *src,
                        int64_t ts_start, int64_t ts_end, int use_highbitdepth,
-                       aom_enc_frame_flags_t flags);
+                       aom_enc_frame_flags_t flags,
+                       aom_release_image_cb_fn_t release_cb,
+                       void *release_cb_priv);
 
 /**\brief Get the next source buffer to encode
  *
@@ -68,6 +68,17 @@ void av1_nn_predict_c(const float *input_nodes,
   if (reduce_prec) av1_nn_output_prec_reduce(output, nn_config->num_outputs);
 }
 
+// Evaluates the network for num_samples feature vectors stored back to back in
+// input_nodes. The outputs are stored back to back in the same order.
+void av1_nn_predict_batch_c(const float *input_nodes, int num_samples,
+                            const NN_CONFIG *const nn_config, int reduce_prec,
+                            float *const output) {
+  for (int s = 0; s < num_samples; ++s) {
+    av1_nn_predict_c(input_nodes + s * nn_config->num_inputs, nn_config,
+                     reduce_prec, output + s * nn_config->num_outputs);
+  }
+}
+
 #if CONFIG_NN_V2
 // Applies the ReLu activation to one fc layer
 // output[i] = Max(input[i],0.0f)
@@ -46,6 +46,76 @@ static INLINE int convert_bsize_to_idx(BLOCK_SIZE bsize) {
 }
 
 #if !CONFIG_REALTIME_ONLY
+// Gathers the DNN features of the block at quad_tree_idx from the CNN output
+// cached for its 64x64 block.
+static void get_intra_cnn_dnn_features(const MACROBLOCK *x, BLOCK_SIZE bsize,
+                                       int quad_tree_idx,
+                                       float *dnn_features) {
+  const float *branch_0 = x->cnn_buffer;
+  const float *branch_1 = branch_0 + CNN_BRANCH_0_OUT_SIZE;
+  const float *branch_2 = branch_1 + CNN_BRANCH_1_OUT_SIZE;
+  const float *branch_3 = branch_2 + CNN_BRANCH_2_OUT_SIZE;
+
+  if (bsize == BLOCK_64X64) {
+    int f_idx = 0;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_0_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_0[ch_idx];
+    }
+
+    const int spa_stride = 2 * 2;
+    for (int lin_idx = 0; lin_idx < spa_stride; lin_idx++) {
+      for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+        dnn_features[f_idx++] = branch_1[lin_idx + ch_idx * spa_stride];
+      }
+    }
+    dnn_features[f_idx++] = x->log_q;
+  } else if (bsize == BLOCK_32X32) {
+    int f_idx = 0;
+    for (int idx = 0; idx < CNN_BRANCH_0_OUT_CH; idx++) {
+      dnn_features[f_idx++] = branch_0[idx];
+    }
+
+    const int curr_lin_idx = quad_to_linear_1[quad_tree_idx - 1];
+    const int spa_stride = 2 * 2;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_1[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = x->log_q;
+  } else if (bsize == BLOCK_16X16) {
+    int f_idx = 0;
+    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
+    const int prev_lin_idx = quad_to_linear_1[prev_quad_idx - 1];
+    const int prev_spa_stride = 2 * 2;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_1[prev_lin_idx + ch_idx * prev_spa_stride];
+    }
+
+    const int curr_lin_idx = quad_to_linear_2[quad_tree_idx - 5];
+    const int spa_stride = 4 * 4;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_2[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = x->log_q;
+  } else if (bsize == BLOCK_8X8) {
+    int f_idx = 0;
+    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
+    const int prev_lin_idx = quad_to_linear_2[prev_quad_idx - 5];
+    const int prev_spa_stride = 4 * 4;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_2[prev_lin_idx + ch_idx * prev_spa_stride];
+    }
+
+    const int curr_lin_idx = quad_to_linear_3[quad_tree_idx - 21];
+    const int spa_stride = 8 * 8;
+    for (int ch_idx = 0; ch_idx < CNN_BRANCH_3_OUT_CH; ch_idx++) {
+      dnn_features[f_idx++] = branch_3[curr_lin_idx + ch_idx * spa_stride];
+    }
+    dnn_features[f_idx++] = x->log_q;
+  } else {
+    assert(0 && "Invalid bsize in intra_cnn partition");
+  }
+}
+
 // TODO(chiyotsai@google.com): This is very much a work in progress. We still
 // need to the following:
 //   -- add support for hdres
@@ -123,6 +193,7 @@ void av1_intra_mode_cnn_partition(const AV1_COMMON *const cm, MACROBLOCK *x,
     }
 
     x->cnn_output_valid = 1;
+    av1_zero(x->cnn_logits_valid);
   }
 
   if (!x->cnn_output_valid) {
@@ -139,76 +210,34 @@ void av1_intra_mode_cnn_partition(const AV1_COMMON *const cm, MACROBLOCK *x,
 
   const NN_CONFIG *dnn_config = dnn_configs[bsize_idx];
 
+  // All block sizes go through av1_nn_predict_batch(), whose versions add
+  // the products in the same order, so the logit of a block does not depend
+  // on whether it was predicted alone or with its siblings.
   aom_clear_system_state();
-  float dnn_features[100];
-  float logits[4] = { 0.0f };
-
-  const float *branch_0 = x->cnn_buffer;
-  const float *branch_1 = branch_0 + CNN_BRANCH_0_OUT_SIZE;
-  const float *branch_2 = branch_1 + CNN_BRANCH_1_OUT_SIZE;
-  const float *branch_3 = branch_2 + CNN_BRANCH_2_OUT_SIZE;
-
+  float logit;
   if (bsize == BLOCK_64X64) {
-    int f_idx = 0;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_0_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_0[ch_idx];
-    }
-
-    const int spa_stride = 2 * 2;
-    for (int lin_idx = 0; lin_idx < spa_stride; lin_idx++) {
-      for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-        dnn_features[f_idx++] = branch_1[lin_idx + ch_idx * spa_stride];
+    float dnn_features[100];
+    get_intra_cnn_dnn_features(x, bsize, quad_tree_idx, dnn_features);
+    av1_nn_predict_batch(dnn_features, 1, dnn_config, 1, &logit);
+  } else {
+    // The four blocks of a split are predicted together, when the first of
+    // them is searched.
+    const int parent_idx = (quad_tree_idx - 1) / 4;
+    if (!x->cnn_logits_valid[parent_idx]) {
+      const int num_inputs = dnn_config->num_inputs;
+      float dnn_features[4 * 100];
+      float logits[4];
+      assert(dnn_config->num_outputs == 1);
+      for (int i = 0; i < 4; ++i) {
+        get_intra_cnn_dnn_features(x, bsize, 4 * parent_idx + i + 1,
+                                   dnn_features + i * num_inputs);
       }
+      av1_nn_predict_batch(dnn_features, 4, dnn_config, 1, logits);
+      memcpy(&x->cnn_logits[4 * parent_idx + 1], logits, sizeof(logits));
+      x->cnn_logits_valid[parent_idx] = 1;
     }
-    dnn_features[f_idx++] = x->log_q;
-  } else if (bsize == BLOCK_32X32) {
-    int f_idx = 0;
-    for (int idx = 0; idx < CNN_BRANCH_0_OUT_CH; idx++) {
-      dnn_features[f_idx++] = branch_0[idx];
-    }
-
-    const int curr_lin_idx = quad_to_linear_1[quad_tree_idx - 1];
-    const int spa_stride = 2 * 2;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_1[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = x->log_q;
-  } else if (bsize == BLOCK_16X16) {
-    int f_idx = 0;
-    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
-    const int prev_lin_idx = quad_to_linear_1[prev_quad_idx - 1];
-    const int prev_spa_stride = 2 * 2;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_1_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_1[prev_lin_idx + ch_idx * prev_spa_stride];
-    }
-
-    const int curr_lin_idx = quad_to_linear_2[quad_tree_idx - 5];
-    const int spa_stride = 4 * 4;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_2[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = x->log_q;
-  } else if (bsize == BLOCK_8X8) {
-    int f_idx = 0;
-    const int prev_quad_idx = (quad_tree_idx - 1) / 4;
-    const int prev_lin_idx = quad_to_linear_2[prev_quad_idx - 5];
-    const int prev_spa_stride = 4 * 4;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_2_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_2[prev_lin_idx + ch_idx * prev_spa_stride];
-    }
-
-    const int curr_lin_idx = quad_to_linear_3[quad_tree_idx - 21];
-    const int spa_stride = 8 * 8;
-    for (int ch_idx = 0; ch_idx < CNN_BRANCH_3_OUT_CH; ch_idx++) {
-      dnn_features[f_idx++] = branch_3[curr_lin_idx + ch_idx * spa_stride];
-    }
-    dnn_features[f_idx++] = x->log_q;
-  } else {
-    assert(0 && "Invalid bsize in intra_cnn partition");
+    logit = x->cnn_logits[quad_tree_idx];
   }
-
-  // Make decision
-  av1_nn_predict(dnn_features, dnn_config, 1, logits);
   aom_clear_system_state();
 
   const int is_720p_or_larger = AOMMIN(cm->width, cm->height) >= 720;
@@ -231,14 +260,14 @@ void av1_intra_mode_cnn_partition(const AV1_COMMON *const cm, MACROBLOCK *x,
         av1_intra_mode_cnn_partition_no_split_thresh_lowres[bsize_idx];
   }
 
-  if (logits[0] > split_only_thresh) {
+  if (logit > split_only_thresh) {
     *partition_none_allowed = 0;
     *partition_horz_allowed = 0;
     *partition_vert_allowed = 0;
     *do_rectangular_split = 0;
   }
 
-  if (logits[0] < no_split_thresh) {
+  if (logit < no_split_thresh) {
     *do_square_split = 0;
   }
 }
@@ -358,26 +358,197 @@ static void pick_cdef_from_qp(AV1_COMMON *const cm) {
   }
 }
 
+// Frame level state of the CDEF strength search, shared by the threads that
+// fill in the mse tables of the 64x64 filter block rows.
+typedef struct CdefSearchCtxt {
+  const AV1_COMMON *cm;
+  uint16_t *src[3];
+  uint16_t *ref_coeff[3];
+  int stride[3];
+  int bsize[3];
+  int mi_wide_l2[3];
+  int mi_high_l2[3];
+  int xdec[3];
+  int ydec[3];
+  int nvfb;
+  int nhfb;
+  int num_planes;
+  int damping;
+  int coeff_shift;
+  int fast;
+  int total_strengths;
+  // Index of each filter block in the mse tables, or -1 if it is not filtered.
+  int *fb_sb_index;
+  uint64_t (*mse[2])[TOTAL_STRENGTHS];
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
+  // Filter block rows are handed out top to bottom.
+  int next_fb_row;
+} CdefSearchCtxt;
+
+// Fills in the mse tables for every strength of the filter blocks in row fbr.
+static void cdef_search_fb_row(const CdefSearchCtxt *const ctxt, int fbr) {
+  const AV1_COMMON *const cm = ctxt->cm;
+  const int nvfb = ctxt->nvfb;
+  const int nhfb = ctxt->nhfb;
+  cdef_list dlist[MI_SIZE_128X128 * MI_SIZE_128X128];
+  int dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
+  int var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
+  DECLARE_ALIGNED(32, uint16_t, tmp_dst[1 << (MAX_SB_SIZE_LOG2 * 2)]);
+  DECLARE_ALIGNED(32, uint16_t, inbuf[CDEF_INBUF_SIZE]);
+  uint16_t *const in = inbuf + CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER;
+
+  for (int fbc = 0; fbc < nhfb; ++fbc) {
+    const int sb_count = ctxt->fb_sb_index[fbr * nhfb + fbc];
+    if (sb_count < 0) continue;
+
+    const MB_MODE_INFO *const mbmi =
+        cm->mi_grid_visible[MI_SIZE_64X64 * fbr * cm->mi_stride +
+                            MI_SIZE_64X64 * fbc];
+    int nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
+    int nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
+    int hb_step = 1;
+    int vb_step = 1;
+    BLOCK_SIZE bs;
+    if (mbmi->sb_type == BLOCK_128X128 || mbmi->sb_type == BLOCK_128X64 ||
+        mbmi->sb_type == BLOCK_64X128) {
+      bs = mbmi->sb_type;
+      if (bs == BLOCK_128X128 || bs == BLOCK_128X64) {
+        nhb = AOMMIN(MI_SIZE_128X128, cm->mi_cols - MI_SIZE_64X64 * fbc);
+        hb_step = 2;
+      }
+      if (bs == BLOCK_128X128 || bs == BLOCK_64X128) {
+        nvb = AOMMIN(MI_SIZE_128X128, cm->mi_rows - MI_SIZE_64X64 * fbr);
+        vb_step = 2;
+      }
+    } else {
+      bs = BLOCK_64X64;
+    }
+
+    const int cdef_count = av1_cdef_compute_sb_list(
+        cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64, dlist, bs);
+
+    const int yoff = CDEF_VBORDER * (fbr != 0);
+    const int xoff = CDEF_HBORDER * (fbc != 0);
+    int dirinit = 0;
+    for (int pli = 0; pli < ctxt->num_planes; pli++) {
+      for (int i = 0; i < CDEF_INBUF_SIZE; i++) inbuf[i] = CDEF_VERY_LARGE;
+      /* We avoid filtering the pixels for which some of the pixels to average
+         are outside the frame. We could change the filter instead, but it
+         would add special cases for any future vectorization. */
+      const int ysize = (nvb << ctxt->mi_high_l2[pli]) +
+                        CDEF_VBORDER * (fbr + vb_step < nvfb) + yoff;
+      const int xsize = (nhb << ctxt->mi_wide_l2[pli]) +
+                        CDEF_HBORDER * (fbc + hb_step < nhfb) + xoff;
+      const int row = fbr * MI_SIZE_64X64 << ctxt->mi_high_l2[pli];
+      const int col = fbc * MI_SIZE_64X64 << ctxt->mi_wide_l2[pli];
+      for (int gi = 0; gi < ctxt->total_strengths; gi++) {
+        int pri_strength = gi / CDEF_SEC_STRENGTHS;
+        if (ctxt->fast) pri_strength = priconv[pri_strength];
+        const int sec_strength = gi % CDEF_SEC_STRENGTHS;
+        copy_sb16_16(&in[(-yoff * CDEF_BSTRIDE - xoff)], CDEF_BSTRIDE,
+                     ctxt->src[pli], row - yoff, col - xoff, ctxt->stride[pli],
+                     ysize, xsize);
+        av1_cdef_filter_fb(NULL, tmp_dst, CDEF_BSTRIDE, in, ctxt->xdec[pli],
+                           ctxt->ydec[pli], dir, &dirinit, var, pli, dlist,
+                           cdef_count, pri_strength,
+                           sec_strength + (sec_strength == 3), ctxt->damping,
+                           ctxt->coeff_shift);
+        const uint64_t curr_mse = compute_cdef_dist(
+            ctxt->ref_coeff[pli] + row * ctxt->stride[pli] + col,
+            ctxt->stride[pli], tmp_dst, dlist, cdef_count, ctxt->bsize[pli],
+            ctxt->coeff_shift, pli);
+        if (pli < 2)
+          ctxt->mse[pli][sb_count][gi] = curr_mse;
+        else
+          ctxt->mse[1][sb_count][gi] += curr_mse;
+      }
+    }
+  }
+}
+
+static int get_next_fb_row(CdefSearchCtxt *const ctxt, int *fbr) {
+  int ret = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(ctxt->job_mutex);
+#endif
+
+  if (ctxt->next_fb_row < ctxt->nvfb) {
+    *fbr = ctxt->next_fb_row++;
+    ret = 1;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(ctxt->job_mutex);
+#endif
+
+  return ret;
+}
+
+static int cdef_search_worker(void *arg1, void *unused) {
+  CdefSearchCtxt *const ctxt = (CdefSearchCtxt *)arg1;
+  int fbr;
+  (void)unused;
+
+  while (get_next_fb_row(ctxt, &fbr)) cdef_search_fb_row(ctxt, fbr);
+  return 1;
+}
+
+// Runs the search over the filter block rows on num_workers threads. Each
+// filter block only writes its own entries of the mse tables, so the result
+// does not depend on the number of threads.
+static void cdef_search_mt(CdefSearchCtxt *const ctxt, AVxWorker *workers,
+                           int num_workers) {
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  int i;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t job_mutex;
+  pthread_mutex_init(&job_mutex, NULL);
+  ctxt->job_mutex = &job_mutex;
+#endif
+  ctxt->next_fb_row = 0;
+
+  for (i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = cdef_search_worker;
+    worker->data1 = ctxt;
+    worker->data2 = NULL;
+
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  for (i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&job_mutex);
+  ctxt->job_mutex = NULL;
+#endif
+}
+
 void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
                      AV1_COMMON *cm, MACROBLOCKD *xd, int pick_method,
-                     int rdmult) {
+                     int rdmult, AVxWorker *workers, int num_workers) {
   if (pick_method == CDEF_PICK_FROM_Q) {
     pick_cdef_from_qp(cm);
     return;
   }
 
-  uint16_t *src[3];
-  uint16_t *ref_coeff[3];
-  static cdef_list dlist[MI_SIZE_128X128 * MI_SIZE_128X128];
-  int dir[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
-  int var[CDEF_NBLOCKS][CDEF_NBLOCKS] = { { 0 } };
+  CdefSearchCtxt ctxt;
   const int nvfb = (cm->mi_rows + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
   const int nhfb = (cm->mi_cols + MI_SIZE_64X64 - 1) / MI_SIZE_64X64;
   int *sb_index = aom_malloc(nvfb * nhfb * sizeof(*sb_index));
+  int *fb_sb_index = aom_malloc(nvfb * nhfb * sizeof(*fb_sb_index));
   const int damping = 3 + (cm->base_qindex >> 6);
   const int fast = pick_method == CDEF_FAST_SEARCH;
-  const int total_strengths = fast ? REDUCED_TOTAL_STRENGTHS : TOTAL_STRENGTHS;
-  DECLARE_ALIGNED(32, uint16_t, tmp_dst[1 << (MAX_SB_SIZE_LOG2 * 2)]);
   const int num_planes = av1_num_planes(cm);
   av1_setup_dst_planes(xd->plane, cm->seq_params.sb_size, frame, 0, 0, 0,
                        num_planes);
@@ -385,12 +556,21 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
   mse[0] = aom_malloc(sizeof(**mse) * nvfb * nhfb);
   mse[1] = aom_malloc(sizeof(**mse) * nvfb * nhfb);
 
-  int stride[3];
-  int bsize[3];
-  int mi_wide_l2[3];
-  int mi_high_l2[3];
-  int xdec[3];
-  int ydec[3];
+  ctxt.cm = cm;
+  ctxt.nvfb = nvfb;
+  ctxt.nhfb = nhfb;
+  ctxt.num_planes = num_planes;
+  ctxt.damping = damping;
+  ctxt.coeff_shift = AOMMAX(cm->seq_params.bit_depth - 8, 0);
+  ctxt.fast = fast;
+  ctxt.total_strengths = fast ? REDUCED_TOTAL_STRENGTHS : TOTAL_STRENGTHS;
+  ctxt.fb_sb_index = fb_sb_index;
+  ctxt.mse[0] = mse[0];
+  ctxt.mse[1] = mse[1];
+
+  uint16_t **const src = ctxt.src;
+  uint16_t **const ref_coeff = ctxt.ref_coeff;
+  int *const stride = ctxt.stride;
   for (int pli = 0; pli < num_planes; pli++) {
     uint8_t *ref_buffer;
     int ref_stride;
@@ -412,13 +592,13 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
         32, sizeof(*src) * cm->mi_rows * cm->mi_cols * MI_SIZE * MI_SIZE);
     ref_coeff[pli] = aom_memalign(
         32, sizeof(*ref_coeff) * cm->mi_rows * cm->mi_cols * MI_SIZE * MI_SIZE);
-    xdec[pli] = xd->plane[pli].subsampling_x;
-    ydec[pli] = xd->plane[pli].subsampling_y;
-    bsize[pli] = ydec[pli] ? (xdec[pli] ? BLOCK_4X4 : BLOCK_8X4)
-                           : (xdec[pli] ? BLOCK_4X8 : BLOCK_8X8);
+    ctxt.xdec[pli] = xd->plane[pli].subsampling_x;
+    ctxt.ydec[pli] = xd->plane[pli].subsampling_y;
+    ctxt.bsize[pli] = ctxt.ydec[pli] ? (ctxt.xdec[pli] ? BLOCK_4X4 : BLOCK_8X4)
+                                     : (ctxt.xdec[pli] ? BLOCK_4X8 : BLOCK_8X8);
     stride[pli] = cm->mi_cols << MI_SIZE_LOG2;
-    mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
-    mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
+    ctxt.mi_wide_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_x;
+    ctxt.mi_high_l2[pli] = MI_SIZE_LOG2 - xd->plane[pli].subsampling_y;
 
     const int frame_height =
         (cm->mi_rows * MI_SIZE) >> xd->plane[pli].subsampling_y;
@@ -442,12 +622,12 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
     }
   }
 
-  DECLARE_ALIGNED(32, uint16_t, inbuf[CDEF_INBUF_SIZE]);
-  uint16_t *const in = inbuf + CDEF_VBORDER * CDEF_BSTRIDE + CDEF_HBORDER;
-  const int coeff_shift = AOMMAX(cm->seq_params.bit_depth - 8, 0);
+  // Number the filtered blocks in raster order, so that the mse tables have
+  // the same layout however the rows are searched.
   int sb_count = 0;
   for (int fbr = 0; fbr < nvfb; ++fbr) {
     for (int fbc = 0; fbc < nhfb; ++fbc) {
+      fb_sb_index[fbr * nhfb + fbc] = -1;
       // No filtering if the entire filter block is skipped
       if (sb_all_skip(cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64)) continue;
 
@@ -460,68 +640,19 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
            (mbmi->sb_type == BLOCK_128X128 || mbmi->sb_type == BLOCK_64X128)))
         continue;
 
-      int nhb = AOMMIN(MI_SIZE_64X64, cm->mi_cols - MI_SIZE_64X64 * fbc);
-      int nvb = AOMMIN(MI_SIZE_64X64, cm->mi_rows - MI_SIZE_64X64 * fbr);
-      int hb_step = 1;
-      int vb_step = 1;
-      BLOCK_SIZE bs;
-      if (mbmi->sb_type == BLOCK_128X128 || mbmi->sb_type == BLOCK_128X64 ||
-          mbmi->sb_type == BLOCK_64X128) {
-        bs = mbmi->sb_type;
-        if (bs == BLOCK_128X128 || bs == BLOCK_128X64) {
-          nhb = AOMMIN(MI_SIZE_128X128, cm->mi_cols - MI_SIZE_64X64 * fbc);
-          hb_step = 2;
-        }
-        if (bs == BLOCK_128X128 || bs == BLOCK_64X128) {
-          nvb = AOMMIN(MI_SIZE_128X128, cm->mi_rows - MI_SIZE_64X64 * fbr);
-          vb_step = 2;
-        }
-      } else {
-        bs = BLOCK_64X64;
-      }
-
-      const int cdef_count = av1_cdef_compute_sb_list(
-          cm, fbr * MI_SIZE_64X64, fbc * MI_SIZE_64X64, dlist, bs);
-
-      const int yoff = CDEF_VBORDER * (fbr != 0);
-      const int xoff = CDEF_HBORDER * (fbc != 0);
-      int dirinit = 0;
-      for (int pli = 0; pli < num_planes; pli++) {
-        for (int i = 0; i < CDEF_INBUF_SIZE; i++) inbuf[i] = CDEF_VERY_LARGE;
-        /* We avoid filtering the pixels for which some of the pixels to average
-           are outside the frame. We could change the filter instead, but it
-           would add special cases for any future vectorization. */
-        const int ysize = (nvb << mi_high_l2[pli]) +
-                          CDEF_VBORDER * (fbr + vb_step < nvfb) + yoff;
-        const int xsize = (nhb << mi_wide_l2[pli]) +
-                          CDEF_HBORDER * (fbc + hb_step < nhfb) + xoff;
-        const int row = fbr * MI_SIZE_64X64 << mi_high_l2[pli];
-        const int col = fbc * MI_SIZE_64X64 << mi_wide_l2[pli];
-        for (int gi = 0; gi < total_strengths; gi++) {
-          int pri_strength = gi / CDEF_SEC_STRENGTHS;
-          if (fast) pri_strength = priconv[pri_strength];
-          const int sec_strength = gi % CDEF_SEC_STRENGTHS;
-          copy_sb16_16(&in[(-yoff * CDEF_BSTRIDE - xoff)], CDEF_BSTRIDE,
-                       src[pli], row - yoff, col - xoff, stride[pli], ysize,
-                       xsize);
-          av1_cdef_filter_fb(
-              NULL, tmp_dst, CDEF_BSTRIDE, in, xdec[pli], ydec[pli], dir,
-              &dirinit, var, pli, dlist, cdef_count, pri_strength,
-              sec_strength + (sec_strength == 3), damping, coeff_shift);
-          const uint64_t curr_mse = compute_cdef_dist(
-              ref_coeff[pli] + row * stride[pli] + col, stride[pli], tmp_dst,
-              dlist, cdef_count, bsize[pli], coeff_shift, pli);
-          if (pli < 2)
-            mse[pli][sb_count][gi] = curr_mse;
-          else
-            mse[1][sb_count][gi] += curr_mse;
-        }
-      }
+      fb_sb_index[fbr * nhfb + fbc] = sb_count;
       sb_index[sb_count++] =
           MI_SIZE_64X64 * fbr * cm->mi_stride + MI_SIZE_64X64 * fbc;
     }
   }
 
+  num_workers = AOMMIN(num_workers, nvfb);
+  if (num_workers > 1) {
+    cdef_search_mt(&ctxt, workers, num_workers);
+  } else {
+    for (int fbr = 0; fbr < nvfb; ++fbr) cdef_search_fb_row(&ctxt, fbr);
+  }
+
   /* Search for different number of signalling bits. */
   int nb_strength_bits = 0;
   uint64_t best_rd = UINT64_MAX;
@@ -594,4 +725,5 @@ void av1_cdef_search(YV12_BUFFER_CONFIG *frame, const YV12_BUFFER_CONFIG *ref,
     aom_free(ref_coeff[pli]);
   }
   aom_free(sb_index);
+  aom_free(fb_sb_index);
 }
@@ -29,6 +29,7 @@
 
 #include "av1/encoder/av1_quantize.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/mathutils.h"
 #include "av1/encoder/picklpf.h"
 #include "av1/encoder/pickrst.h"
@@ -92,6 +93,9 @@ typedef struct {
   // The rtype to use for this unit given a frame rtype as
   // index. Indices: WIENER, SGRPROJ, SWITCHABLE.
   RestorationType best_rtype[RESTORE_TYPES - 1];
+
+  // The extent of this unit in the plane being searched.
+  RestorationTileLimits limits;
 } RestUnitSearchInfo;
 
 typedef struct {
@@ -158,6 +162,7 @@ static void init_rsc(const YV12_BUFFER_CONFIG *src, const AV1_COMMON *cm,
   rsc->dgd_buffer = dgd->buffers[plane];
   rsc->dgd_stride = dgd->strides[is_uv];
   rsc->tile_rect = av1_whole_frame_rect(cm, is_uv);
+  rsc->tile_stripe0 = 0;
   assert(src->crop_widths[is_uv] == dgd->crop_widths[is_uv]);
   assert(src->crop_heights[is_uv] == dgd->crop_heights[is_uv]);
 }
@@ -668,15 +673,11 @@ static int count_sgrproj_bits(SgrprojInfo *sgrproj_info,
   return bits;
 }
 
-static void search_sgrproj(const RestorationTileLimits *limits,
-                           const AV1PixelRect *tile, int rest_unit_idx,
-                           void *priv, int32_t *tmpbuf,
-                           RestorationLineBuffers *rlbs) {
-  (void)rlbs;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const MACROBLOCK *const x = rsc->x;
+// Finds the self-guided filter parameters of a restoration unit that give the
+// smallest projection error.
+static void compute_sgrproj_stats(const RestSearchCtxt *rsc,
+                                  const RestorationTileLimits *limits,
+                                  RestUnitSearchInfo *rusi, int32_t *tmpbuf) {
   const AV1_COMMON *const cm = rsc->cm;
   const int highbd = cm->seq_params.use_highbitdepth;
   const int bit_depth = cm->seq_params.bit_depth;
@@ -697,6 +698,18 @@ static void search_sgrproj(const RestorationTileLimits *limits,
       limits->v_end - limits->v_start, rsc->dgd_stride, src_start,
       rsc->src_stride, highbd, bit_depth, procunit_width, procunit_height,
       tmpbuf, rsc->sf->enable_sgr_ep_pruning);
+}
+
+static void search_sgrproj(const RestorationTileLimits *limits,
+                           const AV1PixelRect *tile, int rest_unit_idx,
+                           void *priv, int32_t *tmpbuf,
+                           RestorationLineBuffers *rlbs) {
+  (void)tmpbuf;
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const MACROBLOCK *const x = rsc->x;
 
   RestorationUnitInfo rui;
   rui.restoration_type = RESTORE_SGRPROJ;
@@ -1237,23 +1250,19 @@ static int64_t finer_tile_search_wiener(const RestSearchCtxt *rsc,
   return err;
 }
 
-static void search_wiener(const RestorationTileLimits *limits,
-                          const AV1PixelRect *tile_rect, int rest_unit_idx,
-                          void *priv, int32_t *tmpbuf,
-                          RestorationLineBuffers *rlbs) {
-  (void)tmpbuf;
-  (void)rlbs;
-  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
-  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
-
-  const int wiener_win =
-      (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
+static int get_reduced_wiener_win(const RestSearchCtxt *rsc) {
+  if (rsc->sf->reduce_wiener_window_size)
+    return (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN_REDUCED : WIENER_WIN_CHROMA;
+  return (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
+}
 
-  int reduced_wiener_win = wiener_win;
-  if (rsc->sf->reduce_wiener_window_size) {
-    reduced_wiener_win =
-        (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN_REDUCED : WIENER_WIN_CHROMA;
-  }
+// Solves for the Wiener filter of a restoration unit from its statistics.
+// sse[RESTORE_WIENER] is set to INT64_MAX if the filter does no better than
+// the identity filter, and is otherwise left for search_wiener() to fill in.
+static void compute_wiener_stats(const RestSearchCtxt *rsc,
+                                 const RestorationTileLimits *limits,
+                                 RestUnitSearchInfo *rusi) {
+  const int reduced_wiener_win = get_reduced_wiener_win(rsc);
 
   int64_t M[WIENER_WIN2];
   int64_t H[WIENER_WIN2 * WIENER_WIN2];
@@ -1271,13 +1280,8 @@ static void search_wiener(const RestorationTileLimits *limits,
                       limits->v_end, rsc->dgd_stride, rsc->src_stride, M, H);
   }
 
-  const MACROBLOCK *const x = rsc->x;
-  const int64_t bits_none = x->wiener_restore_cost[0];
-
+  rusi->sse[RESTORE_WIENER] = 0;
   if (!wiener_decompose_sep_sym(reduced_wiener_win, M, H, vfilter, hfilter)) {
-    rsc->bits += bits_none;
-    rsc->sse += rusi->sse[RESTORE_NONE];
-    rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
     rusi->sse[RESTORE_WIENER] = INT64_MAX;
     return;
   }
@@ -1293,13 +1297,40 @@ static void search_wiener(const RestorationTileLimits *limits,
   // reduction in the function, the filter is reverted back to identity
   if (compute_score(reduced_wiener_win, M, H, rui.wiener_info.vfilter,
                     rui.wiener_info.hfilter) > 0) {
+    rusi->sse[RESTORE_WIENER] = INT64_MAX;
+    return;
+  }
+  rusi->wiener = rui.wiener_info;
+}
+
+static void search_wiener(const RestorationTileLimits *limits,
+                          const AV1PixelRect *tile_rect, int rest_unit_idx,
+                          void *priv, int32_t *tmpbuf,
+                          RestorationLineBuffers *rlbs) {
+  (void)tmpbuf;
+  (void)rlbs;
+  RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+
+  const int wiener_win =
+      (rsc->plane == AOM_PLANE_Y) ? WIENER_WIN : WIENER_WIN_CHROMA;
+  const int reduced_wiener_win = get_reduced_wiener_win(rsc);
+
+  const MACROBLOCK *const x = rsc->x;
+  const int64_t bits_none = x->wiener_restore_cost[0];
+
+  if (rusi->sse[RESTORE_WIENER] == INT64_MAX) {
     rsc->bits += bits_none;
     rsc->sse += rusi->sse[RESTORE_NONE];
     rusi->best_rtype[RESTORE_WIENER - 1] = RESTORE_NONE;
-    rusi->sse[RESTORE_WIENER] = INT64_MAX;
     return;
   }
 
+  RestorationUnitInfo rui;
+  memset(&rui, 0, sizeof(rui));
+  rui.restoration_type = RESTORE_WIENER;
+  rui.wiener_info = rusi->wiener;
+
   aom_clear_system_state();
 
   rusi->sse[RESTORE_WIENER] = finer_tile_search_wiener(
@@ -1336,6 +1367,7 @@ static void search_norestore(const RestorationTileLimits *limits,
                              const AV1PixelRect *tile_rect, int rest_unit_idx,
                              void *priv, int32_t *tmpbuf,
                              RestorationLineBuffers *rlbs) {
+  (void)limits;
   (void)tile_rect;
   (void)tmpbuf;
   (void)rlbs;
@@ -1343,10 +1375,6 @@ static void search_norestore(const RestorationTileLimits *limits,
   RestSearchCtxt *rsc = (RestSearchCtxt *)priv;
   RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
 
-  const int highbd = rsc->cm->seq_params.use_highbitdepth;
-  rusi->sse[RESTORE_NONE] = sse_restoration_unit(
-      limits, rsc->src, &rsc->cm->cur_frame->buf, rsc->plane, highbd);
-
   rsc->sse += rusi->sse[RESTORE_NONE];
 }
 
@@ -1436,6 +1464,131 @@ static double search_rest_type(RestSearchCtxt *rsc, RestorationType rtype) {
   return RDCOST_DBL(rsc->x->rdmult, rsc->bits >> 4, rsc->sse);
 }
 
+static void get_rest_unit_limits(const RestorationTileLimits *limits,
+                                 const AV1PixelRect *tile_rect,
+                                 int rest_unit_idx, void *priv, int32_t *tmpbuf,
+                                 RestorationLineBuffers *rlbs) {
+  (void)tile_rect;
+  (void)tmpbuf;
+  (void)rlbs;
+  RestUnitSearchInfo *rusi = (RestUnitSearchInfo *)priv;
+  rusi[rest_unit_idx].limits = *limits;
+}
+
+// Computes the statistics of a restoration unit that the searches of
+// search_rest_type() start from: the unfiltered sse, the Wiener filter solved
+// from av1_compute_stats() and the self-guided parameters with the smallest
+// projection error. They only read the frame and do not depend on the other
+// units, so the units can be processed in any order. Trial filtering is left
+// to the searches, as it temporarily overwrites the frame around the stripe
+// boundaries of the unit. The statistics of a filter that force_restore_type
+// rules out are skipped, as the search never reads them.
+static void compute_rest_unit_stats(const RestSearchCtxt *rsc,
+                                    int rest_unit_idx, int32_t *tmpbuf) {
+  RestUnitSearchInfo *rusi = &rsc->rusi[rest_unit_idx];
+  const RestorationTileLimits *limits = &rusi->limits;
+  const int highbd = rsc->cm->seq_params.use_highbitdepth;
+
+  rusi->sse[RESTORE_NONE] = sse_restoration_unit(
+      limits, rsc->src, &rsc->cm->cur_frame->buf, rsc->plane, highbd);
+  if (force_restore_type == RESTORE_TYPES ||
+      force_restore_type == RESTORE_WIENER)
+    compute_wiener_stats(rsc, limits, rusi);
+  if (force_restore_type == RESTORE_TYPES ||
+      force_restore_type == RESTORE_SGRPROJ)
+    compute_sgrproj_stats(rsc, limits, rusi, tmpbuf);
+}
+
+typedef struct {
+  const RestSearchCtxt *rsc;
+  int num_units;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t *job_mutex;
+#endif
+  // Restoration units are handed out in raster order.
+  int next_unit;
+} RestStatsJobs;
+
+static int get_next_rest_unit(RestStatsJobs *jobs, int *unit) {
+  int ret = 0;
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_lock(jobs->job_mutex);
+#endif
+
+  if (jobs->next_unit < jobs->num_units) {
+    *unit = jobs->next_unit++;
+    ret = 1;
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_unlock(jobs->job_mutex);
+#endif
+
+  return ret;
+}
+
+static int rest_stats_worker(void *arg1, void *arg2) {
+  RestStatsJobs *const jobs = (RestStatsJobs *)arg1;
+  int32_t *const tmpbuf = (int32_t *)arg2;
+  int unit;
+
+  while (get_next_rest_unit(jobs, &unit)) {
+    compute_rest_unit_stats(jobs->rsc, unit, tmpbuf);
+  }
+  return 1;
+}
+
+// Computes the statistics of all the restoration units of the plane, spread
+// over num_workers threads when there is more than one. Worker i uses
+// tmpbufs[i] as its scratch buffer.
+static void compute_rest_stats(const RestSearchCtxt *rsc, int num_units,
+                               AVxWorker *workers, int num_workers,
+                               int32_t *const *tmpbufs) {
+  AV1PixelRect tile_rect = rsc->tile_rect;
+  av1_foreach_rest_unit_in_plane(rsc->cm, rsc->plane, get_rest_unit_limits,
+                                 rsc->rusi, &tile_rect, NULL, NULL);
+
+  num_workers = AOMMIN(num_workers, num_units);
+  if (num_workers <= 1) {
+    for (int unit = 0; unit < num_units; ++unit)
+      compute_rest_unit_stats(rsc, unit, tmpbufs[0]);
+    return;
+  }
+
+  const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+  RestStatsJobs jobs;
+  jobs.rsc = rsc;
+  jobs.num_units = num_units;
+  jobs.next_unit = 0;
+#if CONFIG_MULTITHREAD
+  pthread_mutex_t job_mutex;
+  pthread_mutex_init(&job_mutex, NULL);
+  jobs.job_mutex = &job_mutex;
+#endif
+
+  for (int i = 0; i < num_workers; ++i) {
+    AVxWorker *const worker = &workers[i];
+    worker->hook = rest_stats_worker;
+    worker->data1 = &jobs;
+    worker->data2 = tmpbufs[i];
+
+    if (i == num_workers - 1) {
+      winterface->execute(worker);
+    } else {
+      winterface->launch(worker);
+    }
+  }
+
+  for (int i = 0; i < num_workers; ++i) {
+    winterface->sync(&workers[i]);
+  }
+
+#if CONFIG_MULTITHREAD
+  pthread_mutex_destroy(&job_mutex);
+#endif
+}
+
 static int rest_tiles_in_plane(const AV1_COMMON *cm, int plane) {
   const RestorationInfo *rsi = &cm->rst_info[plane];
   return rsi->units_per_tile;
@@ -1451,6 +1604,22 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
     ntiles[is_uv] = rest_tiles_in_plane(cm, is_uv);
 
   assert(ntiles[1] <= ntiles[0]);
+
+  // The statistics of the units are computed on the encoder workers, each
+  // with its own filter scratch buffer. Those of the workers are allocated
+  // the first time they are needed and kept with the thread data.
+  const int num_workers = AOMMIN(cpi->num_workers, ntiles[0]);
+  int32_t *tmpbufs[MAX_NUM_THREADS];
+  tmpbufs[0] = cm->rst_tmpbuf;
+  for (int i = 1; i < num_workers; ++i) {
+    ThreadData *const td = cpi->tile_thr_data[i].td;
+    if (td->rst_tmpbuf == NULL) {
+      CHECK_MEM_ERROR(cm, td->rst_tmpbuf,
+                      (int32_t *)aom_memalign(16, RESTORATION_TMPBUF_SIZE));
+    }
+    tmpbufs[i] = td->rst_tmpbuf;
+  }
+
   RestUnitSearchInfo *rusi =
       (RestUnitSearchInfo *)aom_memalign(16, sizeof(*rusi) * ntiles[0]);
 
@@ -1482,6 +1651,9 @@ void av1_pick_filter_restoration(const YV12_BUFFER_CONFIG *src, AV1_COMP *cpi) {
                        rsc.dgd_stride, RESTORATION_BORDER, RESTORATION_BORDER,
                        highbd);
 
+      compute_rest_stats(&rsc, plane_ntiles, cpi->workers, num_workers,
+                         tmpbufs);
+
       for (RestorationType r = 0; r < num_rtypes; ++r) {
         if ((force_restore_type != RESTORE_TYPES) && (r != RESTORE_NONE) &&
             (r != force_restore_type))
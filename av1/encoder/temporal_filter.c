@@ -24,6 +24,7 @@
 #include "av1/encoder/firstpass.h"
 #include "av1/encoder/mcomp.h"
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/ratectrl.h"
 #include "av1/encoder/reconinter_enc.h"
 #include "av1/encoder/segmentation.h"
@@ -860,12 +861,11 @@ void apply_temporal_filter_block(YV12_BUFFER_CONFIG *frame, MACROBLOCKD *mbd,
 }
 #endif  // EXPERIMENT_TEMPORAL_FILTER
 
-static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi,
+static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi, MACROBLOCK *x,
                                               uint8_t *arf_frame_buf,
                                               uint8_t *frame_ptr_buf,
                                               int stride, int x_pos, int y_pos,
                                               MV *blk_mvs, int *blk_bestsme) {
-  MACROBLOCK *const x = &cpi->td.mb;
   MACROBLOCKD *const xd = &x->e_mbd;
   const MV_SPEED_FEATURES *const mv_sf = &cpi->sf.mv;
   int step_param;
@@ -981,25 +981,24 @@ static int temporal_filter_find_matching_mb_c(AV1_COMP *cpi,
   return bestsme;
 }
 
-static void temporal_filter_iterate_c(AV1_COMP *cpi,
-                                      YV12_BUFFER_CONFIG **frames,
-                                      int frame_count, int alt_ref_index,
-                                      int strength, double sigma,
-                                      struct scale_factors *ref_scale_factors) {
+void av1_temporal_filter_row(AV1_COMP *cpi, ThreadData *td, int mb_row) {
   const AV1_COMMON *cm = &cpi->common;
+  const TemporalFilterCtxt *const tf_ctxt = &cpi->tf_ctxt;
+  YV12_BUFFER_CONFIG **frames = tf_ctxt->frames;
+  const int frame_count = tf_ctxt->frame_count;
+  const int alt_ref_index = tf_ctxt->alt_ref_index;
+  const int strength = tf_ctxt->strength;
+  struct scale_factors *ref_scale_factors = tf_ctxt->ref_scale_factors;
   const int num_planes = av1_num_planes(cm);
   int byte;
   int frame;
-  int mb_col, mb_row;
-  int mb_cols = (frames[alt_ref_index]->y_crop_width + BW - 1) >> BW_LOG2;
-  int mb_rows = (frames[alt_ref_index]->y_crop_height + BH - 1) >> BH_LOG2;
-  int mb_y_offset = 0;
-  int mb_y_src_offset = 0;
-  int mb_uv_offset = 0;
-  int mb_uv_src_offset = 0;
+  int mb_col;
+  const int mb_cols = tf_ctxt->mb_cols;
+  const int mb_rows = tf_ctxt->mb_rows;
   DECLARE_ALIGNED(16, unsigned int, accumulator[BLK_PELS * 3]);
   DECLARE_ALIGNED(16, uint16_t, count[BLK_PELS * 3]);
-  MACROBLOCKD *mbd = &cpi->td.mb.e_mbd;
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *mbd = &x->e_mbd;
   YV12_BUFFER_CONFIG *f = frames[alt_ref_index];
   uint8_t *dst1, *dst2;
   DECLARE_ALIGNED(32, uint16_t, predictor16[BLK_PELS * 3]);
@@ -1007,17 +1006,24 @@ static void temporal_filter_iterate_c(AV1_COMP *cpi,
   uint8_t *predictor;
   const int mb_uv_height = BH >> mbd->plane[1].subsampling_y;
   const int mb_uv_width = BW >> mbd->plane[1].subsampling_x;
+  int mb_y_offset = mb_row * BH * cpi->alt_ref_buffer.y_stride;
+  int mb_y_src_offset = mb_row * BH * f->y_stride;
+  int mb_uv_offset = mb_row * mb_uv_height * cpi->alt_ref_buffer.uv_stride;
+  int mb_uv_src_offset = mb_row * mb_uv_height * f->uv_stride;
 #if EXPERIMENT_TEMPORAL_FILTER
+  const double sigma = tf_ctxt->sigma;
   const int is_screen_content_type = cm->allow_screen_content_tools != 0;
   const int use_new_temporal_mode =
       AOMMIN(cm->width, cm->height) >= 480 && !is_screen_content_type;
 #else
-  (void)sigma;
   const int use_new_temporal_mode = 0;
 #endif
 
   // Save input state
   uint8_t *input_buffer[MAX_MB_PLANE];
+  MB_MODE_INFO **const input_mi = mbd->mi;
+  int *const input_m_search_count_ptr = x->m_search_count_ptr;
+  int *const input_ex_search_count_ptr = x->ex_search_count_ptr;
   int i;
   const int is_hbd = is_cur_buf_hbd(mbd);
   if (is_hbd) {
@@ -1026,287 +1032,323 @@ static void temporal_filter_iterate_c(AV1_COMP *cpi,
     predictor = predictor8;
   }
 
+  // The block search leaves its 32x32 motion vector in mbd->mi[0], which is
+  // the start point of the 16x16 sub-block searches and selects the
+  // prediction of the block. Keep that state in this row, so that the rows
+  // filtered at the same time do not overwrite each other's vectors.
+  MB_MODE_INFO mbmi = *mbd->mi[0];
+  MB_MODE_INFO *mbmi_ptr = &mbmi;
+  mbd->mi = &mbmi_ptr;
+
+  // The motion search counters would otherwise point into the tile data of
+  // the last encoded frame, shared by all the workers. Each block searches
+  // every frame of the filter window, so counting from zero at the start of
+  // the row bounds the exhaustive searches of the row.
+  int m_search_count = 0;
+  int ex_search_count = 0;
+  x->m_search_count_ptr = &m_search_count;
+  x->ex_search_count_ptr = &ex_search_count;
+
   mbd->block_ref_scale_factors[0] = ref_scale_factors;
   mbd->block_ref_scale_factors[1] = ref_scale_factors;
 
   for (i = 0; i < num_planes; i++) input_buffer[i] = mbd->plane[i].pre[0].buf;
 
-  for (mb_row = 0; mb_row < mb_rows; mb_row++) {
-    // Source frames are extended to 16 pixels. This is different than
-    //  L/A/G reference frames that have a border of 32 (AV1ENCBORDERINPIXELS)
-    // A 6/8 tap filter is used for motion search.  This requires 2 pixels
-    //  before and 3 pixels after.  So the largest Y mv on a border would
-    //  then be 16 - AOM_INTERP_EXTEND. The UV blocks are half the size of the
-    //  Y and therefore only extended by 8.  The largest mv that a UV block
-    //  can support is 8 - AOM_INTERP_EXTEND.  A UV mv is half of a Y mv.
-    //  (16 - AOM_INTERP_EXTEND) >> 1 which is greater than
-    //  8 - AOM_INTERP_EXTEND.
-    // To keep the mv in play for both Y and UV planes the max that it
-    //  can be on a border is therefore 16 - (2*AOM_INTERP_EXTEND+1).
-    cpi->td.mb.mv_limits.row_min =
-        -((mb_row * BH) + (17 - 2 * AOM_INTERP_EXTEND));
-    cpi->td.mb.mv_limits.row_max =
-        ((mb_rows - 1 - mb_row) * BH) + (17 - 2 * AOM_INTERP_EXTEND);
-
-    for (mb_col = 0; mb_col < mb_cols; mb_col++) {
-      int j, k;
-      int stride;
-
-      memset(accumulator, 0, BLK_PELS * 3 * sizeof(accumulator[0]));
-      memset(count, 0, BLK_PELS * 3 * sizeof(count[0]));
-
-      cpi->td.mb.mv_limits.col_min =
-          -((mb_col * BW) + (17 - 2 * AOM_INTERP_EXTEND));
-      cpi->td.mb.mv_limits.col_max =
-          ((mb_cols - 1 - mb_col) * BW) + (17 - 2 * AOM_INTERP_EXTEND);
-
-      for (frame = 0; frame < frame_count; frame++) {
-        // MVs for 4 16x16 sub blocks.
-        MV blk_mvs[4];
-        // Filter weights for 4 16x16 sub blocks.
-        int blk_fw[4] = { 0, 0, 0, 0 };
-        int use_32x32 = 0;
-
-        if (frames[frame] == NULL) continue;
-
-        mbd->mi[0]->mv[0].as_mv.row = 0;
-        mbd->mi[0]->mv[0].as_mv.col = 0;
-        mbd->mi[0]->motion_mode = SIMPLE_TRANSLATION;
-        blk_mvs[0] = kZeroMv;
-        blk_mvs[1] = kZeroMv;
-        blk_mvs[2] = kZeroMv;
-        blk_mvs[3] = kZeroMv;
+  // Source frames are extended to 16 pixels. This is different than
+  //  L/A/G reference frames that have a border of 32 (AV1ENCBORDERINPIXELS)
+  // A 6/8 tap filter is used for motion search.  This requires 2 pixels
+  //  before and 3 pixels after.  So the largest Y mv on a border would
+  //  then be 16 - AOM_INTERP_EXTEND. The UV blocks are half the size of the
+  //  Y and therefore only extended by 8.  The largest mv that a UV block
+  //  can support is 8 - AOM_INTERP_EXTEND.  A UV mv is half of a Y mv.
+  //  (16 - AOM_INTERP_EXTEND) >> 1 which is greater than
+  //  8 - AOM_INTERP_EXTEND.
+  // To keep the mv in play for both Y and UV planes the max that it
+  //  can be on a border is therefore 16 - (2*AOM_INTERP_EXTEND+1).
+  x->mv_limits.row_min = -((mb_row * BH) + (17 - 2 * AOM_INTERP_EXTEND));
+  x->mv_limits.row_max =
+      ((mb_rows - 1 - mb_row) * BH) + (17 - 2 * AOM_INTERP_EXTEND);
+
+  for (mb_col = 0; mb_col < mb_cols; mb_col++) {
+    int j, k;
+    int stride;
+
+    memset(accumulator, 0, BLK_PELS * 3 * sizeof(accumulator[0]));
+    memset(count, 0, BLK_PELS * 3 * sizeof(count[0]));
+
+    x->mv_limits.col_min = -((mb_col * BW) + (17 - 2 * AOM_INTERP_EXTEND));
+    x->mv_limits.col_max =
+        ((mb_cols - 1 - mb_col) * BW) + (17 - 2 * AOM_INTERP_EXTEND);
+
+    for (frame = 0; frame < frame_count; frame++) {
+      // MVs for 4 16x16 sub blocks.
+      MV blk_mvs[4];
+      // Filter weights for 4 16x16 sub blocks.
+      int blk_fw[4] = { 0, 0, 0, 0 };
+      int use_32x32 = 0;
+
+      if (frames[frame] == NULL) continue;
+
+      mbd->mi[0]->mv[0].as_mv.row = 0;
+      mbd->mi[0]->mv[0].as_mv.col = 0;
+      mbd->mi[0]->motion_mode = SIMPLE_TRANSLATION;
+      blk_mvs[0] = kZeroMv;
+      blk_mvs[1] = kZeroMv;
+      blk_mvs[2] = kZeroMv;
+      blk_mvs[3] = kZeroMv;
+
+      if (frame == alt_ref_index) {
+        blk_fw[0] = blk_fw[1] = blk_fw[2] = blk_fw[3] = 2;
+        use_32x32 = 1;
+      } else {
+        int thresh_low = 10000;
+        int thresh_high = 20000;
+        int blk_bestsme[4] = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
+
+        // Find best match in this frame by MC
+        int err = temporal_filter_find_matching_mb_c(
+            cpi, x, frames[alt_ref_index]->y_buffer + mb_y_src_offset,
+            frames[frame]->y_buffer + mb_y_src_offset,
+            frames[frame]->y_stride, mb_col * BW, mb_row * BH, blk_mvs,
+            blk_bestsme);
+
+        int err16 =
+            blk_bestsme[0] + blk_bestsme[1] + blk_bestsme[2] + blk_bestsme[3];
+        int max_err = INT_MIN, min_err = INT_MAX;
+        for (k = 0; k < 4; k++) {
+          if (min_err > blk_bestsme[k]) min_err = blk_bestsme[k];
+          if (max_err < blk_bestsme[k]) max_err = blk_bestsme[k];
+        }
 
-        if (frame == alt_ref_index) {
-          blk_fw[0] = blk_fw[1] = blk_fw[2] = blk_fw[3] = 2;
+        if (((err * 15 < (err16 << 4)) && max_err - min_err < 12000) ||
+            ((err * 14 < (err16 << 4)) && max_err - min_err < 6000)) {
           use_32x32 = 1;
+          // Assign higher weight to matching MB if it's error
+          // score is lower. If not applying MC default behavior
+          // is to weight all MBs equal.
+          blk_fw[0] = err < (thresh_low << THR_SHIFT)
+                          ? 2
+                          : err < (thresh_high << THR_SHIFT) ? 1 : 0;
+          blk_fw[1] = blk_fw[2] = blk_fw[3] = blk_fw[0];
         } else {
-          int thresh_low = 10000;
-          int thresh_high = 20000;
-          int blk_bestsme[4] = { INT_MAX, INT_MAX, INT_MAX, INT_MAX };
-
-          // Find best match in this frame by MC
-          int err = temporal_filter_find_matching_mb_c(
-              cpi, frames[alt_ref_index]->y_buffer + mb_y_src_offset,
-              frames[frame]->y_buffer + mb_y_src_offset,
-              frames[frame]->y_stride, mb_col * BW, mb_row * BH, blk_mvs,
-              blk_bestsme);
-
-          int err16 =
-              blk_bestsme[0] + blk_bestsme[1] + blk_bestsme[2] + blk_bestsme[3];
-          int max_err = INT_MIN, min_err = INT_MAX;
-          for (k = 0; k < 4; k++) {
-            if (min_err > blk_bestsme[k]) min_err = blk_bestsme[k];
-            if (max_err < blk_bestsme[k]) max_err = blk_bestsme[k];
-          }
-
-          if (((err * 15 < (err16 << 4)) && max_err - min_err < 12000) ||
-              ((err * 14 < (err16 << 4)) && max_err - min_err < 6000)) {
-            use_32x32 = 1;
-            // Assign higher weight to matching MB if it's error
-            // score is lower. If not applying MC default behavior
-            // is to weight all MBs equal.
-            blk_fw[0] = err < (thresh_low << THR_SHIFT)
+          use_32x32 = 0;
+          for (k = 0; k < 4; k++)
+            blk_fw[k] = blk_bestsme[k] < thresh_low
                             ? 2
-                            : err < (thresh_high << THR_SHIFT) ? 1 : 0;
-            blk_fw[1] = blk_fw[2] = blk_fw[3] = blk_fw[0];
-          } else {
-            use_32x32 = 0;
-            for (k = 0; k < 4; k++)
-              blk_fw[k] = blk_bestsme[k] < thresh_low
-                              ? 2
-                              : blk_bestsme[k] < thresh_high ? 1 : 0;
-          }
+                            : blk_bestsme[k] < thresh_high ? 1 : 0;
         }
+      }
+
+      if (blk_fw[0] || blk_fw[1] || blk_fw[2] || blk_fw[3]) {
+        // Construct the predictors
+        temporal_filter_predictors_mb_c(
+            mbd, frames[frame]->y_buffer + mb_y_src_offset,
+            frames[frame]->u_buffer + mb_uv_src_offset,
+            frames[frame]->v_buffer + mb_uv_src_offset,
+            frames[frame]->y_stride, mb_uv_width, mb_uv_height,
+            mbd->mi[0]->mv[0].as_mv.row, mbd->mi[0]->mv[0].as_mv.col,
+            predictor, ref_scale_factors, mb_col * BW, mb_row * BH,
+            cm->allow_warped_motion, num_planes, blk_mvs, use_32x32);
+
+        // Apply the filter (YUV)
+        if (frame == alt_ref_index) {
+          uint8_t *pred = predictor;
+          uint32_t *accum = accumulator;
+          uint16_t *cnt = count;
+          int plane;
+
+          // All 4 blk_fws are equal to 2.
+          for (plane = 0; plane < num_planes; ++plane) {
+            const int pred_stride = plane ? mb_uv_width : BW;
+            const unsigned int w = plane ? mb_uv_width : BW;
+            const unsigned int h = plane ? mb_uv_height : BH;
 
-        if (blk_fw[0] || blk_fw[1] || blk_fw[2] || blk_fw[3]) {
-          // Construct the predictors
-          temporal_filter_predictors_mb_c(
-              mbd, frames[frame]->y_buffer + mb_y_src_offset,
-              frames[frame]->u_buffer + mb_uv_src_offset,
-              frames[frame]->v_buffer + mb_uv_src_offset,
-              frames[frame]->y_stride, mb_uv_width, mb_uv_height,
-              mbd->mi[0]->mv[0].as_mv.row, mbd->mi[0]->mv[0].as_mv.col,
-              predictor, ref_scale_factors, mb_col * BW, mb_row * BH,
-              cm->allow_warped_motion, num_planes, blk_mvs, use_32x32);
-
-          // Apply the filter (YUV)
-          if (frame == alt_ref_index) {
-            uint8_t *pred = predictor;
-            uint32_t *accum = accumulator;
-            uint16_t *cnt = count;
-            int plane;
-
-            // All 4 blk_fws are equal to 2.
-            for (plane = 0; plane < num_planes; ++plane) {
-              const int pred_stride = plane ? mb_uv_width : BW;
-              const unsigned int w = plane ? mb_uv_width : BW;
-              const unsigned int h = plane ? mb_uv_height : BH;
-
-              if (is_hbd) {
-                highbd_apply_temporal_filter_self(pred, pred_stride, w, h,
-                                                  blk_fw[0], accum, cnt,
-                                                  use_new_temporal_mode);
-              } else {
-                apply_temporal_filter_self(pred, pred_stride, w, h, blk_fw[0],
-                                           accum, cnt, use_new_temporal_mode);
-              }
-
-              pred += BLK_PELS;
-              accum += BLK_PELS;
-              cnt += BLK_PELS;
-            }
-          } else {
             if (is_hbd) {
+              highbd_apply_temporal_filter_self(pred, pred_stride, w, h,
+                                                blk_fw[0], accum, cnt,
+                                                use_new_temporal_mode);
+            } else {
+              apply_temporal_filter_self(pred, pred_stride, w, h, blk_fw[0],
+                                         accum, cnt, use_new_temporal_mode);
+            }
+
+            pred += BLK_PELS;
+            accum += BLK_PELS;
+            cnt += BLK_PELS;
+          }
+        } else {
+          if (is_hbd) {
 #if EXPERIMENT_TEMPORAL_FILTER
-              apply_temporal_filter_block(
-                  f, mbd, mb_y_src_offset, mb_uv_src_offset, mb_uv_width,
-                  mb_uv_height, num_planes, predictor, cm->height, strength,
-                  sigma, blk_fw, use_32x32, accumulator, count,
-                  use_new_temporal_mode);
+            apply_temporal_filter_block(
+                f, mbd, mb_y_src_offset, mb_uv_src_offset, mb_uv_width,
+                mb_uv_height, num_planes, predictor, cm->height, strength,
+                sigma, blk_fw, use_32x32, accumulator, count,
+                use_new_temporal_mode);
 #else
-              const int adj_strength = strength + 2 * (mbd->bd - 8);
-              if (num_planes <= 1) {
-                // Single plane case
-                av1_highbd_temporal_filter_apply_c(
-                    f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
-                    BH, adj_strength, blk_fw, use_32x32, accumulator, count);
-              } else {
-                // Process 3 planes together.
-                av1_highbd_apply_temporal_filter(
-                    f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
-                    f->u_buffer + mb_uv_src_offset,
-                    f->v_buffer + mb_uv_src_offset, f->uv_stride,
-                    predictor + BLK_PELS, predictor + (BLK_PELS << 1),
-                    mb_uv_width, BW, BH, mbd->plane[1].subsampling_x,
-                    mbd->plane[1].subsampling_y, adj_strength, blk_fw,
-                    use_32x32, accumulator, count, accumulator + BLK_PELS,
-                    count + BLK_PELS, accumulator + (BLK_PELS << 1),
-                    count + (BLK_PELS << 1));
-              }
-#endif  // EXPERIMENT_TEMPORAL_FILTER
+            const int adj_strength = strength + 2 * (mbd->bd - 8);
+            if (num_planes <= 1) {
+              // Single plane case
+              av1_highbd_temporal_filter_apply_c(
+                  f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
+                  BH, adj_strength, blk_fw, use_32x32, accumulator, count);
             } else {
+              // Process 3 planes together.
+              av1_highbd_apply_temporal_filter(
+                  f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
+                  f->u_buffer + mb_uv_src_offset,
+                  f->v_buffer + mb_uv_src_offset, f->uv_stride,
+                  predictor + BLK_PELS, predictor + (BLK_PELS << 1),
+                  mb_uv_width, BW, BH, mbd->plane[1].subsampling_x,
+                  mbd->plane[1].subsampling_y, adj_strength, blk_fw,
+                  use_32x32, accumulator, count, accumulator + BLK_PELS,
+                  count + BLK_PELS, accumulator + (BLK_PELS << 1),
+                  count + (BLK_PELS << 1));
+            }
+#endif  // EXPERIMENT_TEMPORAL_FILTER
+          } else {
 #if EXPERIMENT_TEMPORAL_FILTER
-              apply_temporal_filter_block(
-                  f, mbd, mb_y_src_offset, mb_uv_src_offset, mb_uv_width,
-                  mb_uv_height, num_planes, predictor, cm->height, strength,
-                  sigma, blk_fw, use_32x32, accumulator, count,
-                  use_new_temporal_mode);
+            apply_temporal_filter_block(
+                f, mbd, mb_y_src_offset, mb_uv_src_offset, mb_uv_width,
+                mb_uv_height, num_planes, predictor, cm->height, strength,
+                sigma, blk_fw, use_32x32, accumulator, count,
+                use_new_temporal_mode);
 #else
-              if (num_planes <= 1) {
-                // Single plane case
-                av1_temporal_filter_apply_c(
-                    f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
-                    BH, strength, blk_fw, use_32x32, accumulator, count);
-              } else {
-                // Process 3 planes together.
-                av1_apply_temporal_filter(
-                    f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
-                    f->u_buffer + mb_uv_src_offset,
-                    f->v_buffer + mb_uv_src_offset, f->uv_stride,
-                    predictor + BLK_PELS, predictor + (BLK_PELS << 1),
-                    mb_uv_width, BW, BH, mbd->plane[1].subsampling_x,
-                    mbd->plane[1].subsampling_y, strength, blk_fw, use_32x32,
-                    accumulator, count, accumulator + BLK_PELS,
-                    count + BLK_PELS, accumulator + (BLK_PELS << 1),
-                    count + (BLK_PELS << 1));
-              }
-#endif  // EXPERIMENT_TEMPORAL_FILTER
+            if (num_planes <= 1) {
+              // Single plane case
+              av1_temporal_filter_apply_c(
+                  f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
+                  BH, strength, blk_fw, use_32x32, accumulator, count);
+            } else {
+              // Process 3 planes together.
+              av1_apply_temporal_filter(
+                  f->y_buffer + mb_y_src_offset, f->y_stride, predictor, BW,
+                  f->u_buffer + mb_uv_src_offset,
+                  f->v_buffer + mb_uv_src_offset, f->uv_stride,
+                  predictor + BLK_PELS, predictor + (BLK_PELS << 1),
+                  mb_uv_width, BW, BH, mbd->plane[1].subsampling_x,
+                  mbd->plane[1].subsampling_y, strength, blk_fw, use_32x32,
+                  accumulator, count, accumulator + BLK_PELS,
+                  count + BLK_PELS, accumulator + (BLK_PELS << 1),
+                  count + (BLK_PELS << 1));
             }
+#endif  // EXPERIMENT_TEMPORAL_FILTER
           }
         }
       }
+    }
+
+    // Normalize filter output to produce AltRef frame
+    if (is_hbd) {
+      uint16_t *dst1_16;
+      uint16_t *dst2_16;
+      dst1 = cpi->alt_ref_buffer.y_buffer;
+      dst1_16 = CONVERT_TO_SHORTPTR(dst1);
+      stride = cpi->alt_ref_buffer.y_stride;
+      byte = mb_y_offset;
+      for (i = 0, k = 0; i < BH; i++) {
+        for (j = 0; j < BW; j++, k++) {
+          dst1_16[byte] =
+              (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
+
+          // move to next pixel
+          byte++;
+        }
 
-      // Normalize filter output to produce AltRef frame
-      if (is_hbd) {
-        uint16_t *dst1_16;
-        uint16_t *dst2_16;
-        dst1 = cpi->alt_ref_buffer.y_buffer;
+        byte += stride - BW;
+      }
+      if (num_planes > 1) {
+        dst1 = cpi->alt_ref_buffer.u_buffer;
+        dst2 = cpi->alt_ref_buffer.v_buffer;
         dst1_16 = CONVERT_TO_SHORTPTR(dst1);
-        stride = cpi->alt_ref_buffer.y_stride;
-        byte = mb_y_offset;
-        for (i = 0, k = 0; i < BH; i++) {
-          for (j = 0; j < BW; j++, k++) {
+        dst2_16 = CONVERT_TO_SHORTPTR(dst2);
+        stride = cpi->alt_ref_buffer.uv_stride;
+        byte = mb_uv_offset;
+        for (i = 0, k = BLK_PELS; i < mb_uv_height; i++) {
+          for (j = 0; j < mb_uv_width; j++, k++) {
+            int m = k + BLK_PELS;
+            // U
             dst1_16[byte] =
                 (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-
+            // V
+            dst2_16[byte] =
+                (uint16_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
             // move to next pixel
             byte++;
           }
-
-          byte += stride - BW;
+          byte += stride - mb_uv_width;
         }
-        if (num_planes > 1) {
-          dst1 = cpi->alt_ref_buffer.u_buffer;
-          dst2 = cpi->alt_ref_buffer.v_buffer;
-          dst1_16 = CONVERT_TO_SHORTPTR(dst1);
-          dst2_16 = CONVERT_TO_SHORTPTR(dst2);
-          stride = cpi->alt_ref_buffer.uv_stride;
-          byte = mb_uv_offset;
-          for (i = 0, k = BLK_PELS; i < mb_uv_height; i++) {
-            for (j = 0; j < mb_uv_width; j++, k++) {
-              int m = k + BLK_PELS;
-              // U
-              dst1_16[byte] =
-                  (uint16_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-              // V
-              dst2_16[byte] =
-                  (uint16_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
-              // move to next pixel
-              byte++;
-            }
-            byte += stride - mb_uv_width;
-          }
+      }
+    } else {
+      dst1 = cpi->alt_ref_buffer.y_buffer;
+      stride = cpi->alt_ref_buffer.y_stride;
+      byte = mb_y_offset;
+      for (i = 0, k = 0; i < BH; i++) {
+        for (j = 0; j < BW; j++, k++) {
+          dst1[byte] =
+              (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
+
+          // move to next pixel
+          byte++;
         }
-      } else {
-        dst1 = cpi->alt_ref_buffer.y_buffer;
-        stride = cpi->alt_ref_buffer.y_stride;
-        byte = mb_y_offset;
-        for (i = 0, k = 0; i < BH; i++) {
-          for (j = 0; j < BW; j++, k++) {
+        byte += stride - BW;
+      }
+      if (num_planes > 1) {
+        dst1 = cpi->alt_ref_buffer.u_buffer;
+        dst2 = cpi->alt_ref_buffer.v_buffer;
+        stride = cpi->alt_ref_buffer.uv_stride;
+        byte = mb_uv_offset;
+        for (i = 0, k = BLK_PELS; i < mb_uv_height; i++) {
+          for (j = 0; j < mb_uv_width; j++, k++) {
+            int m = k + BLK_PELS;
+            // U
             dst1[byte] =
                 (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-
+            // V
+            dst2[byte] =
+                (uint8_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
             // move to next pixel
             byte++;
           }
-          byte += stride - BW;
-        }
-        if (num_planes > 1) {
-          dst1 = cpi->alt_ref_buffer.u_buffer;
-          dst2 = cpi->alt_ref_buffer.v_buffer;
-          stride = cpi->alt_ref_buffer.uv_stride;
-          byte = mb_uv_offset;
-          for (i = 0, k = BLK_PELS; i < mb_uv_height; i++) {
-            for (j = 0; j < mb_uv_width; j++, k++) {
-              int m = k + BLK_PELS;
-              // U
-              dst1[byte] =
-                  (uint8_t)OD_DIVU(accumulator[k] + (count[k] >> 1), count[k]);
-              // V
-              dst2[byte] =
-                  (uint8_t)OD_DIVU(accumulator[m] + (count[m] >> 1), count[m]);
-              // move to next pixel
-              byte++;
-            }
-            byte += stride - mb_uv_width;
-          }
+          byte += stride - mb_uv_width;
         }
       }
-      mb_y_offset += BW;
-      mb_y_src_offset += BW;
-      mb_uv_offset += mb_uv_width;
-      mb_uv_src_offset += mb_uv_width;
     }
-    mb_y_offset += BH * cpi->alt_ref_buffer.y_stride - BW * mb_cols;
-    mb_y_src_offset += BH * f->y_stride - BW * mb_cols;
-    mb_uv_src_offset += mb_uv_height * f->uv_stride - mb_uv_width * mb_cols;
-    mb_uv_offset +=
-        mb_uv_height * cpi->alt_ref_buffer.uv_stride - mb_uv_width * mb_cols;
+    mb_y_offset += BW;
+    mb_y_src_offset += BW;
+    mb_uv_offset += mb_uv_width;
+    mb_uv_src_offset += mb_uv_width;
   }
 
   // Restore input state
   for (i = 0; i < num_planes; i++) mbd->plane[i].pre[0].buf = input_buffer[i];
+  mbd->mi = input_mi;
+  x->m_search_count_ptr = input_m_search_count_ptr;
+  x->ex_search_count_ptr = input_ex_search_count_ptr;
+}
+
+static void temporal_filter_iterate_c(AV1_COMP *cpi,
+                                      YV12_BUFFER_CONFIG **frames,
+                                      int frame_count, int alt_ref_index,
+                                      int strength, double sigma,
+                                      struct scale_factors *ref_scale_factors) {
+  TemporalFilterCtxt *const tf_ctxt = &cpi->tf_ctxt;
+  int mb_row;
+
+  tf_ctxt->frames = frames;
+  tf_ctxt->frame_count = frame_count;
+  tf_ctxt->alt_ref_index = alt_ref_index;
+  tf_ctxt->strength = strength;
+  tf_ctxt->sigma = sigma;
+  tf_ctxt->ref_scale_factors = ref_scale_factors;
+  tf_ctxt->mb_cols = (frames[alt_ref_index]->y_crop_width + BW - 1) >> BW_LOG2;
+  tf_ctxt->mb_rows = (frames[alt_ref_index]->y_crop_height + BH - 1) >> BH_LOG2;
+
+  if (cpi->oxcf.row_mt == 1 && cpi->oxcf.max_threads > 1) {
+    av1_temporal_filter_row_mt(cpi);
+  } else {
+    for (mb_row = 0; mb_row < tf_ctxt->mb_rows; mb_row++)
+      av1_temporal_filter_row(cpi, &cpi->td, mb_row);
+  }
 }
 
 // This is an adaptation of the mehtod in the following paper:
@@ -32,6 +32,10 @@ extern "C" {
 
 void av1_temporal_filter(AV1_COMP *cpi, int distance);
 
+// Filters one row of 32x32 blocks of the ARF described by cpi->tf_ctxt into
+// cpi->alt_ref_buffer, using the motion search state of td.
+void av1_temporal_filter_row(AV1_COMP *cpi, ThreadData *td, int mb_row);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
@@ -22,7 +22,9 @@
 #include "av1/common/reconintra.h"
 
 #include "av1/encoder/encoder.h"
+#include "av1/encoder/ethread.h"
 #include "av1/encoder/reconinter_enc.h"
+#include "av1/encoder/tpl_model.h"
 
 #define MC_FLOW_BSIZE 16
 #define MC_FLOW_NUM_PELS (MC_FLOW_BSIZE * MC_FLOW_BSIZE)
@@ -424,19 +426,86 @@ static YV12_BUFFER_CONFIG *get_framebuf(
   }
 }
 
+void av1_mc_flow_dispenser_row(AV1_COMP *cpi, ThreadData *td, int mi_row) {
+  AV1_COMMON *const cm = &cpi->common;
+  TplFrameCtxt *const tpl_ctxt = &cpi->tpl_frame_ctxt;
+  const int frame_idx = tpl_ctxt->frame_idx;
+  TplDepFrame *tpl_frame =
+      &cpi->tpl_stats[cpi->gf_group.frame_disp_idx[frame_idx]];
+  MACROBLOCK *const x = &td->mb;
+  MACROBLOCKD *const xd = &x->e_mbd;
+  const BLOCK_SIZE bsize = tpl_ctxt->bsize;
+  const TX_SIZE tx_size = max_txsize_lookup[bsize];
+  const int mi_height = mi_size_high[bsize];
+  const int mi_width = mi_size_wide[bsize];
+  int mi_col;
+
+  DECLARE_ALIGNED(32, uint16_t, predictor16[MC_FLOW_NUM_PELS * 3]);
+  DECLARE_ALIGNED(32, uint8_t, predictor8[MC_FLOW_NUM_PELS * 3]);
+  uint8_t *predictor;
+  DECLARE_ALIGNED(32, int16_t, src_diff[MC_FLOW_NUM_PELS]);
+  DECLARE_ALIGNED(32, tran_low_t, coeff[MC_FLOW_NUM_PELS]);
+
+  // mode_estimation() sets the block size and reference frame of the block
+  // in xd->mi[0]. Point it at a copy owned by this row rather than at
+  // cm->mi, which the other rows of the frame would be writing as well.
+  MB_MODE_INFO mbmi = *cm->mi;
+  MB_MODE_INFO *mbmi_ptr = &mbmi;
+  xd->mi = &mbmi_ptr;
+
+  // The TPL pass runs before the tiles of the frame are set up, so there are
+  // no tile counters for the motion search. Counting per row keeps the
+  // exhaustive search allowance of a block independent of the thread that
+  // runs its row.
+  int m_search_count = 0;
+  int ex_search_count = 0;
+  x->m_search_count_ptr = &m_search_count;
+  x->ex_search_count_ptr = &ex_search_count;
+
+  if (is_cur_buf_hbd(xd))
+    predictor = CONVERT_TO_BYTEPTR(predictor16);
+  else
+    predictor = predictor8;
+
+  // Motion estimation row boundary
+  x->mv_limits.row_min = -((mi_row * MI_SIZE) + (17 - 2 * AOM_INTERP_EXTEND));
+  x->mv_limits.row_max = (cm->mi_rows - mi_height - mi_row) * MI_SIZE +
+                         (17 - 2 * AOM_INTERP_EXTEND);
+  xd->mb_to_top_edge = -((mi_row * MI_SIZE) * 8);
+  xd->mb_to_bottom_edge = ((cm->mi_rows - mi_height - mi_row) * MI_SIZE) * 8;
+  for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
+    TplDepStats tpl_stats;
+
+    // Motion estimation column boundary
+    x->mv_limits.col_min = -((mi_col * MI_SIZE) + (17 - 2 * AOM_INTERP_EXTEND));
+    x->mv_limits.col_max = ((cm->mi_cols - mi_width - mi_col) * MI_SIZE) +
+                           (17 - 2 * AOM_INTERP_EXTEND);
+    xd->mb_to_left_edge = -((mi_col * MI_SIZE) * 8);
+    xd->mb_to_right_edge = ((cm->mi_cols - mi_width - mi_col) * MI_SIZE) * 8;
+    mode_estimation(cpi, x, xd, &tpl_ctxt->sf, frame_idx, src_diff, coeff, 1,
+                    mi_row, mi_col, bsize, tx_size, tpl_ctxt->ref_frame,
+                    predictor, &tpl_stats);
+
+    // Motion flow dependency dispenser.
+    tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
+                    tpl_frame->stride, &tpl_stats);
+  }
+
+  xd->mi = cm->mi_grid_visible;
+  x->m_search_count_ptr = NULL;
+  x->ex_search_count_ptr = NULL;
+}
+
 static void mc_flow_dispenser(AV1_COMP *cpi, YV12_BUFFER_CONFIG **gf_picture,
                               int frame_idx) {
   const GF_GROUP *gf_group = &cpi->gf_group;
   if (frame_idx == gf_group->size) return;
   int tpl_idx = gf_group->frame_disp_idx[frame_idx];
   TplDepFrame *tpl_frame = &cpi->tpl_stats[tpl_idx];
+  TplFrameCtxt *const tpl_ctxt = &cpi->tpl_frame_ctxt;
   YV12_BUFFER_CONFIG *this_frame = gf_picture[frame_idx];
-  YV12_BUFFER_CONFIG *ref_frame[7] = {
-    NULL, NULL, NULL, NULL, NULL, NULL, NULL
-  };
 
   AV1_COMMON *cm = &cpi->common;
-  struct scale_factors sf;
   int rdmult, idx;
   ThreadData *td = &cpi->td;
   MACROBLOCK *x = &td->mb;
@@ -457,32 +526,24 @@ static void mc_flow_dispenser(AV1_COMP *cpi, YV12_BUFFER_CONFIG **gf_picture,
 #endif  // MC_FLOW_BSIZE == 64
   av1_tile_init(&xd->tile, cm, 0, 0);
 
-  DECLARE_ALIGNED(32, uint16_t, predictor16[MC_FLOW_NUM_PELS * 3]);
-  DECLARE_ALIGNED(32, uint8_t, predictor8[MC_FLOW_NUM_PELS * 3]);
-  uint8_t *predictor;
-  DECLARE_ALIGNED(32, int16_t, src_diff[MC_FLOW_NUM_PELS]);
-  DECLARE_ALIGNED(32, tran_low_t, coeff[MC_FLOW_NUM_PELS]);
-
-  const TX_SIZE tx_size = max_txsize_lookup[bsize];
   const int mi_height = mi_size_high[bsize];
   const int mi_width = mi_size_wide[bsize];
 
+  tpl_ctxt->frame_idx = frame_idx;
+  tpl_ctxt->bsize = bsize;
+
   // Setup scaling factor
   av1_setup_scale_factors_for_frame(
-      &sf, this_frame->y_crop_width, this_frame->y_crop_height,
+      &tpl_ctxt->sf, this_frame->y_crop_width, this_frame->y_crop_height,
       this_frame->y_crop_width, this_frame->y_crop_height);
 
   xd->cur_buf = this_frame;
 
-  if (is_cur_buf_hbd(xd))
-    predictor = CONVERT_TO_BYTEPTR(predictor16);
-  else
-    predictor = predictor8;
-
   // Prepare reference frame pointers. If any reference frame slot is
   // unavailable, the pointer will be set to Null.
   for (idx = 0; idx < INTER_REFS_PER_FRAME; ++idx) {
     const int rf_idx = gf_group->ref_frame_gop_idx[frame_idx][idx];
+    tpl_ctxt->ref_frame[idx] = NULL;
     if (rf_idx != -1) {
       int duplicate = 0;
       for (int idx2 = 0; idx2 < idx; ++idx2) {
@@ -492,13 +553,13 @@ static void mc_flow_dispenser(AV1_COMP *cpi, YV12_BUFFER_CONFIG **gf_picture,
           break;
         }
       }
-      if (!duplicate) ref_frame[idx] = gf_picture[rf_idx];
+      if (!duplicate) tpl_ctxt->ref_frame[idx] = gf_picture[rf_idx];
     }
   }
 
   xd->mi = cm->mi_grid_visible;
   xd->mi[0] = cm->mi;
-  xd->block_ref_scale_factors[0] = &sf;
+  xd->block_ref_scale_factors[0] = &tpl_ctxt->sf;
 
   const int base_qindex = gf_group->q_val[frame_idx];
   // Get rd multiplier set up.
@@ -512,33 +573,24 @@ static void mc_flow_dispenser(AV1_COMP *cpi, YV12_BUFFER_CONFIG **gf_picture,
   cm->base_qindex = base_qindex;
   av1_frame_init_quantizer(cpi);
 
-  for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height) {
-    // Motion estimation row boundary
-    x->mv_limits.row_min = -((mi_row * MI_SIZE) + (17 - 2 * AOM_INTERP_EXTEND));
-    x->mv_limits.row_max = (cm->mi_rows - mi_height - mi_row) * MI_SIZE +
-                           (17 - 2 * AOM_INTERP_EXTEND);
-    xd->mb_to_top_edge = -((mi_row * MI_SIZE) * 8);
-    xd->mb_to_bottom_edge = ((cm->mi_rows - mi_height - mi_row) * MI_SIZE) * 8;
-    for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
-      TplDepStats tpl_stats;
-
-      // Motion estimation column boundary
-      x->mv_limits.col_min =
-          -((mi_col * MI_SIZE) + (17 - 2 * AOM_INTERP_EXTEND));
-      x->mv_limits.col_max = ((cm->mi_cols - mi_width - mi_col) * MI_SIZE) +
-                             (17 - 2 * AOM_INTERP_EXTEND);
-      xd->mb_to_left_edge = -((mi_col * MI_SIZE) * 8);
-      xd->mb_to_right_edge = ((cm->mi_cols - mi_width - mi_col) * MI_SIZE) * 8;
-      mode_estimation(cpi, x, xd, &sf, frame_idx, src_diff, coeff, 1, mi_row,
-                      mi_col, bsize, tx_size, ref_frame, predictor, &tpl_stats);
-
-      // Motion flow dependency dispenser.
-      tpl_model_store(tpl_frame->tpl_stats_ptr, mi_row, mi_col, bsize,
-                      tpl_frame->stride, &tpl_stats);
+  // The motion search of a block starts from a zero motion vector and does
+  // not read the other blocks of the frame, so the rows need no sync.
+  if (cpi->oxcf.row_mt == 1 && cpi->oxcf.max_threads > 1) {
+    av1_mc_flow_dispenser_mt(cpi);
+  } else {
+    for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height)
+      av1_mc_flow_dispenser_row(cpi, td, mi_row);
+  }
 
-      if (frame_idx)
+  // Propagate the dependencies to the reference frames in raster order once
+  // all blocks of the frame are stored, so that the accumulated flow is the
+  // same whatever the number of threads.
+  if (frame_idx) {
+    for (mi_row = 0; mi_row < cm->mi_rows; mi_row += mi_height) {
+      for (mi_col = 0; mi_col < cm->mi_cols; mi_col += mi_width) {
         tpl_model_update(cpi->tpl_stats, tpl_frame->tpl_stats_ptr, mi_row,
                          mi_col, bsize);
+      }
     }
   }
 }
@@ -21,6 +21,10 @@ void av1_tpl_setup_stats(AV1_COMP *cpi,
 
 void av1_tpl_setup_forward_stats(AV1_COMP *cpi);
 
+// Runs the TPL model on the row of blocks starting at mi_row of the frame
+// described by cpi->tpl_frame_ctxt.
+void av1_mc_flow_dispenser_row(AV1_COMP *cpi, ThreadData *td, int mi_row);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif
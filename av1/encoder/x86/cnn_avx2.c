@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX2
+
+#include "config/av1_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+#include "av1/encoder/cnn.h"
+
+// Convolution without maxpool and with PADDING_VALID, which is what the intra
+// partition model uses: a 5x5 filter with stride 4 followed by 2x2 filters
+// with stride 2.
+//
+// The weights are stored with the output channels innermost, so eight output
+// channels are computed at a time, one per lane. Each lane adds the products
+// in the same order as av1_cnn_convolve_c(), and the multiplies and adds are
+// not fused, so the output matches the C code exactly.
+static void cnn_convolve_no_maxpool_padding_valid_avx2(
+    const float **input, int in_width, int in_height, int in_stride,
+    const CNN_LAYER_CONFIG *layer_config, float **output, int out_stride) {
+  const int in_channels = layer_config->in_channels;
+  const int out_channels = layer_config->out_channels;
+  const int filter_width = layer_config->filter_width;
+  const int filter_height = layer_config->filter_height;
+  const int skip_width = layer_config->skip_width;
+  const int skip_height = layer_config->skip_height;
+  const int cstep = in_channels * out_channels;
+  const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  DECLARE_ALIGNED(32, float, sum_buf[8]);
+
+  for (int i = 0; i < out_channels; i += 8) {
+    const int num_channels = AOMMIN(8, out_channels - i);
+    const __m256i mask =
+        _mm256_cmpgt_epi32(_mm256_set1_epi32(num_channels), lanes);
+    const __m256 bias = _mm256_maskload_ps(layer_config->bias + i, mask);
+
+    for (int h = 0, u = 0; h < in_height - filter_height + 1;
+         h += skip_height, ++u) {
+      const int out_h = u * out_stride;
+      for (int w = 0, out_index = out_h; w < in_width - filter_width + 1;
+           w += skip_width, ++out_index) {
+        __m256 sum = bias;
+        for (int k = 0; k < in_channels; ++k) {
+          const float *weights = layer_config->weights + k * out_channels + i;
+          const float *in = input[k] + h * in_stride + w;
+          for (int ii = 0; ii < filter_height; ++ii, in += in_stride) {
+            for (int jj = 0; jj < filter_width; ++jj, weights += cstep) {
+              const __m256 wt = _mm256_maskload_ps(weights, mask);
+              const __m256 px = _mm256_broadcast_ss(in + jj);
+              sum = _mm256_add_ps(sum, _mm256_mul_ps(wt, px));
+            }
+          }
+        }
+        _mm256_store_ps(sum_buf, sum);
+        for (int c = 0; c < num_channels; ++c) {
+          output[i + c][out_index] = sum_buf[c];
+        }
+      }
+    }
+  }
+}
+
+void av1_cnn_convolve_avx2(const float **input, int in_width, int in_height,
+                           int in_stride, const CNN_LAYER_CONFIG *layer_config,
+                           float **output, int out_stride, int start_idx,
+                           int step) {
+  assert(!layer_config->deconvolve);
+  const int use_maxpool =
+      layer_config->maxpool &&
+      (layer_config->skip_height > 1 || layer_config->skip_width > 1);
+  const int is_1x1 =
+      layer_config->filter_height == 1 && layer_config->filter_width == 1;
+
+  // The other cases, and the split of the output channels between threads,
+  // are left to the C code.
+  if (use_maxpool || is_1x1 || layer_config->pad != PADDING_VALID ||
+      start_idx != 0 || step > 1) {
+    av1_cnn_convolve_c(input, in_width, in_height, in_stride, layer_config,
+                       output, out_stride, start_idx, step);
+    return;
+  }
+
+  cnn_convolve_no_maxpool_padding_valid_avx2(
+      input, in_width, in_height, in_stride, layer_config, output, out_stride);
+}
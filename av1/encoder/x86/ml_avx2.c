@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <assert.h>
+#include <immintrin.h>  // AVX2
+
+#include "config/av1_rtcd.h"
+
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_ports/mem.h"
+#include "av1/encoder/ml.h"
+
+#define NN_BATCH_LANES 8
+
+// Evaluates the network for up to eight samples at once, one sample per lane.
+// The nodes of every layer are kept transposed, so each weight is broadcast
+// and multiplied with the same node of all the samples. Each lane adds the
+// products in the same order as av1_nn_predict_c(), and the multiplies and
+// adds are not fused, so the output matches the C code exactly.
+static void nn_predict_8_samples(const float *input_nodes, int num_samples,
+                                 const NN_CONFIG *const nn_config,
+                                 float *const output) {
+  __m256 buf[3][NN_MAX_NODES_PER_LAYER];
+  DECLARE_ALIGNED(32, float, lanes[NN_BATCH_LANES]);
+  const __m256 zero = _mm256_setzero_ps();
+  int num_inputs = nn_config->num_inputs;
+  int buf_index = 0;
+
+  assert(num_samples > 0 && num_samples <= NN_BATCH_LANES);
+  assert(num_inputs <= NN_MAX_NODES_PER_LAYER);
+
+  // Transpose the input features. Unused lanes are set to zero.
+  for (int i = 0; i < num_inputs; ++i) {
+    for (int s = 0; s < NN_BATCH_LANES; ++s) {
+      lanes[s] = s < num_samples ? input_nodes[s * num_inputs + i] : 0.0f;
+    }
+    buf[2][i] = _mm256_load_ps(lanes);
+  }
+  const __m256 *in = buf[2];
+
+  // Hidden layers, except the final iteration is the output layer.
+  for (int layer = 0; layer <= nn_config->num_hidden_layers; ++layer) {
+    const float *layer_weights = nn_config->weights[layer];
+    const float *layer_bias = nn_config->bias[layer];
+    const int output_layer = layer == nn_config->num_hidden_layers;
+    const int num_outputs = output_layer ? nn_config->num_outputs
+                                         : nn_config->num_hidden_nodes[layer];
+    __m256 *const out = buf[buf_index];
+
+    for (int node = 0; node < num_outputs; ++node) {
+      const float *weights = &layer_weights[node * num_inputs];
+      __m256 val = _mm256_broadcast_ss(&layer_bias[node]);
+      for (int i = 0; i < num_inputs; ++i) {
+        const __m256 wt = _mm256_broadcast_ss(&weights[i]);
+        val = _mm256_add_ps(val, _mm256_mul_ps(wt, in[i]));
+      }
+      // ReLU as activation function.
+      out[node] = output_layer ? val : _mm256_max_ps(val, zero);
+    }
+    in = out;
+    num_inputs = num_outputs;
+    buf_index = 1 - buf_index;
+  }
+
+  for (int node = 0; node < num_inputs; ++node) {
+    _mm256_store_ps(lanes, in[node]);
+    for (int s = 0; s < num_samples; ++s) {
+      output[s * num_inputs + node] = lanes[s];
+    }
+  }
+}
+
+void av1_nn_predict_batch_avx2(const float *input_nodes, int num_samples,
+                               const NN_CONFIG *const nn_config,
+                               int reduce_prec, float *const output) {
+  assert(nn_config->num_hidden_layers <= NN_MAX_HIDDEN_LAYERS);
+  for (int s = 0; s < num_samples; s += NN_BATCH_LANES) {
+    const int n = AOMMIN(NN_BATCH_LANES, num_samples - s);
+    nn_predict_8_samples(input_nodes + s * nn_config->num_inputs, n, nn_config,
+                         output + s * nn_config->num_outputs);
+  }
+  if (reduce_prec) {
+    av1_nn_output_prec_reduce(output, num_samples * nn_config->num_outputs);
+  }
+}
@@ -37,6 +37,7 @@ GetOptions(
   'arch=s',
   'sym=s',
   'config=s',
+  'bench',
 );
 
 foreach my $opt (qw/arch config/) {
@@ -384,6 +385,26 @@ EOF
   common_bottom;
 }
 
+#
+# Lists every function and the variants declared for it in the header, for
+# the micro-benchmark in test/test_rtcd_speed.cc.
+#
+sub bench() {
+  print "// This file is generated. Do not edit.\n";
+  foreach my $fn (sort keys %ALL_FUNCS) {
+    my @val = @{$ALL_FUNCS{$fn}};
+    my $args = pop @val;
+    my $rtyp = "@val";
+    $args =~ s/\s+/ /g;
+    print "RTCD_BENCH_FUNCTION($fn, \"$rtyp\", \"$args\")\n";
+    foreach my $opt ("c", @ALL_ARCHS) {
+      my $ofn = eval "\$${fn}_${opt}";
+      next if !$ofn;
+      print "RTCD_BENCH_VARIANT($fn, $opt)\n";
+    }
+  }
+}
+
 sub unoptimized() {
   determine_indirection "c";
   common_top;
@@ -410,14 +431,15 @@ EOF
 
 &require("c");
 &require(keys %required);
+my $generate;
 if ($opts{arch} eq 'x86') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 sse4_2 avx avx2/);
-  x86;
+  $generate = \&x86;
 } elsif ($opts{arch} eq 'x86_64') {
   @ALL_ARCHS = filter(qw/mmx sse sse2 sse3 ssse3 sse4_1 sse4_2 avx avx2/);
   @REQUIRES = filter(qw/mmx sse sse2/);
   &require(@REQUIRES);
-  x86;
+  $generate = \&x86;
 } elsif ($opts{arch} eq 'mips32' || $opts{arch} eq 'mips64') {
   @ALL_ARCHS = filter("$opts{arch}");
   if (aom_config("HAVE_DSPR2") eq "yes") {
@@ -425,20 +447,21 @@ if ($opts{arch} eq 'x86') {
   } elsif (aom_config("HAVE_MSA") eq "yes") {
     @ALL_ARCHS = filter("$opts{arch}", qw/msa/);
   }
-  mips;
+  $generate = \&mips;
 } elsif ($opts{arch} =~ /armv[78]\w?/) {
   @ALL_ARCHS = filter(qw/neon/);
-  arm;
+  $generate = \&arm;
 } elsif ($opts{arch} eq 'arm64' ) {
   @ALL_ARCHS = filter(qw/neon/);
   &require("neon");
-  arm;
+  $generate = \&arm;
 } elsif ($opts{arch} eq 'ppc') {
   @ALL_ARCHS = filter(qw/vsx/);
-  ppc;
+  $generate = \&ppc;
 } else {
-  unoptimized;
+  $generate = \&unoptimized;
 }
+$opts{bench} ? bench() : &$generate();
 
 __END__
 
@@ -465,3 +488,5 @@ Options:
   --require-EXT     Require support for EXT extensions
   --sym=SYMBOL      Unique symbol to use for RTCD initialization function
   --config=FILE     Path to file containing C preprocessor directives to parse
+  --bench           Generate the function table of the rtcd micro-benchmark
+                    instead of the C header
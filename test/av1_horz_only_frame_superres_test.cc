@@ -300,6 +300,11 @@ TEST_P(LowBDConvolveHorizRSTest, DISABLED_Speed) { SpeedTest(); }
 INSTANTIATE_TEST_CASE_P(SSE4_1, LowBDConvolveHorizRSTest,
                         ::testing::Values(av1_convolve_horiz_rs_sse4_1));
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, LowBDConvolveHorizRSTest,
+                        ::testing::Values(av1_convolve_horiz_rs_avx2));
+#endif
+
 typedef void (*HighBDConvolveHorizRsFunc)(const uint16_t *src, int src_stride,
                                           uint16_t *dst, int dst_stride, int w,
                                           int h, const int16_t *x_filters,
@@ -359,4 +364,11 @@ INSTANTIATE_TEST_CASE_P(
     ::testing::Combine(::testing::Values(av1_highbd_convolve_horiz_rs_sse4_1),
                        ::testing::ValuesIn(kBDs)));
 
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(
+    AVX2, HighBDConvolveHorizRSTest,
+    ::testing::Combine(::testing::Values(av1_highbd_convolve_horiz_rs_avx2),
+                       ::testing::ValuesIn(kBDs)));
+#endif
+
 }  // namespace
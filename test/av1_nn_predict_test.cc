@@ -9,6 +9,8 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <vector>
+
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "aom/aom_integer.h"
@@ -212,4 +214,134 @@ INSTANTIATE_TEST_CASE_P(SSE3, NnPredictTest,
                         ::testing::Values(av1_nn_predict_sse3));
 #endif
 
+typedef void (*NnPredictBatch_Func)(const float *input_nodes, int num_samples,
+                                    const NN_CONFIG *const nn_config,
+                                    int reduce_prec, float *const output);
+
+const int kMaxBatchSamples = 20;
+
+class NnPredictBatchTest
+    : public ::testing::TestWithParam<NnPredictBatch_Func> {
+ public:
+  virtual void SetUp() {
+    weights_.resize((NN_MAX_HIDDEN_LAYERS + 1) * NN_MAX_NODES_PER_LAYER *
+                    NN_MAX_NODES_PER_LAYER);
+    bias_.resize((NN_MAX_HIDDEN_LAYERS + 1) * NN_MAX_NODES_PER_LAYER);
+    inputs_.resize(kMaxBatchSamples * NN_MAX_NODES_PER_LAYER);
+    outputs_ref_.resize(kMaxBatchSamples * NN_MAX_NODES_PER_LAYER);
+    outputs_test_.resize(kMaxBatchSamples * NN_MAX_NODES_PER_LAYER);
+    target_func_ = GetParam();
+  }
+
+ protected:
+  float RandFloat() {
+    return ((float)rng_.Rand31() - (1 << 30)) / (1u << 31);
+  }
+  void SetUpConfig(const NN_CONFIG *const shape, NN_CONFIG *nn_config) {
+    memcpy(nn_config, shape, sizeof(*nn_config));
+    for (int i = 0; i <= NN_MAX_HIDDEN_LAYERS; i++) {
+      nn_config->weights[i] =
+          &weights_[i * NN_MAX_NODES_PER_LAYER * NN_MAX_NODES_PER_LAYER];
+      nn_config->bias[i] = &bias_[i * NN_MAX_NODES_PER_LAYER];
+    }
+  }
+  void RunTest(const NN_CONFIG *const shape);
+  void RunSpeedTest(const NN_CONFIG *const shape, int num_samples,
+                    int run_times);
+
+  NnPredictBatch_Func target_func_;
+  libaom_test::ACMRandom rng_;
+  std::vector<float> weights_;
+  std::vector<float> bias_;
+  std::vector<float> inputs_;
+  std::vector<float> outputs_ref_;
+  std::vector<float> outputs_test_;
+};
+
+void NnPredictBatchTest::RunTest(const NN_CONFIG *const shape) {
+  NN_CONFIG nn_config;
+  SetUpConfig(shape, &nn_config);
+
+  for (int iter = 0; iter < 200 && !HasFatalFailure(); ++iter) {
+    for (size_t i = 0; i < weights_.size(); i++) weights_[i] = RandFloat();
+    for (size_t i = 0; i < bias_.size(); i++) bias_[i] = RandFloat();
+    for (size_t i = 0; i < inputs_.size(); i++) inputs_[i] = RandFloat();
+    const int num_samples = 1 + iter % kMaxBatchSamples;
+    const int reduce_prec = iter & 1;
+
+    av1_nn_predict_batch_c(&inputs_[0], num_samples, &nn_config, reduce_prec,
+                           &outputs_ref_[0]);
+    target_func_(&inputs_[0], num_samples, &nn_config, reduce_prec,
+                 &outputs_test_[0]);
+    libaom_test::ClearSystemState();
+
+    // The batched versions add the products in the same order as the C code,
+    // so the outputs must match exactly.
+    for (int i = 0; i < num_samples * shape->num_outputs; i++) {
+      ASSERT_EQ(outputs_ref_[i], outputs_test_[i])
+          << "num_inputs " << shape->num_inputs << " num_outputs "
+          << shape->num_outputs << " num_samples " << num_samples
+          << " index " << i;
+    }
+  }
+}
+
+void NnPredictBatchTest::RunSpeedTest(const NN_CONFIG *const shape,
+                                      int num_samples, int run_times) {
+  NN_CONFIG nn_config;
+  SetUpConfig(shape, &nn_config);
+
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  for (int i = 0; i < run_times; ++i) {
+    for (int s = 0; s < num_samples; ++s) {
+      av1_nn_predict(&inputs_[s * shape->num_inputs], &nn_config, 0,
+                     &outputs_ref_[s * shape->num_outputs]);
+    }
+  }
+  aom_usec_timer_mark(&timer);
+  const double time1 = static_cast<double>(aom_usec_timer_elapsed(&timer));
+  aom_usec_timer_start(&timer);
+  for (int i = 0; i < run_times; ++i) {
+    target_func_(&inputs_[0], num_samples, &nn_config, 0, &outputs_test_[0]);
+  }
+  aom_usec_timer_mark(&timer);
+  libaom_test::ClearSystemState();
+  const double time2 = static_cast<double>(aom_usec_timer_elapsed(&timer));
+
+  printf("%d", shape->num_inputs);
+  for (int layer = 0; layer < shape->num_hidden_layers; layer++)
+    printf("x%d", shape->num_hidden_nodes[layer]);
+  printf("x%d, %d samples: ", shape->num_outputs, num_samples);
+  printf("%7.2f/%7.2fns (%3.2f)\n", time1, time2, time1 / time2);
+}
+
+// The shapes above, plus networks with two hidden layers.
+static const NN_CONFIG batch_shapes[] = {
+  { 10, 16, 1, { 64 }, { 0 }, { 0 } },    { 12, 1, 1, { 24 }, { 0 }, { 0 } },
+  { 18, 4, 1, { 32 }, { 0 }, { 0 } },     { 8, 1, 1, { 64 }, { 0 }, { 0 } },
+  { 9, 3, 1, { 32 }, { 0 }, { 0 } },      { 4, 4, 1, { 8 }, { 0 }, { 0 } },
+  { 17, 1, 2, { 24, 16 }, { 0 }, { 0 } }, { 7, 5, 0, { 0 }, { 0 }, { 0 } },
+};
+
+TEST_P(NnPredictBatchTest, RandomValues) {
+  for (size_t i = 0; i < sizeof(batch_shapes) / sizeof(*batch_shapes); i++)
+    RunTest(&batch_shapes[i]);
+}
+
+TEST_P(NnPredictBatchTest, DISABLED_Speed) {
+  for (size_t i = 0; i < sizeof(batch_shapes) / sizeof(*batch_shapes); i++) {
+    RunSpeedTest(&batch_shapes[i], 1, 1000000);
+    RunSpeedTest(&batch_shapes[i], 16, 100000);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, NnPredictBatchTest,
+                        ::testing::Values(av1_nn_predict_batch_c));
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, NnPredictBatchTest,
+                        ::testing::Values(av1_nn_predict_batch_avx2));
+#endif
+
 }  // namespace
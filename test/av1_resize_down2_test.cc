@@ -0,0 +1,182 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "config/av1_rtcd.h"
+
+#include "aom_ports/aom_timer.h"
+#include "av1/common/resize.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/util.h"
+
+namespace {
+const int kTestIters = 2000;
+const int kMaxLength = 400;
+const int kPerfLength = 1920;
+const int kPerfIters = 100000;
+
+using libaom_test::ACMRandom;
+using ::testing::make_tuple;
+using ::testing::tuple;
+
+// The length of the input selects between the even and odd filters, as in
+// resize_multistep().
+template <typename Pixel>
+class Down2TestBase {
+ public:
+  Down2TestBase() : bd_(8) {}
+
+  void CorrectnessTest() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const Pixel mask = (1 << bd_) - 1;
+    std::vector<Pixel> output_ref((kMaxLength + 1) / 2);
+    std::vector<Pixel> output_tst((kMaxLength + 1) / 2);
+    for (int i = 0; i < kTestIters; ++i) {
+      const int length = 1 + rnd.PseudoUniform(kMaxLength);
+      // Allocate the input with its exact length, so that any read past
+      // either end shows up in the memory checkers.
+      std::vector<Pixel> input(length);
+      const bool extreme = (i & 3) == 0;
+      for (int j = 0; j < length; ++j)
+        input[j] = extreme ? (rnd.Rand8() & 1) * mask : rnd.Rand16() & mask;
+
+      RunOne(true, &input[0], length, &output_ref[0]);
+      RunOne(false, &input[0], length, &output_tst[0]);
+      for (int j = 0; j < (length + 1) / 2; ++j) {
+        ASSERT_EQ(output_ref[j], output_tst[j])
+            << "Error at " << j << ", length: " << length << ", bd: " << bd_;
+      }
+    }
+  }
+
+  void SpeedTest() {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    const Pixel mask = (1 << bd_) - 1;
+    std::vector<Pixel> input(kPerfLength);
+    std::vector<Pixel> output(kPerfLength / 2);
+    for (int j = 0; j < kPerfLength; ++j) input[j] = rnd.Rand16() & mask;
+
+    for (int length = kPerfLength - 1; length <= kPerfLength; ++length) {
+      aom_usec_timer ref_timer;
+      aom_usec_timer_start(&ref_timer);
+      for (int i = 0; i < kPerfIters; ++i)
+        RunOne(true, &input[0], length, &output[0]);
+      aom_usec_timer_mark(&ref_timer);
+      const int64_t ref_time = aom_usec_timer_elapsed(&ref_timer);
+
+      aom_usec_timer tst_timer;
+      aom_usec_timer_start(&tst_timer);
+      for (int i = 0; i < kPerfIters; ++i)
+        RunOne(false, &input[0], length, &output[0]);
+      aom_usec_timer_mark(&tst_timer);
+      const int64_t tst_time = aom_usec_timer_elapsed(&tst_timer);
+
+      std::cout << "[          ] length " << length
+                << ": C time = " << ref_time / 1000
+                << " ms, SIMD time = " << tst_time / 1000 << " ms\n";
+    }
+  }
+
+ protected:
+  virtual ~Down2TestBase() {}
+  virtual void RunOne(bool ref, const Pixel *input, int length,
+                      Pixel *output) = 0;
+
+  int bd_;
+};
+
+typedef void (*LowBDDown2Func)(const uint8_t *const input, int length,
+                               uint8_t *output);
+
+// Test parameter list:
+//  <even_fun_, odd_fun_>
+typedef tuple<LowBDDown2Func, LowBDDown2Func> LowBDParams;
+
+class LowBDResizeDown2Test : public Down2TestBase<uint8_t>,
+                             public ::testing::TestWithParam<LowBDParams> {
+ public:
+  virtual ~LowBDResizeDown2Test() {}
+  virtual void SetUp() {
+    even_fun_ = GET_PARAM(0);
+    odd_fun_ = GET_PARAM(1);
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  virtual void RunOne(bool ref, const uint8_t *input, int length,
+                      uint8_t *output) {
+    if (length & 1)
+      (ref ? av1_down2_symodd_c : odd_fun_)(input, length, output);
+    else
+      (ref ? av1_down2_symeven_c : even_fun_)(input, length, output);
+  }
+
+ private:
+  LowBDDown2Func even_fun_;
+  LowBDDown2Func odd_fun_;
+};
+
+TEST_P(LowBDResizeDown2Test, Correctness) { CorrectnessTest(); }
+TEST_P(LowBDResizeDown2Test, DISABLED_Speed) { SpeedTest(); }
+
+INSTANTIATE_TEST_CASE_P(SSE4_1, LowBDResizeDown2Test,
+                        ::testing::Values(make_tuple(av1_down2_symeven_sse4_1,
+                                                     av1_down2_symodd_sse4_1)));
+
+typedef void (*HighBDDown2Func)(const uint16_t *const input, int length,
+                                uint16_t *output, int bd);
+
+// Test parameter list:
+//  <even_fun_, odd_fun_, bd>
+typedef tuple<HighBDDown2Func, HighBDDown2Func, int> HighBDParams;
+
+class HighBDResizeDown2Test : public Down2TestBase<uint16_t>,
+                              public ::testing::TestWithParam<HighBDParams> {
+ public:
+  virtual ~HighBDResizeDown2Test() {}
+  virtual void SetUp() {
+    even_fun_ = GET_PARAM(0);
+    odd_fun_ = GET_PARAM(1);
+    bd_ = GET_PARAM(2);
+  }
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+
+ protected:
+  virtual void RunOne(bool ref, const uint16_t *input, int length,
+                      uint16_t *output) {
+    if (length & 1)
+      (ref ? av1_highbd_down2_symodd_c : odd_fun_)(input, length, output, bd_);
+    else
+      (ref ? av1_highbd_down2_symeven_c : even_fun_)(input, length, output,
+                                                     bd_);
+  }
+
+ private:
+  HighBDDown2Func even_fun_;
+  HighBDDown2Func odd_fun_;
+};
+
+const int kBDs[] = { 8, 10, 12 };
+
+TEST_P(HighBDResizeDown2Test, Correctness) { CorrectnessTest(); }
+TEST_P(HighBDResizeDown2Test, DISABLED_Speed) { SpeedTest(); }
+
+INSTANTIATE_TEST_CASE_P(
+    SSE4_1, HighBDResizeDown2Test,
+    ::testing::Combine(::testing::Values(av1_highbd_down2_symeven_sse4_1),
+                       ::testing::Values(av1_highbd_down2_symodd_sse4_1),
+                       ::testing::ValuesIn(kBDs)));
+
+}  // namespace
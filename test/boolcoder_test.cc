@@ -171,3 +171,34 @@ TEST(AV1, TestHasOverflowed) {
     ASSERT_TRUE(aom_reader_has_overflowed(&br));
   }
 }
+
+TEST(AV1, TestFinishEncode) {
+  const int kBufferSize = 10000;
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  uint8_t stop_buffer[kBufferSize];
+  uint8_t finish_buffer[kBufferSize];
+  const int kSymbols = 4096;
+  int probas[kSymbols];
+  int bits[kSymbols];
+  for (int i = 0; i < kSymbols; i++) {
+    probas[i] = rnd.Rand8();
+    bits[i] = rnd(256) >= probas[i];
+  }
+
+  aom_writer stop_bw;
+  aom_start_encode(&stop_bw, stop_buffer);
+  for (int i = 0; i < kSymbols; i++) aom_write(&stop_bw, bits[i], probas[i]);
+  const int stop_bits = aom_stop_encode(&stop_bw);
+
+  // Coding without a destination leaves the coded data in the writer, which
+  // matches what aom_stop_encode() copies out.
+  aom_writer finish_bw;
+  aom_start_encode(&finish_bw, NULL);
+  for (int i = 0; i < kSymbols; i++) aom_write(&finish_bw, bits[i], probas[i]);
+  const int finish_bits = aom_finish_encode(&finish_bw);
+  ASSERT_EQ(stop_bits, finish_bits);
+  ASSERT_EQ(stop_bw.pos, finish_bw.pos);
+  memcpy(finish_buffer, finish_bw.buffer, finish_bw.pos);
+  aom_release_encode(&finish_bw);
+  ASSERT_EQ(0, memcmp(stop_buffer, finish_buffer, stop_bw.pos));
+}
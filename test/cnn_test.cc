@@ -12,12 +12,15 @@
 #include <assert.h>
 #include <math.h>
 #include <stdio.h>
+#include <vector>
 
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "config/av1_rtcd.h"
 
+#include "aom_ports/aom_timer.h"
 #include "av1/encoder/cnn.h"
+#include "test/acm_random.h"
 
 #define SQR(x) ((x) * (x))
 
@@ -2494,3 +2497,142 @@ TEST_F(CNNTest, TestMultiOutput) {
 
   aom_free(output_);
 }
+
+namespace {
+
+typedef void (*CNNConvolveFunc)(const float **input, int in_width,
+                                int in_height, int in_stride,
+                                const CNN_LAYER_CONFIG *layer_config,
+                                float **output, int out_stride, int start_idx,
+                                int step);
+
+// Compares an optimized av1_cnn_convolve() against the C version on layers
+// without maxpool and with PADDING_VALID, the kind used by the intra
+// partition model.
+class CNNConvolveTest : public ::testing::TestWithParam<CNNConvolveFunc> {
+ protected:
+  void SetUp() { rnd_.Reset(libaom_test::ACMRandom::DeterministicSeed()); }
+
+  float RandFloat() {
+    return static_cast<float>(rnd_.Rand16()) / 32768.0f - 1.0f;
+  }
+
+  // Runs the C and optimized functions num_iters times each and stores the
+  // microseconds they took in *time_c and *time_opt.
+  void RunTest(int in_width, int in_height, int in_channels, int out_channels,
+               int filter_size, int skip, int num_iters, double *time_c,
+               double *time_opt) {
+    const int in_stride = in_width + rnd_(4);
+    const int out_width = (in_width - filter_size) / skip + 1;
+    const int out_height = (in_height - filter_size) / skip + 1;
+    const int out_size = out_width * out_height;
+    const int num_weights =
+        filter_size * filter_size * in_channels * out_channels;
+
+    std::vector<float> weights(num_weights);
+    std::vector<float> bias(out_channels);
+    std::vector<float> input_buf(in_channels * in_stride * in_height);
+    std::vector<float> output_ref_buf(out_channels * out_size);
+    std::vector<float> output_buf(out_channels * out_size);
+    for (float &w : weights) w = RandFloat();
+    for (float &b : bias) b = RandFloat();
+    for (float &v : input_buf) v = RandFloat();
+
+    CNN_LAYER_CONFIG layer_config = {
+      in_channels,       // in_channels
+      filter_size,       // filter_width
+      filter_size,       // filter_height
+      out_channels,      // out_channels
+      skip,              // skip_width
+      skip,              // skip_height
+      0,                 // maxpool
+      weights.data(),    // weights
+      bias.data(),       // bias
+      PADDING_VALID,     // pad
+      NONE,              // activation
+      0,                 // deconvolve
+      0,                 // branch
+      BRANCH_NO_COPY,    // branch_copy_type
+      BRANCH_NOC,        // branch_combine_type
+      NO_BRANCH_CONFIG,  // branch_config
+      NO_BN_PARAMS,      // bn_params
+      -1,                // output_num
+    };
+
+    const float *input[CNN_MAX_CHANNELS] = { nullptr };
+    float *output_ref[CNN_MAX_CHANNELS] = { nullptr };
+    float *output[CNN_MAX_CHANNELS] = { nullptr };
+    for (int k = 0; k < in_channels; ++k) {
+      input[k] = &input_buf[k * in_stride * in_height];
+    }
+    for (int c = 0; c < out_channels; ++c) {
+      output_ref[c] = &output_ref_buf[c * out_size];
+      output[c] = &output_buf[c * out_size];
+    }
+
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < num_iters; ++i) {
+      av1_cnn_convolve_c(input, in_width, in_height, in_stride, &layer_config,
+                         output_ref, out_width, 0, 1);
+    }
+    aom_usec_timer_mark(&timer);
+    *time_c = static_cast<double>(aom_usec_timer_elapsed(&timer));
+    aom_usec_timer_start(&timer);
+    for (int i = 0; i < num_iters; ++i) {
+      GetParam()(input, in_width, in_height, in_stride, &layer_config, output,
+                 out_width, 0, 1);
+    }
+    aom_usec_timer_mark(&timer);
+    *time_opt = static_cast<double>(aom_usec_timer_elapsed(&timer));
+
+    for (int c = 0; c < out_channels; ++c) {
+      for (int i = 0; i < out_size; ++i) {
+        ASSERT_EQ(output_ref[c][i], output[c][i])
+            << "channel " << c << " pixel " << i << " (" << in_width << "x"
+            << in_height << ", " << in_channels << "->" << out_channels
+            << " channels, filter " << filter_size << ", skip " << skip << ")";
+      }
+    }
+  }
+
+  libaom_test::ACMRandom rnd_;
+};
+
+TEST_P(CNNConvolveTest, CheckOutput) {
+  double time_c, time_opt;
+  for (int i = 0; i < 200; ++i) {
+    const int filter_size = 2 + rnd_(4);
+    const int skip = 1 + rnd_(4);
+    RunTest(filter_size + rnd_(40), filter_size + rnd_(40), 1 + rnd_(24),
+            1 + rnd_(40), filter_size, skip, 1, &time_c, &time_opt);
+  }
+}
+
+// The layers of av1_intra_mode_cnn_partition_cnn_config.
+TEST_P(CNNConvolveTest, DISABLED_Speed) {
+  static const struct {
+    int in_size, in_channels, out_channels, filter_size, skip;
+  } kLayers[] = {
+    { 65, 1, 20, 5, 4 }, { 16, 20, 20, 2, 2 }, { 8, 20, 20, 2, 2 },
+    { 4, 20, 4, 2, 2 },  { 2, 4, 20, 2, 2 },
+  };
+  for (const auto &layer : kLayers) {
+    double time_c, time_opt;
+    RunTest(layer.in_size, layer.in_size, layer.in_channels,
+            layer.out_channels, layer.filter_size, layer.skip, 10000, &time_c,
+            &time_opt);
+    printf("%2dx%-2d %2d->%-2d channels, %dx%d filter, skip %d: %8.0f/%8.0fus "
+           "(%3.2fx)\n",
+           layer.in_size, layer.in_size, layer.in_channels, layer.out_channels,
+           layer.filter_size, layer.filter_size, layer.skip, time_c, time_opt,
+           time_c / time_opt);
+  }
+}
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, CNNConvolveTest,
+                        ::testing::Values(av1_cnn_convolve_avx2));
+#endif
+
+}  // namespace
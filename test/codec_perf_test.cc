@@ -0,0 +1,576 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Encoder and decoder speed benchmark, built as test_codec_perf.
+//
+// The clips are either generated in memory or read from the bundled test
+// vectors in LIBAOM_TEST_DATA_PATH (clips whose file is missing are skipped),
+// so the benchmark needs no external data. The encoder is timed for each
+// preset, speed and thread count, the decoder for each thread count and
+// threading mode. The results of all the tests that ran are written as a
+// single JSON document to the file given with --json_output=<file>, apart
+// from the test output. Without it, a one line summary of each result is
+// printed to stderr instead.
+//
+// The peak RSS is the high-water mark of the whole process at the end of each
+// test. To attribute it to one configuration, run one test per process with
+// --gtest_filter.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+#include <string>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "config/aom_config.h"
+#include "config/aom_version.h"
+
+#include "aom/aom_decoder.h"
+#include "aom/aom_encoder.h"
+#include "aom/aomcx.h"
+#include "aom/aomdx.h"
+#include "aom_ports/aom_timer.h"
+#include "test/acm_random.h"
+
+namespace {
+
+using libaom_test::ACMRandom;
+
+const double kUsecsInSec = 1000000.0;
+const int kFramesPerSecond = 30;
+
+struct PerfClip {
+  const char *name;
+  // I420 file in LIBAOM_TEST_DATA_PATH, or NULL for a generated clip.
+  const char *file;
+  int width;
+  int height;
+  // Number of frames, or the maximum read from the file.
+  int frames;
+  // Target bitrate in kbps.
+  unsigned int bitrate;
+};
+
+const PerfClip kPerfClips[] = {
+  { "synthetic_640x360", NULL, 640, 360, 20, 800 },
+  { "hantro_collage_w352h288", "hantro_collage_w352h288.yuv", 352, 288, 30,
+    400 },
+};
+
+const int kNumPerfClips = sizeof(kPerfClips) / sizeof(kPerfClips[0]);
+
+enum EncodePreset { kGoodQuality, kRealTime };
+
+const char *const kEncodePresetNames[] = { "good", "realtime" };
+
+// The decoder threading modes: tiles only, tiles and superblock rows, or
+// consecutive frames in parallel (AV1D_SET_FRAME_PARALLEL_DEPTH).
+enum DecodeMode { kTileMT, kRowMT, kFrameMT };
+
+const char *const kDecodeModeNames[] = { "tile", "row", "frame" };
+
+// The decode tests share one bitstream per clip, coded with 4 tiles so that
+// tile threading has work to split.
+const int kDecodeLog2TileCols = 1;
+const int kDecodeLog2TileRows = 1;
+const int kDecodeSpeed = 6;
+// The bitstream starts with a key frame, so it is decoded several times in a
+// row to give the timing a useful length.
+const int kDecodeLoops = 5;
+
+size_t FrameSize(const PerfClip &clip) {
+  return clip.width * clip.height + 2 * ((clip.width + 1) / 2) *
+                                        ((clip.height + 1) / 2);
+}
+
+uint8_t ClipPixel(int value) {
+  return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// Generates an I420 frame with a scrolling textured background, a block
+// moving across it and some noise, so that motion search, prediction and
+// entropy coding all have realistic work to do.
+void GenerateFrame(const PerfClip &clip, int frame, ACMRandom *rnd,
+                   uint8_t *buf) {
+  const int uv_w = (clip.width + 1) / 2;
+  const int uv_h = (clip.height + 1) / 2;
+  const int block_size = clip.height / 4;
+  const int block_x = (frame * 5) % (clip.width - block_size);
+  const int block_y = clip.height / 3;
+  uint8_t *y = buf;
+  for (int r = 0; r < clip.height; ++r) {
+    for (int c = 0; c < clip.width; ++c) {
+      int value;
+      if (c >= block_x && c < block_x + block_size && r >= block_y &&
+          r < block_y + block_size) {
+        value = 160 + ((((c - block_x) * 7) ^ ((r - block_y) * 13)) & 63);
+      } else {
+        const int x = c + 2 * frame;
+        const int yy = r + frame;
+        value = 48 + ((x + yy) & 127) + (((x >> 4) ^ (yy >> 4)) & 1) * 32;
+      }
+      y[c] = ClipPixel(value + rnd->Rand8() % 5 - 2);
+    }
+    y += clip.width;
+  }
+  uint8_t *u = buf + clip.width * clip.height;
+  uint8_t *v = u + uv_w * uv_h;
+  for (int r = 0; r < uv_h; ++r) {
+    for (int c = 0; c < uv_w; ++c) {
+      u[c] = 112 + (((c + frame) >> 1) & 31);
+      v[c] = 112 + (((r + frame) >> 1) & 31);
+    }
+    u += uv_w;
+    v += uv_w;
+  }
+}
+
+// Loads the frames of |clip| into |raw|, to keep file reads out of the timing.
+// Returns false if the clip file is not available.
+bool LoadClip(const PerfClip &clip, std::vector<uint8_t> *raw) {
+  const size_t frame_size = FrameSize(clip);
+  raw->resize(frame_size * clip.frames);
+  if (clip.file == NULL) {
+    ACMRandom rnd(ACMRandom::DeterministicSeed());
+    for (int i = 0; i < clip.frames; ++i)
+      GenerateFrame(clip, i, &rnd, &(*raw)[i * frame_size]);
+    return true;
+  }
+
+  const char *const env = getenv("LIBAOM_TEST_DATA_PATH");
+  const std::string path = std::string(env ? env : ".") + "/" + clip.file;
+  FILE *const file = fopen(path.c_str(), "rb");
+  if (file == NULL) return false;
+  const size_t read = fread(&(*raw)[0], frame_size, clip.frames, file);
+  fclose(file);
+  raw->resize(frame_size * read);
+  return read > 0;
+}
+
+// Returns the peak resident set size of the process in KiB, or -1 if it is
+// not available.
+long PeakRssKb() {
+#if defined(_WIN32)
+  return -1;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+  return static_cast<long>(usage.ru_maxrss / 1024);
+#else
+  return static_cast<long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+struct EncodeConfig {
+  EncodePreset preset;
+  int speed;
+  int threads;
+  int log2_tile_cols;
+  int log2_tile_rows;
+};
+
+struct EncodeOutput {
+  int num_frames;
+  std::vector<std::string> frames;
+  size_t total_bytes;
+  double elapsed_secs;
+};
+
+// Encodes the frames in |raw| and returns the compressed frames along with
+// the time spent in the encoder.
+void EncodeClip(const PerfClip &clip, const std::vector<uint8_t> &raw,
+                const EncodeConfig &config, EncodeOutput *output) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  const unsigned int usage =
+      config.preset == kRealTime ? AOM_USAGE_REALTIME : AOM_USAGE_GOOD_QUALITY;
+  aom_codec_enc_cfg_t cfg;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, usage));
+  cfg.g_usage = usage;
+  cfg.g_w = clip.width;
+  cfg.g_h = clip.height;
+  cfg.g_timebase.num = 1;
+  cfg.g_timebase.den = kFramesPerSecond;
+  cfg.g_threads = config.threads;
+  cfg.rc_target_bitrate = clip.bitrate;
+  if (config.preset == kRealTime) {
+    cfg.g_lag_in_frames = 0;
+    cfg.rc_end_usage = AOM_CBR;
+  } else {
+    cfg.rc_end_usage = AOM_VBR;
+  }
+
+  aom_codec_ctx_t enc;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED,
+                                            config.speed));
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AV1E_SET_TILE_COLUMNS,
+                                            config.log2_tile_cols));
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AV1E_SET_TILE_ROWS,
+                                            config.log2_tile_rows));
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AV1E_SET_ROW_MT, 1));
+
+  const size_t frame_size = FrameSize(clip);
+  const int num_frames = static_cast<int>(raw.size() / frame_size);
+  output->num_frames = num_frames;
+  output->frames.clear();
+  output->total_bytes = 0;
+  int64_t elapsed_usecs = 0;
+  for (int i = 0;; ++i) {
+    aom_image_t img;
+    aom_image_t *src = NULL;
+    if (i < num_frames) {
+      src = aom_img_wrap(&img, AOM_IMG_FMT_I420, clip.width, clip.height, 1,
+                         const_cast<uint8_t *>(&raw[i * frame_size]));
+    }
+
+    aom_usec_timer timer;
+    aom_usec_timer_start(&timer);
+    const aom_codec_err_t res = aom_codec_encode(&enc, src, i, 1, 0);
+    aom_usec_timer_mark(&timer);
+    elapsed_usecs += aom_usec_timer_elapsed(&timer);
+    ASSERT_EQ(AOM_CODEC_OK, res) << aom_codec_error_detail(&enc);
+
+    bool got_data = false;
+    aom_codec_iter_t iter = NULL;
+    const aom_codec_cx_pkt_t *pkt;
+    while ((pkt = aom_codec_get_cx_data(&enc, &iter)) != NULL) {
+      if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+      got_data = true;
+      output->frames.push_back(std::string(
+          static_cast<const char *>(pkt->data.frame.buf), pkt->data.frame.sz));
+      output->total_bytes += pkt->data.frame.sz;
+    }
+    // Once the frames run out, flush until the encoder returns no more data.
+    if (i >= num_frames && !got_data) break;
+  }
+  output->elapsed_secs = elapsed_usecs / kUsecsInSec;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+}
+
+// Decodes |frames| with the given threading and returns the time spent in the
+// decoder.
+void DecodeFrames(const std::vector<std::string> &frames, DecodeMode mode,
+                  int threads, int *frames_out, double *elapsed_secs) {
+  aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+  cfg.threads = threads;
+  cfg.allow_lowbitdepth = 1;
+  aom_codec_ctx_t dec;
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_dec_init(&dec, aom_codec_av1_dx(), &cfg, 0));
+  ASSERT_EQ(AOM_CODEC_OK,
+            aom_codec_control(&dec, AV1D_SET_ROW_MT, mode != kTileMT));
+  if (mode == kFrameMT) {
+    ASSERT_EQ(AOM_CODEC_OK,
+              aom_codec_control(&dec, AV1D_SET_FRAME_PARALLEL_DEPTH,
+                                threads < 4 ? threads : 4));
+  }
+
+  *frames_out = 0;
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  // The last iteration flushes the frames still held by the frame threads.
+  const size_t num_frames = kDecodeLoops * frames.size();
+  for (size_t i = 0; i <= num_frames; ++i) {
+    aom_codec_err_t res;
+    if (i < num_frames) {
+      const std::string &frame = frames[i % frames.size()];
+      res = aom_codec_decode(&dec,
+                             reinterpret_cast<const uint8_t *>(frame.data()),
+                             frame.size(), NULL);
+    } else {
+      res = aom_codec_decode(&dec, NULL, 0, NULL);
+    }
+    ASSERT_EQ(AOM_CODEC_OK, res) << aom_codec_error_detail(&dec);
+    aom_codec_iter_t iter = NULL;
+    while (aom_codec_get_frame(&dec, &iter) != NULL) ++*frames_out;
+  }
+  aom_usec_timer_mark(&timer);
+  *elapsed_secs = aom_usec_timer_elapsed(&timer) / kUsecsInSec;
+  ASSERT_EQ(AOM_CODEC_OK, aom_codec_destroy(&dec));
+}
+
+// One JSON object per test, as a list of keys and preformatted JSON values.
+class PerfRecord {
+ public:
+  PerfRecord &Add(const char *key, const char *value) {
+    return AddRaw(key, std::string("\"") + value + "\"");
+  }
+
+  PerfRecord &Add(const char *key, int value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%d", value);
+    return AddRaw(key, buf);
+  }
+
+  PerfRecord &Add(const char *key, double value) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%f", value);
+    return AddRaw(key, buf);
+  }
+
+  PerfRecord &AddPeakRss() {
+    const long rss_kb = PeakRssKb();
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%ld", rss_kb);
+    return AddRaw("peakRssKb", rss_kb < 0 ? "null" : buf);
+  }
+
+  void Print(FILE *file) const {
+    fprintf(file, "    {");
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      fprintf(file, "%s\n      \"%s\" : %s", i ? "," : "", keys_[i].c_str(),
+              values_[i].c_str());
+    }
+    fprintf(file, "\n    }");
+  }
+
+  // Prints the record on one line, as key=value pairs.
+  void PrintSummary(FILE *file) const {
+    for (size_t i = 0; i < keys_.size(); ++i) {
+      fprintf(file, "%s%s=%s", i ? " " : "", keys_[i].c_str(),
+              values_[i].c_str());
+    }
+    fprintf(file, "\n");
+  }
+
+ private:
+  PerfRecord &AddRaw(const char *key, const std::string &value) {
+    keys_.push_back(key);
+    values_.push_back(value);
+    return *this;
+  }
+
+  std::vector<std::string> keys_;
+  std::vector<std::string> values_;
+};
+
+std::vector<PerfRecord> perf_records;
+
+void RecordResult(const PerfRecord &record) { perf_records.push_back(record); }
+
+void WriteResults(FILE *file) {
+  fprintf(file, "{\n");
+  fprintf(file, "  \"type\" : \"codec_perf_test\",\n");
+  fprintf(file, "  \"version\" : \"%s\",\n", VERSION_STRING_NOSP);
+  fprintf(file, "  \"results\" : [");
+  for (size_t i = 0; i < perf_records.size(); ++i) {
+    fprintf(file, "%s\n", i ? "," : "");
+    perf_records[i].Print(file);
+  }
+  fprintf(file, "\n  ]\n}\n");
+}
+
+void PrintResultSummary(FILE *file) {
+  for (size_t i = 0; i < perf_records.size(); ++i)
+    perf_records[i].PrintSummary(file);
+  fprintf(file, "%d results. Pass --json_output=<file> to save them as JSON.\n",
+          static_cast<int>(perf_records.size()));
+}
+
+// Loads each clip once and keeps the bitstream the decode tests share.
+class PerfClipCache {
+ public:
+  static const std::vector<uint8_t> *Raw(int clip_index) {
+    Entry &entry = GetEntry(clip_index);
+    return entry.loaded ? &entry.raw : NULL;
+  }
+
+  static const EncodeOutput *Encoded(int clip_index) {
+    Entry &entry = GetEntry(clip_index);
+    if (!entry.loaded) return NULL;
+    if (entry.encoded.frames.empty()) {
+      EncodeConfig config;
+#if CONFIG_REALTIME_ONLY
+      config.preset = kRealTime;
+#else
+      config.preset = kGoodQuality;
+#endif
+      config.speed = kDecodeSpeed;
+      config.threads = 1;
+      config.log2_tile_cols = kDecodeLog2TileCols;
+      config.log2_tile_rows = kDecodeLog2TileRows;
+      EncodeClip(kPerfClips[clip_index], entry.raw, config, &entry.encoded);
+      if (::testing::Test::HasFatalFailure()) return NULL;
+    }
+    return &entry.encoded;
+  }
+
+ private:
+  struct Entry {
+    Entry() : initialized(false), loaded(false) {}
+    bool initialized;
+    bool loaded;
+    std::vector<uint8_t> raw;
+    EncodeOutput encoded;
+  };
+
+  static Entry &GetEntry(int clip_index) {
+    static Entry entries[kNumPerfClips];
+    Entry &entry = entries[clip_index];
+    if (!entry.initialized) {
+      entry.initialized = true;
+      entry.loaded = LoadClip(kPerfClips[clip_index], &entry.raw);
+      if (!entry.loaded) {
+        fprintf(stderr, "Skipping %s: %s not found in LIBAOM_TEST_DATA_PATH\n",
+                kPerfClips[clip_index].name, kPerfClips[clip_index].file);
+      }
+    }
+    return entry;
+  }
+};
+
+/*
+ CodecEncodePerfTest takes a tuple of clip index, preset, speed and thread
+ count. Like the other perf tests, it does no correctness checks.
+ */
+typedef ::testing::tuple<int, EncodePreset, int, int> EncodePerfParam;
+
+class CodecEncodePerfTest : public ::testing::TestWithParam<EncodePerfParam> {
+};
+
+TEST_P(CodecEncodePerfTest, PerfTest) {
+  const int clip_index = ::testing::get<0>(GetParam());
+  const PerfClip &clip = kPerfClips[clip_index];
+  EncodeConfig config;
+  config.preset = ::testing::get<1>(GetParam());
+  config.speed = ::testing::get<2>(GetParam());
+  config.threads = ::testing::get<3>(GetParam());
+  // Give each thread a tile column, up to 4.
+  config.log2_tile_cols = config.threads > 2 ? 2 : config.threads - 1;
+  config.log2_tile_rows = 0;
+
+  const std::vector<uint8_t> *const raw = PerfClipCache::Raw(clip_index);
+  if (raw == NULL) return;
+
+  EncodeOutput output;
+  ASSERT_NO_FATAL_FAILURE(EncodeClip(clip, *raw, config, &output));
+
+  const double fps = output.num_frames / output.elapsed_secs;
+  const double kbps = output.total_bytes * 8.0 * kFramesPerSecond /
+                      output.num_frames / 1000.0;
+  RecordResult(PerfRecord()
+                   .Add("type", "encode")
+                   .Add("videoName", clip.name)
+                   .Add("width", clip.width)
+                   .Add("height", clip.height)
+                   .Add("preset", kEncodePresetNames[config.preset])
+                   .Add("speed", config.speed)
+                   .Add("threadCount", config.threads)
+                   .Add("totalFrames", output.num_frames)
+                   .Add("encodeTimeSecs", output.elapsed_secs)
+                   .Add("framesPerSecond", fps)
+                   .Add("bitrateKbps", kbps)
+                   .AddPeakRss());
+}
+
+#if !CONFIG_REALTIME_ONLY
+INSTANTIATE_TEST_CASE_P(
+    GoodQuality, CodecEncodePerfTest,
+    ::testing::Combine(::testing::Range(0, kNumPerfClips),
+                       ::testing::Values(kGoodQuality), ::testing::Values(4, 6),
+                       ::testing::Values(1, 2, 4)));
+#endif  // !CONFIG_REALTIME_ONLY
+
+INSTANTIATE_TEST_CASE_P(
+    RealTime, CodecEncodePerfTest,
+    ::testing::Combine(::testing::Range(0, kNumPerfClips),
+                       ::testing::Values(kRealTime), ::testing::Values(7, 8),
+                       ::testing::Values(1, 2, 4)));
+
+/*
+ CodecDecodePerfTest takes a tuple of clip index, threading mode and thread
+ count.
+ */
+typedef ::testing::tuple<int, DecodeMode, int> DecodePerfParam;
+
+class CodecDecodePerfTest : public ::testing::TestWithParam<DecodePerfParam> {
+};
+
+TEST_P(CodecDecodePerfTest, PerfTest) {
+  const int clip_index = ::testing::get<0>(GetParam());
+  const DecodeMode mode = ::testing::get<1>(GetParam());
+  const int threads = ::testing::get<2>(GetParam());
+  const PerfClip &clip = kPerfClips[clip_index];
+
+  const EncodeOutput *encoded = NULL;
+  ASSERT_NO_FATAL_FAILURE(encoded = PerfClipCache::Encoded(clip_index));
+  if (encoded == NULL) return;
+
+  int decoded_frames = 0;
+  double elapsed_secs = 0;
+  ASSERT_NO_FATAL_FAILURE(DecodeFrames(encoded->frames, mode, threads,
+                                       &decoded_frames, &elapsed_secs));
+  EXPECT_EQ(kDecodeLoops * encoded->num_frames, decoded_frames);
+
+  RecordResult(PerfRecord()
+                   .Add("type", "decode")
+                   .Add("videoName", clip.name)
+                   .Add("width", clip.width)
+                   .Add("height", clip.height)
+                   .Add("mode", kDecodeModeNames[mode])
+                   .Add("threadCount", threads)
+                   .Add("tileColumns", 1 << kDecodeLog2TileCols)
+                   .Add("tileRows", 1 << kDecodeLog2TileRows)
+                   .Add("totalFrames", decoded_frames)
+                   .Add("decodeTimeSecs", elapsed_secs)
+                   .Add("framesPerSecond", decoded_frames / elapsed_secs)
+                   .AddPeakRss());
+}
+
+INSTANTIATE_TEST_CASE_P(
+    AV1, CodecDecodePerfTest,
+    ::testing::Combine(::testing::Range(0, kNumPerfClips),
+                       ::testing::Values(kTileMT, kRowMT, kFrameMT),
+                       ::testing::Values(1, 2, 4, 8)));
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+
+  const char *json_output = NULL;
+  const char kJsonOutputFlag[] = "--json_output=";
+  for (int i = 1; i < argc; ++i) {
+    if (!strncmp(argv[i], kJsonOutputFlag, strlen(kJsonOutputFlag))) {
+      json_output = argv[i] + strlen(kJsonOutputFlag);
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  FILE *file = NULL;
+  if (json_output != NULL) {
+    file = fopen(json_output, "w");
+    if (file == NULL) {
+      fprintf(stderr, "Failed to open %s\n", json_output);
+      return EXIT_FAILURE;
+    }
+  }
+
+  const int result = RUN_ALL_TESTS();
+  if (file != NULL) {
+    WriteResults(file);
+    fclose(file);
+  } else {
+    PrintResultSummary(stderr);
+  }
+  return result;
+}
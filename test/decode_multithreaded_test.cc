@@ -11,9 +11,12 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <string>
 
+#include "aom_dsp/grain_synthesis.h"
 #include "aom_mem/aom_mem.h"
+#include "av1/encoder/grain_test_vectors.h"
 #include "test/codec_factory.h"
 #include "test/encode_test_driver.h"
 #include "test/i420_video_source.h"
@@ -182,4 +185,482 @@ AV1_INSTANTIATE_TEST_CASE(AV1DecodeMultiThreadedLSTestLarge,
                           ::testing::Values(1), ::testing::Values(0, 3),
                           ::testing::Values(0, 1));
 
+// Decodes a stream with the loop filter, CDEF and loop restoration enabled
+// with several thread counts, which all go through the pipelined post filter,
+// and checks the MD5 of each against single thread decoding, which runs the
+// filters one after the other on the whole frame.
+class AV1PostFilterPipelineTest
+    : public ::libaom_test::CodecTestWith2Params<int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  AV1PostFilterPipelineTest()
+      : EncoderTest(GET_PARAM(0)), n_tile_cols_(GET_PARAM(1)),
+        row_mt_(GET_PARAM(2)) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    cfg.threads = 1;
+    single_thread_dec_ = codec_->CreateDecoder(cfg, 0);
+    for (int i = 0; i < kNumMultiThreadDecoders; ++i) {
+      cfg.threads <<= 1;
+      multi_thread_dec_[i] = codec_->CreateDecoder(cfg, 0);
+      multi_thread_dec_[i]->Control(AV1D_SET_ROW_MT, row_mt_);
+    }
+  }
+
+  virtual ~AV1PostFilterPipelineTest() {
+    delete single_thread_dec_;
+    for (int i = 0; i < kNumMultiThreadDecoders; ++i)
+      delete multi_thread_dec_[i];
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libaom_test::kTwoPassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                                  libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AV1E_SET_TILE_COLUMNS, n_tile_cols_);
+      encoder->Control(AV1E_SET_ENABLE_CDEF, 1);
+      encoder->Control(AV1E_SET_ENABLE_RESTORATION, 1);
+      encoder->Control(AOME_SET_CPUUSED, 1);
+    }
+  }
+
+  void UpdateMD5(::libaom_test::Decoder *dec, const aom_codec_cx_pkt_t *pkt,
+                 ::libaom_test::MD5 *md5) {
+    const aom_codec_err_t res = dec->DecodeFrame(
+        reinterpret_cast<uint8_t *>(pkt->data.frame.buf), pkt->data.frame.sz);
+    if (res != AOM_CODEC_OK) {
+      abort_ = true;
+      ASSERT_EQ(AOM_CODEC_OK, res);
+    }
+    const aom_image_t *img = dec->GetDxData().Next();
+    md5->Add(img);
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    UpdateMD5(single_thread_dec_, pkt, &md5_single_thread_);
+    for (int i = 0; i < kNumMultiThreadDecoders; ++i)
+      UpdateMD5(multi_thread_dec_[i], pkt, &md5_multi_thread_[i]);
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 200;
+    cfg_.g_lag_in_frames = 12;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0, 6);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    for (int i = 0; i < kNumMultiThreadDecoders; ++i)
+      ASSERT_STREQ(md5_single_thread_.Get(), md5_multi_thread_[i].Get());
+  }
+
+ private:
+  int n_tile_cols_;
+  int row_mt_;
+  ::libaom_test::MD5 md5_single_thread_;
+  ::libaom_test::MD5 md5_multi_thread_[kNumMultiThreadDecoders];
+  ::libaom_test::Decoder *single_thread_dec_;
+  ::libaom_test::Decoder *multi_thread_dec_[kNumMultiThreadDecoders];
+};
+
+TEST_P(AV1PostFilterPipelineTest, MD5Match) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_CASE(AV1PostFilterPipelineTest, ::testing::Values(0, 1),
+                          ::testing::Values(0, 1));
+
+// Decodes the encoder output with frame parallel decoding, which returns the
+// frames with a delay, and checks the MD5 against serial decoding.
+class AV1FrameParallelDecodeTest
+    : public ::libaom_test::CodecTestWith2Params<int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  AV1FrameParallelDecodeTest()
+      : EncoderTest(GET_PARAM(0)), frame_parallel_depth_(GET_PARAM(1)),
+        threads_(GET_PARAM(2)), num_serial_frames_(0),
+        num_frame_parallel_frames_(0) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    cfg.threads = 1;
+    serial_dec_ = codec_->CreateDecoder(cfg, 0);
+    cfg.threads = threads_;
+    frame_parallel_dec_ = codec_->CreateDecoder(cfg, 0);
+    frame_parallel_dec_->Control(AV1D_SET_FRAME_PARALLEL_DEPTH,
+                                 frame_parallel_depth_);
+  }
+
+  virtual ~AV1FrameParallelDecodeTest() {
+    delete serial_dec_;
+    delete frame_parallel_dec_;
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libaom_test::kTwoPassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                                  libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) encoder->Control(AOME_SET_CPUUSED, 4);
+  }
+
+  void DecodeAndUpdateMD5(::libaom_test::Decoder *dec, const uint8_t *data,
+                          size_t size, ::libaom_test::MD5 *md5,
+                          int *num_frames) {
+    const aom_codec_err_t res = dec->DecodeFrame(data, size);
+    if (res != AOM_CODEC_OK) {
+      abort_ = true;
+      ASSERT_EQ(AOM_CODEC_OK, res);
+    }
+    ::libaom_test::DxDataIterator dec_iter = dec->GetDxData();
+    const aom_image_t *img;
+    while ((img = dec_iter.Next()) != NULL) {
+      md5->Add(img);
+      ++*num_frames;
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *const data =
+        reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+    DecodeAndUpdateMD5(serial_dec_, data, pkt->data.frame.sz, &md5_serial_,
+                       &num_serial_frames_);
+    DecodeAndUpdateMD5(frame_parallel_dec_, data, pkt->data.frame.sz,
+                       &md5_frame_parallel_, &num_frame_parallel_frames_);
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 300;
+    cfg_.g_lag_in_frames = 12;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0, 12);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    // Flush the frames still in flight.
+    ASSERT_NO_FATAL_FAILURE(DecodeAndUpdateMD5(frame_parallel_dec_, NULL, 0,
+                                               &md5_frame_parallel_,
+                                               &num_frame_parallel_frames_));
+    EXPECT_EQ(num_serial_frames_, num_frame_parallel_frames_);
+    ASSERT_STREQ(md5_serial_.Get(), md5_frame_parallel_.Get());
+  }
+
+ private:
+  int frame_parallel_depth_;
+  int threads_;
+  int num_serial_frames_;
+  int num_frame_parallel_frames_;
+  ::libaom_test::MD5 md5_serial_;
+  ::libaom_test::MD5 md5_frame_parallel_;
+  ::libaom_test::Decoder *serial_dec_;
+  ::libaom_test::Decoder *frame_parallel_dec_;
+};
+
+TEST_P(AV1FrameParallelDecodeTest, MD5Match) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_CASE(AV1FrameParallelDecodeTest,
+                          ::testing::Values(2, 4), ::testing::Values(2, 8));
+
+// Checks the stage times reported by AV1D_GET_FRAME_STATS after each frame is
+// decoded, with and without row based multithreading.
+class AV1DecodeFrameStatsTest
+    : public ::libaom_test::CodecTestWith2Params<int, int>,
+      public ::libaom_test::EncoderTest {
+ protected:
+  AV1DecodeFrameStatsTest()
+      : EncoderTest(GET_PARAM(0)), threads_(GET_PARAM(1)),
+        row_mt_(GET_PARAM(2)) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    cfg.threads = threads_;
+    dec_ = codec_->CreateDecoder(cfg, 0);
+    dec_->Control(AV1D_SET_ROW_MT, row_mt_);
+    memset(stage_time_, 0, sizeof(stage_time_));
+  }
+
+  virtual ~AV1DecodeFrameStatsTest() { delete dec_; }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libaom_test::kTwoPassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                                  libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 4);
+      encoder->Control(AV1E_SET_TILE_COLUMNS, 1);
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    aom_dec_frame_stats_t stats;
+    const aom_codec_err_t res = dec_->DecodeFrame(
+        reinterpret_cast<const uint8_t *>(pkt->data.frame.buf),
+        pkt->data.frame.sz);
+    if (res != AOM_CODEC_OK) {
+      abort_ = true;
+      ASSERT_EQ(AOM_CODEC_OK, res);
+    }
+    ::libaom_test::DxDataIterator dec_iter = dec_->GetDxData();
+    while (dec_iter.Next() != NULL) {
+    }
+    ASSERT_EQ(AOM_CODEC_OK, aom_codec_control(dec_->GetDecoder(),
+                                              AV1D_GET_FRAME_STATS, &stats));
+    EXPECT_GE(stats.frames, 1u);
+    ASSERT_EQ(threads_, stats.num_threads);
+    for (int thread = 0; thread < stats.num_threads; ++thread) {
+      uint64_t thread_total = 0;
+      for (int i = 0; i < AOM_DEC_STAGES; ++i)
+        thread_total += stats.thread_time[thread][i];
+      // Each thread runs one stage at a time during the decode call.
+      EXPECT_LE(thread_total, stats.total_time);
+    }
+    for (int i = 0; i < AOM_DEC_STAGES; ++i) {
+      uint64_t stage_total = 0;
+      for (int thread = 0; thread < stats.num_threads; ++thread)
+        stage_total += stats.thread_time[thread][i];
+      EXPECT_EQ(stage_total, stats.stage_time[i]);
+      stage_time_[i] += stats.stage_time[i];
+    }
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 300;
+    cfg_.g_lag_in_frames = 12;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0, 6);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    // Only row based multithreading parses and reconstructs the tiles in
+    // separate passes.
+    if (threads_ > 1 && row_mt_) {
+      EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_TILE_DECODE]);
+      EXPECT_GT(stage_time_[AOM_DEC_STAGE_ENTROPY_DECODE], 0u);
+      EXPECT_GT(stage_time_[AOM_DEC_STAGE_RECON], 0u);
+    } else {
+      EXPECT_GT(stage_time_[AOM_DEC_STAGE_TILE_DECODE], 0u);
+      EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_ENTROPY_DECODE]);
+      EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_RECON]);
+    }
+    EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_SUPERRES]);
+    EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_FILM_GRAIN]);
+    if (threads_ == 1) {
+      EXPECT_EQ(0u, stage_time_[AOM_DEC_STAGE_IDLE]);
+    }
+  }
+
+ private:
+  int threads_;
+  int row_mt_;
+  uint64_t stage_time_[AOM_DEC_STAGES];
+  ::libaom_test::Decoder *dec_;
+};
+
+TEST_P(AV1DecodeFrameStatsTest, StageTimes) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_CASE(AV1DecodeFrameStatsTest, ::testing::Values(1, 4),
+                          ::testing::Values(0, 1));
+
+void ExpectScalingPointsEqual(const int (*expected)[2], const int (*actual)[2],
+                              int num_points) {
+  for (int i = 0; i < num_points; ++i) {
+    EXPECT_EQ(expected[i][0], actual[i][0]) << "point " << i;
+    EXPECT_EQ(expected[i][1], actual[i][1]) << "point " << i;
+  }
+}
+
+void ExpectArCoeffsEqual(const int *expected, const int *actual,
+                         int num_coeffs) {
+  for (int i = 0; i < num_coeffs; ++i)
+    EXPECT_EQ(expected[i], actual[i]) << "coefficient " << i;
+}
+
+// Checks the parameters returned by AV1D_GET_FILM_GRAIN_PARAMS against the
+// ones the encoder signaled.
+void ExpectFilmGrainParamsEqual(const aom_film_grain_t &expected,
+                                const aom_film_grain_params_t &actual) {
+  EXPECT_EQ(expected.apply_grain, actual.apply_grain);
+  EXPECT_EQ(expected.random_seed, actual.random_seed);
+  ASSERT_EQ(expected.num_y_points, actual.num_y_points);
+  ExpectScalingPointsEqual(expected.scaling_points_y, actual.scaling_points_y,
+                           expected.num_y_points);
+  ASSERT_EQ(expected.num_cb_points, actual.num_cb_points);
+  ExpectScalingPointsEqual(expected.scaling_points_cb, actual.scaling_points_cb,
+                           expected.num_cb_points);
+  ASSERT_EQ(expected.num_cr_points, actual.num_cr_points);
+  ExpectScalingPointsEqual(expected.scaling_points_cr, actual.scaling_points_cr,
+                           expected.num_cr_points);
+  EXPECT_EQ(expected.chroma_scaling_from_luma, actual.chroma_scaling_from_luma);
+  EXPECT_EQ(expected.scaling_shift, actual.scaling_shift);
+  ASSERT_EQ(expected.ar_coeff_lag, actual.ar_coeff_lag);
+  const int num_pos_luma =
+      2 * expected.ar_coeff_lag * (expected.ar_coeff_lag + 1);
+  const int num_pos_chroma = num_pos_luma + (expected.num_y_points > 0);
+  ExpectArCoeffsEqual(expected.ar_coeffs_y, actual.ar_coeffs_y, num_pos_luma);
+  ExpectArCoeffsEqual(expected.ar_coeffs_cb, actual.ar_coeffs_cb,
+                      num_pos_chroma);
+  ExpectArCoeffsEqual(expected.ar_coeffs_cr, actual.ar_coeffs_cr,
+                      num_pos_chroma);
+  EXPECT_EQ(expected.ar_coeff_shift, actual.ar_coeff_shift);
+  EXPECT_EQ(expected.grain_scale_shift, actual.grain_scale_shift);
+  EXPECT_EQ(expected.cb_mult, actual.cb_mult);
+  EXPECT_EQ(expected.cb_luma_mult, actual.cb_luma_mult);
+  EXPECT_EQ(expected.cb_offset, actual.cb_offset);
+  EXPECT_EQ(expected.cr_mult, actual.cr_mult);
+  EXPECT_EQ(expected.cr_luma_mult, actual.cr_luma_mult);
+  EXPECT_EQ(expected.cr_offset, actual.cr_offset);
+  EXPECT_EQ(expected.overlap_flag, actual.overlap_flag);
+  EXPECT_EQ(expected.clip_to_restricted_range, actual.clip_to_restricted_range);
+  EXPECT_EQ(expected.bit_depth, actual.bit_depth);
+}
+
+// Decodes a stream with film grain three ways: with the grain added to a new
+// image, with the grain added in place, and without the grain, which the test
+// then adds itself from the first film grain test vector the stream was
+// encoded with. All three must give the same output, serially and with frame
+// parallel decoding. The parameters returned by AV1D_GET_FILM_GRAIN_PARAMS
+// must match the test vector.
+// Every other frame is droppable, so that the decoder does not keep it as a
+// reference frame and can add its grain in place.
+class AV1FilmGrainOutputTest : public ::libaom_test::CodecTestWithParam<int>,
+                               public ::libaom_test::EncoderTest {
+ protected:
+  AV1FilmGrainOutputTest()
+      : EncoderTest(GET_PARAM(0)), frame_parallel_depth_(GET_PARAM(1)),
+        num_grain_frames_(0), grain_(film_grain_test_vectors[0]) {
+    aom_codec_dec_cfg_t cfg = aom_codec_dec_cfg_t();
+    cfg.allow_lowbitdepth = 1;
+    cfg.threads = 2;
+    for (int i = 0; i < kNumOutputs; ++i) {
+      dec_[i] = codec_->CreateDecoder(cfg, 0);
+      dec_[i]->Control(AV1D_SET_FRAME_PARALLEL_DEPTH, frame_parallel_depth_);
+      num_frames_[i] = 0;
+    }
+    dec_[kInPlace]->Control(AV1D_SET_FILM_GRAIN_IN_PLACE, 1);
+    dec_[kByApp]->Control(AV1D_SET_SKIP_FILM_GRAIN, 1);
+  }
+
+  virtual ~AV1FilmGrainOutputTest() {
+    for (int i = 0; i < kNumOutputs; ++i) delete dec_[i];
+  }
+
+  virtual void SetUp() {
+    InitializeConfig();
+    SetMode(libaom_test::kOnePassGood);
+  }
+
+  virtual void PreEncodeFrameHook(libaom_test::VideoSource *video,
+                                  libaom_test::Encoder *encoder) {
+    if (video->frame() == 0) {
+      encoder->Control(AOME_SET_CPUUSED, 4);
+      encoder->Control(AV1E_SET_FILM_GRAIN_TEST_VECTOR, 1);
+    }
+    frame_flags_ = 0;
+    if (video->frame() % 2) {
+      frame_flags_ =
+          AOM_EFLAG_NO_UPD_LAST | AOM_EFLAG_NO_UPD_GF | AOM_EFLAG_NO_UPD_ARF;
+    }
+  }
+
+  // The decoded frames have film grain, so they do not match the encoder's
+  // reconstruction.
+  virtual bool DoDecode() const { return false; }
+
+  void DecodeAndUpdateMD5(int output, const uint8_t *data, size_t size) {
+    ::libaom_test::Decoder *const dec = dec_[output];
+    const aom_codec_err_t res = dec->DecodeFrame(data, size);
+    if (res != AOM_CODEC_OK) {
+      abort_ = true;
+      ASSERT_EQ(AOM_CODEC_OK, res);
+    }
+    ::libaom_test::DxDataIterator dec_iter = dec->GetDxData();
+    const aom_image_t *img;
+    while ((img = dec_iter.Next()) != NULL) {
+      ++num_frames_[output];
+      if (output != kByApp) {
+        md5_[output].Add(img);
+        continue;
+      }
+      aom_film_grain_params_t grain_params;
+      ASSERT_EQ(AOM_CODEC_OK,
+                aom_codec_control(dec->GetDecoder(), AV1D_GET_FILM_GRAIN_PARAMS,
+                                  &grain_params));
+      if (!grain_params.apply_grain) {
+        md5_[output].Add(img);
+        continue;
+      }
+      ++num_grain_frames_;
+      grain_.bit_depth = img->bit_depth;
+      ASSERT_NO_FATAL_FAILURE(ExpectFilmGrainParamsEqual(grain_, grain_params));
+      aom_image_t *const grain_img =
+          aom_img_alloc(NULL, img->fmt, (img->d_w + 1) & ~1,
+                        (img->d_h + 1) & ~1, 16);
+      ASSERT_TRUE(grain_img != NULL);
+      EXPECT_EQ(0, av1_add_film_grain(&grain_, img, grain_img));
+      md5_[output].Add(grain_img);
+      aom_img_free(grain_img);
+      // The encoder moves the random seed on by 3381 for each shown frame.
+      grain_.random_seed += 3381;
+      if (grain_.random_seed == 0) grain_.random_seed = 7391;
+    }
+  }
+
+  virtual void FramePktHook(const aom_codec_cx_pkt_t *pkt) {
+    const uint8_t *const data =
+        reinterpret_cast<const uint8_t *>(pkt->data.frame.buf);
+    for (int i = 0; i < kNumOutputs; ++i)
+      ASSERT_NO_FATAL_FAILURE(DecodeAndUpdateMD5(i, data, pkt->data.frame.sz));
+  }
+
+  void DoTest() {
+    const aom_rational timebase = { 33333333, 1000000000 };
+    cfg_.g_timebase = timebase;
+    cfg_.rc_target_bitrate = 300;
+    cfg_.g_lag_in_frames = 0;
+    cfg_.rc_end_usage = AOM_VBR;
+
+    libaom_test::I420VideoSource video("hantro_collage_w352h288.yuv", 352, 288,
+                                       timebase.den, timebase.num, 0, 8);
+    ASSERT_NO_FATAL_FAILURE(RunLoop(&video));
+
+    // Flush the frames still in flight.
+    for (int i = 0; i < kNumOutputs; ++i)
+      ASSERT_NO_FATAL_FAILURE(DecodeAndUpdateMD5(i, NULL, 0));
+    EXPECT_GT(num_grain_frames_, 0);
+    for (int i = 1; i < kNumOutputs; ++i) {
+      EXPECT_EQ(num_frames_[kNewImage], num_frames_[i]);
+      EXPECT_STREQ(md5_[kNewImage].Get(), md5_[i].Get());
+    }
+  }
+
+ private:
+  enum { kNewImage, kInPlace, kByApp, kNumOutputs };
+
+  int frame_parallel_depth_;
+  int num_grain_frames_;
+  // The film grain of the next frame output by dec_[kByApp].
+  aom_film_grain_t grain_;
+  int num_frames_[kNumOutputs];
+  ::libaom_test::MD5 md5_[kNumOutputs];
+  ::libaom_test::Decoder *dec_[kNumOutputs];
+};
+
+TEST_P(AV1FilmGrainOutputTest, MD5Match) { DoTest(); }
+
+AV1_INSTANTIATE_TEST_CASE(AV1FilmGrainOutputTest, ::testing::Values(0, 2));
+
 }  // namespace
@@ -9,10 +9,13 @@
  * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
  */
 
+#include <vector>
+
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
 
 #include "config/aom_config.h"
 
+#include "test/acm_random.h"
 #include "test/util.h"
 #include "aom/aomcx.h"
 #include "aom/aom_encoder.h"
@@ -70,4 +73,209 @@ TEST(EncodeAPI, InvalidParams) {
   }
 }
 
+#if CONFIG_AV1_ENCODER
+const int kZeroCopyWidth = 128;
+const int kZeroCopyHeight = 64;
+const int kZeroCopyFrames = 8;
+
+void CountRelease(void *priv) { ++*static_cast<int *>(priv); }
+
+void FillFrame(aom_image_t *img, int frame) {
+  libaom_test::ACMRandom rnd(frame + 1);
+  for (int plane = 0; plane < 3; ++plane) {
+    const int w = aom_img_plane_width(img, plane);
+    const int h = aom_img_plane_height(img, plane);
+    for (int r = 0; r < h; ++r) {
+      for (int c = 0; c < w; ++c)
+        img->planes[plane][r * img->stride[plane] + c] = rnd.Rand8();
+    }
+  }
+}
+
+// Appends the compressed frames available from the encoder to data and returns
+// whether there were any.
+bool GetFrames(aom_codec_ctx_t *enc, std::vector<uint8_t> *data) {
+  aom_codec_iter_t iter = NULL;
+  const aom_codec_cx_pkt_t *pkt;
+  bool got_frames = false;
+  while ((pkt = aom_codec_get_cx_data(enc, &iter)) != NULL) {
+    if (pkt->kind != AOM_CODEC_CX_FRAME_PKT) continue;
+    const uint8_t *const buf = static_cast<const uint8_t *>(pkt->data.frame.buf);
+    data->insert(data->end(), buf, buf + pkt->data.frame.sz);
+    got_frames = true;
+  }
+  return got_frames;
+}
+
+// Encodes kZeroCopyFrames frames, each in its own image, and returns the
+// compressed data. If zero_copy is set, the encoder may reference the images
+// until it releases them.
+std::vector<uint8_t> EncodeFrames(bool zero_copy, int *num_released) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  aom_codec_ctx_t enc;
+  std::vector<aom_image_t *> imgs;
+  std::vector<uint8_t> data;
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  cfg.g_lag_in_frames = 4;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, 5));
+
+  *num_released = 0;
+  for (int frame = 0; frame < kZeroCopyFrames; ++frame) {
+    // The layout matches the encoder's lookahead buffers.
+    aom_image_t *const img = aom_img_alloc_with_border(
+        NULL, AOM_IMG_FMT_I420, kZeroCopyWidth, kZeroCopyHeight, 32, 8, 64);
+    EXPECT_TRUE(img != NULL);
+    FillFrame(img, frame);
+    if (zero_copy) {
+      img->release_cb = CountRelease;
+      img->release_cb_priv = num_released;
+    }
+    imgs.push_back(img);
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, img, frame, 1, 0));
+    GetFrames(&enc, &data);
+  }
+  // The queued frames are held until the lookahead slots are reused.
+  if (zero_copy) {
+    EXPECT_LT(*num_released, kZeroCopyFrames);
+  }
+  do {
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, NULL, 0, 0, 0));
+  } while (GetFrames(&enc, &data));
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  for (size_t i = 0; i < imgs.size(); ++i) aom_img_free(imgs[i]);
+  return data;
+}
+
+TEST(EncodeAPI, ZeroCopyInput) {
+  int num_released;
+  const std::vector<uint8_t> copied = EncodeFrames(false, &num_released);
+  EXPECT_EQ(0, num_released);
+  const std::vector<uint8_t> referenced = EncodeFrames(true, &num_released);
+  EXPECT_EQ(kZeroCopyFrames, num_released);
+  EXPECT_FALSE(copied.empty());
+  EXPECT_TRUE(copied == referenced);
+}
+
+TEST(EncodeAPI, ZeroCopyInputFallsBackToCopy) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  aom_codec_ctx_t enc;
+  std::vector<uint8_t> buf(kZeroCopyWidth * kZeroCopyHeight * 3 / 2);
+  aom_image_t img;
+  int num_released = 0;
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+
+  // A wrapped image has no border, so it is copied and released at once.
+  EXPECT_EQ(&img, aom_img_wrap(&img, AOM_IMG_FMT_I420, kZeroCopyWidth,
+                               kZeroCopyHeight, 1, &buf[0]));
+  img.release_cb = CountRelease;
+  img.release_cb_priv = &num_released;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, &img, 0, 1, 0));
+  EXPECT_EQ(1, num_released);
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+  EXPECT_EQ(1, num_released);
+}
+
+TEST(EncodeAPI, MemUsage) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  aom_codec_ctx_t enc;
+  size_t mem_usage[2] = { 0, 0 };
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_INVALID_PARAM,
+            aom_codec_control(&enc, AV1E_GET_MEM_USAGE, NULL));
+#if CONFIG_MEM_POOL
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_control(&enc, AV1E_GET_MEM_USAGE, mem_usage));
+  EXPECT_GT(mem_usage[0], 0u);
+  EXPECT_GE(mem_usage[1], mem_usage[0]);
+#else
+  EXPECT_EQ(AOM_CODEC_INCAPABLE,
+            aom_codec_control(&enc, AV1E_GET_MEM_USAGE, mem_usage));
+#endif
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+}
+
+// Checks the stage times returned after a call to aom_codec_encode(), adds
+// them to stage_time, and returns the number of frames that call encoded.
+unsigned int CheckFrameStats(aom_codec_ctx_t *enc, uint64_t *stage_time) {
+  aom_enc_frame_stats_t stats;
+  EXPECT_EQ(AOM_CODEC_OK,
+            aom_codec_control(enc, AV1E_GET_FRAME_STATS, &stats));
+  uint64_t stage_total = 0;
+  for (int i = 0; i < AOM_ENC_STAGES; ++i) {
+    stage_total += stats.stage_time[i];
+    stage_time[i] += stats.stage_time[i];
+  }
+  // The stages run one after the other within the total time.
+  EXPECT_LE(stage_total, stats.total_time);
+  if (stats.frames == 0) {
+    EXPECT_EQ(0u, stats.total_time);
+  }
+  return stats.frames;
+}
+
+TEST(EncodeAPI, FrameStats) {
+  aom_codec_iface_t *const iface = aom_codec_av1_cx();
+  aom_codec_enc_cfg_t cfg;
+  aom_codec_ctx_t enc;
+  std::vector<uint8_t> data;
+
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_config_default(iface, &cfg, 0));
+  cfg.g_w = kZeroCopyWidth;
+  cfg.g_h = kZeroCopyHeight;
+  cfg.g_lag_in_frames = 4;
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_enc_init(&enc, iface, &cfg, 0));
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_control(&enc, AOME_SET_CPUUSED, 5));
+  EXPECT_EQ(AOM_CODEC_INVALID_PARAM,
+            aom_codec_control(&enc, AV1E_GET_FRAME_STATS, NULL));
+
+  aom_image_t *const img = aom_img_alloc(NULL, AOM_IMG_FMT_I420,
+                                         kZeroCopyWidth, kZeroCopyHeight, 32);
+  ASSERT_TRUE(img != NULL);
+  unsigned int frames = 0;
+  uint64_t stage_time[AOM_ENC_STAGES] = { 0 };
+  for (int frame = 0; frame < kZeroCopyFrames; ++frame) {
+    FillFrame(img, frame);
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, img, frame, 1, 0));
+    frames += CheckFrameStats(&enc, stage_time);
+    GetFrames(&enc, &data);
+  }
+  // The frames still in the lookahead are encoded while flushing.
+  bool got_frames;
+  do {
+    EXPECT_EQ(AOM_CODEC_OK, aom_codec_encode(&enc, NULL, 0, 0, 0));
+    frames += CheckFrameStats(&enc, stage_time);
+    got_frames = GetFrames(&enc, &data);
+  } while (got_frames);
+  EXPECT_GE(frames, static_cast<unsigned int>(kZeroCopyFrames));
+
+  // One pass encoding with a lookahead too short for an ARF runs every stage
+  // but the first pass and the temporal filtering.
+  EXPECT_EQ(0u, stage_time[AOM_ENC_STAGE_FIRST_PASS]);
+  EXPECT_EQ(0u, stage_time[AOM_ENC_STAGE_TEMPORAL_FILTER]);
+  for (int i = AOM_ENC_STAGE_TPL; i < AOM_ENC_STAGES; ++i) {
+    EXPECT_GT(stage_time[i], 0u) << "stage " << i;
+  }
+
+  aom_img_free(img);
+  EXPECT_EQ(AOM_CODEC_OK, aom_codec_destroy(&enc));
+}
+#endif  // CONFIG_AV1_ENCODER
+
 }  // namespace
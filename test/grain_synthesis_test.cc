@@ -0,0 +1,491 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+#include <string.h>
+#include <vector>
+
+#include "third_party/googletest/src/googletest/include/gtest/gtest.h"
+
+#include "config/aom_dsp_rtcd.h"
+
+#include "aom_dsp/grain_synthesis.h"
+#include "aom_util/aom_thread.h"
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "test/util.h"
+
+namespace {
+const int kTestIters = 1000;
+const int kMaxWidth = 40;
+const int kMaxHeight = 34;
+const int kStride = 2 * kMaxWidth + 8;
+
+using libaom_test::ACMRandom;
+using ::testing::make_tuple;
+using ::testing::tuple;
+
+// Random arguments shared by the noise kernels, in the ranges that
+// add_noise_to_block() and add_noise_to_block_hbd() use.
+struct NoiseArgs {
+  void Randomize(ACMRandom *rnd, int bd) {
+    const int shift = bd - 8;
+    width = 1 + rnd->PseudoUniform(kMaxWidth);
+    height = 1 + rnd->PseudoUniform(kMaxHeight);
+    subsamp_x = rnd->Rand8() & 1;
+    subsamp_y = subsamp_x ? rnd->Rand8() & 1 : 0;
+    for (int i = 0; i < 256; ++i) scaling_lut[i] = rnd->Rand8();
+    scaling_shift = 8 + rnd->PseudoUniform(4);
+    luma_mult = rnd->Rand8() - 128;
+    chroma_mult = rnd->Rand8() - 128;
+    offset = ((rnd->Rand16() & 511) << shift) - (1 << bd);
+    if (rnd->Rand8() & 1) {
+      min_value = 16 << shift;
+      max_value = 235 << shift;
+    } else {
+      min_value = 0;
+      max_value = (256 << shift) - 1;
+    }
+    const int grain_center = 128 << shift;
+    for (int i = 0; i < kMaxHeight * kStride; ++i) {
+      grain[i] = rnd->PseudoUniform(2 * grain_center) - grain_center;
+    }
+  }
+
+  int width;
+  int height;
+  int subsamp_x;
+  int subsamp_y;
+  int scaling_lut[256];
+  int scaling_shift;
+  int luma_mult;
+  int chroma_mult;
+  int offset;
+  int min_value;
+  int max_value;
+  int grain[kMaxHeight * kStride];
+};
+
+template <typename Pixel>
+void FillPixels(ACMRandom *rnd, int bd, Pixel *pixels, int size) {
+  const int mask = (1 << bd) - 1;
+  const bool extreme = (rnd->Rand8() & 3) == 0;
+  for (int i = 0; i < size; ++i)
+    pixels[i] = extreme ? (rnd->Rand8() & 1) * mask : rnd->Rand16() & mask;
+}
+
+typedef void (*LumaNoiseFunc)(uint8_t *luma, int luma_stride, const int *grain,
+                              int grain_stride, int width, int height,
+                              const int *scaling_lut, int scaling_shift,
+                              int min_luma, int max_luma);
+
+class LumaNoiseTest : public ::testing::TestWithParam<LumaNoiseFunc> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+
+TEST_P(LumaNoiseTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  NoiseArgs args;
+  uint8_t ref[kMaxHeight * kStride];
+  uint8_t tst[kMaxHeight * kStride];
+  for (int iter = 0; iter < kTestIters; ++iter) {
+    args.Randomize(&rnd, 8);
+    FillPixels(&rnd, 8, ref, kMaxHeight * kStride);
+    memcpy(tst, ref, sizeof(ref));
+    aom_film_grain_add_luma_noise_c(ref, kStride, args.grain, kStride,
+                                    args.width, args.height, args.scaling_lut,
+                                    args.scaling_shift, args.min_value,
+                                    args.max_value);
+    GetParam()(tst, kStride, args.grain, kStride, args.width, args.height,
+               args.scaling_lut, args.scaling_shift, args.min_value,
+               args.max_value);
+    for (int i = 0; i < kMaxHeight * kStride; ++i)
+      ASSERT_EQ(ref[i], tst[i]) << "Error at " << i << ", iter: " << iter;
+  }
+}
+
+typedef void (*ChromaNoiseFunc)(
+    uint8_t *chroma, int chroma_stride, const uint8_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma);
+
+class ChromaNoiseTest : public ::testing::TestWithParam<ChromaNoiseFunc> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+
+TEST_P(ChromaNoiseTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  NoiseArgs args;
+  uint8_t luma[2 * kMaxHeight * kStride];
+  uint8_t ref[kMaxHeight * kStride];
+  uint8_t tst[kMaxHeight * kStride];
+  for (int iter = 0; iter < kTestIters; ++iter) {
+    args.Randomize(&rnd, 8);
+    FillPixels(&rnd, 8, luma, 2 * kMaxHeight * kStride);
+    FillPixels(&rnd, 8, ref, kMaxHeight * kStride);
+    memcpy(tst, ref, sizeof(ref));
+    aom_film_grain_add_chroma_noise_c(
+        ref, kStride, luma, kStride, args.grain, kStride, args.width,
+        args.height, args.subsamp_x, args.subsamp_y, args.scaling_lut,
+        args.scaling_shift, args.luma_mult, args.chroma_mult, args.offset,
+        args.min_value, args.max_value);
+    GetParam()(tst, kStride, luma, kStride, args.grain, kStride, args.width,
+               args.height, args.subsamp_x, args.subsamp_y, args.scaling_lut,
+               args.scaling_shift, args.luma_mult, args.chroma_mult,
+               args.offset, args.min_value, args.max_value);
+    for (int i = 0; i < kMaxHeight * kStride; ++i)
+      ASSERT_EQ(ref[i], tst[i]) << "Error at " << i << ", iter: " << iter;
+  }
+}
+
+typedef void (*HighbdLumaNoiseFunc)(uint16_t *luma, int luma_stride,
+                                    const int *grain, int grain_stride,
+                                    int width, int height,
+                                    const int *scaling_lut, int scaling_shift,
+                                    int min_luma, int max_luma, int bd);
+typedef tuple<HighbdLumaNoiseFunc, int> HighbdLumaNoiseParam;
+
+class HighbdLumaNoiseTest
+    : public ::testing::TestWithParam<HighbdLumaNoiseParam> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+
+TEST_P(HighbdLumaNoiseTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const HighbdLumaNoiseFunc func = ::testing::get<0>(GetParam());
+  const int bd = ::testing::get<1>(GetParam());
+  NoiseArgs args;
+  uint16_t ref[kMaxHeight * kStride];
+  uint16_t tst[kMaxHeight * kStride];
+  for (int iter = 0; iter < kTestIters; ++iter) {
+    args.Randomize(&rnd, bd);
+    FillPixels(&rnd, bd, ref, kMaxHeight * kStride);
+    memcpy(tst, ref, sizeof(ref));
+    aom_highbd_film_grain_add_luma_noise_c(
+        ref, kStride, args.grain, kStride, args.width, args.height,
+        args.scaling_lut, args.scaling_shift, args.min_value, args.max_value,
+        bd);
+    func(tst, kStride, args.grain, kStride, args.width, args.height,
+         args.scaling_lut, args.scaling_shift, args.min_value, args.max_value,
+         bd);
+    for (int i = 0; i < kMaxHeight * kStride; ++i)
+      ASSERT_EQ(ref[i], tst[i]) << "Error at " << i << ", iter: " << iter;
+  }
+}
+
+typedef void (*HighbdChromaNoiseFunc)(
+    uint16_t *chroma, int chroma_stride, const uint16_t *luma, int luma_stride,
+    const int *grain, int grain_stride, int width, int height,
+    int chroma_subsamp_x, int chroma_subsamp_y, const int *scaling_lut,
+    int scaling_shift, int luma_mult, int chroma_mult, int offset,
+    int min_chroma, int max_chroma, int bd);
+typedef tuple<HighbdChromaNoiseFunc, int> HighbdChromaNoiseParam;
+
+class HighbdChromaNoiseTest
+    : public ::testing::TestWithParam<HighbdChromaNoiseParam> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+
+TEST_P(HighbdChromaNoiseTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const HighbdChromaNoiseFunc func = ::testing::get<0>(GetParam());
+  const int bd = ::testing::get<1>(GetParam());
+  NoiseArgs args;
+  uint16_t luma[2 * kMaxHeight * kStride];
+  uint16_t ref[kMaxHeight * kStride];
+  uint16_t tst[kMaxHeight * kStride];
+  for (int iter = 0; iter < kTestIters; ++iter) {
+    args.Randomize(&rnd, bd);
+    FillPixels(&rnd, bd, luma, 2 * kMaxHeight * kStride);
+    FillPixels(&rnd, bd, ref, kMaxHeight * kStride);
+    memcpy(tst, ref, sizeof(ref));
+    aom_highbd_film_grain_add_chroma_noise_c(
+        ref, kStride, luma, kStride, args.grain, kStride, args.width,
+        args.height, args.subsamp_x, args.subsamp_y, args.scaling_lut,
+        args.scaling_shift, args.luma_mult, args.chroma_mult, args.offset,
+        args.min_value, args.max_value, bd);
+    func(tst, kStride, luma, kStride, args.grain, kStride, args.width,
+         args.height, args.subsamp_x, args.subsamp_y, args.scaling_lut,
+         args.scaling_shift, args.luma_mult, args.chroma_mult, args.offset,
+         args.min_value, args.max_value, bd);
+    for (int i = 0; i < kMaxHeight * kStride; ++i)
+      ASSERT_EQ(ref[i], tst[i]) << "Error at " << i << ", iter: " << iter;
+  }
+}
+
+typedef void (*HorOverlapFunc)(const int *top, int top_stride,
+                               const int *bottom, int bottom_stride, int *dst,
+                               int dst_stride, int width, int height,
+                               int min_value, int max_value);
+
+class HorOverlapTest : public ::testing::TestWithParam<HorOverlapFunc> {
+ public:
+  virtual void TearDown() { libaom_test::ClearSystemState(); }
+};
+
+TEST_P(HorOverlapTest, MatchesC) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  int top[2 * kStride];
+  int bottom[2 * kStride];
+  int ref[2 * kStride];
+  int tst[2 * kStride];
+  for (int iter = 0; iter < kTestIters; ++iter) {
+    const int bd = 8 + 2 * rnd.PseudoUniform(3);
+    const int grain_center = 128 << (bd - 8);
+    const int width = 1 + rnd.PseudoUniform(kStride);
+    const int height = 1 + (rnd.Rand8() & 1);
+    for (int i = 0; i < 2 * kStride; ++i) {
+      top[i] = rnd.PseudoUniform(2 * grain_center) - grain_center;
+      bottom[i] = rnd.PseudoUniform(2 * grain_center) - grain_center;
+    }
+    // The grain is blended in place, as it is in the line buffers.
+    memcpy(ref, top, sizeof(top));
+    memcpy(tst, top, sizeof(top));
+    aom_film_grain_hor_overlap_c(ref, kStride, bottom, kStride, ref, kStride,
+                                 width, height, -grain_center,
+                                 grain_center - 1);
+    GetParam()(tst, kStride, bottom, kStride, tst, kStride, width, height,
+               -grain_center, grain_center - 1);
+    for (int i = 0; i < 2 * kStride; ++i)
+      ASSERT_EQ(ref[i], tst[i]) << "Error at " << i << ", iter: " << iter;
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, LumaNoiseTest,
+                        ::testing::Values(aom_film_grain_add_luma_noise_c));
+INSTANTIATE_TEST_CASE_P(C, ChromaNoiseTest,
+                        ::testing::Values(aom_film_grain_add_chroma_noise_c));
+INSTANTIATE_TEST_CASE_P(
+    C, HighbdLumaNoiseTest,
+    ::testing::Combine(::testing::Values(aom_highbd_film_grain_add_luma_noise_c),
+                       ::testing::Values(8, 10, 12)));
+INSTANTIATE_TEST_CASE_P(
+    C, HighbdChromaNoiseTest,
+    ::testing::Combine(
+        ::testing::Values(aom_highbd_film_grain_add_chroma_noise_c),
+        ::testing::Values(8, 10, 12)));
+INSTANTIATE_TEST_CASE_P(C, HorOverlapTest,
+                        ::testing::Values(aom_film_grain_hor_overlap_c));
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, LumaNoiseTest,
+                        ::testing::Values(aom_film_grain_add_luma_noise_avx2));
+INSTANTIATE_TEST_CASE_P(
+    AVX2, ChromaNoiseTest,
+    ::testing::Values(aom_film_grain_add_chroma_noise_avx2));
+INSTANTIATE_TEST_CASE_P(
+    AVX2, HighbdLumaNoiseTest,
+    ::testing::Combine(
+        ::testing::Values(aom_highbd_film_grain_add_luma_noise_avx2),
+        ::testing::Values(8, 10, 12)));
+INSTANTIATE_TEST_CASE_P(
+    AVX2, HighbdChromaNoiseTest,
+    ::testing::Combine(
+        ::testing::Values(aom_highbd_film_grain_add_chroma_noise_avx2),
+        ::testing::Values(8, 10, 12)));
+INSTANTIATE_TEST_CASE_P(AVX2, HorOverlapTest,
+                        ::testing::Values(aom_film_grain_hor_overlap_avx2));
+#endif  // HAVE_AVX2
+
+// Random grain parameters within the ranges of the bitstream syntax.
+void RandomGrainParams(ACMRandom *rnd, int bit_depth, aom_film_grain_t *p) {
+  memset(p, 0, sizeof(*p));
+  p->apply_grain = 1;
+  p->update_parameters = 1;
+  p->bit_depth = bit_depth;
+  p->random_seed = rnd->Rand16();
+  p->num_y_points = 1 + rnd->PseudoUniform(14);
+  p->chroma_scaling_from_luma = (rnd->Rand8() & 3) == 0;
+  if (!p->chroma_scaling_from_luma) {
+    p->num_cb_points = rnd->PseudoUniform(11);
+    p->num_cr_points = rnd->PseudoUniform(11);
+  }
+  int(*const points[3])[2] = { p->scaling_points_y, p->scaling_points_cb,
+                                p->scaling_points_cr };
+  const int num_points[3] = { p->num_y_points, p->num_cb_points,
+                              p->num_cr_points };
+  for (int c = 0; c < 3; ++c) {
+    int x = rnd->PseudoUniform(16);
+    for (int i = 0; i < num_points[c]; ++i) {
+      points[c][i][0] = x;
+      points[c][i][1] = rnd->Rand8();
+      x += 1 + rnd->PseudoUniform(16);
+    }
+  }
+  p->scaling_shift = 8 + rnd->PseudoUniform(4);
+  p->ar_coeff_lag = rnd->PseudoUniform(4);
+  p->ar_coeff_shift = 6 + rnd->PseudoUniform(4);
+  for (int i = 0; i < 24; ++i) p->ar_coeffs_y[i] = rnd->Rand8() - 128;
+  for (int i = 0; i < 25; ++i) {
+    p->ar_coeffs_cb[i] = rnd->Rand8() - 128;
+    p->ar_coeffs_cr[i] = rnd->Rand8() - 128;
+  }
+  p->cb_mult = rnd->Rand8();
+  p->cb_luma_mult = rnd->Rand8();
+  p->cb_offset = rnd->Rand16() & 511;
+  p->cr_mult = rnd->Rand8();
+  p->cr_luma_mult = rnd->Rand8();
+  p->cr_offset = rnd->Rand16() & 511;
+  p->overlap_flag = rnd->Rand8() & 1;
+  p->clip_to_restricted_range = rnd->Rand8() & 1;
+  p->grain_scale_shift = rnd->PseudoUniform(4);
+}
+
+typedef tuple<aom_img_fmt_t, int> AddFilmGrainMtParam;
+
+class AddFilmGrainMtTest
+    : public ::testing::TestWithParam<AddFilmGrainMtParam> {
+ protected:
+  static const int kMaxWorkers = 4;
+
+  virtual void SetUp() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kMaxWorkers; ++i) {
+      winterface->init(&workers_[i]);
+      ASSERT_TRUE(winterface->reset(&workers_[i]));
+    }
+  }
+
+  virtual void TearDown() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kMaxWorkers; ++i) winterface->end(&workers_[i]);
+    libaom_test::ClearSystemState();
+  }
+
+  AVxWorker workers_[kMaxWorkers];
+};
+
+// Fills the visible area of img, rounded up to even sizes, so that the
+// source covers all of the output.
+void FillImage(ACMRandom *rnd, aom_image_t *img) {
+  const int use_high_bit_depth = (img->fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 1 : 0;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int ss_x = plane ? img->x_chroma_shift : 0;
+    const int ss_y = plane ? img->y_chroma_shift : 0;
+    for (int y = 0; y < (int)img->d_h >> ss_y; ++y) {
+      uint8_t *const row = img->planes[plane] + y * img->stride[plane];
+      if (use_high_bit_depth) {
+        FillPixels(rnd, img->bit_depth, reinterpret_cast<uint16_t *>(row),
+                   img->d_w >> ss_x);
+      } else {
+        FillPixels(rnd, 8, row, img->d_w >> ss_x);
+      }
+    }
+  }
+}
+
+void ExpectImagesMatch(const aom_image_t &ref, const aom_image_t &tst) {
+  const int use_high_bit_depth = (ref.fmt & AOM_IMG_FMT_HIGHBITDEPTH) ? 1 : 0;
+  for (int plane = 0; plane < 3; ++plane) {
+    const int ss_x = plane ? ref.x_chroma_shift : 0;
+    const int ss_y = plane ? ref.y_chroma_shift : 0;
+    const int row_bytes = (ref.d_w >> ss_x) << use_high_bit_depth;
+    for (int y = 0; y < (int)ref.d_h >> ss_y; ++y) {
+      ASSERT_EQ(0, memcmp(ref.planes[plane] + y * ref.stride[plane],
+                          tst.planes[plane] + y * tst.stride[plane],
+                          row_bytes))
+          << "Plane " << plane << ", row " << y;
+    }
+  }
+}
+
+TEST_P(AddFilmGrainMtTest, MatchesSingleThread) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const aom_img_fmt_t fmt = ::testing::get<0>(GetParam());
+  const int bit_depth = ::testing::get<1>(GetParam());
+  for (int iter = 0; iter < 20; ++iter) {
+    const int width = 2 + 2 * rnd.PseudoUniform(150);
+    const int height = 2 + 2 * rnd.PseudoUniform(150);
+    aom_film_grain_t params;
+    RandomGrainParams(&rnd, bit_depth, &params);
+
+    aom_image_t src;
+    ASSERT_EQ(&src, aom_img_alloc(&src, fmt, width, height, 16));
+    src.bit_depth = bit_depth;
+    FillImage(&rnd, &src);
+
+    aom_image_t ref;
+    ASSERT_EQ(&ref, aom_img_alloc(&ref, fmt, width, height, 16));
+    ASSERT_EQ(0, av1_add_film_grain(&params, &src, &ref));
+
+    for (int num_workers = 1; num_workers <= kMaxWorkers; ++num_workers) {
+      SCOPED_TRACE(testing::Message() << num_workers << " workers, iter: "
+                                      << iter);
+      aom_image_t tst;
+      ASSERT_EQ(&tst, aom_img_alloc(&tst, fmt, width, height, 16));
+      ASSERT_EQ(0, av1_add_film_grain_mt(&params, &src, &tst, NULL, workers_,
+                                         num_workers));
+      ExpectImagesMatch(ref, tst);
+      aom_img_free(&tst);
+      if (HasFatalFailure()) break;
+    }
+    aom_img_free(&ref);
+    aom_img_free(&src);
+    if (HasFatalFailure()) return;
+  }
+}
+
+TEST_P(AddFilmGrainMtTest, CacheMatchesUncached) {
+  ACMRandom rnd(ACMRandom::DeterministicSeed());
+  const aom_img_fmt_t fmt = ::testing::get<0>(GetParam());
+  const int bit_depth = ::testing::get<1>(GetParam());
+  const int width = 98;
+  const int height = 66;
+  aom_film_grain_cache_t cache;
+  memset(&cache, 0, sizeof(cache));
+  aom_film_grain_t params;
+  RandomGrainParams(&rnd, bit_depth, &params);
+
+  aom_image_t src, ref, tst;
+  ASSERT_EQ(&src, aom_img_alloc(&src, fmt, width, height, 16));
+  ASSERT_EQ(&ref, aom_img_alloc(&ref, fmt, width, height, 16));
+  ASSERT_EQ(&tst, aom_img_alloc(&tst, fmt, width, height, 16));
+  src.bit_depth = bit_depth;
+
+  for (int iter = 0; iter < 40 && !HasFatalFailure(); ++iter) {
+    SCOPED_TRACE(testing::Message() << "iter: " << iter);
+    aom_film_grain_t new_params;
+    RandomGrainParams(&rnd, bit_depth, &new_params);
+    switch (rnd.PseudoUniform(4)) {
+      case 0: break;  // Same parameters as the previous frame.
+      case 1: params.random_seed = new_params.random_seed; break;
+      case 2:
+        params.num_y_points = new_params.num_y_points;
+        memcpy(params.scaling_points_y, new_params.scaling_points_y,
+               sizeof(params.scaling_points_y));
+        break;
+      default: params = new_params; break;
+    }
+    FillImage(&rnd, &src);
+    ASSERT_EQ(0, av1_add_film_grain(&params, &src, &ref));
+    ASSERT_EQ(0, av1_add_film_grain_mt(&params, &src, &tst, &cache, workers_,
+                                       1 + (iter & 1)));
+    ExpectImagesMatch(ref, tst);
+  }
+  av1_free_film_grain_cache(&cache);
+  aom_img_free(&tst);
+  aom_img_free(&ref);
+  aom_img_free(&src);
+}
+
+INSTANTIATE_TEST_CASE_P(
+    FilmGrain, AddFilmGrainMtTest,
+    ::testing::Values(make_tuple(AOM_IMG_FMT_I420, 8),
+                      make_tuple(AOM_IMG_FMT_I422, 8),
+                      make_tuple(AOM_IMG_FMT_I444, 8),
+                      make_tuple(AOM_IMG_FMT_I42016, 10),
+                      make_tuple(AOM_IMG_FMT_I44416, 12)));
+}  // namespace
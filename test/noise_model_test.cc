@@ -15,6 +15,7 @@
 
 #include "aom_dsp/noise_model.h"
 #include "aom_dsp/noise_util.h"
+#include "aom_util/aom_thread.h"
 #include "config/aom_dsp_rtcd.h"
 #include "test/acm_random.h"
 #include "third_party/googletest/src/googletest/include/gtest/gtest.h"
@@ -111,6 +112,36 @@ std::vector<float> get_noise_psd(double *noise, int width, int height,
   return psd;
 }
 
+// Worker threads for the multi-threaded variants of the denoiser.
+struct TestWorkers {
+  static const int kMaxWorkers = 4;
+
+  TestWorkers() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kMaxWorkers; ++i) {
+      winterface->init(&workers[i]);
+      EXPECT_TRUE(winterface->reset(&workers[i]));
+    }
+  }
+
+  ~TestWorkers() {
+    const AVxWorkerInterface *const winterface = aom_get_worker_interface();
+    for (int i = 0; i < kMaxWorkers; ++i) winterface->end(&workers[i]);
+  }
+
+  AVxWorker workers[kMaxWorkers];
+};
+
+void ExpectEquationSystemsEqual(const aom_equation_system_t &ref,
+                                const aom_equation_system_t &tst) {
+  ASSERT_EQ(ref.n, tst.n);
+  for (int i = 0; i < ref.n * ref.n; ++i) EXPECT_EQ(ref.A[i], tst.A[i]);
+  for (int i = 0; i < ref.n; ++i) {
+    EXPECT_EQ(ref.b[i], tst.b[i]);
+    EXPECT_EQ(ref.x[i], tst.x[i]);
+  }
+}
+
 }  // namespace
 
 TEST(NoiseStrengthSolver, GetCentersTwoBins) {
@@ -494,8 +525,53 @@ TYPED_TEST_P(FlatBlockEstimatorTest, FindFlatBlocks) {
   aom_flat_block_finder_free(&flat_block_finder);
 }
 
+TYPED_TEST_P(FlatBlockEstimatorTest, FindFlatBlocksMt) {
+  const int kBlockSize = 32;
+  aom_flat_block_finder_t flat_block_finder;
+  ASSERT_EQ(1, aom_flat_block_finder_init(&flat_block_finder, kBlockSize,
+                                          this->kBitDepth, this->kUseHighBD));
+
+  const int num_blocks_w = 6;
+  const int num_blocks_h = 7;
+  const int w = kBlockSize * num_blocks_w - 5;
+  const int h = kBlockSize * num_blocks_h - 9;
+  const int stride = w + 3;
+  this->data_.resize(h * stride, 0);
+
+  // Blocks with a mix of low and high noise levels, so that some are flat by
+  // threshold and some are only picked by score.
+  const int shift = this->kBitDepth - 8;
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const int block = (y / kBlockSize) * num_blocks_w + x / kBlockSize;
+      const double sigma = 0.5 + (block % 5);
+      this->data_[y * stride + x] =
+          ((uint8_t)(128 + x / 8 + randn(&this->random_, sigma))) << shift;
+    }
+  }
+
+  std::vector<uint8_t> ref_flat_blocks(num_blocks_w * num_blocks_h, 0);
+  const int ref_num_flat = aom_flat_block_finder_run(
+      &flat_block_finder, (uint8_t *)&this->data_[0], w, h, stride,
+      &ref_flat_blocks[0]);
+  EXPECT_GT(ref_num_flat, 0);
+
+  TestWorkers workers;
+  for (int num_workers = 1; num_workers <= TestWorkers::kMaxWorkers;
+       ++num_workers) {
+    std::vector<uint8_t> flat_blocks(num_blocks_w * num_blocks_h, 0);
+    EXPECT_EQ(ref_num_flat,
+              aom_flat_block_finder_run_mt(
+                  &flat_block_finder, (uint8_t *)&this->data_[0], w, h,
+                  stride, &flat_blocks[0], workers.workers, num_workers));
+    EXPECT_EQ(ref_flat_blocks, flat_blocks) << num_workers << " workers";
+  }
+
+  aom_flat_block_finder_free(&flat_block_finder);
+}
+
 REGISTER_TYPED_TEST_CASE_P(FlatBlockEstimatorTest, ExtractBlock,
-                           FindFlatBlocks);
+                           FindFlatBlocks, FindFlatBlocksMt);
 
 typedef ::testing::Types<BitDepthParams<uint8_t, 8, false>,   // lowbd
                          BitDepthParams<uint16_t, 8, true>,   // lowbd in 16-bit
@@ -546,6 +622,14 @@ class NoiseModelUpdateTest : public ::testing::Test, public T {
                                   &flat_blocks_[0], block_size);
   }
 
+  int NoiseModelUpdateMt(aom_noise_model_t *model, AVxWorker *workers,
+                         int num_workers) {
+    return aom_noise_model_update_mt(model, data_ptr_raw_, denoised_ptr_raw_,
+                                     kWidth, kHeight, strides_, chroma_sub_,
+                                     &flat_blocks_[0], kBlockSize, workers,
+                                     num_workers);
+  }
+
   void TearDown() { aom_noise_model_free(&model_); }
 
  protected:
@@ -929,6 +1013,48 @@ TYPED_TEST_P(NoiseModelUpdateTest, NoiseCoeffsSignalsDifferentNoiseType) {
   }
   EXPECT_EQ(AOM_NOISE_STATUS_DIFFERENT_NOISE_TYPE, this->NoiseModelUpdate());
 }
+
+TYPED_TEST_P(NoiseModelUpdateTest, UpdateMtMatchesSingleThread) {
+  const int kWidth = this->kWidth;
+  const int kHeight = this->kHeight;
+  const int shift = this->kBitDepth - 8;
+  for (int c = 0; c < 3; ++c) {
+    for (int y = 0; y < kHeight; ++y) {
+      for (int x = 0; x < kWidth; ++x) {
+        this->data_ptr_[c][y * kWidth + x] =
+            int(64 + y + randn(&this->random_, 1 + c)) << shift;
+        this->denoised_ptr_[c][y * kWidth + x] = (64 + y) << shift;
+      }
+    }
+  }
+  for (size_t i = 0; i < this->flat_blocks_.size(); ++i) {
+    this->flat_blocks_[i] = (i % 3) != 1;
+  }
+  const int ref_status = this->NoiseModelUpdateMt(&this->model_, NULL, 0);
+  EXPECT_EQ(AOM_NOISE_STATUS_OK, ref_status);
+
+  TestWorkers workers;
+  for (int num_workers = 1; num_workers <= TestWorkers::kMaxWorkers;
+       ++num_workers) {
+    SCOPED_TRACE(testing::Message() << num_workers << " workers");
+    aom_noise_model_t model;
+    ASSERT_TRUE(aom_noise_model_init(&model, this->model_.params));
+    EXPECT_EQ(ref_status,
+              this->NoiseModelUpdateMt(&model, workers.workers, num_workers));
+    for (int c = 0; c < 3; ++c) {
+      const aom_noise_state_t &ref = this->model_.latest_state[c];
+      const aom_noise_state_t &tst = model.latest_state[c];
+      EXPECT_EQ(ref.num_observations, tst.num_observations);
+      ExpectEquationSystemsEqual(ref.eqns, tst.eqns);
+      ExpectEquationSystemsEqual(ref.strength_solver.eqns,
+                                 tst.strength_solver.eqns);
+      ExpectEquationSystemsEqual(this->model_.combined_state[c].eqns,
+                                 model.combined_state[c].eqns);
+    }
+    aom_noise_model_free(&model);
+  }
+}
+
 REGISTER_TYPED_TEST_CASE_P(NoiseModelUpdateTest, UpdateFailsNoFlatBlocks,
                            UpdateSuccessForZeroNoiseAllFlat,
                            UpdateFailsBlockSizeTooSmall,
@@ -936,7 +1062,8 @@ REGISTER_TYPED_TEST_CASE_P(NoiseModelUpdateTest, UpdateFailsNoFlatBlocks,
                            UpdateSuccessForScaledWhiteNoise,
                            UpdateSuccessForCorrelatedNoise,
                            NoiseStrengthChangeSignalsDifferentNoiseType,
-                           NoiseCoeffsSignalsDifferentNoiseType);
+                           NoiseCoeffsSignalsDifferentNoiseType,
+                           UpdateMtMatchesSingleThread);
 
 INSTANTIATE_TYPED_TEST_CASE_P(NoiseModelUpdateTestInstatiation,
                               NoiseModelUpdateTest, AllBitDepthParams);
@@ -1336,8 +1463,152 @@ TYPED_TEST_P(WienerDenoiseTest, GradientTest) {
   }
 }
 
+TYPED_TEST_P(WienerDenoiseTest, MtMatchesSingleThread) {
+  const int kWidth = this->kWidth;
+  const int kHeight = this->kHeight;
+  const uint8_t *const data_ptrs[3] = {
+    reinterpret_cast<uint8_t *>(&this->data_[0][0]),
+    reinterpret_cast<uint8_t *>(&this->data_[1][0]),
+    reinterpret_cast<uint8_t *>(&this->data_[2][0]),
+  };
+  uint8_t *denoised_ptrs[3] = {
+    reinterpret_cast<uint8_t *>(&this->denoised_[0][0]),
+    reinterpret_cast<uint8_t *>(&this->denoised_[1][0]),
+    reinterpret_cast<uint8_t *>(&this->denoised_[2][0]),
+  };
+  // Use a size that is not a multiple of the block size.
+  const int w = kWidth - 38;
+  const int h = kHeight - 70;
+  ASSERT_EQ(1, aom_wiener_denoise_2d(data_ptrs, denoised_ptrs, w, h,
+                                     this->stride_, this->chroma_sub_,
+                                     this->noise_psd_ptrs_, this->kBlockSize,
+                                     this->kBitDepth, this->kUseHighBD));
+
+  TestWorkers workers;
+  for (int num_workers = 1; num_workers <= TestWorkers::kMaxWorkers;
+       ++num_workers) {
+    std::vector<typename TypeParam::data_type_t> denoised[3];
+    uint8_t *denoised_mt_ptrs[3];
+    for (int c = 0; c < 3; ++c) {
+      denoised[c].resize(kWidth * kHeight);
+      denoised_mt_ptrs[c] = reinterpret_cast<uint8_t *>(&denoised[c][0]);
+    }
+    ASSERT_EQ(1, aom_wiener_denoise_2d_mt(
+                     data_ptrs, denoised_mt_ptrs, w, h, this->stride_,
+                     this->chroma_sub_, this->noise_psd_ptrs_,
+                     this->kBlockSize, this->kBitDepth, this->kUseHighBD,
+                     workers.workers, num_workers));
+    for (int c = 0; c < 3; ++c) {
+      EXPECT_EQ(this->denoised_[c], denoised[c])
+          << "plane " << c << ", " << num_workers << " workers";
+    }
+  }
+}
+
 REGISTER_TYPED_TEST_CASE_P(WienerDenoiseTest, InvalidBlockSize,
-                           InvalidChromaSubsampling, GradientTest);
+                           InvalidChromaSubsampling, GradientTest,
+                           MtMatchesSingleThread);
 
 INSTANTIATE_TYPED_TEST_CASE_P(WienerDenoiseTestInstatiation, WienerDenoiseTest,
                               AllBitDepthParams);
+
+typedef void (*WienerFilterFunc)(float *tx_block, const float *psd, int n);
+
+class NoiseTxWienerFilterTest
+    : public ::testing::TestWithParam<WienerFilterFunc> {};
+
+TEST_P(NoiseTxWienerFilterTest, MatchesC) {
+  const int kMaxCoeffs = 32 * 32;
+  const float kScales[3] = { 1e-3f, 1e-1f, 1.f };
+  libaom_test::ACMRandom random;
+  std::vector<float> psd(kMaxCoeffs);
+  std::vector<float> ref(2 * kMaxCoeffs);
+  std::vector<float> tst(2 * kMaxCoeffs);
+  for (int iter = 0; iter < 100; ++iter) {
+    const int n = 1 + random.PseudoUniform(kMaxCoeffs);
+    // Mix coefficients well above and below the noise level, along with some
+    // that are close to the power threshold.
+    for (int i = 0; i < n; ++i) {
+      psd[i] = (float)random.PseudoUniform(1000) * 1e-5f;
+      for (int j = 0; j < 2; ++j) {
+        ref[2 * i + j] =
+            (float)randn(&random, 1) * kScales[random.PseudoUniform(3)];
+      }
+    }
+    tst = ref;
+    aom_noise_tx_wiener_filter_c(&ref[0], &psd[0], n);
+    GetParam()(&tst[0], &psd[0], n);
+    for (int i = 0; i < 2 * n; ++i) {
+      ASSERT_EQ(ref[i], tst[i]) << "iter " << iter << ", index " << i;
+    }
+  }
+}
+
+TEST_P(NoiseTxWienerFilterTest, ThresholdsMatchC) {
+  const int kSteps = 64;
+  std::vector<float> psd(2 * kSteps);
+  std::vector<float> ref(4 * kSteps);
+  // Sweep the power over the minimum power threshold, with no noise. The
+  // squares of consecutive c0 are two steps apart, so every other imaginary
+  // part adds a single step to fill in the powers between them.
+  const float kHalfStep = sqrtf(ldexpf(1.f, -43));
+  float c0 = sqrtf(1e-6f);
+  for (int i = 0; i < kSteps / 4; ++i) c0 = nextafterf(c0, 0.f);
+  for (int i = 0; i < kSteps; ++i) {
+    if (i % 2 == 0) c0 = nextafterf(c0, 1.f);
+    psd[i] = 0;
+    ref[2 * i] = c0;
+    ref[2 * i + 1] = (i % 2) ? kHalfStep : 0;
+  }
+  // Sweep the scaled noise power over a fixed power of 1.
+  float noise = 1.f / 1.1f;
+  for (int i = 0; i < kSteps / 2; ++i) noise = nextafterf(noise, 0.f);
+  for (int i = kSteps; i < 2 * kSteps; ++i, noise = nextafterf(noise, 1.f)) {
+    psd[i] = noise;
+    ref[2 * i] = 1.f;
+    ref[2 * i + 1] = 0;
+  }
+  std::vector<float> tst(ref);
+  aom_noise_tx_wiener_filter_c(&ref[0], &psd[0], 2 * kSteps);
+  GetParam()(&tst[0], &psd[0], 2 * kSteps);
+  for (int i = 0; i < 4 * kSteps; ++i) {
+    ASSERT_EQ(ref[i], tst[i]) << "index " << i;
+  }
+}
+
+typedef void (*PointwiseMultiplyFunc)(const float *a, float *b, int n);
+
+class NoisePointwiseMultiplyTest
+    : public ::testing::TestWithParam<PointwiseMultiplyFunc> {};
+
+TEST_P(NoisePointwiseMultiplyTest, MatchesC) {
+  const int kMaxSize = 32 * 32;
+  libaom_test::ACMRandom random;
+  std::vector<float> a(kMaxSize);
+  std::vector<float> ref(kMaxSize);
+  for (int iter = 0; iter < 100; ++iter) {
+    const int n = 1 + random.PseudoUniform(kMaxSize);
+    for (int i = 0; i < n; ++i) {
+      a[i] = (float)randn(&random, 1);
+      ref[i] = (float)randn(&random, 100);
+    }
+    std::vector<float> tst(ref);
+    aom_noise_pointwise_multiply_c(&a[0], &ref[0], n);
+    GetParam()(&a[0], &tst[0], n);
+    for (int i = 0; i < n; ++i) {
+      ASSERT_EQ(ref[i], tst[i]) << "iter " << iter << ", index " << i;
+    }
+  }
+}
+
+INSTANTIATE_TEST_CASE_P(C, NoiseTxWienerFilterTest,
+                        ::testing::Values(aom_noise_tx_wiener_filter_c));
+INSTANTIATE_TEST_CASE_P(C, NoisePointwiseMultiplyTest,
+                        ::testing::Values(aom_noise_pointwise_multiply_c));
+
+#if HAVE_AVX2
+INSTANTIATE_TEST_CASE_P(AVX2, NoiseTxWienerFilterTest,
+                        ::testing::Values(aom_noise_tx_wiener_filter_avx2));
+INSTANTIATE_TEST_CASE_P(AVX2, NoisePointwiseMultiplyTest,
+                        ::testing::Values(aom_noise_pointwise_multiply_avx2));
+#endif  // HAVE_AVX2
@@ -84,9 +84,11 @@ list(APPEND AOM_UNIT_TEST_ENCODER_SOURCES
 
 list(APPEND AOM_DECODE_PERF_TEST_SOURCES "${AOM_ROOT}/test/decode_perf_test.cc")
 list(APPEND AOM_ENCODE_PERF_TEST_SOURCES "${AOM_ROOT}/test/encode_perf_test.cc")
+list(APPEND AOM_CODEC_PERF_TEST_SOURCES "${AOM_ROOT}/test/codec_perf_test.cc")
 list(APPEND AOM_UNIT_TEST_WEBM_SOURCES "${AOM_ROOT}/test/webm_video_source.h")
 list(APPEND AOM_TEST_INTRA_PRED_SPEED_SOURCES "${AOM_GEN_SRC_DIR}/usage_exit.c"
             "${AOM_ROOT}/test/test_intra_pred_speed.cc")
+list(APPEND AOM_RTCD_PERF_TEST_SOURCES "${AOM_ROOT}/test/test_rtcd_speed.cc")
 
 if(NOT BUILD_SHARED_LIBS)
   list(APPEND AOM_UNIT_TEST_COMMON_SOURCES
@@ -124,6 +126,7 @@ if(NOT BUILD_SHARED_LIBS)
                 "${AOM_ROOT}/test/ec_test.cc"
                 "${AOM_ROOT}/test/ethread_test.cc"
                 "${AOM_ROOT}/test/film_grain_table_test.cc"
+                "${AOM_ROOT}/test/grain_synthesis_test.cc"
                 "${AOM_ROOT}/test/segment_binarization_sync.cc"
                 "${AOM_ROOT}/test/superframe_test.cc"
                 "${AOM_ROOT}/test/tile_independence_test.cc"
@@ -227,6 +230,7 @@ if(NOT BUILD_SHARED_LIBS)
     list(APPEND AOM_UNIT_TEST_ENCODER_SOURCES
                 "${AOM_ROOT}/test/av1_convolve_scale_test.cc"
                 "${AOM_ROOT}/test/av1_horz_only_frame_superres_test.cc"
+                "${AOM_ROOT}/test/av1_resize_down2_test.cc"
                 "${AOM_ROOT}/test/intra_edge_test.cc")
 
   endif()
@@ -317,9 +321,25 @@ function(setup_aom_test_targets)
       target_link_libraries(test_intra_pred_speed ${AOM_LIB_LINK_TYPE} aom
                             aom_gtest)
       list(APPEND AOM_APP_TARGETS test_intra_pred_speed)
+
+      add_rtcd_bench_build_step("${AOM_ROOT}/aom_dsp/aom_dsp_rtcd_defs.pl"
+                                "${AOM_CONFIG_DIR}/config/aom_dsp_rtcd_bench.h"
+                                "${AOM_RTCD_PERF_TEST_SOURCES}")
+      add_rtcd_bench_build_step("${AOM_ROOT}/av1/common/av1_rtcd_defs.pl"
+                                "${AOM_CONFIG_DIR}/config/av1_rtcd_bench.h"
+                                "${AOM_RTCD_PERF_TEST_SOURCES}")
+      add_executable(test_rtcd_speed ${AOM_RTCD_PERF_TEST_SOURCES})
+      target_link_libraries(test_rtcd_speed ${AOM_LIB_LINK_TYPE} aom aom_gtest)
+      list(APPEND AOM_APP_TARGETS test_rtcd_speed)
     endif()
   endif()
 
+  if(CONFIG_AV1_ENCODER AND CONFIG_AV1_DECODER)
+    add_executable(test_codec_perf ${AOM_CODEC_PERF_TEST_SOURCES})
+    target_link_libraries(test_codec_perf ${AOM_LIB_LINK_TYPE} aom aom_gtest)
+    list(APPEND AOM_APP_TARGETS test_codec_perf)
+  endif()
+
   target_link_libraries(test_libaom ${AOM_LIB_LINK_TYPE} aom aom_gtest)
 
   if(CONFIG_LIBYUV)
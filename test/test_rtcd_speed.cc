@@ -0,0 +1,1350 @@
+/*
+ * Copyright (c) 2019, Alliance for Open Media. All rights reserved
+ *
+ * This source code is subject to the terms of the BSD 2 Clause License and
+ * the Alliance for Open Media Patent License 1.0. If the BSD 2 Clause License
+ * was not distributed with this source code in the LICENSE file, you can
+ * obtain it at www.aomedia.org/license/software. If the Alliance for Open
+ * Media Patent License 1.0 was not distributed with this source code in the
+ * PATENTS file, you can obtain it at www.aomedia.org/license/patent.
+ */
+
+// Micro-benchmark of the rtcd functions, built as test_rtcd_speed.
+//
+// The functions and their variants come from the tables that rtcd.pl --bench
+// generates from aom_dsp_rtcd_defs.pl and av1_rtcd_defs.pl, so every function
+// added to the definitions is picked up without changes here. A function is
+// timed by the runner registered for its argument types; the block size and
+// bit depth are taken from its name. Functions with an argument list that has
+// no runner are listed at the end as coverage gaps.
+//
+// Each variant the CPU supports is timed over enough calls to take about a
+// millisecond, best of kRepeats, and reported per pixel (in TSC cycles on x86,
+// nanoseconds elsewhere) together with its speedup over the C version.
+//
+// Usage: test_rtcd_speed [--filter=<substring>] [--verbose]
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "config/aom_config.h"
+#include "config/aom_dsp_rtcd.h"
+#include "config/av1_rtcd.h"
+
+#include "test/acm_random.h"
+#include "test/clear_system_state.h"
+#include "aom/aom_integer.h"
+#include "aom_dsp/aom_dsp_common.h"
+#include "aom_mem/aom_mem.h"
+#include "aom_ports/aom_timer.h"
+#include "aom_ports/mem.h"
+#if ARCH_X86 || ARCH_X86_64
+#include "aom_ports/x86.h"
+#elif ARCH_ARM
+#include "aom_ports/arm.h"
+#endif
+#include "av1/common/common_data.h"
+#include "av1/common/convolve.h"
+#include "av1/common/filter.h"
+
+namespace {
+
+typedef void (*GenericFn)(void);
+
+struct Variant {
+  Variant(const char *arch_name, GenericFn function)
+      : arch(arch_name), fn(function) {}
+  const char *arch;
+  GenericFn fn;
+};
+
+struct Function {
+  Function(const char *function_name, const char *return_type,
+           const char *arguments)
+      : name(function_name), ret(return_type), args(arguments) {}
+  const char *name;
+  const char *ret;
+  const char *args;
+  std::vector<Variant> variants;
+};
+
+#define RTCD_BENCH_FUNCTION(fn, ret, args) \
+  functions->push_back(Function(#fn, ret, args));
+#define RTCD_BENCH_VARIANT(fn, arch)   \
+  functions->back().variants.push_back( \
+      Variant(#arch, reinterpret_cast<GenericFn>(fn##_##arch)));
+
+void AddFunctions(std::vector<Function> *functions) {
+#include "config/aom_dsp_rtcd_bench.h"
+#include "config/av1_rtcd_bench.h"
+}
+
+#undef RTCD_BENCH_FUNCTION
+#undef RTCD_BENCH_VARIANT
+
+// The frame buffers are kStride x kStride pixels and the blocks start
+// kBorder rows and columns in, so that filters may read around the largest
+// block.
+const int kStride = 512;
+const int kBorder = 64;
+const int kFrameSize = kStride * kStride;
+const int kBlockOffset = kBorder * kStride + kBorder;
+const int kMaxBlockSize = 128 * 128;
+const int kEdgeSize = 1024;
+
+const int kSubpelOffset = 3;
+const int kRepeats = 3;
+const int kMaxIterations = 1 << 24;
+#if ARCH_X86 || ARCH_X86_64
+const char kUnit[] = "cycles/px";
+const uint64_t kMinTicks = 2000000;
+#else
+const char kUnit[] = "ns/px";
+const uint64_t kMinTicks = 1000000;
+#endif
+
+// The arguments of one function call. The pixel pointers of high bitdepth
+// functions that take uint8_t pointers are CONVERT_TO_BYTEPTR() pointers to
+// 16-bit pixels, as in the rest of the codec.
+struct BenchArgs {
+  int width;
+  int height;
+  int bd;
+  bool compound;
+  int dir_dx;
+  int dir_dy;
+  TX_SIZE tx_size;
+  uint8_t *src;
+  uint8_t *ref;
+  uint8_t *dst;
+  uint8_t *pred;
+  uint16_t *src16;
+  uint16_t *dst16;
+  const uint8_t *above;
+  const uint8_t *left;
+  const uint16_t *above16;
+  const uint16_t *left16;
+  uint8_t *mask;
+  int16_t *diff;
+  int16_t *diff2;
+  tran_low_t *coeff;
+  tran_low_t *qcoeff;
+  tran_low_t *dqcoeff;
+  int32_t *coeff32;
+  int32_t *out32;
+  int32_t *wsrc;
+  int32_t *obmc_mask;
+  float *fin;
+  float *ftemp;
+  float *fout;
+  CONV_BUF_TYPE *conv;
+};
+
+template <typename T>
+T *AllocBuffer(int size, std::vector<void *> *allocations) {
+  T *const buf = static_cast<T *>(aom_memalign(64, size * sizeof(T)));
+  if (buf == NULL) {
+    fprintf(stderr, "Failed to allocate the benchmark buffers.\n");
+    exit(EXIT_FAILURE);
+  }
+  allocations->push_back(buf);
+  return buf;
+}
+
+// Owns the buffers behind the BenchArgs of all the functions.
+class BenchBuffers {
+ public:
+  BenchBuffers() {
+    libaom_test::ACMRandom rnd(libaom_test::ACMRandom::DeterministicSeed());
+    src8_ = AllocBuffer<uint8_t>(kFrameSize, &allocations_);
+    ref8_ = AllocBuffer<uint8_t>(kFrameSize, &allocations_);
+    dst8_ = AllocBuffer<uint8_t>(kFrameSize, &allocations_);
+    pred8_ = AllocBuffer<uint8_t>(kFrameSize, &allocations_);
+    src16_ = AllocBuffer<uint16_t>(kFrameSize, &allocations_);
+    ref16_ = AllocBuffer<uint16_t>(kFrameSize, &allocations_);
+    dst16_ = AllocBuffer<uint16_t>(kFrameSize, &allocations_);
+    pred16_ = AllocBuffer<uint16_t>(kFrameSize, &allocations_);
+    edge8_ = AllocBuffer<uint8_t>(2 * kEdgeSize, &allocations_);
+    edge16_ = AllocBuffer<uint16_t>(2 * kEdgeSize, &allocations_);
+    mask_ = AllocBuffer<uint8_t>(kFrameSize, &allocations_);
+    diff_ = AllocBuffer<int16_t>(kFrameSize, &allocations_);
+    diff2_ = AllocBuffer<int16_t>(kFrameSize, &allocations_);
+    coeff_ = AllocBuffer<tran_low_t>(kMaxBlockSize, &allocations_);
+    qcoeff_ = AllocBuffer<tran_low_t>(kMaxBlockSize, &allocations_);
+    dqcoeff_ = AllocBuffer<tran_low_t>(kMaxBlockSize, &allocations_);
+    coeff32_ = AllocBuffer<int32_t>(kMaxBlockSize, &allocations_);
+    out32_ = AllocBuffer<int32_t>(kMaxBlockSize, &allocations_);
+    wsrc_ = AllocBuffer<int32_t>(kMaxBlockSize, &allocations_);
+    obmc_mask_ = AllocBuffer<int32_t>(kMaxBlockSize, &allocations_);
+    fin_ = AllocBuffer<float>(4 * kMaxBlockSize, &allocations_);
+    ftemp_ = AllocBuffer<float>(4 * kMaxBlockSize, &allocations_);
+    fout_ = AllocBuffer<float>(4 * kMaxBlockSize, &allocations_);
+    conv_ = AllocBuffer<CONV_BUF_TYPE>(kFrameSize, &allocations_);
+
+    for (int i = 0; i < kFrameSize; ++i) {
+      src8_[i] = rnd.Rand8();
+      ref8_[i] = rnd.Rand8();
+      dst8_[i] = rnd.Rand8();
+      pred8_[i] = rnd.Rand8();
+      src16_[i] = rnd.Rand16() & 1023;
+      ref16_[i] = rnd.Rand16() & 1023;
+      dst16_[i] = rnd.Rand16() & 1023;
+      pred16_[i] = rnd.Rand16() & 1023;
+      mask_[i] = rnd(65);
+      diff_[i] = rnd(511) - 255;
+      diff2_[i] = rnd(511) - 255;
+      conv_[i] = rnd.Rand16() & 0x3fff;
+    }
+    for (int i = 0; i < 2 * kEdgeSize; ++i) {
+      edge8_[i] = rnd.Rand8();
+      edge16_[i] = rnd.Rand16() & 1023;
+    }
+    for (int i = 0; i < kMaxBlockSize; ++i) {
+      coeff_[i] = rnd(129) - 64;
+      qcoeff_[i] = rnd(129) - 64;
+      dqcoeff_[i] = rnd(129) - 64;
+      coeff32_[i] = rnd(129) - 64;
+      wsrc_[i] = rnd(256 << 12);
+      obmc_mask_[i] = rnd(4097);
+    }
+    for (int i = 0; i < 4 * kMaxBlockSize; ++i) {
+      fin_[i] = static_cast<float>(rnd(2001) - 1000) / 1000.0f;
+      ftemp_[i] = fout_[i] = 0.0f;
+    }
+  }
+
+  ~BenchBuffers() {
+    for (size_t i = 0; i < allocations_.size(); ++i) aom_free(allocations_[i]);
+  }
+
+  void SetUpArgs(bool highbd, BenchArgs *args) const {
+    args->src16 = src16_ + kBlockOffset;
+    args->dst16 = dst16_ + kBlockOffset;
+    if (highbd) {
+      args->src = CONVERT_TO_BYTEPTR(src16_ + kBlockOffset);
+      args->ref = CONVERT_TO_BYTEPTR(ref16_ + kBlockOffset);
+      args->dst = CONVERT_TO_BYTEPTR(dst16_ + kBlockOffset);
+      args->pred = CONVERT_TO_BYTEPTR(pred16_);
+    } else {
+      args->src = src8_ + kBlockOffset;
+      args->ref = ref8_ + kBlockOffset;
+      args->dst = dst8_ + kBlockOffset;
+      args->pred = pred8_;
+    }
+    args->above = edge8_ + kBorder;
+    args->left = edge8_ + kEdgeSize + kBorder;
+    args->above16 = edge16_ + kBorder;
+    args->left16 = edge16_ + kEdgeSize + kBorder;
+    args->mask = mask_;
+    args->diff = diff_;
+    args->diff2 = diff2_;
+    args->coeff = coeff_;
+    args->qcoeff = qcoeff_;
+    args->dqcoeff = dqcoeff_;
+    args->coeff32 = coeff32_;
+    args->out32 = out32_;
+    args->wsrc = wsrc_;
+    args->obmc_mask = obmc_mask_;
+    args->fin = fin_;
+    args->ftemp = ftemp_;
+    args->fout = fout_;
+    args->conv = conv_;
+  }
+
+ private:
+  std::vector<void *> allocations_;
+  uint8_t *src8_;
+  uint8_t *ref8_;
+  uint8_t *dst8_;
+  uint8_t *pred8_;
+  uint16_t *src16_;
+  uint16_t *ref16_;
+  uint16_t *dst16_;
+  uint16_t *pred16_;
+  uint8_t *edge8_;
+  uint16_t *edge16_;
+  uint8_t *mask_;
+  int16_t *diff_;
+  int16_t *diff2_;
+  tran_low_t *coeff_;
+  tran_low_t *qcoeff_;
+  tran_low_t *dqcoeff_;
+  int32_t *coeff32_;
+  int32_t *out32_;
+  int32_t *wsrc_;
+  int32_t *obmc_mask_;
+  float *fin_;
+  float *ftemp_;
+  float *fout_;
+  CONV_BUF_TYPE *conv_;
+};
+
+// -----------------------------------------------------------------------------
+// Runners. Each one calls a function with one argument list |iterations|
+// times.
+
+typedef void (*RunFn)(GenericFn fn, const BenchArgs &a, int iterations);
+
+DECLARE_ALIGNED(16, const int16_t, kFilter8[8]) = { 0, 2,  -6, 126,
+                                                    8, -2, 0,  0 };
+
+const DIST_WTD_COMP_PARAMS kDistWtdParams = { 1, 9, 7 };
+
+void RunIntraPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, ptrdiff_t, const uint8_t *, const uint8_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.dst, kStride, a.above, a.left);
+}
+
+void RunHighbdIntraPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint16_t *, ptrdiff_t, const uint16_t *, const uint16_t *,
+                     int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst16, kStride, a.above16, a.left16, a.bd);
+  }
+}
+
+void RunDirPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, ptrdiff_t, int, int, const uint8_t *,
+                     const uint8_t *, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.width, a.height, a.above, a.left, 0, a.dir_dx,
+      a.dir_dy);
+  }
+}
+
+void RunHighbdDirPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint16_t *, ptrdiff_t, int, int, const uint16_t *,
+                     const uint16_t *, int, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst16, kStride, a.width, a.height, a.above16, a.left16, 0, a.dir_dx,
+      a.dir_dy, a.bd);
+  }
+}
+
+void RunDirPredZ2(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, ptrdiff_t, int, int, const uint8_t *,
+                     const uint8_t *, int, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.width, a.height, a.above, a.left, 0, 0, 64, 64);
+  }
+}
+
+void RunHighbdDirPredZ2(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint16_t *, ptrdiff_t, int, int, const uint16_t *,
+                     const uint16_t *, int, int, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst16, kStride, a.width, a.height, a.above16, a.left16, 0, 0, 64, 64,
+      a.bd);
+  }
+}
+
+void RunSad(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.src, kStride, a.ref, kStride);
+}
+
+void RunSadAvg(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             const uint8_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, a.pred);
+  }
+}
+
+void RunDistWtdSadAvg(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             const uint8_t *, const DIST_WTD_COMP_PARAMS *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, a.pred, &kDistWtdParams);
+  }
+}
+
+void RunSad4d(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *const[], int,
+                     uint32_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const uint8_t *const refs[4] = { a.ref, a.ref + 1, a.ref + 2, a.ref + 3 };
+  uint32_t sads[4];
+  for (int i = 0; i < iterations; ++i) f(a.src, kStride, refs, kStride, sads);
+}
+
+void RunSadWxh(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int, int,
+                             int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, a.width, a.height);
+  }
+}
+
+void RunMaskedSad(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             const uint8_t *, const uint8_t *, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, a.pred, a.mask, kStride, 0);
+  }
+}
+
+void RunObmcSad(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const int32_t *,
+                             const int32_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, a.wsrc, a.obmc_mask);
+  }
+}
+
+void RunVariance(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                             unsigned int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  unsigned int sse;
+  for (int i = 0; i < iterations; ++i) f(a.src, kStride, a.ref, kStride, &sse);
+}
+
+void RunGetVar(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *, int,
+                     unsigned int *, int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  unsigned int sse;
+  int sum;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, &sse, &sum);
+  }
+}
+
+void RunSubpelVariance(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef uint32_t (*Fn)(const uint8_t *, int, int, int, const uint8_t *, int,
+                         uint32_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  uint32_t sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, kSubpelOffset, kSubpelOffset, a.src, kStride, &sse);
+  }
+}
+
+void RunSubpelAvgVariance(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef uint32_t (*Fn)(const uint8_t *, int, int, int, const uint8_t *, int,
+                         uint32_t *, const uint8_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  uint32_t sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, kSubpelOffset, kSubpelOffset, a.src, kStride, &sse,
+      a.pred);
+  }
+}
+
+void RunDistWtdSubpelAvgVariance(GenericFn fn, const BenchArgs &a,
+                                 int iterations) {
+  typedef uint32_t (*Fn)(const uint8_t *, int, int, int, const uint8_t *, int,
+                         uint32_t *, const uint8_t *,
+                         const DIST_WTD_COMP_PARAMS *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  uint32_t sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, kSubpelOffset, kSubpelOffset, a.src, kStride, &sse,
+      a.pred, &kDistWtdParams);
+  }
+}
+
+void RunMaskedSubpelVariance(GenericFn fn, const BenchArgs &a,
+                             int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, int, int, const uint8_t *,
+                             int, const uint8_t *, const uint8_t *, int, int,
+                             unsigned int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  unsigned int sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, kSubpelOffset, kSubpelOffset, a.src, kStride, a.pred,
+      a.mask, kStride, 0, &sse);
+  }
+}
+
+void RunObmcVariance(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, const int32_t *,
+                             const int32_t *, unsigned int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  unsigned int sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, a.wsrc, a.obmc_mask, &sse);
+  }
+}
+
+void RunObmcSubpelVariance(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int, int, int, const int32_t *,
+                             const int32_t *, unsigned int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  unsigned int sse;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.ref, kStride, kSubpelOffset, kSubpelOffset, a.wsrc, a.obmc_mask, &sse);
+  }
+}
+
+void RunSse(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int64_t (*Fn)(const uint8_t *, int, const uint8_t *, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, a.width, a.height);
+  }
+}
+
+void RunAvg(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const uint8_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.src, kStride);
+}
+
+void RunMinMax(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, int, const uint8_t *, int, int *, int *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  int min, max;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.ref, kStride, &min, &max);
+  }
+}
+
+void RunCompAvgPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, const uint8_t *, int, int, const uint8_t *,
+                     int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, a.pred, a.width, a.height, a.ref, kStride);
+  }
+}
+
+void RunCompMaskPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, const uint8_t *, int, int, const uint8_t *,
+                     int, const uint8_t *, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, a.pred, a.width, a.height, a.ref, kStride, a.mask, kStride, 0);
+  }
+}
+
+void RunDistWtdCompAvgPred(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, const uint8_t *, int, int, const uint8_t *,
+                     int, const DIST_WTD_COMP_PARAMS *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, a.pred, a.width, a.height, a.ref, kStride, &kDistWtdParams);
+  }
+}
+
+void RunFwdTxfm2d(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const int16_t *, int32_t *, int, TX_TYPE, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.diff, a.out32, kStride, DCT_DCT, a.bd);
+  }
+}
+
+void RunInvTxfm2dAdd(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const int32_t *, uint16_t *, int, TX_TYPE, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.coeff32, a.dst16, kStride, DCT_DCT, a.bd);
+  }
+}
+
+TxfmParam GetTxfmParam(const BenchArgs &a, bool highbd) {
+  TxfmParam param;
+  param.tx_type = DCT_DCT;
+  param.tx_size = a.tx_size;
+  param.lossless = 0;
+  param.bd = a.bd;
+  param.is_hbd = highbd;
+  param.tx_set_type = EXT_TX_SET_DCTONLY;
+  param.eob = AOMMIN(a.width, 32) * AOMMIN(a.height, 32);
+  return param;
+}
+
+void RunFwdTxfm(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const int16_t *, tran_low_t *, int, TxfmParam *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  TxfmParam param = GetTxfmParam(a, false);
+  for (int i = 0; i < iterations; ++i) f(a.diff, a.dqcoeff, kStride, &param);
+}
+
+void RunInvTxfmAdd(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const tran_low_t *, uint8_t *, int, const TxfmParam *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const TxfmParam param = GetTxfmParam(a, a.bd > 8);
+  for (int i = 0; i < iterations; ++i) f(a.coeff, a.dst, kStride, &param);
+}
+
+void RunFdct(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const int16_t *, tran_low_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.diff, a.dqcoeff, kStride);
+}
+
+void RunHadamard(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const int16_t *, ptrdiff_t, tran_low_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.diff, kStride, a.dqcoeff);
+}
+
+void RunFft(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const float *, float *, float *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.fin, a.ftemp, a.fout);
+}
+
+// Quantizer parameters of about qindex 100, in the order DC, AC.
+DECLARE_ALIGNED(16, const int16_t, kZbin[8]) = { 28, 34, 34, 34,
+                                                 34, 34, 34, 34 };
+DECLARE_ALIGNED(16, const int16_t, kRound[8]) = { 19, 23, 23, 23,
+                                                  23, 23, 23, 23 };
+DECLARE_ALIGNED(16, const int16_t, kQuant[8]) = { 16384, 13653, 13653, 13653,
+                                                  13653, 13653, 13653, 13653 };
+DECLARE_ALIGNED(16, const int16_t, kQuantShift[8]) = {
+  16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384
+};
+DECLARE_ALIGNED(16, const int16_t, kDequant[8]) = { 40, 48, 48, 48,
+                                                    48, 48, 48, 48 };
+
+// The identity scan, which visits the coefficients in memory order.
+const int16_t *IdentityScan() {
+  static int16_t scan[kMaxBlockSize];
+  if (scan[1] == 0) {
+    for (int i = 0; i < kMaxBlockSize; ++i) scan[i] = i;
+  }
+  return scan;
+}
+
+void RunQuantize(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const tran_low_t *, intptr_t, const int16_t *,
+                     const int16_t *, const int16_t *, const int16_t *,
+                     tran_low_t *, tran_low_t *, const int16_t *, uint16_t *,
+                     const int16_t *, const int16_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const int16_t *const scan = IdentityScan();
+  uint16_t eob;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.coeff, a.width * a.height, kZbin, kRound, kQuant, kQuantShift,
+      a.qcoeff, a.dqcoeff, kDequant, &eob, scan, scan);
+  }
+}
+
+void RunQuantizeLogScale(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const tran_low_t *, intptr_t, const int16_t *,
+                     const int16_t *, const int16_t *, const int16_t *,
+                     tran_low_t *, tran_low_t *, const int16_t *, uint16_t *,
+                     const int16_t *, const int16_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const int16_t *const scan = IdentityScan();
+  uint16_t eob;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.coeff, a.width * a.height, kZbin, kRound, kQuant, kQuantShift,
+      a.qcoeff, a.dqcoeff, kDequant, &eob, scan, scan, 0);
+  }
+}
+
+void RunBlockError(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int64_t (*Fn)(const tran_low_t *, const tran_low_t *, intptr_t,
+                        int64_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  int64_t ssz;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.coeff, a.dqcoeff, a.width * a.height, &ssz);
+  }
+}
+
+void RunHighbdBlockError(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int64_t (*Fn)(const tran_low_t *, const tran_low_t *, intptr_t,
+                        int64_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  int64_t ssz;
+  for (int i = 0; i < iterations; ++i) {
+    f(a.coeff, a.dqcoeff, a.width * a.height, &ssz, a.bd);
+  }
+}
+
+void RunSatd(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int (*Fn)(const tran_low_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.coeff, a.width * a.height);
+}
+
+void RunSubtractBlock(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(int, int, int16_t *, ptrdiff_t, const uint8_t *,
+                     ptrdiff_t, const uint8_t *, ptrdiff_t);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.height, a.width, a.diff, kStride, a.src, kStride, a.ref, kStride);
+  }
+}
+
+void RunHighbdSubtractBlock(GenericFn fn, const BenchArgs &a,
+                            int iterations) {
+  typedef void (*Fn)(int, int, int16_t *, ptrdiff_t, const uint8_t *,
+                     ptrdiff_t, const uint8_t *, ptrdiff_t, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.height, a.width, a.diff, kStride, a.src, kStride, a.ref, kStride,
+      a.bd);
+  }
+}
+
+void RunSumSquares2d(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef uint64_t (*Fn)(const int16_t *, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.diff, kStride, a.width, a.height);
+  }
+}
+
+void RunSumSquares(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef uint64_t (*Fn)(const int16_t *, uint32_t);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.diff, a.width * a.height);
+}
+
+void RunGetMbSs(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef unsigned int (*Fn)(const int16_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) f(a.diff);
+}
+
+void RunWedgeSse(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef uint64_t (*Fn)(const int16_t *, const int16_t *, const uint8_t *,
+                         int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.diff, a.diff2, a.mask, a.width * a.height);
+  }
+}
+
+void RunWedgeSign(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int8_t (*Fn)(const int16_t *, const uint8_t *, int, int64_t);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.diff, a.mask, a.width * a.height, 0);
+  }
+}
+
+void RunWedgeDeltaSquares(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(int16_t *, const int16_t *, const int16_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  int16_t *const out = reinterpret_cast<int16_t *>(a.out32);
+  for (int i = 0; i < iterations; ++i) {
+    f(out, a.diff, a.diff2, a.width * a.height);
+  }
+}
+
+// The loop filter thresholds, as in loop_filter_thresh, of a mid-range
+// filter level.
+DECLARE_ALIGNED(16, const uint8_t, kBlimit[16]) = {
+  60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60, 60
+};
+DECLARE_ALIGNED(16, const uint8_t, kLimit[16]) = {
+  10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10, 10
+};
+DECLARE_ALIGNED(16, const uint8_t, kThresh[16]) = { 4, 4, 4, 4, 4, 4, 4, 4,
+                                                    4, 4, 4, 4, 4, 4, 4, 4 };
+
+void RunLpf(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, kBlimit, kLimit, kThresh);
+  }
+}
+
+void RunLpfDual(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, const uint8_t *, const uint8_t *,
+                     const uint8_t *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, kBlimit, kLimit, kThresh, kBlimit, kLimit, kThresh);
+  }
+}
+
+void RunHighbdLpf(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint16_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst16, kStride, kBlimit, kLimit, kThresh, a.bd);
+  }
+}
+
+void RunHighbdLpfDual(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint16_t *, int, const uint8_t *, const uint8_t *,
+                     const uint8_t *, const uint8_t *, const uint8_t *,
+                     const uint8_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst16, kStride, kBlimit, kLimit, kThresh, kBlimit, kLimit, kThresh,
+      a.bd);
+  }
+}
+
+void RunConvolve8(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, ptrdiff_t, uint8_t *, ptrdiff_t,
+                     const int16_t *, int, const int16_t *, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.dst, kStride, kFilter8, 16, kFilter8, 16, a.width,
+      a.height);
+  }
+}
+
+void RunHighbdConvolve8(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, ptrdiff_t, uint8_t *, ptrdiff_t,
+                     const int16_t *, int, const int16_t *, int, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.dst, kStride, kFilter8, 16, kFilter8, 16, a.width,
+      a.height, a.bd);
+  }
+}
+
+void RunWienerConvolve(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, ptrdiff_t, uint8_t *, ptrdiff_t,
+                     const int16_t *, int, const int16_t *, int, int, int,
+                     const ConvolveParams *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const ConvolveParams conv_params = get_conv_params_wiener(a.bd);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.dst, kStride, kFilter8, 16, kFilter8, 16, a.width,
+      a.height, &conv_params);
+  }
+}
+
+// The dist_wtd functions write to the compound buffer and the others to the
+// destination. The subpel positions, in 1/16 pel, are half way between two
+// pixels.
+ConvolveParams GetAv1ConvolveParams(const BenchArgs &a) {
+  ConvolveParams conv_params =
+      get_conv_params_no_round(0, 0, a.conv, kStride, a.compound, a.bd);
+  conv_params.use_dist_wtd_comp_avg = 0;
+  conv_params.fwd_offset = kDistWtdParams.fwd_offset;
+  conv_params.bck_offset = kDistWtdParams.bck_offset;
+  return conv_params;
+}
+
+void RunAv1Convolve(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint8_t *, int, uint8_t *, int, int, int,
+                     const InterpFilterParams *, const InterpFilterParams *,
+                     const int, const int, ConvolveParams *);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const InterpFilterParams *const filter_x =
+      av1_get_interp_filter_params_with_block_size(EIGHTTAP_REGULAR, a.width);
+  const InterpFilterParams *const filter_y =
+      av1_get_interp_filter_params_with_block_size(EIGHTTAP_REGULAR, a.height);
+  ConvolveParams conv_params = GetAv1ConvolveParams(a);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src, kStride, a.dst, kStride, a.width, a.height, filter_x, filter_y, 8,
+      8, &conv_params);
+  }
+}
+
+void RunHighbdAv1Convolve(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(const uint16_t *, int, uint16_t *, int, int, int,
+                     const InterpFilterParams *, const InterpFilterParams *,
+                     const int, const int, ConvolveParams *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  const InterpFilterParams *const filter_x =
+      av1_get_interp_filter_params_with_block_size(EIGHTTAP_REGULAR, a.width);
+  const InterpFilterParams *const filter_y =
+      av1_get_interp_filter_params_with_block_size(EIGHTTAP_REGULAR, a.height);
+  ConvolveParams conv_params = GetAv1ConvolveParams(a);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.src16, kStride, a.dst16, kStride, a.width, a.height, filter_x,
+      filter_y, 8, 8, &conv_params, a.bd);
+  }
+}
+
+void RunBlendA64Mask(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                     const uint8_t *, uint32_t, const uint8_t *, uint32_t, int,
+                     int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.src, kStride, a.ref, kStride, a.mask, kStride, a.width,
+      a.height, 0, 0);
+  }
+}
+
+void RunHighbdBlendA64Mask(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                     const uint8_t *, uint32_t, const uint8_t *, uint32_t, int,
+                     int, int, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.src, kStride, a.ref, kStride, a.mask, kStride, a.width,
+      a.height, 0, 0, a.bd);
+  }
+}
+
+void RunBlendA64Mask1d(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef void (*Fn)(uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                     const uint8_t *, uint32_t, const uint8_t *, int, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.src, kStride, a.ref, kStride, a.mask, a.width,
+      a.height);
+  }
+}
+
+void RunHighbdBlendA64Mask1d(GenericFn fn, const BenchArgs &a,
+                             int iterations) {
+  typedef void (*Fn)(uint8_t *, uint32_t, const uint8_t *, uint32_t,
+                     const uint8_t *, uint32_t, const uint8_t *, int, int,
+                     int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  for (int i = 0; i < iterations; ++i) {
+    f(a.dst, kStride, a.src, kStride, a.ref, kStride, a.mask, a.width,
+      a.height, a.bd);
+  }
+}
+
+void RunCdefFindDir(GenericFn fn, const BenchArgs &a, int iterations) {
+  typedef int (*Fn)(const uint16_t *, int, int32_t *, int);
+  const Fn f = reinterpret_cast<Fn>(fn);
+  int32_t var;
+  for (int i = 0; i < iterations; ++i) f(a.src16, kStride, &var, 0);
+}
+
+// -----------------------------------------------------------------------------
+
+struct Runner {
+  // The return and argument types of the functions, as SignatureKey() gives
+  // them.
+  const char *signature;
+  RunFn run;
+  // The pixels processed per call, or 0 for the width times the height of the
+  // block.
+  int pixels;
+};
+
+const Runner kRunners[] = {
+  { "void|uint8_t*,ptrdiff_t,const uint8_t*,const uint8_t*", RunIntraPred, 0 },
+  { "void|uint16_t*,ptrdiff_t,const uint16_t*,const uint16_t*,int",
+    RunHighbdIntraPred, 0 },
+  { "void|uint8_t*,ptrdiff_t,int,int,const uint8_t*,const uint8_t*,int,int,"
+    "int",
+    RunDirPred, 0 },
+  { "void|uint16_t*,ptrdiff_t,int,int,const uint16_t*,const uint16_t*,int,int,"
+    "int,int",
+    RunHighbdDirPred, 0 },
+  { "void|uint8_t*,ptrdiff_t,int,int,const uint8_t*,const uint8_t*,int,int,"
+    "int,int",
+    RunDirPredZ2, 0 },
+  { "void|uint16_t*,ptrdiff_t,int,int,const uint16_t*,const uint16_t*,int,int,"
+    "int,int,int",
+    RunHighbdDirPredZ2, 0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int", RunSad, 0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,const uint8_t*",
+    RunSadAvg, 0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,const uint8_t*,"
+    "const DIST_WTD_COMP_PARAMS*",
+    RunDistWtdSadAvg, 0 },
+  { "void|const uint8_t*,int,const uint8_t*const[],int,uint32_t*", RunSad4d,
+    0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,int,int", RunSadWxh,
+    0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,const uint8_t*,"
+    "const uint8_t*,int,int",
+    RunMaskedSad, 0 },
+  { "unsigned int|const uint8_t*,int,const int32_t*,const int32_t*",
+    RunObmcSad, 0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,unsigned int*",
+    RunVariance, 0 },
+  { "unsigned int|const uint8_t*,int,const uint8_t*,int,uint32_t*",
+    RunVariance, 0 },
+  { "void|const uint8_t*,int,const uint8_t*,int,unsigned int*,int*", RunGetVar,
+    0 },
+  { "uint32_t|const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*",
+    RunSubpelVariance, 0 },
+  { "uint32_t|const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*,"
+    "const uint8_t*",
+    RunSubpelAvgVariance, 0 },
+  { "uint32_t|const uint8_t*,int,int,int,const uint8_t*,int,uint32_t*,"
+    "const uint8_t*,const DIST_WTD_COMP_PARAMS*",
+    RunDistWtdSubpelAvgVariance, 0 },
+  { "unsigned int|const uint8_t*,int,int,int,const uint8_t*,int,"
+    "const uint8_t*,const uint8_t*,int,int,unsigned int*",
+    RunMaskedSubpelVariance, 0 },
+  { "unsigned int|const uint8_t*,int,const int32_t*,const int32_t*,"
+    "unsigned int*",
+    RunObmcVariance, 0 },
+  { "unsigned int|const uint8_t*,int,int,int,const int32_t*,const int32_t*,"
+    "unsigned int*",
+    RunObmcSubpelVariance, 0 },
+  { "int64_t|const uint8_t*,int,const uint8_t*,int,int,int", RunSse, 0 },
+  { "unsigned int|const uint8_t*,int", RunAvg, 0 },
+  { "void|const uint8_t*,int,const uint8_t*,int,int*,int*", RunMinMax, 0 },
+  { "void|uint8_t*,const uint8_t*,int,int,const uint8_t*,int", RunCompAvgPred,
+    0 },
+  { "void|uint8_t*,const uint8_t*,int,int,const uint8_t*,int,const uint8_t*,"
+    "int,int",
+    RunCompMaskPred, 0 },
+  { "void|uint8_t*,const uint8_t*,int,int,const uint8_t*,int,"
+    "const DIST_WTD_COMP_PARAMS*",
+    RunDistWtdCompAvgPred, 0 },
+  { "void|const int16_t*,int32_t*,int,TX_TYPE,int", RunFwdTxfm2d, 0 },
+  { "void|const int32_t*,uint16_t*,int,TX_TYPE,int", RunInvTxfm2dAdd, 0 },
+  { "void|const int16_t*,tran_low_t*,int,TxfmParam*", RunFwdTxfm, 0 },
+  { "void|const tran_low_t*,uint8_t*,int,const TxfmParam*", RunInvTxfmAdd,
+    0 },
+  { "void|const int16_t*,tran_low_t*,int", RunFdct, 0 },
+  { "void|const int16_t*,ptrdiff_t,tran_low_t*", RunHadamard, 0 },
+  { "void|const float*,float*,float*", RunFft, 0 },
+  { "void|const tran_low_t*,intptr_t,const int16_t*,const int16_t*,"
+    "const int16_t*,const int16_t*,tran_low_t*,tran_low_t*,const int16_t*,"
+    "uint16_t*,const int16_t*,const int16_t*",
+    RunQuantize, 0 },
+  { "void|const tran_low_t*,intptr_t,const int16_t*,const int16_t*,"
+    "const int16_t*,const int16_t*,tran_low_t*,tran_low_t*,const int16_t*,"
+    "uint16_t*,const int16_t*,const int16_t*,int",
+    RunQuantizeLogScale, 0 },
+  { "int64_t|const tran_low_t*,const tran_low_t*,intptr_t,int64_t*",
+    RunBlockError, 0 },
+  { "int64_t|const tran_low_t*,const tran_low_t*,intptr_t,int64_t*,int",
+    RunHighbdBlockError, 0 },
+  { "int|const tran_low_t*,int", RunSatd, 0 },
+  { "void|int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t",
+    RunSubtractBlock, 0 },
+  { "void|int,int,int16_t*,ptrdiff_t,const uint8_t*,ptrdiff_t,const uint8_t*,"
+    "ptrdiff_t,int",
+    RunHighbdSubtractBlock, 0 },
+  { "uint64_t|const int16_t*,int,int,int", RunSumSquares2d, 0 },
+  { "uint64_t|const int16_t*,uint32_t", RunSumSquares, 0 },
+  { "unsigned int|const int16_t*", RunGetMbSs, 16 * 16 },
+  { "uint64_t|const int16_t*,const int16_t*,const uint8_t*,int", RunWedgeSse,
+    0 },
+  { "int8_t|const int16_t*,const uint8_t*,int,int64_t", RunWedgeSign, 0 },
+  { "void|int16_t*,const int16_t*,const int16_t*,int", RunWedgeDeltaSquares,
+    0 },
+  { "void|uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*", RunLpf,
+    4 },
+  { "void|uint8_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*",
+    RunLpfDual, 8 },
+  { "void|uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,int",
+    RunHighbdLpf, 4 },
+  { "void|uint16_t*,int,const uint8_t*,const uint8_t*,const uint8_t*,"
+    "const uint8_t*,const uint8_t*,const uint8_t*,int",
+    RunHighbdLpfDual, 8 },
+  { "void|const uint8_t*,ptrdiff_t,uint8_t*,ptrdiff_t,const int16_t*,int,"
+    "const int16_t*,int,int,int",
+    RunConvolve8, 0 },
+  { "void|const uint8_t*,ptrdiff_t,uint8_t*,ptrdiff_t,const int16_t*,int,"
+    "const int16_t*,int,int,int,int",
+    RunHighbdConvolve8, 0 },
+  { "void|const uint8_t*,ptrdiff_t,uint8_t*,ptrdiff_t,const int16_t*,int,"
+    "const int16_t*,int,int,int,const ConvolveParams*",
+    RunWienerConvolve, 0 },
+  { "void|const uint8_t*,int,uint8_t*,int,int,int,const InterpFilterParams*,"
+    "const InterpFilterParams*,const int,const int,ConvolveParams*",
+    RunAv1Convolve, 0 },
+  { "void|const uint16_t*,int,uint16_t*,int,int,int,"
+    "const InterpFilterParams*,const InterpFilterParams*,const int,const int,"
+    "ConvolveParams*,int",
+    RunHighbdAv1Convolve, 0 },
+  { "void|uint8_t*,uint32_t,const uint8_t*,uint32_t,const uint8_t*,uint32_t,"
+    "const uint8_t*,uint32_t,int,int,int,int",
+    RunBlendA64Mask, 0 },
+  { "void|uint8_t*,uint32_t,const uint8_t*,uint32_t,const uint8_t*,uint32_t,"
+    "const uint8_t*,uint32_t,int,int,int,int,int",
+    RunHighbdBlendA64Mask, 0 },
+  { "void|uint8_t*,uint32_t,const uint8_t*,uint32_t,const uint8_t*,uint32_t,"
+    "const uint8_t*,int,int",
+    RunBlendA64Mask1d, 0 },
+  { "void|uint8_t*,uint32_t,const uint8_t*,uint32_t,const uint8_t*,uint32_t,"
+    "const uint8_t*,int,int,int",
+    RunHighbdBlendA64Mask1d, 0 },
+  { "int|const uint16_t*,int,int32_t*,int", RunCdefFindDir, 8 * 8 },
+};
+
+// Reduces a prototype to its return type and the types of its arguments, with
+// the argument names and the spaces around '*' dropped, e.g.
+// "unsigned int|const uint8_t*,int".
+std::string SignatureKey(const std::string &ret, const std::string &args) {
+  std::string key = ret + "|";
+  bool first = true;
+  size_t begin = 0;
+  while (begin <= args.size()) {
+    size_t end = args.find(',', begin);
+    if (end == std::string::npos) end = args.size();
+    std::string param = args.substr(begin, end - begin);
+    begin = end + 1;
+
+    const size_t bracket = param.find('[');
+    const bool is_array = bracket != std::string::npos;
+    if (is_array) param.erase(bracket);
+    std::vector<std::string> tokens;
+    for (size_t i = 0; i < param.size();) {
+      if (param[i] == '*') {
+        tokens.push_back("*");
+        ++i;
+      } else if (isalnum(param[i]) || param[i] == '_') {
+        size_t j = i;
+        while (j < param.size() && (isalnum(param[j]) || param[j] == '_')) ++j;
+        tokens.push_back(param.substr(i, j - i));
+        i = j;
+      } else {
+        ++i;
+      }
+    }
+    if (tokens.empty() || (tokens.size() == 1 && tokens[0] == "void")) continue;
+    // The last word is the argument name, unless the argument is unnamed.
+    if (tokens.size() > 1 && tokens.back() != "*") tokens.pop_back();
+
+    std::string type;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+      if (!type.empty() && tokens[i] != "*" && type[type.size() - 1] != '*') {
+        type += ' ';
+      }
+      type += tokens[i];
+    }
+    if (is_array) type += "[]";
+    if (!first) key += ',';
+    key += type;
+    first = false;
+  }
+  return key;
+}
+
+const Runner *FindRunner(const std::string &key) {
+  for (size_t i = 0; i < sizeof(kRunners) / sizeof(kRunners[0]); ++i) {
+    if (key == kRunners[i].signature) return &kRunners[i];
+  }
+  return NULL;
+}
+
+// Takes the block size from the last WxH or Wxh in |name|, and 32x32 for the
+// functions without one.
+void ParseBlockSize(std::string name, int *width, int *height) {
+  *width = *height = 32;
+  const std::string x4d = "x4d";
+  if (name.size() > x4d.size() &&
+      name.compare(name.size() - x4d.size(), x4d.size(), x4d) == 0) {
+    name.erase(name.size() - x4d.size());
+  }
+  for (size_t i = 1; i + 1 < name.size(); ++i) {
+    if (name[i] != 'x' || !isdigit(name[i - 1])) continue;
+    size_t begin = i;
+    while (begin > 0 && isdigit(name[begin - 1])) --begin;
+    const int w = atoi(name.c_str() + begin);
+    if (name[i + 1] == 'h') {
+      *width = *height = w;
+    } else if (isdigit(name[i + 1])) {
+      *width = w;
+      *height = atoi(name.c_str() + i + 1);
+    }
+  }
+  *width = clamp(*width, 1, 128);
+  *height = clamp(*height, 1, 128);
+}
+
+TX_SIZE FindTxSize(int width, int height) {
+  for (int i = 0; i < TX_SIZES_ALL; ++i) {
+    if (tx_size_wide[i] == width && tx_size_high[i] == height) {
+      return static_cast<TX_SIZE>(i);
+    }
+  }
+  return TX_32X32;
+}
+
+void SetUpArgs(const BenchBuffers &buffers, const std::string &name,
+               BenchArgs *args) {
+  const bool highbd = name.find("highbd") != std::string::npos;
+  ParseBlockSize(name, &args->width, &args->height);
+  if (name.find("_12_") != std::string::npos) {
+    args->bd = 12;
+  } else if (name.find("_10_") != std::string::npos || highbd) {
+    args->bd = 10;
+  } else {
+    args->bd = 8;
+  }
+  // The zone 1 predictors step along the above row, the zone 3 ones along the
+  // left column, both at 45 degrees.
+  const bool z3 = name.find("_z3") != std::string::npos;
+  args->dir_dx = z3 ? 1 : 64;
+  args->dir_dy = z3 ? 64 : 1;
+  args->compound = name.find("dist_wtd") != std::string::npos;
+  args->tx_size = FindTxSize(args->width, args->height);
+  buffers.SetUpArgs(highbd, args);
+}
+
+bool ArchSupported(const std::string &arch) {
+#if ARCH_X86 || ARCH_X86_64
+  static const struct {
+    const char *name;
+    int flag;
+  } kX86Archs[] = {
+    { "mmx", HAS_MMX },     { "sse", HAS_SSE },       { "sse2", HAS_SSE2 },
+    { "sse3", HAS_SSE3 },   { "ssse3", HAS_SSSE3 },   { "sse4_1", HAS_SSE4_1 },
+    { "sse4_2", HAS_SSE4_2 }, { "avx", HAS_AVX },     { "avx2", HAS_AVX2 },
+  };
+  const int caps = x86_simd_caps();
+  for (size_t i = 0; i < sizeof(kX86Archs) / sizeof(kX86Archs[0]); ++i) {
+    if (arch == kX86Archs[i].name) return (caps & kX86Archs[i].flag) != 0;
+  }
+#elif ARCH_ARM
+  if (arch == "neon") return (aom_arm_cpu_caps() & HAS_NEON) != 0;
+#else
+  (void)arch;
+#endif
+  return true;
+}
+
+// Returns the time taken by |iterations| calls, in TSC cycles on x86 and in
+// nanoseconds elsewhere.
+uint64_t TimeCalls(const Runner &runner, GenericFn fn, const BenchArgs &args,
+                   int iterations) {
+#if ARCH_X86 || ARCH_X86_64
+  const uint64_t start = x86_readtsc64();
+  runner.run(fn, args, iterations);
+  const uint64_t ticks = x86_readtsc64() - start;
+#else
+  aom_usec_timer timer;
+  aom_usec_timer_start(&timer);
+  runner.run(fn, args, iterations);
+  aom_usec_timer_mark(&timer);
+  const uint64_t ticks = 1000 * (uint64_t)aom_usec_timer_elapsed(&timer);
+#endif
+  libaom_test::ClearSystemState();
+  return ticks;
+}
+
+double TicksPerCall(const Runner &runner, GenericFn fn, const BenchArgs &args) {
+  int iterations = 1;
+  uint64_t ticks = TimeCalls(runner, fn, args, iterations);
+  while (ticks < kMinTicks && iterations < kMaxIterations) {
+    iterations *= 2;
+    ticks = TimeCalls(runner, fn, args, iterations);
+  }
+  for (int i = 1; i < kRepeats; ++i) {
+    ticks = AOMMIN(ticks, TimeCalls(runner, fn, args, iterations));
+  }
+  return static_cast<double>(ticks) / iterations;
+}
+
+void PrintNames(const std::vector<std::string> &names) {
+  for (size_t i = 0; i < names.size(); ++i) {
+    printf("    %s\n", names[i].c_str());
+  }
+}
+
+int Usage(const char *program) {
+  fprintf(stderr,
+          "Usage: %s [--filter=<substring>] [--verbose]\n"
+          "  --filter=<substring>  Time only the functions whose name "
+          "contains <substring>.\n"
+          "  --verbose             List every function that is not timed.\n",
+          program);
+  return EXIT_FAILURE;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  std::string filter;
+  bool verbose = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], "--filter=", 9) == 0) {
+      filter = argv[i] + 9;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else {
+      return Usage(argv[0]);
+    }
+  }
+
+  // The C versions of some functions call others through the rtcd pointers.
+  aom_dsp_rtcd();
+  av1_rtcd();
+
+  std::vector<Function> functions;
+  AddFunctions(&functions);
+  const BenchBuffers buffers;
+
+  int timed_functions = 0;
+  int timed_variants = 0;
+  std::vector<std::string> c_only;
+  std::map<std::string, std::vector<std::string> > gaps;
+  printf("%-44s %-7s %10s %8s\n", "function", "arch", kUnit, "vs c");
+  for (size_t i = 0; i < functions.size(); ++i) {
+    const Function &function = functions[i];
+    const std::string name = function.name;
+    if (name.find(filter) == std::string::npos) continue;
+    const std::string key = SignatureKey(function.ret, function.args);
+    const Runner *const runner = FindRunner(key);
+    if (runner == NULL) {
+      gaps[key].push_back(name);
+      continue;
+    }
+
+    BenchArgs args;
+    SetUpArgs(buffers, name, &args);
+    const int pixels =
+        runner->pixels ? runner->pixels : args.width * args.height;
+    double c_ticks = 0;
+    for (size_t j = 0; j < function.variants.size(); ++j) {
+      const Variant &variant = function.variants[j];
+      const char *const label = j == 0 ? function.name : "";
+      if (!ArchSupported(variant.arch)) {
+        printf("%-44s %-7s %10s\n", label, variant.arch, "-");
+        continue;
+      }
+      const double ticks = TicksPerCall(*runner, variant.fn, args);
+      if (j == 0) c_ticks = ticks;
+      printf("%-44s %-7s %10.3f %7.2fx\n", label, variant.arch, ticks / pixels,
+             c_ticks / ticks);
+      ++timed_variants;
+    }
+    fflush(stdout);
+    ++timed_functions;
+    if (function.variants.size() == 1) c_only.push_back(name);
+  }
+
+  int untimed_functions = 0;
+  std::vector<std::pair<size_t, std::string> > gaps_by_count;
+  for (std::map<std::string, std::vector<std::string> >::const_iterator it =
+           gaps.begin();
+       it != gaps.end(); ++it) {
+    untimed_functions += static_cast<int>(it->second.size());
+    gaps_by_count.push_back(std::make_pair(it->second.size(), it->first));
+  }
+  std::sort(gaps_by_count.rbegin(), gaps_by_count.rend());
+
+  printf("\nTimed %d variants of %d functions.\n", timed_variants,
+         timed_functions);
+  printf("%d of the timed functions have only a C version.\n",
+         static_cast<int>(c_only.size()));
+  if (verbose) PrintNames(c_only);
+  printf("%d functions have an argument list with no runner%s\n",
+         untimed_functions, untimed_functions ? ":" : ".");
+  for (size_t i = 0; i < gaps_by_count.size(); ++i) {
+    const std::vector<std::string> &names = gaps[gaps_by_count[i].second];
+    printf("%5d  %s (%s%s)\n", static_cast<int>(names.size()),
+           gaps_by_count[i].second.c_str(), names[0].c_str(),
+           names.size() > 1 ? ", ..." : "");
+    if (verbose) PrintNames(names);
+  }
+  return EXIT_SUCCESS;
+}